@@ -0,0 +1,141 @@
+// gm_convert.cpp
+//
+// Converts gridmaps from the ASCII format of the MovingAI benchmarks
+// into the binary format of warthog::gridmap (see src/domains/gridmap.h),
+// or of warthog::blockmap (see src/domains/blockmap.h) for very large maps.
+// Binary maps are memory-mapped on load instead of being parsed.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "blockmap.h"
+#include "cfg.h"
+#include "gridmap.h"
+#include "timer.h"
+
+#include "getopt.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// display program help on startup
+int print_help = 0;
+// check the output by loading it again
+int verify = 0;
+// write a blockmap instead of a gridmap
+int blocked = 0;
+
+void
+help()
+{
+    std::cerr
+        << "==> manual <==\n"
+        << "This program converts gridmaps into the binary format read by warthog\n\n"
+        << "\t--map [map file] (required; ASCII or binary)\n"
+        << "\t--out [file] (optional; default is [map file].gmb, or .bmb)\n"
+        << "\t--blocked (optional; write the blocked format read by --blocked)\n"
+        << "\t--verify (optional; reload the output and compare it with the input)\n"
+        << "Programs that read maps accept both formats; binary files are\n"
+        << "recognised by their contents, not by their name.\n";
+}
+
+int
+convert_blocked(std::string mapname, std::string outname)
+{
+    warthog::timer t;
+    t.start();
+    warthog::blockmap map(mapname.c_str());
+    t.stop();
+    std::cerr << "read " << mapname << " (" << map.header_width() << "x"
+        << map.header_height() << ", " << map.get_num_blocks()
+        << " blocks) in " << t.elapsed_time_micro() << " us\n";
+
+    if(!map.save_binary(outname.c_str())) { exit(1); }
+    std::cerr << "wrote " << outname << "\n";
+
+    if(verify)
+    {
+        t.start();
+        warthog::blockmap copy(outname.c_str());
+        t.stop();
+        std::cerr << "reloaded in " << t.elapsed_time_micro() << " us\n";
+
+        bool same = copy.get_num_traversable_tiles() ==
+            map.get_num_traversable_tiles();
+        for(uint32_t id = 0; same && id < map.padded_mapsize(); id++)
+        { same = copy.get_label(id) == map.get_label(id); }
+        if(!same)
+        {
+            std::cerr << "err; " << outname << " does not match " << mapname
+                << "\n";
+            exit(1);
+        }
+        std::cerr << "verified\n";
+    }
+    return 0;
+}
+
+int
+main(int argc, char** argv)
+{
+	warthog::util::param valid_args[] =
+	{
+		{"map",  required_argument, 0, 1},
+		{"out",  required_argument, 0, 1},
+		{"verify", no_argument, &verify, 1},
+		{"blocked", no_argument, &blocked, 1},
+		{"help", no_argument, &print_help, 1},
+		{0,  0, 0, 0}
+	};
+
+	warthog::util::cfg cfg;
+	cfg.parse_args(argc, argv, "", valid_args);
+
+    std::string mapname = cfg.get_param_value("map");
+    if(argc == 1 || print_help || mapname == "")
+    {
+		help();
+        exit(0);
+    }
+
+    std::string outname = cfg.get_param_value("out");
+    if(outname == "") { outname = mapname + (blocked ? ".bmb" : ".gmb"); }
+    if(blocked) { return convert_blocked(mapname, outname); }
+
+    warthog::timer t;
+    t.start();
+    warthog::gridmap map(mapname.c_str());
+    t.stop();
+    std::cerr << "read " << mapname << " (" << map.header_width() << "x"
+        << map.header_height() << ") in " << t.elapsed_time_micro()
+        << " us\n";
+
+    if(!map.save_binary(outname.c_str())) { exit(1); }
+    std::cerr << "wrote " << outname << "\n";
+
+    if(verify)
+    {
+        t.start();
+        warthog::gridmap copy(outname.c_str());
+        t.stop();
+        std::cerr << "reloaded in " << t.elapsed_time_micro() << " us\n";
+
+        warthog::gridmap* rmap = map.rotated_copy();
+        warthog::gridmap* rcopy = copy.rotated_copy();
+        bool same = copy.checksum() == map.checksum() &&
+            rcopy->checksum() == rmap->checksum() &&
+            copy.get_num_traversable_tiles() == map.get_num_traversable_tiles();
+        delete rmap;
+        delete rcopy;
+        if(!same)
+        {
+            std::cerr << "err; " << outname << " does not match " << mapname
+                << "\n";
+            exit(1);
+        }
+        std::cerr << "verified\n";
+    }
+    return 0;
+}
@@ -0,0 +1,114 @@
+// make_cpd.cpp
+//
+// Builds the Compressed Path Database (warthog::cpd::graph_oracle) of a
+// road graph, or of the graph of a gridmap, on every core. The output
+// file is written row by row as the build goes; if a build stops
+// before it is done, running it again with the same output file only
+// computes the missing rows (see src/cpd/graph_oracle_builder.h).
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "cfg.h"
+#include "dimacs_parser.h"
+#include "graph_oracle.h"
+#include "graph_oracle_builder.h"
+#include "gridmap.h"
+#include "timer.h"
+#include "xy_graph.h"
+
+#include "getopt.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// display program help on startup
+int print_help = 0;
+// check the output by loading it again
+int verify = 0;
+
+void
+help()
+{
+    std::cerr
+        << "==> manual <==\n"
+        << "This program computes the CPD of a graph, using every core\n\n"
+        << "\t--input [gr file] [co file] (a DIMACS graph; or --map)\n"
+        << "\t--map [map file] (the graph of a gridmap; or --input)\n"
+        << "\t--out [file] (required)\n"
+        << "\t--verify (optional; reload the output and compare it with the CPD)\n"
+        << "Rows are written to the output as soon as they are done. If the\n"
+        << "output already holds some of the rows of the same graph (e.g.\n"
+        << "because an earlier build was stopped), only the others are computed.\n"
+        << "Until the build is done, [file].ckpt records which graph the rows\n"
+        << "are for; a partial output of another graph is an error.\n";
+}
+
+int
+main(int argc, char** argv)
+{
+	warthog::util::param valid_args[] =
+	{
+		{"input",  required_argument, 0, 1},
+		{"map",  required_argument, 0, 1},
+		{"out",  required_argument, 0, 1},
+		{"verify", no_argument, &verify, 1},
+		{"help", no_argument, &print_help, 1},
+		{0,  0, 0, 0}
+	};
+
+	warthog::util::cfg cfg;
+	cfg.parse_args(argc, argv, "", valid_args);
+
+    std::string grfile = cfg.get_param_value("input");
+    std::string cofile = cfg.get_param_value("input");
+    std::string mapname = cfg.get_param_value("map");
+    std::string outname = cfg.get_param_value("out");
+    if(argc == 1 || print_help || outname == "" ||
+       (mapname == "" && (grfile == "" || cofile == "")))
+    {
+		help();
+        exit(0);
+    }
+
+    warthog::timer t;
+    t.start();
+    warthog::graph::xy_graph g;
+    if(mapname != "")
+    {
+        warthog::gridmap map(mapname.c_str());
+        warthog::graph::gridmap_to_xy_graph(&map, &g);
+    }
+    else
+    {
+        warthog::dimacs_parser dimacs(cofile.c_str(), grfile.c_str());
+        warthog::graph::dimacs_to_xy_graph(dimacs, g);
+    }
+    t.stop();
+    std::cerr << "read graph with " << g.get_num_nodes() << " nodes and "
+        << g.get_num_edges_out() << " edges in "
+        << t.elapsed_time_micro() / 1e6 << " s\n";
+
+    warthog::cpd::graph_oracle cpd(&g);
+    warthog::cpd::graph_oracle_builder<warthog::cpd::FORWARD> builder(&cpd);
+    if(!builder.build(outname.c_str())) { exit(1); }
+    std::cerr << "wrote " << outname << "; memory: " << cpd.mem() << "\n";
+
+    if(verify)
+    {
+        warthog::cpd::graph_oracle copy(&g);
+        std::ifstream in(outname.c_str(),
+                std::ios_base::in | std::ios_base::binary);
+        in >> copy;
+        if(!in.good() || !(copy == cpd))
+        {
+            std::cerr << "err; " << outname << " does not match the cpd\n";
+            exit(1);
+        }
+        std::cerr << "verified\n";
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+// trace_decode.cpp
+//
+// Decodes binary search traces written by warthog::trace_listener
+// (see src/search/trace_listener.h) into CSV or into PPM frames.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "cfg.h"
+#include "gridmap.h"
+#include "trace_listener.h"
+
+#include "getopt.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// display program help on startup
+int print_help = 0;
+
+static const char* event_names[] =
+    { "query", "expand", "generate", "relax", "jump" };
+
+void
+help()
+{
+    std::cerr
+        << "==> manual <==\n"
+        << "This program decodes search traces recorded with warthog --trace\n\n"
+        << "\t--trace [file] (required)\n"
+        << "\t--ppm [prefix] (optional; write PPM frames instead of CSV)\n"
+        << "\t--map [map file] (optional; draws obstacles in PPM frames)\n"
+        << "\t--query [n] (optional; decode only the n-th query, from 0)\n"
+        << "\t--step [k] (optional; write a PPM frame every k expansions)\n"
+        << "Without --ppm all events are written to stdout as CSV.\n"
+        << "PPM frames are written to [prefix]-[query]-[frame].ppm\n";
+}
+
+struct frame_writer
+{
+    frame_writer(warthog::trace::header& hdr, warthog::gridmap* map,
+            std::string prefix)
+        : hdr_(hdr), prefix_(prefix)
+    {
+        background_.resize(3 * (size_t)hdr.width_ * hdr.height_, 255);
+        if(map)
+        {
+            for(uint32_t y = 0; y < hdr.height_; y++)
+            for(uint32_t x = 0; x < hdr.width_; x++)
+            {
+                if(x >= map->header_width() || y >= map->header_height())
+                { continue; }
+                if(!map->get_label(map->to_padded_id(x, y)))
+                { paint(background_, x, y, 64, 64, 64); }
+            }
+        }
+    }
+
+    void
+    begin_query(uint32_t query)
+    {
+        pixels_ = background_;
+        query_ = query;
+        frame_ = 0;
+        last_expanded_ = warthog::GRID_ID_MAX;
+    }
+
+    void
+    apply(warthog::trace::event& e)
+    {
+        switch(e.type_)
+        {
+            case warthog::trace::QUERY:
+                paint(pixels_, e.id_, 255, 0, 0);
+                break;
+            case warthog::trace::EXPAND:
+                paint(pixels_, e.id_, 255, 160, 0);
+                last_expanded_ = e.id_;
+                break;
+            case warthog::trace::GENERATE:
+            case warthog::trace::RELAX:
+                paint(pixels_, e.id_, 120, 170, 255);
+                break;
+            case warthog::trace::JUMP:
+                segment(e.from_, e.id_);
+                break;
+        }
+    }
+
+    // write the current state of the search; the last node expanded
+    // (i.e. the target, at the end of a successful query) is highlighted
+    void
+    write()
+    {
+        std::vector<uint8_t> out = pixels_;
+        if(last_expanded_ != warthog::GRID_ID_MAX)
+        { paint(out, last_expanded_, 255, 0, 255); }
+
+        std::stringstream fname;
+        fname << prefix_ << "-" << query_ << "-" << frame_++ << ".ppm";
+        FILE* fd = fopen(fname.str().c_str(), "wb");
+        if(fd == 0)
+        {
+            std::cerr << "err; cannot write " << fname.str() << "\n";
+            exit(1);
+        }
+        fprintf(fd, "P6\n%u %u\n255\n", hdr_.width_, hdr_.height_);
+        fwrite(&out[0], 1, out.size(), fd);
+        fclose(fd);
+    }
+
+    private:
+        warthog::trace::header hdr_;
+        std::string prefix_;
+        std::vector<uint8_t> background_;
+        std::vector<uint8_t> pixels_;
+        uint32_t query_;
+        uint32_t frame_;
+        warthog::grid_id_t last_expanded_;
+
+        void
+        paint(std::vector<uint8_t>& px, uint32_t x, uint32_t y,
+                uint8_t r, uint8_t g, uint8_t b)
+        {
+            if(x >= hdr_.width_ || y >= hdr_.height_) { return; }
+            size_t i = 3 * ((size_t)y * hdr_.width_ + x);
+            px[i] = r; px[i+1] = g; px[i+2] = b;
+        }
+
+        void
+        paint(std::vector<uint8_t>& px, warthog::grid_id_t padded_id,
+                uint8_t r, uint8_t g, uint8_t b)
+        {
+            int32_t x, y;
+            to_xy(padded_id, x, y);
+            if(x < 0 || y < 0) { return; }
+            paint(px, (uint32_t)x, (uint32_t)y, r, g, b);
+        }
+
+        // jump segments are a diagonal prefix followed by a straight suffix
+        void
+        segment(warthog::grid_id_t from_id, warthog::grid_id_t to_id)
+        {
+            int32_t x, y, x2, y2;
+            to_xy(from_id, x, y);
+            to_xy(to_id, x2, y2);
+            while(x != x2 || y != y2)
+            {
+                x += (x2 > x) - (x2 < x);
+                y += (y2 > y) - (y2 < y);
+                if(x == x2 && y == y2) { break; }
+                paint(pixels_, (uint32_t)x, (uint32_t)y, 0, 200, 0);
+            }
+        }
+
+        void
+        to_xy(warthog::grid_id_t padded_id, int32_t& x, int32_t& y)
+        {
+            if(padded_id < hdr_.origin_) { x = y = -1; return; }
+            padded_id -= hdr_.origin_;
+            y = (int32_t)(padded_id / hdr_.padded_width_);
+            x = (int32_t)(padded_id % hdr_.padded_width_);
+        }
+};
+
+int
+main(int argc, char** argv)
+{
+	warthog::util::param valid_args[] =
+	{
+		{"trace",  required_argument, 0, 1},
+		{"ppm",  required_argument, 0, 1},
+		{"map",  required_argument, 0, 1},
+		{"query",  required_argument, 0, 1},
+		{"step",  required_argument, 0, 1},
+		{"help", no_argument, &print_help, 1},
+		{0,  0, 0, 0}
+	};
+
+	warthog::util::cfg cfg;
+	cfg.parse_args(argc, argv, "", valid_args);
+
+    std::string tracefile = cfg.get_param_value("trace");
+    if(argc == 1 || print_help || tracefile == "")
+    {
+		help();
+        exit(0);
+    }
+
+    std::string prefix = cfg.get_param_value("ppm");
+    std::string mapname = cfg.get_param_value("map");
+    std::string qstr = cfg.get_param_value("query");
+    std::string sstr = cfg.get_param_value("step");
+    int64_t only_query = qstr == "" ? -1 : atol(qstr.c_str());
+    uint32_t step = sstr == "" ? 0 : (uint32_t)atol(sstr.c_str());
+
+    FILE* fd = fopen(tracefile.c_str(), "rb");
+    if(fd == 0)
+    {
+        std::cerr << "err; cannot open trace file " << tracefile << "\n";
+        exit(1);
+    }
+
+    warthog::trace::header hdr;
+    if(fread(&hdr, sizeof(hdr), 1, fd) != 1 ||
+       memcmp(hdr.magic_, warthog::trace::TRACE_MAGIC, 4) != 0 ||
+       (hdr.version_ != 1 && hdr.version_ != 2))
+    {
+        std::cerr << "err; " << tracefile << " is not a valid trace file\n";
+        exit(1);
+    }
+    if(hdr.version_ != warthog::trace::TRACE_VERSION)
+    {
+        std::cerr << "err; " << tracefile << " has "
+            << (hdr.version_ == 2 ? 64 : 32) << "-bit ids; decode it with a "
+            << "build that has the same (see -DGRID_ID64)\n";
+        exit(1);
+    }
+
+    bool ppm = prefix != "";
+    bool has_geometry = hdr.padded_width_ != 0;
+    if(ppm && !has_geometry)
+    {
+        std::cerr << "err; trace has no grid geometry; cannot write PPM\n";
+        exit(1);
+    }
+
+    warthog::gridmap* map = 0;
+    if(mapname != "") { map = new warthog::gridmap(mapname.c_str()); }
+    frame_writer* frames = ppm ? new frame_writer(hdr, map, prefix) : 0;
+
+    if(!ppm)
+    { std::cout << "query,event,id,x,y,from,from_x,from_y,g,dir\n"; }
+
+    int64_t query = -1;
+    uint32_t expansions = 0;
+    std::vector<warthog::trace::event> buf(1 << 16);
+    size_t num_read;
+    while((num_read = fread(&buf[0], sizeof(warthog::trace::event),
+                    buf.size(), fd)) > 0)
+    {
+        for(size_t i = 0; i < num_read; i++)
+        {
+            warthog::trace::event& e = buf[i];
+            if(e.type_ == warthog::trace::QUERY)
+            {
+                if(frames && query >= 0 &&
+                   (only_query < 0 || query == only_query))
+                { frames->write(); }
+                query++;
+                expansions = 0;
+                if(frames) { frames->begin_query((uint32_t)query); }
+            }
+            if(only_query >= 0 && query != only_query) { continue; }
+
+            if(frames)
+            {
+                frames->apply(e);
+                if(e.type_ == warthog::trace::EXPAND && step &&
+                   (++expansions % step) == 0)
+                { frames->write(); }
+                continue;
+            }
+
+            int64_t x = -1, y = -1, fx = -1, fy = -1;
+            if(has_geometry)
+            {
+                if(e.id_ >= hdr.origin_)
+                {
+                    x = (e.id_ - hdr.origin_) % hdr.padded_width_;
+                    y = (e.id_ - hdr.origin_) / hdr.padded_width_;
+                }
+                if(e.from_ != warthog::GRID_ID_MAX && e.from_ >= hdr.origin_)
+                {
+                    fx = (e.from_ - hdr.origin_) % hdr.padded_width_;
+                    fy = (e.from_ - hdr.origin_) / hdr.padded_width_;
+                }
+            }
+            std::cout
+                << query << ","
+                << (e.type_ <= warthog::trace::JUMP ?
+                        event_names[e.type_] : "unknown") << ","
+                << e.id_ << "," << x << "," << y << ","
+                << (e.from_ == warthog::GRID_ID_MAX ? -1 : (int64_t)e.from_)
+                << ","
+                << fx << "," << fy << ","
+                << e.g_ << "," << (uint32_t)e.dir_ << "\n";
+        }
+    }
+    if(frames && query >= 0 && (only_query < 0 || query == only_query))
+    { frames->write(); }
+
+    fclose(fd);
+    delete frames;
+    delete map;
+    return 0;
+}
@@ -7,23 +7,37 @@
 // @created: 2016-11-23
 //
 
+#include "blockmap.h"
+#include "rle_gridmap.h"
 #include "cfg.h"
 #include "constants.h"
 #include "flexible_astar.h"
 #include "gridmap.h"
 #include "gridmap_expansion_policy.h"
+#include "hpa_expansion_policy.h"
+#include "hpa_graph.h"
+#include "hpa_search.h"
+#include "grid_cpd_search.h"
+#include "grid_oracle.h"
 #include "jps_expansion_policy.h"
 #include "jps2_expansion_policy.h"
 #include "jps2_expansion_policy_prune2.h"
+#include "jps2plus_expansion_policy.h"
+#include "component_labelling.h"
+#include "jps_bb_labelling.h"
+#include "landmark_heuristic.h"
 #include "octile_heuristic.h"
+#include "query_server.h"
 #include "scenario_manager.h"
 #include "timer.h"
+#include "trace_listener.h"
 #include "nodemap.h"
 #include "zero_heuristic.h"
 
 #include "getopt.h"
 #include "global.h"
 
+#include <atomic>
 #include <fstream>
 #include <functional>
 #include <iomanip>
@@ -32,6 +46,8 @@
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <thread>
+#include <vector>
 
 namespace G = global;
 // check computed solutions are optimal
@@ -41,6 +57,32 @@ int verbose = 0;
 // display program help on startup
 int print_help = 0;
 long long tot = 0;
+// record a binary search trace to this file (jps2, jps2-prune2, astar)
+std::string tracefile = "";
+// per-query wall-clock limit, in microseconds (0 = no limit)
+double time_limit_us = 0;
+// use a landmark heuristic with this many landmarks (jps2, jps2-prune2, astar)
+uint32_t num_landmarks = 0;
+// store landmark distances in 16 (cf. 32) bits
+int lm16 = 0;
+// prune jump directions with geometric containers (jps2, jps2-prune2)
+int bbox = 0;
+// fail at once on queries between disconnected cells (jps, jps2, jps2-prune2)
+int components = 0;
+// number of worker threads used to solve the instances
+uint32_t num_threads = 1;
+// search a block-tiled copy of the map (jps2, jps2-prune2)
+int blocked = 0;
+// search a run-length encoded copy of the map (jps2)
+int rle = 0;
+// keep jump tables in 8 (cf. 16) bits (jps2+)
+int jp8 = 0;
+// width and height of the clusters of the hpa abstraction (hpa, hpa-exact)
+uint32_t cluster_size = 32;
+// memory limit for the maps kept by --serve, in bytes (0 = no limit)
+size_t map_budget = 0;
+// entries in the query cache of --serve (0 = no cache)
+uint32_t cache_entries = 0;
 
 void
 help()
@@ -57,11 +99,34 @@ help()
     << "\t--map [map file] (optional; specify this to override map values in scen file) \n"
 	<< "\t--checkopt (optional; compare solution costs against values in the scen file)\n"
 	<< "\t--verbose (optional; prints debugging info when compiled with debug symbols)\n"
+	<< "\t--trace [file] (optional; record a binary search trace; see bin/trace_decode)\n"
+	<< "\t--timeout [micros] (optional; per-query wall-clock limit)\n"
+	<< "\t--landmarks [num] (optional; use a landmark heuristic, tables go in [map file].lm)\n"
+	<< "\t--lm16 (optional; store landmark distances in 16 bits)\n"
+	<< "\t--bbox (optional; prune jumps with bounding boxes, stored in [map file].jbb)\n"
+	<< "\t--components (optional; label connected components, and fail at once\n"
+	<< "\t\ton queries between disconnected cells; jps, jps2, jps2-prune2)\n"
+	<< "\t--threads [num] (optional; solve instances in parallel; not with --trace)\n"
+	<< "\t--blocked (optional; jps2 and jps2-prune2 on a blockmap, for very large\n"
+	<< "\t\tmaps; reads [map file] in any format, see bin/gm_convert --blocked.\n"
+	<< "\t\tslower than the default on maps that fit in memory)\n"
+	<< "\t--rle (optional; jps2 on a run-length encoded map, for large open maps;\n"
+	<< "\t\tabout 4x slower than the default on maps with many obstacles)\n"
+	<< "\t--cluster [size] (optional; cluster size of hpa and hpa-exact; default 32)\n"
+	<< "\t--jp8 (optional; jps2+ keeps jump distances in 8 bits, in memory only;\n"
+	<< "\t\t[map file].jps+ holds the 16 bit table, which is compressed on load)\n"
+    << "\t--serve [socket file or -] (replaces --scen; answer queries on a unix\n"
+    << "\t\tsocket or on stdin, keeping maps in memory; see util/query_server.h)\n"
+    << "\t--budget [MB] (optional; with --serve, evict least recently used maps\n"
+    << "\t\twhen resident maps and their indexes use more memory than this)\n"
+    << "\t--cache [entries] (optional; with --serve, answer repeated queries, and\n"
+    << "\t\tqueries along paths found before, from a cache of this many paths)\n"
     << "Invoking the program this way solves all instances in [scen file] with algorithm [alg]\n"
     << "Currently recognised values for [alg]:\n"
     << "\tcbs_ll, cbs_ll_w, dijkstra, astar, astar_wgm, astar4c, sipp\n"
     << "\tsssp, jps, jps2, jps+, jps2+, jps, jps4c\n"
-    << "\tdfs, gdfs\n\n"
+    << "\tdfs, gdfs, hpa, hpa-exact, grid-cpd\n"
+    << "\t(grid-cpd keeps its database in [map file].gcpd)\n\n"
     << ""
     << "The following are valid parameters for GENERATING instances:\n"
     << "\t --gen [map file (required)]\n"
@@ -99,6 +164,32 @@ check_optimality(warthog::solution& sol, warthog::experiment* exp)
     return true;
 }
 
+void
+print_result(std::ostream& out, uint32_t i, std::string& alg_name,
+        warthog::solution& sol, uint32_t scan_cnt,
+        warthog::scenario_manager& scenmgr)
+{
+		out
+            << i<<"\t" 
+            << alg_name << "\t" 
+            << sol.nodes_expanded_ << "\t" 
+            << sol.nodes_inserted_ << "\t"
+            << sol.nodes_touched_ << "\t"
+            << sol.time_elapsed_nano_ << "\t"
+            << sol.sum_of_edge_costs_ << "\t" 
+            << scan_cnt << "\t"
+            << scenmgr.last_file_loaded() 
+            << std::endl;
+}
+
+void
+print_throughput(uint32_t num_queries, double nanos, uint32_t threads)
+{
+    std::cerr << "throughput: " << num_queries << " queries in " 
+        << nanos / 1e9 << " s (" << (num_queries / (nanos / 1e9)) 
+        << " queries/sec, " << threads << " threads)\n";
+}
+
 void
 run_experiments(warthog::search* algo, std::string alg_name,
         warthog::scenario_manager& scenmgr, bool verbose, bool checkopt,
@@ -109,6 +200,9 @@ run_experiments(warthog::search* algo, std::string alg_name,
   /*       << "\tnanos\tpcost\tplen\tmap\n"; */
 	std::cout << "id\talg\texpd\tgend\ttouched\ttime\tcost\tscnt\tsfile\n";
   tot = 0;
+  if(time_limit_us > 0) { algo->set_time_cutoff_nano(time_limit_us * 1000); }
+  warthog::timer mytimer;
+  mytimer.start();
 	for(unsigned int i=0; i < scenmgr.num_experiments(); i++)
 	{
 		warthog::experiment* exp = scenmgr.get_experiment(i);
@@ -120,30 +214,207 @@ run_experiments(warthog::search* algo, std::string alg_name,
         G::statis::clear();
         algo->get_path(pi, sol);
 
-		out
-            << i<<"\t" 
-            << alg_name << "\t" 
-            << sol.nodes_expanded_ << "\t" 
-            << sol.nodes_inserted_ << "\t"
-            << sol.nodes_touched_ << "\t"
-            << sol.time_elapsed_nano_ << "\t"
-            << sol.sum_of_edge_costs_ << "\t" 
-            << G::statis::scan_cnt << "\t"
-            << scenmgr.last_file_loaded() 
-            << std::endl;
+        print_result(out, i, alg_name, sol, G::statis::scan_cnt, scenmgr);
 
     tot += G::statis::scan_cnt;
-        if(checkopt) { check_optimality(sol, exp); }
+        if(checkopt && sol.status_ != warthog::solution::TIMED_OUT)
+        { check_optimality(sol, exp); }
 	}
+  mytimer.stop();
+  print_throughput(scenmgr.num_experiments(), mytimer.elapsed_time_nano(), 1);
 }
 
+// everything one search needs, except the map and the heuristic
+// (both are read-only and shared between threads)
+template<typename H, typename E>
+struct search_context
+{
+    E expander_;
+    warthog::pqueue_min open_;
+    warthog::flexible_astar<H, E, warthog::pqueue_min> astar_;
+
+    // NB: construct on the thread that runs the search; the
+    // (thread-local) globals used by the pruning expanders are set here
+    template<typename M>
+    search_context(H* heuristic, M* map)
+        : expander_(map), astar_(heuristic, &expander_, &open_)
+    {
+        bind(map);
+    }
+
+    void
+    bind(warthog::gridmap* map)
+    {
+        G::nodepool = expander_.get_nodepool();
+        G::query::map = map;
+        G::query::open = &open_;
+    }
+
+    // G::query::map is only read by the statistics of CNT builds
+    template<typename M>
+    void
+    bind(M*)
+    {
+        G::nodepool = expander_.get_nodepool();
+        G::query::map = 0;
+        G::query::open = &open_;
+    }
+};
+
+// expanders that write to the map during search (prune2 places temporary
+// obstacles) cannot share it between threads
+template<typename E>
+struct writes_map { static const bool value = false; };
+
+template<typename M>
+struct writes_map<warthog::jps2_expansion_policy_prune2_base<M> >
+{ static const bool value = true; };
+
+// solves the instances of @param scenmgr with ::num_threads workers.
+// each worker takes the next unsolved instance until none are left;
+// results are reported in input order once all workers are done.
+// @param configure is applied to the expander of every worker
+template<typename H, typename E, typename M>
+void
+run_experiments_parallel(H* heuristic, M* map,
+        std::function<void(E&)> configure, std::string alg_name,
+        warthog::scenario_manager& scenmgr)
+{
+    struct result
+    {
+        warthog::solution sol_;
+        uint32_t scan_cnt_;
+    };
+    uint32_t num_queries = scenmgr.num_experiments();
+    std::vector<result> results(num_queries);
+    std::atomic<uint32_t> next(0);
+
+    std::function<void()> worker = [&]() -> void
+    {
+        std::unique_ptr<M> own_map;
+        if(writes_map<E>::value)
+        { own_map.reset(new M(map->filename())); }
+
+        search_context<H, E> ctx(heuristic,
+                own_map ? own_map.get() : map);
+        configure(ctx.expander_);
+        if(time_limit_us > 0)
+        { ctx.astar_.set_time_cutoff_nano(time_limit_us * 1000); }
+
+        for(uint32_t i = next++; i < num_queries; i = next++)
+        {
+            warthog::experiment* exp = scenmgr.get_experiment(i);
+            uint32_t startid = exp->starty() * exp->mapwidth() + exp->startx();
+            uint32_t goalid = exp->goaly() * exp->mapwidth() + exp->goalx();
+            warthog::problem_instance pi(startid, goalid, verbose);
+            G::statis::clear();
+            ctx.astar_.get_path(pi, results[i].sol_);
+            results[i].scan_cnt_ = G::statis::scan_cnt;
+        }
+    };
+
+    warthog::timer mytimer;
+    mytimer.start();
+    std::vector<std::thread> threads;
+    for(uint32_t t = 0; t < num_threads; t++)
+    { threads.push_back(std::thread(worker)); }
+    for(std::thread& t : threads) { t.join(); }
+    mytimer.stop();
+
+	std::cout << "id\talg\texpd\tgend\ttouched\ttime\tcost\tscnt\tsfile\n";
+    tot = 0;
+    for(uint32_t i = 0; i < num_queries; i++)
+    {
+        print_result(std::cout, i, alg_name, results[i].sol_,
+                results[i].scan_cnt_, scenmgr);
+        tot += results[i].scan_cnt_;
+        if(checkopt && results[i].sol_.status_ != warthog::solution::TIMED_OUT)
+        { check_optimality(results[i].sol_, scenmgr.get_experiment(i)); }
+    }
+    print_throughput(num_queries, mytimer.elapsed_time_nano(), num_threads);
+}
+
+// load the jps bounding boxes of @param map, or compute (and save) them
+std::shared_ptr<warthog::label::jps_bb_labelling>
+load_bb_labelling(warthog::gridmap& map, std::string mapname)
+{
+    std::string bbfile = mapname + ".jbb";
+    std::shared_ptr<warthog::label::jps_bb_labelling> bbl(
+            new warthog::label::jps_bb_labelling(&map));
+    if(!bbl->load(bbfile.c_str()))
+    {
+        bbl->precompute();
+        bbl->save(bbfile.c_str());
+    }
+    return bbl;
+}
+
+// label the connected components of @param map
+std::shared_ptr<warthog::label::component_labelling>
+make_component_labelling(warthog::gridmap& map)
+{
+    std::shared_ptr<warthog::label::component_labelling> cl(
+            new warthog::label::component_labelling(&map));
+    cl->precompute();
+    return cl;
+}
+
+// search with a landmark heuristic instead of octile distance
+template<typename EXPANDER>
+void
+run_landmarks(warthog::gridmap& map, std::function<void(EXPANDER&)> configure,
+        warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    std::string lmfile = mapname + ".lm";
+    warthog::landmark_heuristic heuristic(
+            &map, lmfile.c_str(), num_landmarks, lm16 ? 2 : 4);
+    std::cerr << "landmarks: " << heuristic.get_num_landmarks() << "\n";
+
+    if(num_threads > 1)
+    {
+        run_experiments_parallel<warthog::landmark_heuristic, EXPANDER>(
+                &heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
+    search_context<warthog::landmark_heuristic, EXPANDER> ctx(&heuristic, &map);
+    configure(ctx.expander_);
+    run_experiments(&ctx.astar_, alg_name, scenmgr,
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< ctx.astar_.mem() + scenmgr.mem()
+            << ", tot scan: " << tot << "\n";
+}
 
 void
 run_jps2(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
     warthog::gridmap map(mapname.c_str());
-	warthog::jps2_expansion_policy expander(&map);
+    std::shared_ptr<warthog::label::jps_bb_labelling> bbl;
+    if(bbox) { bbl = load_bb_labelling(map, mapname); }
+    std::shared_ptr<warthog::label::component_labelling> cl;
+    if(components) { cl = make_component_labelling(map); }
+    std::function<void(warthog::jps2_expansion_policy&)> configure =
+        [bbl, cl](warthog::jps2_expansion_policy& exp) 
+        {
+            exp.set_bb_labelling(bbl.get());
+            exp.set_component_labelling(cl.get());
+        };
+
+    if(num_landmarks)
+    {
+        run_landmarks(map, configure, scenmgr, mapname, alg_name);
+        return;
+    }
 	warthog::octile_heuristic heuristic(map.width(), map.height());
+    if(num_threads > 1 && tracefile == "")
+    {
+        run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
+	warthog::jps2_expansion_policy expander(&map);
+    configure(expander);
     warthog::pqueue_min open;
 
 	warthog::flexible_astar<
@@ -154,8 +425,26 @@ run_jps2(warthog::scenario_manager& scenmgr, std::string mapname, std::string al
 
     tot = 0;
     G::nodepool = expander.get_nodepool();
-    run_experiments(&astar, alg_name, scenmgr, 
-            verbose, checkopt, std::cout);
+    if(tracefile != "")
+    {
+        warthog::trace_listener tracer(tracefile.c_str(), &map);
+        expander.set_trace_listener(&tracer);
+        warthog::flexible_astar<
+            warthog::octile_heuristic,
+            warthog::jps2_expansion_policy,
+            warthog::pqueue_min,
+            warthog::trace_listener>
+                tastar(&heuristic, &expander, &open, &tracer);
+        run_experiments(&tastar, alg_name, scenmgr,
+                verbose, checkopt, std::cout);
+        expander.set_trace_listener(0);
+        std::cerr << "trace: " << tracer.num_events() << " events\n";
+    }
+    else
+    {
+        run_experiments(&astar, alg_name, scenmgr,
+                verbose, checkopt, std::cout);
+    }
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() 
             << ", tot scan: " << tot << "\n";
 }
@@ -163,8 +452,31 @@ void
 run_jps2_prune2(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
   warthog::gridmap map(mapname.c_str());
-	warthog::jps2_expansion_policy_prune2 expander(&map);
+  std::shared_ptr<warthog::label::jps_bb_labelling> bbl;
+  if(bbox) { bbl = load_bb_labelling(map, mapname); }
+  std::shared_ptr<warthog::label::component_labelling> cl;
+  if(components) { cl = make_component_labelling(map); }
+  std::function<void(warthog::jps2_expansion_policy_prune2&)> configure =
+    [bbl, cl](warthog::jps2_expansion_policy_prune2& exp) 
+    {
+      exp.set_bb_labelling(bbl.get());
+      exp.set_component_labelling(cl.get());
+    };
+
+  if(num_landmarks)
+  {
+    run_landmarks(map, configure, scenmgr, mapname, alg_name);
+    return;
+  }
 	warthog::octile_heuristic heuristic(map.width(), map.height());
+  if(num_threads > 1 && tracefile == "")
+  {
+    run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+    return;
+  }
+
+	warthog::jps2_expansion_policy_prune2 expander(&map);
+  configure(expander);
   warthog::pqueue_min open;
 
 	warthog::flexible_astar<
@@ -176,16 +488,90 @@ run_jps2_prune2(warthog::scenario_manager& scenmgr, std::string mapname, std::st
   G::query::map = &map;
   G::query::open = &open;
   G::nodepool = expander.get_nodepool();
-  run_experiments(&astar, alg_name, scenmgr, verbose, checkopt, std::cout);
+  if(tracefile != "")
+  {
+    warthog::trace_listener tracer(tracefile.c_str(), &map);
+    expander.set_trace_listener(&tracer);
+    warthog::flexible_astar<
+      warthog::octile_heuristic,
+      warthog::jps2_expansion_policy_prune2,
+      warthog::pqueue_min,
+      warthog::trace_listener> tastar(&heuristic, &expander, &open, &tracer);
+    run_experiments(&tastar, alg_name, scenmgr, verbose, checkopt, std::cout);
+    expander.set_trace_listener(0);
+    std::cerr << "trace: " << tracer.num_events() << " events\n";
+  }
+  else
+  {
+    run_experiments(&astar, alg_name, scenmgr, verbose, checkopt, std::cout);
+  }
   std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << ", tot scan: " << tot << "\n";
 }
 
+// runs @param EXPANDER on a map that stands in for a gridmap (a
+// warthog::blockmap or warthog::rle_gridmap); ids are the same as on
+// a gridmap, so results are identical
+template<typename EXPANDER, typename M>
+void
+run_on_map(M& map, warthog::scenario_manager& scenmgr, std::string alg_name)
+{
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    std::function<void(EXPANDER&)> configure = [](EXPANDER&) { };
+    if(num_threads > 1)
+    {
+        run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
+    search_context<warthog::octile_heuristic, EXPANDER> ctx(&heuristic, &map);
+    run_experiments(&ctx.astar_, alg_name, scenmgr,
+            verbose, checkopt, std::cout);
+	std::cerr << "done. total memory: "<< ctx.astar_.mem() + scenmgr.mem()
+            << ", tot scan: " << tot << "\n";
+}
+
+// jps2 and jps2-prune2 on a warthog::blockmap
+template<typename EXPANDER>
+void
+run_blocked(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    warthog::blockmap map(mapname.c_str());
+    std::cerr << "blocks: " << map.get_num_blocks()
+        << (map.is_mapped() ? " (mapped)" : "") << "\n";
+    run_on_map<EXPANDER>(map, scenmgr, alg_name);
+}
+
+// jps2 on a warthog::rle_gridmap
+void
+run_rle(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    warthog::rle_gridmap map(mapname.c_str());
+    std::cerr << "runs: " << map.get_num_runs()
+        << ", map memory: " << map.mem() << "\n";
+    run_on_map<warthog::rle_jps2_expansion_policy>(map, scenmgr, alg_name);
+}
+
 void
 run_jps(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
 {
     warthog::gridmap map(mapname.c_str());
-	warthog::jps_expansion_policy expander(&map);
+    std::shared_ptr<warthog::label::component_labelling> cl;
+    if(components) { cl = make_component_labelling(map); }
+    std::function<void(warthog::jps_expansion_policy&)> configure =
+        [cl](warthog::jps_expansion_policy& exp)
+        { exp.set_component_labelling(cl.get()); };
+
 	warthog::octile_heuristic heuristic(map.width(), map.height());
+    if(num_threads > 1)
+    {
+        run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
+	warthog::jps_expansion_policy expander(&map);
+    configure(expander);
     warthog::pqueue_min open;
 
 	warthog::flexible_astar<
@@ -199,17 +585,19 @@ run_jps(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+// jps2 with jump distances read from precomputed tables
 void
-run_astar(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+run_jps2plus(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
 {
     warthog::gridmap map(mapname.c_str());
-	warthog::gridmap_expansion_policy expander(&map);
 	warthog::octile_heuristic heuristic(map.width(), map.height());
+	warthog::jps2plus_expansion_policy expander(&map, jp8);
     warthog::pqueue_min open;
 
 	warthog::flexible_astar<
 		warthog::octile_heuristic,
-	   	warthog::gridmap_expansion_policy, 
+	   	warthog::jps2plus_expansion_policy,
         warthog::pqueue_min> 
             astar(&heuristic, &expander, &open);
 
@@ -218,12 +606,116 @@ run_astar(warthog::scenario_manager& scenmgr, std::string mapname, std::string a
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+// HPA*: an abstract search over clusters, refined with jps2 inside each
+// cluster. paths are near-optimal unless @param exact
 void
-run_dijkstra(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+run_hpa(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name, bool exact)
 {
     warthog::gridmap map(mapname.c_str());
+    warthog::hpa::hpa_graph g(&map, cluster_size, exact);
+    g.precompute();
+
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::hpa::hpa_expansion_policy abs_expander(&g);
+    warthog::pqueue_min abs_open;
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::hpa::hpa_expansion_policy,
+        warthog::pqueue_min>
+            abs_astar(&heuristic, &abs_expander, &abs_open);
+
+    warthog::hpa::hpa_search hpa(&abs_astar, &g);
+    run_experiments(&hpa, alg_name, scenmgr,
+            verbose, checkopt, std::cout);
+	std::cerr << "done. abstraction memory: " << g.mem()
+        << " total memory: "<< hpa.mem() + g.mem() + scenmgr.mem() << "\n";
+}
+
+// paths read from a compressed path database of the grid; the database
+// is computed (and saved) if there is none for the map
+void
+run_grid_cpd(warthog::scenario_manager& scenmgr, std::string mapname,
+        std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
+    warthog::cpd::grid_oracle oracle(&map);
+    std::string fname = mapname + ".gcpd";
+    if(!oracle.load(fname.c_str()))
+    {
+        oracle.precompute();
+        oracle.save(fname.c_str());
+    }
+
+    warthog::cpd::grid_cpd_search cpd(&oracle);
+    run_experiments(&cpd, alg_name, scenmgr,
+            verbose, checkopt, std::cout);
+	std::cerr << "done. database memory: " << oracle.mem()
+        << " total memory: "<< cpd.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_astar(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
+    std::function<void(warthog::gridmap_expansion_policy&)> configure =
+        [](warthog::gridmap_expansion_policy&) { };
+    if(num_landmarks)
+    {
+        run_landmarks(map, configure, scenmgr, mapname, alg_name);
+        return;
+    }
+	warthog::octile_heuristic heuristic(map.width(), map.height());
+    if(num_threads > 1 && tracefile == "")
+    {
+        run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
 	warthog::gridmap_expansion_policy expander(&map);
+    warthog::pqueue_min open;
+
+	warthog::flexible_astar<
+		warthog::octile_heuristic,
+	   	warthog::gridmap_expansion_policy, 
+        warthog::pqueue_min> 
+            astar(&heuristic, &expander, &open);
+
+    if(tracefile != "")
+    {
+        warthog::trace_listener tracer(tracefile.c_str(), &map);
+        warthog::flexible_astar<
+            warthog::octile_heuristic,
+            warthog::gridmap_expansion_policy,
+            warthog::pqueue_min,
+            warthog::trace_listener>
+                tastar(&heuristic, &expander, &open, &tracer);
+        run_experiments(&tastar, alg_name, scenmgr,
+                verbose, checkopt, std::cout);
+        std::cerr << "trace: " << tracer.num_events() << " events\n";
+    }
+    else
+    {
+        run_experiments(&astar, alg_name, scenmgr,
+                verbose, checkopt, std::cout);
+    }
+	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
+}
+
+void
+run_dijkstra(warthog::scenario_manager& scenmgr, std::string mapname, std::string alg_name)
+{
+    warthog::gridmap map(mapname.c_str());
 	warthog::zero_heuristic heuristic;
+    if(num_threads > 1)
+    {
+        std::function<void(warthog::gridmap_expansion_policy&)> configure =
+            [](warthog::gridmap_expansion_policy&) { };
+        run_experiments_parallel(&heuristic, &map, configure, alg_name, scenmgr);
+        return;
+    }
+
+	warthog::gridmap_expansion_policy expander(&map);
     warthog::pqueue_min open;
 
 	warthog::flexible_astar<
@@ -237,6 +729,164 @@ run_dijkstra(warthog::scenario_manager& scenmgr, std::string mapname, std::strin
 	std::cerr << "done. total memory: "<< astar.mem() + scenmgr.mem() << "\n";
 }
 
+// a map and its search, kept in memory by the query server
+template<typename H, typename E>
+class resident_grid_search : public warthog::resident_search
+{
+    public:
+        resident_grid_search(const std::string& mapname,
+                std::function<H*(warthog::gridmap&)> make_heuristic,
+                bool use_bbox)
+            : map_(mapname.c_str()), heuristic_(make_heuristic(map_)),
+              ctx_(heuristic_.get(), &map_)
+        {
+            if(use_bbox)
+            {
+                bbl_ = load_bb_labelling(map_, mapname);
+                set_bb_labelling(ctx_.expander_, bbl_.get());
+            }
+            if(time_limit_us > 0)
+            { ctx_.astar_.set_time_cutoff_nano(time_limit_us * 1000); }
+        }
+
+        virtual warthog::gridmap*
+        get_map() { return &map_; }
+
+        virtual warthog::search*
+        get_search() { return &ctx_.astar_; }
+
+        virtual void
+        bind() { ctx_.bind(&map_); }
+
+        virtual size_t
+        mem()
+        {
+            return ctx_.astar_.mem() + (bbl_ ? bbl_->mem() : 0) +
+                sizeof(*this);
+        }
+
+    private:
+        warthog::gridmap map_;
+        std::unique_ptr<H> heuristic_;
+        search_context<H, E> ctx_;
+        std::shared_ptr<warthog::label::jps_bb_labelling> bbl_;
+
+        // only the jps2 expanders can prune with bounding boxes
+        template<typename E2>
+        static void
+        set_bb_labelling(E2&, warthog::label::jps_bb_labelling*) { }
+
+        static void
+        set_bb_labelling(warthog::jps2_expansion_policy& exp,
+                warthog::label::jps_bb_labelling* bbl)
+        { exp.set_bb_labelling(bbl); }
+
+        static void
+        set_bb_labelling(warthog::jps2_expansion_policy_prune2& exp,
+                warthog::label::jps_bb_labelling* bbl)
+        { exp.set_bb_labelling(bbl); }
+};
+
+// creates resident searches for algorithm @param alg; the heuristic is
+// chosen from the command line (--landmarks) the same way as for
+// scenario files
+template<typename E>
+warthog::query_server::factory_fn
+resident_search_factory(bool informed, bool use_bbox)
+{
+    return [informed, use_bbox](const std::string& mapname)
+        -> warthog::resident_search*
+    {
+        if(!warthog::gridmap::is_map_file(mapname.c_str())) { return 0; }
+
+        if(!informed)
+        {
+            return new resident_grid_search<warthog::zero_heuristic, E>(
+                    mapname,
+                    [](warthog::gridmap&) { return new warthog::zero_heuristic(); },
+                    false);
+        }
+        if(num_landmarks)
+        {
+            return new resident_grid_search<warthog::landmark_heuristic, E>(
+                    mapname,
+                    [mapname](warthog::gridmap& map)
+                    {
+                        std::string lmfile = mapname + ".lm";
+                        return new warthog::landmark_heuristic(
+                            &map, lmfile.c_str(), num_landmarks, lm16 ? 2 : 4);
+                    },
+                    use_bbox);
+        }
+        return new resident_grid_search<warthog::octile_heuristic, E>(
+                mapname,
+                [](warthog::gridmap& map)
+                {
+                    return new warthog::octile_heuristic(
+                        map.width(), map.height());
+                },
+                use_bbox);
+    };
+}
+
+// answer queries on stdin (@param where == "-") or on the unix socket
+// at @param where, until a client asks for a shutdown
+void
+run_server(std::string alg, std::string mapname, std::string where)
+{
+    warthog::query_server::factory_fn factory;
+    if(alg == "jps2")
+    {
+        factory = resident_search_factory<warthog::jps2_expansion_policy>(
+                true, bbox);
+    }
+    else if(alg == "jps2-prune2")
+    {
+        factory = resident_search_factory<
+            warthog::jps2_expansion_policy_prune2>(true, bbox);
+    }
+    else if(alg == "jps")
+    {
+        factory = resident_search_factory<warthog::jps_expansion_policy>(
+                true, false);
+    }
+    else if(alg == "astar")
+    {
+        factory = resident_search_factory<warthog::gridmap_expansion_policy>(
+                true, false);
+    }
+    else if(alg == "dijkstra")
+    {
+        factory = resident_search_factory<warthog::gridmap_expansion_policy>(
+                false, false);
+    }
+    else
+    {
+        std::cerr << "err; invalid search algorithm: " << alg << "\n";
+        exit(1);
+    }
+
+    warthog::query_server server(factory, map_budget, cache_entries);
+    if(mapname != "" && !server.preload(mapname))
+    {
+        std::cerr << "err; cannot load map " << mapname << "\n";
+        exit(1);
+    }
+
+    if(where == "-") { server.serve(stdin, stdout); }
+    else if(!server.listen(where.c_str())) { exit(1); }
+    warthog::map_registry* registry = server.get_registry();
+    std::cerr << "done. queries: " << server.get_num_queries()
+        << " maps: " << server.get_num_maps()
+        << " hits: " << registry->get_hits()
+        << " misses: " << registry->get_misses()
+        << " evictions: " << registry->get_evictions()
+        << " cache hits: " << (server.get_cache() ?
+                server.get_cache()->get_hits() +
+                server.get_cache()->get_subpath_hits() : 0)
+        << " total memory: " << server.mem() << "\n";
+}
+
 int 
 main(int argc, char** argv)
 {
@@ -250,6 +900,20 @@ main(int argc, char** argv)
 		{"help", no_argument, &print_help, 1},
 		{"checkopt",  no_argument, &checkopt, 1},
 		{"verbose",  no_argument, &verbose, 1},
+		{"trace",  required_argument, 0, 1},
+		{"timeout",  required_argument, 0, 1},
+		{"landmarks",  required_argument, 0, 1},
+		{"lm16",  no_argument, &lm16, 1},
+		{"bbox",  no_argument, &bbox, 1},
+		{"components",  no_argument, &components, 1},
+		{"blocked",  no_argument, &blocked, 1},
+		{"rle",  no_argument, &rle, 1},
+		{"cluster",  required_argument, 0, 1},
+		{"jp8",  no_argument, &jp8, 1},
+		{"threads",  required_argument, 0, 1},
+		{"serve",  required_argument, 0, 1},
+		{"budget",  required_argument, 0, 1},
+		{"cache",  required_argument, 0, 1},
 		{0,  0, 0, 0}
 	};
 
@@ -266,6 +930,30 @@ main(int argc, char** argv)
     std::string alg = cfg.get_param_value("alg");
     std::string gen = cfg.get_param_value("gen");
     std::string mapname = cfg.get_param_value("map");
+    tracefile = cfg.get_param_value("trace");
+    std::string timeout = cfg.get_param_value("timeout");
+    if(timeout != "") { time_limit_us = atof(timeout.c_str()); }
+    std::string landmarks = cfg.get_param_value("landmarks");
+    if(landmarks != "") { num_landmarks = (uint32_t)atoi(landmarks.c_str()); }
+    std::string threads = cfg.get_param_value("threads");
+    if(threads != "") 
+    { num_threads = std::max(1, atoi(threads.c_str())); }
+
+    std::string cluster = cfg.get_param_value("cluster");
+    if(cluster != "") { cluster_size = (uint32_t)atoi(cluster.c_str()); }
+
+    std::string budget = cfg.get_param_value("budget");
+    if(budget != "")
+    { map_budget = (size_t)(atof(budget.c_str()) * 1024 * 1024); }
+    std::string cache = cfg.get_param_value("cache");
+    if(cache != "") { cache_entries = (uint32_t)atoi(cache.c_str()); }
+    std::string serve = cfg.get_param_value("serve");
+    if(serve != "")
+    {
+        if(alg == "") { help(); exit(0); }
+        run_server(alg, mapname, serve);
+        exit(0);
+    }
 
 	if(gen != "")
 	{
@@ -296,6 +984,20 @@ main(int argc, char** argv)
     // the map filename can be given or (default) taken from the scenario file
     if(mapname == "")
     { mapname = scenmgr.get_experiment(0)->map().c_str(); }
+    else if(rle && alg == "jps2")
+    {
+        run_rle(scenmgr, mapname, alg);
+    }
+    else if(blocked && alg == "jps2")
+    {
+        run_blocked<warthog::blocked_jps2_expansion_policy>(
+                scenmgr, mapname, alg);
+    }
+    else if(blocked && alg == "jps2-prune2")
+    {
+        run_blocked<warthog::blocked_jps2_expansion_policy_prune2>(
+                scenmgr, mapname, alg);
+    }
     else if(alg == "jps2")
     {
         run_jps2(scenmgr, mapname, alg);
@@ -308,6 +1010,18 @@ main(int argc, char** argv)
     {
         run_jps(scenmgr, mapname, alg);
     }
+    else if(alg == "jps2+")
+    {
+        run_jps2plus(scenmgr, mapname, alg);
+    }
+    else if(alg == "hpa" || alg == "hpa-exact")
+    {
+        run_hpa(scenmgr, mapname, alg, alg == "hpa-exact");
+    }
+    else if(alg == "grid-cpd")
+    {
+        run_grid_cpd(scenmgr, mapname, alg);
+    }
     else if(alg == "dijkstra")
     {
         run_dijkstra(scenmgr, mapname, alg); 
@@ -319,6 +319,64 @@ class graph_oracle_base
             fm_.insert(fm_.end(), cpd.fm_.begin(), cpd.fm_.end());
         }
 
+        // drop every row, e.g. before the rows are computed again
+        void
+        clear_rows()
+        {
+            fm_.clear();
+            fm_.resize(g_->get_num_nodes());
+        }
+
+        // The format of operator<< in parts, so that a CPD can be written
+        // one row at a time. A header followed by the first k rows is a
+        // partial CPD, as read by operator>>.
+        void
+        write_header(std::ostream& out)
+        {
+            uint32_t num_nodes = g_->get_num_nodes();
+            out.write((char*)(&num_nodes), 4);
+            out.write((char*)order_.data(), 4 * order_.size());
+        }
+
+        // @return false if the header does not match the graph
+        bool
+        read_header(std::istream& in)
+        {
+            uint32_t num_nodes = 0;
+            in.read((char*)(&num_nodes), 4);
+            if(!in.good() || num_nodes != g_->get_num_nodes()) { return false; }
+
+            order_.resize(num_nodes);
+            in.read((char*)order_.data(), 4 * order_.size());
+            return in.good();
+        }
+
+        void
+        write_row(std::ostream& out, uint32_t row_id)
+        {
+            uint32_t num_runs = (uint32_t)fm_.at(row_id).size();
+            out.write((char*)(&num_runs), 4);
+            out.write((char*)fm_.at(row_id).data(),
+                    sizeof(warthog::cpd::rle_run32) * num_runs);
+        }
+
+        // @return false, and leave the row as it was, unless all of it
+        // could be read
+        bool
+        read_row(std::istream& in, uint32_t row_id)
+        {
+            uint32_t num_runs = 0;
+            in.read((char*)(&num_runs), 4);
+            if(!in.good() || num_runs > g_->get_num_nodes()) { return false; }
+
+            std::vector<warthog::cpd::rle_run32> row(num_runs);
+            in.read((char*)row.data(),
+                    sizeof(warthog::cpd::rle_run32) * num_runs);
+            if(!in.good()) { return false; }
+            fm_.at(row_id).swap(row);
+            return true;
+        }
+
         void
         compute_row(uint32_t source_id, warthog::search* dijk,
                     std::vector<warthog::cpd::fm_coll> &s_row)
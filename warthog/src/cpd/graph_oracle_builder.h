@@ -0,0 +1,328 @@
+#ifndef WARTHOG_CPD_GRAPH_ORACLE_BUILDER_H
+#define WARTHOG_CPD_GRAPH_ORACLE_BUILDER_H
+
+// cpd/graph_oracle_builder.h
+//
+// Computes the rows of a warthog::cpd::graph_oracle_base on every core.
+//
+// Each row is one Dijkstra search from its source plus the compression
+// of the result (see graph_oracle_base::compute_row). Rows do not
+// depend on one another, so each worker thread owns its own expander,
+// queue and listener, takes the next source that nobody has taken yet
+// and writes the compressed row into the slot of that source. Threads
+// that finish early keep taking rows, so a few slow rows do not hold up
+// the others.
+//
+// Builds of large graphs take hours. If a file is given, rows are
+// appended to it in order as soon as they (and every row before them)
+// are done, in the format of graph_oracle_base::operator<<. At any
+// point the file is a partial CPD; when the build ends it is the whole
+// CPD. Starting again with the same file picks up after the last row
+// that was written in full.
+//
+// The CPD format does not say which graph the rows are for, so a build
+// that writes to a file also keeps a checkpoint next to it
+// (<file>.ckpt) with the number of nodes and a hash of the graph (see
+// warthog::graph::xy_graph::checksum). A build only resumes a file
+// whose checkpoint matches the graph; a file of another graph is an
+// error. The checkpoint is removed when the last row is written, and a
+// file without one is written again from the start.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "flexible_astar.h"
+#include "graph_expansion_policy.h"
+#include "graph_oracle.h"
+#include "helpers.h"
+#include "oracle_listener.h"
+#include "pqueue.h"
+#include "timer.h"
+#include "zero_heuristic.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace warthog
+{
+
+namespace cpd
+{
+
+// @param SYM: the kind of oracle
+// @param L: the listener that records first moves for oracles of kind SYM
+// (e.g. warthog::cpd::graph_oracle_listener<SYM>)
+// @param E: the expansion policy of the Dijkstra searches
+template<warthog::cpd::symbol SYM,
+         class L = warthog::cpd::graph_oracle_listener<SYM>,
+         class E = warthog::simple_graph_expansion_policy>
+class graph_oracle_builder
+{
+    public:
+        graph_oracle_builder(warthog::cpd::graph_oracle_base<SYM>* oracle)
+            : oracle_(oracle) { }
+
+        ~graph_oracle_builder() { }
+
+        // compute every row of the oracle. the column order is a DFS
+        // pre-order of the graph, unless a partial CPD is resumed
+        //
+        // @param filename: where to write the CPD, row by row; or 0 to
+        // keep it in memory only. if the file holds a partial CPD of the
+        // same graph, only the missing rows are computed
+        // @return false if the file could not be read or written, or if
+        // it holds a partial CPD of another graph
+        bool
+        build(const char* filename = 0)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+
+            uint32_t num_nodes = oracle_->get_graph()->get_num_nodes();
+            uint64_t graph_hash = filename ? oracle_->get_graph()->checksum() : 0;
+            std::string ckptname = filename ? std::string(filename) + ".ckpt" : "";
+            std::ofstream out;
+            uint32_t first_row = 0;
+            if(filename && !resume(filename, graph_hash, first_row))
+            { return false; }
+            if(first_row == 0)
+            {
+                oracle_->clear_rows();
+                oracle_->compute_dfs_preorder();
+                if(filename)
+                {
+                    if(!write_checkpoint(ckptname.c_str(), graph_hash))
+                    {
+                        std::cerr << "err; cannot write checkpoint "
+                            << ckptname << "\n";
+                        return false;
+                    }
+
+                    // the file keeps the order in the form used for queries
+                    out.open(filename, std::ios_base::out |
+                            std::ios_base::trunc | std::ios_base::binary);
+                    oracle_->value_index_swap_array();
+                    oracle_->write_header(out);
+                    oracle_->value_index_swap_array();
+                }
+            }
+            else
+            {
+                std::cerr << "resuming " << filename << " from row "
+                    << first_row << " of " << num_nodes << "\n";
+                oracle_->value_index_swap_array();
+                out.open(filename, std::ios_base::out |
+                        std::ios_base::app | std::ios_base::binary);
+            }
+            if(filename && !out.good())
+            {
+                std::cerr << "err; cannot write cpd to " << filename << "\n";
+                return false;
+            }
+
+            shared_data shared;
+            shared.oracle_ = oracle_;
+            shared.next_ = first_row;
+            shared.num_rows_ = num_nodes;
+            shared.failed_ = false;
+            shared.out_ = filename ? &out : 0;
+            shared.done_.resize(num_nodes, 0);
+            shared.written_ = first_row;
+            warthog::helpers::parallel_compute(
+                    &worker, &shared, num_nodes - first_row);
+
+            // rows are compressed w.r.t. the column order, but queries
+            // want the column of each node
+            oracle_->value_index_swap_array();
+            mytimer.stop();
+
+            if(shared.failed_)
+            {
+                std::cerr << "err; while writing cpd to " << filename
+                    << "; rows up to " << shared.written_
+                    << " can be resumed\n";
+                return false;
+            }
+            if(filename)
+            {
+                // the file is a whole CPD; nothing left to resume
+                out.close();
+                remove(ckptname.c_str());
+            }
+            std::cerr << "computed " << num_nodes - first_row << " rows. "
+                << " time: " << (double)mytimer.elapsed_time_nano() / 1e9
+                << " s\n";
+            return true;
+        }
+
+    private:
+        warthog::cpd::graph_oracle_base<SYM>* oracle_;
+
+        // the graph a partial CPD is for
+        struct checkpoint
+        {
+            char magic_[4];
+            uint32_t version_;
+            uint64_t graph_hash_;
+            uint32_t num_nodes_;
+            uint32_t reserved_;
+        };
+
+        struct shared_data
+        {
+            warthog::cpd::graph_oracle_base<SYM>* oracle_;
+            std::atomic<uint32_t> next_;    // the first row nobody took
+            uint32_t num_rows_;
+            std::atomic<bool> failed_;
+
+            // finished rows are written in order; the lock protects
+            // everything below
+            std::mutex lock_;
+            std::ofstream* out_;
+            std::vector<uint8_t> done_;
+            uint32_t written_;              // the first row not written
+        };
+
+        static void*
+        worker(void* args_in)
+        {
+            warthog::helpers::thread_params* par =
+                (warthog::helpers::thread_params*) args_in;
+            shared_data* shared = (shared_data*) par->shared_;
+            warthog::cpd::graph_oracle_base<SYM>* oracle = shared->oracle_;
+
+            E expander(oracle->get_graph());
+            warthog::zero_heuristic heuristic;
+            warthog::pqueue_min open;
+            L listener(oracle);
+            warthog::flexible_astar<warthog::zero_heuristic, E,
+                warthog::pqueue_min, L>
+                    dijkstra(&heuristic, &expander, &open, &listener);
+
+            std::vector<warthog::cpd::fm_coll> row(shared->num_rows_);
+            warthog::sn_id_t source_id;
+            listener.set_run(&source_id, &row);
+
+            while(!shared->failed_)
+            {
+                uint32_t id = shared->next_++;
+                if(id >= shared->num_rows_) { break; }
+
+                source_id = id;
+                oracle->compute_row(id, &dijkstra, row);
+                par->nprocessed_++;
+                if(!shared->out_) { continue; }
+
+                // whoever finishes the first missing row writes it, and
+                // every finished row after it
+                std::lock_guard<std::mutex> guard(shared->lock_);
+                shared->done_[id] = 1;
+                uint32_t written = shared->written_;
+                while(shared->written_ < shared->num_rows_ &&
+                      shared->done_[shared->written_])
+                { oracle->write_row(*shared->out_, shared->written_++); }
+                if(shared->written_ != written) { shared->out_->flush(); }
+                if(!shared->out_->good()) { shared->failed_ = true; }
+            }
+            return 0;
+        }
+
+        bool
+        write_checkpoint(const char* ckptname, uint64_t graph_hash)
+        {
+            checkpoint ckpt;
+            memset(&ckpt, 0, sizeof(ckpt));
+            memcpy(ckpt.magic_, CKPT_MAGIC, 4);
+            ckpt.version_ = CKPT_VERSION;
+            ckpt.graph_hash_ = graph_hash;
+            ckpt.num_nodes_ = oracle_->get_graph()->get_num_nodes();
+            std::ofstream out(ckptname, std::ios_base::out |
+                    std::ios_base::trunc | std::ios_base::binary);
+            out.write((char*)&ckpt, sizeof(ckpt));
+            out.close();
+            return out.good();
+        }
+
+        // read the rows of a partial CPD in @param filename and drop any
+        // row that was cut short. @param first_row is set to the first
+        // row still missing; 0 if there is no file (or nothing in it),
+        // or if the file has no checkpoint.
+        // @return false if the checkpoint is for another graph than the
+        // one with hash @param graph_hash, or the file for another graph
+        bool
+        resume(const char* filename, uint64_t graph_hash, uint32_t& first_row)
+        {
+            first_row = 0;
+            std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+            if(!in.good() || in.peek() == EOF) { return true; }
+
+            std::string ckptname = std::string(filename) + ".ckpt";
+            std::ifstream ckpt_in(ckptname.c_str(),
+                    std::ios_base::in | std::ios_base::binary);
+            if(!ckpt_in.good())
+            {
+                std::cerr << "no checkpoint for " << filename
+                    << "; computing every row\n";
+                return true;
+            }
+            checkpoint ckpt;
+            ckpt_in.read((char*)&ckpt, sizeof(ckpt));
+            if(!ckpt_in.good() || memcmp(ckpt.magic_, CKPT_MAGIC, 4) != 0 ||
+               ckpt.version_ != CKPT_VERSION ||
+               ckpt.graph_hash_ != graph_hash ||
+               ckpt.num_nodes_ != oracle_->get_graph()->get_num_nodes())
+            {
+                std::cerr << "err; " << filename
+                    << " is a partial cpd of another graph (see "
+                    << ckptname << ")\n";
+                return false;
+            }
+
+            oracle_->clear_rows();
+            if(!oracle_->read_header(in))
+            {
+                std::cerr << "err; " << filename
+                    << " is not a cpd of this graph\n";
+                return false;
+            }
+
+            uint32_t num_nodes = oracle_->get_graph()->get_num_nodes();
+            std::streamoff end = in.tellg();
+            while(first_row < num_nodes && oracle_->read_row(in, first_row))
+            {
+                first_row++;
+                end = in.tellg();
+            }
+            in.close();
+
+            if(truncate(filename, (off_t)end) != 0)
+            {
+                std::cerr << "err; cannot truncate " << filename << "\n";
+                return false;
+            }
+            return true;
+        }
+
+        static constexpr const char* CKPT_MAGIC = "WCPK";
+        static const uint32_t CKPT_VERSION = 1;
+
+        graph_oracle_builder(const graph_oracle_builder& other) { }
+        graph_oracle_builder&
+        operator=(const graph_oracle_builder& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
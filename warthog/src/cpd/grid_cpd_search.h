@@ -0,0 +1,131 @@
+#ifndef WARTHOG_CPD_GRID_CPD_SEARCH_H
+#define WARTHOG_CPD_GRID_CPD_SEARCH_H
+
+// cpd/grid_cpd_search.h
+//
+// Paths read from a warthog::cpd::grid_oracle: from the start, make the
+// first move towards the target and repeat until the target is reached.
+// Each step is one lookup in the row of the current tile, so the time
+// of a query depends only on the length of the path.
+//
+// Queries on a map that was edited after the oracle was built have no
+// answer (see warthog::cpd::grid_oracle::is_current). Neither do walks
+// that hit a tile with no first move, or that take more steps than the
+// map has tiles; both would mean the oracle is corrupt.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "grid_oracle.h"
+#include "gridmap.h"
+#include "problem_instance.h"
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+
+namespace warthog
+{
+
+namespace cpd
+{
+
+class grid_cpd_search : public warthog::search
+{
+    public:
+        grid_cpd_search(warthog::cpd::grid_oracle* oracle)
+            : oracle_(oracle) { }
+
+        virtual ~grid_cpd_search() { }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        { walk(pi, sol, true); }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        { walk(pi, sol, false); }
+
+        virtual size_t
+        mem() { return sizeof(*this) + oracle_->mem(); }
+
+    private:
+        warthog::cpd::grid_oracle* oracle_;
+
+        void
+        walk(warthog::problem_instance& pi, warthog::solution& sol,
+                bool keep_path)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            sol.reset();
+
+            warthog::gridmap* map = oracle_->get_map();
+            if(!oracle_->is_current())
+            {
+                finish(sol, mytimer);
+                return;
+            }
+
+            warthog::sn_id_t max_id =
+                (warthog::sn_id_t)map->header_width() * map->header_height();
+            if(pi.start_id_ >= max_id || pi.target_id_ >= max_id)
+            {
+                finish(sol, mytimer);
+                return;
+            }
+
+            warthog::grid_id_t from =
+                map->to_padded_id((warthog::grid_id_t)pi.start_id_);
+            warthog::grid_id_t to =
+                map->to_padded_id((warthog::grid_id_t)pi.target_id_);
+            if(!oracle_->is_connected(from, to))
+            {
+                finish(sol, mytimer);
+                return;
+            }
+
+            sol.sum_of_edge_costs_ = 0;
+            uint32_t max_steps = oracle_->get_num_nodes();
+            while(from != to)
+            {
+                uint32_t move = oracle_->get_move(from, to);
+                if(move >= 8 || sol.nodes_touched_ >= max_steps)
+                {
+                    sol.reset();
+                    finish(sol, mytimer);
+                    return;
+                }
+                if(keep_path) { sol.path_.push_back(from); }
+                from = oracle_->step(from, move);
+                sol.sum_of_edge_costs_ +=
+                    warthog::cpd::grid_oracle::move_cost(move);
+                sol.nodes_touched_++;
+
+                // the walk expands nothing; check the limits every so
+                // many steps instead. the path so far is kept
+                if((sol.nodes_touched_ & 63) == 0 && interrupted(mytimer, sol))
+                {
+                    finish(sol, mytimer);
+                    return;
+                }
+            }
+            if(keep_path) { sol.path_.push_back(to); }
+            sol.status_ = warthog::solution::FOUND;
+            finish(sol, mytimer);
+        }
+
+        inline void
+        finish(warthog::solution& sol, warthog::timer& mytimer)
+        {
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        }
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,325 @@
+#include "flexible_astar.h"
+#include "gridmap_expansion_policy.h"
+#include "grid_oracle.h"
+#include "helpers.h"
+#include "oracle_listener.h"
+#include "pqueue.h"
+#include "problem_instance.h"
+#include "solution.h"
+#include "timer.h"
+#include "zero_heuristic.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+
+// the steps of each move, in the order of warthog::jps::direction
+const int32_t MOVE_DX[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+const int32_t MOVE_DY[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+
+// the move of each step (dx, dy), at index (dy + 1) * 3 + dx + 1
+const uint32_t MOVE_OF[9] = { 5, 0, 4, 3, UINT32_MAX, 2, 7, 1, 6 };
+
+// a tile that any move is optimal for
+const warthog::cpd::fm_coll FM_ANY = 0xFF;
+
+// file layout: a header and then the first run of every row (plus the
+// end of the last row), and the runs. the node order is not stored; it
+// is recomputed from the map
+const char GC_MAGIC[4] = { 'W', 'G', 'C', 'P' };
+const uint32_t GC_VERSION = 1;
+
+struct gc_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint64_t map_hash_;
+    uint64_t num_nodes_;
+    uint64_t num_runs_;
+};
+
+// collects the first moves of one row, in the manner of
+// warthog::cpd::graph_oracle_listener; moves are told apart by the
+// position of a successor relative to the source
+class grid_oracle_listener final : public warthog::cpd::oracle_listener
+{
+    public:
+        grid_oracle_listener(warthog::gridmap* map) : map_(map) { }
+
+        inline void
+        generate_node(warthog::search_node *from, warthog::search_node *succ,
+                      warthog::cost_t edge_cost, uint32_t edge_id)
+        {
+            if(from == 0) { return; } // start node
+
+            warthog::sn_id_t succ_id = succ->get_id();
+            warthog::sn_id_t from_id = from->get_id();
+            std::vector<warthog::cpd::fm_coll>& row = *s_row_;
+            if(from_id == *source_id_)
+            {
+                int64_t w = map_->width();
+                int64_t diff = (int64_t)succ_id - (int64_t)from_id + w + 1;
+                row[succ_id] = (warthog::cpd::fm_coll)
+                    (1 << MOVE_OF[(diff / w) * 3 + diff % w]);
+                return;
+            }
+
+            double alt_g = from->get_g() + edge_cost;
+            double g_val =
+                succ->get_search_number() == from->get_search_number() ?
+                succ->get_g() : DBL_MAX;
+            if(alt_g < g_val) { row[succ_id] = row[from_id]; }
+            if(alt_g == g_val) { row[succ_id] |= row[from_id]; }
+        }
+
+    private:
+        warthog::gridmap* map_;
+};
+
+struct gc_shared_data
+{
+    warthog::gridmap* map_;
+    const std::vector<warthog::grid_id_t>* ids_;
+    std::vector<uint32_t> order_;   // column -> node
+    std::vector<std::vector<warthog::cpd::rle_run32>> rows_;
+};
+
+}
+
+const uint32_t warthog::cpd::grid_oracle::NO_NODE;
+
+warthog::cpd::grid_oracle::grid_oracle(warthog::gridmap* map)
+    : map_(map), map_version_(map->get_version())
+{
+    int32_t w = (int32_t)map_->width();
+    for(uint32_t move = 0; move < 8; move++)
+    { delta_[move] = MOVE_DY[move] * w + MOVE_DX[move]; }
+    compute_order();
+}
+
+warthog::cpd::grid_oracle::~grid_oracle()
+{ }
+
+bool
+warthog::cpd::grid_oracle::can_move(warthog::grid_id_t grid_id_p, uint32_t move)
+{
+    int64_t id = (int64_t)grid_id_p;
+    int64_t dx = MOVE_DX[move];
+    int64_t dy = MOVE_DY[move] * (int64_t)map_->width();
+
+    // NB: no corner cutting
+    return map_->get_label((warthog::grid_id_t)(id + dx)) &&
+        map_->get_label((warthog::grid_id_t)(id + dy)) &&
+        map_->get_label((warthog::grid_id_t)(id + dx + dy));
+}
+
+void
+warthog::cpd::grid_oracle::compute_order()
+{
+    node_of_.assign(map_->padded_mapsize(), NO_NODE);
+    ids_.clear();
+    for(warthog::grid_id_t id = 0; id < map_->padded_mapsize(); id++)
+    {
+        if(!map_->get_label(id)) { continue; }
+        node_of_[id] = (uint32_t)ids_.size();
+        ids_.push_back(id);
+    }
+
+    // DFS from every tile not yet visited, one component at a time
+    column_.assign(ids_.size(), NO_NODE);
+    component_begin_.clear();
+    uint32_t next_column = 0;
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for(uint32_t root = 0; root < ids_.size(); root++)
+    {
+        if(column_[root] != NO_NODE) { continue; }
+        component_begin_.push_back(next_column);
+        column_[root] = next_column++;
+        stack.push_back(std::make_pair(root, 0));
+        while(stack.size())
+        {
+            std::pair<uint32_t, uint32_t>& top = stack.back();
+            if(top.second == 8) { stack.pop_back(); continue; }
+
+            uint32_t move = top.second++;
+            warthog::grid_id_t id = ids_[top.first];
+            if(!can_move(id, move)) { continue; }
+            uint32_t succ = node_of_[step(id, move)];
+            if(column_[succ] != NO_NODE) { continue; }
+            column_[succ] = next_column++;
+            stack.push_back(std::make_pair(succ, 0));
+        }
+    }
+    component_begin_.push_back(next_column);
+}
+
+void
+warthog::cpd::grid_oracle::precompute()
+{
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        gc_shared_data* shared = (gc_shared_data*) par->shared_;
+        const std::vector<warthog::grid_id_t>& ids = *shared->ids_;
+
+        // one Dijkstra search per worker thread
+        warthog::gridmap_expansion_policy expander(shared->map_);
+        warthog::zero_heuristic heuristic;
+        warthog::pqueue_min open;
+        grid_oracle_listener listener(shared->map_);
+        warthog::flexible_astar<
+            warthog::zero_heuristic,
+            warthog::gridmap_expansion_policy,
+            warthog::pqueue_min,
+            grid_oracle_listener>
+                dijkstra(&heuristic, &expander, &open, &listener);
+
+        std::vector<warthog::cpd::fm_coll> row(shared->map_->padded_mapsize());
+        warthog::sn_id_t source_id;
+        listener.set_run(&source_id, &row);
+
+        // rows are evenly divided among all threads
+        for(uint32_t i = par->thread_id_; i < ids.size();
+                i += par->max_threads_)
+        {
+            // tiles the search does not reach stay wildcards
+            source_id = ids[i];
+            std::fill(row.begin(), row.end(), FM_ANY);
+            warthog::problem_instance pi(
+                    shared->map_->to_unpadded_id((uint32_t)source_id));
+            warthog::solution sol;
+            dijkstra.get_pathcost(pi, sol);
+            row[source_id] = FM_ANY;
+
+            // greedily compress the row w.r.t. the column order
+            std::vector<warthog::cpd::rle_run32>& runs = shared->rows_[i];
+            warthog::cpd::fm_coll moveset = FM_ANY;
+            uint32_t head = 0;
+            for(uint32_t c = 0; c < ids.size(); c++)
+            {
+                warthog::cpd::fm_coll fm = row[ids[shared->order_[c]]];
+                if((moveset & fm) == 0)
+                {
+                    uint32_t firstmove = __builtin_ffs(moveset) - 1;
+                    runs.push_back(warthog::cpd::rle_run32{
+                            (head << 4) | firstmove });
+                    moveset = FM_ANY;
+                    head = c;
+                }
+                moveset &= fm;
+            }
+            uint32_t firstmove = __builtin_ffs(moveset) - 1;
+            runs.push_back(warthog::cpd::rle_run32{ (head << 4) | firstmove });
+            runs.shrink_to_fit();
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    if(ids_.size() > warthog::cpd::RLE_RUN32_MAX_INDEX)
+    {
+        std::cerr << "err; too many tiles for a grid cpd. aborting.\n";
+        exit(1);
+    }
+
+    warthog::timer t;
+    t.start();
+    std::cerr << "computing grid cpd (" << ids_.size() << " tiles, "
+        << component_begin_.size() - 1 << " components)\n";
+
+    gc_shared_data shared;
+    shared.map_ = map_;
+    shared.ids_ = &ids_;
+    shared.order_.resize(ids_.size());
+    for(uint32_t i = 0; i < ids_.size(); i++) { shared.order_[column_[i]] = i; }
+    shared.rows_.resize(ids_.size());
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, (uint32_t)ids_.size());
+
+    row_begin_.assign(1, 0);
+    runs_.clear();
+    for(std::vector<warthog::cpd::rle_run32>& runs : shared.rows_)
+    {
+        runs_.insert(runs_.end(), runs.begin(), runs.end());
+        row_begin_.push_back((uint32_t)runs_.size());
+        std::vector<warthog::cpd::rle_run32>().swap(runs);
+    }
+    runs_.shrink_to_fit();
+
+    t.stop();
+    std::cerr << "done. runs: " << runs_.size()
+        << " time " << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+bool
+warthog::cpd::grid_oracle::load(const char* filename)
+{
+    std::ifstream in(filename, std::ios_base::in | std::ios_base::binary);
+    if(!in.good()) { return false; }
+
+    gc_header header;
+    in.read((char*)&header, sizeof(header));
+    if(!in.good() || memcmp(header.magic_, GC_MAGIC, 4) != 0 ||
+       header.version_ != GC_VERSION ||
+       header.map_hash_ != map_->checksum() ||
+       header.num_nodes_ != ids_.size())
+    {
+        std::cerr << "grid cpd in " << filename
+            << " does not match the map\n";
+        return false;
+    }
+
+    row_begin_.resize(ids_.size() + 1);
+    runs_.resize(header.num_runs_);
+    in.read((char*)row_begin_.data(), sizeof(uint32_t) * row_begin_.size());
+    in.read((char*)runs_.data(),
+            sizeof(warthog::cpd::rle_run32) * runs_.size());
+    if(!in.good() || row_begin_.back() != runs_.size())
+    {
+        std::cerr << "err; while reading grid cpd " << filename << "\n";
+        row_begin_.clear();
+        runs_.clear();
+        return false;
+    }
+    return true;
+}
+
+bool
+warthog::cpd::grid_oracle::save(const char* filename)
+{
+    std::ofstream out(filename, std::ios_base::out | std::ios_base::binary);
+    if(!out.good())
+    {
+        std::cerr << "cannot write grid cpd to " << filename << "\n";
+        return false;
+    }
+
+    gc_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic_, GC_MAGIC, 4);
+    header.version_ = GC_VERSION;
+    header.map_hash_ = map_->checksum();
+    header.num_nodes_ = ids_.size();
+    header.num_runs_ = runs_.size();
+    out.write((char*)&header, sizeof(header));
+    out.write((char*)row_begin_.data(), sizeof(uint32_t) * row_begin_.size());
+    out.write((char*)runs_.data(),
+            sizeof(warthog::cpd::rle_run32) * runs_.size());
+    return out.good();
+}
+
+size_t
+warthog::cpd::grid_oracle::mem()
+{
+    return sizeof(*this) +
+        sizeof(uint32_t) * node_of_.capacity() +
+        sizeof(warthog::grid_id_t) * ids_.capacity() +
+        sizeof(uint32_t) * column_.capacity() +
+        sizeof(uint32_t) * component_begin_.capacity() +
+        sizeof(uint32_t) * row_begin_.capacity() +
+        sizeof(warthog::cpd::rle_run32) * runs_.capacity();
+}
@@ -0,0 +1,164 @@
+#ifndef WARTHOG_CPD_GRID_ORACLE_H
+#define WARTHOG_CPD_GRID_ORACLE_H
+
+// cpd/grid_oracle.h
+//
+// A Compressed Path Database over the tiles of a gridmap, built without
+// first turning the map into a warthog::graph::xy_graph (cf.
+// warthog::cpd::graph_oracle). Nodes are the traversable tiles and
+// moves are the 8 steps of an octile grid, without corner cutting,
+// numbered as the directions of warthog::jps::direction (N, S, E, W,
+// NE, NW, SE, SW).
+//
+// The row of a tile lists, for every other tile, a move that starts an
+// optimal path to it. Rows are found with one Dijkstra search per tile;
+// tiles are divided among threads. Each row is run-length encoded over
+// a DFS pre-order of the tiles: DFS visits every component of the map
+// in turn, so tiles in another component (which a query can never ask
+// for) are wildcards, as is the tile of the row itself.
+//
+// A query is a walk: look up the first move towards the target, make
+// it, repeat (see warthog::cpd::grid_cpd_search). There is no search.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "cpd.h"
+#include "gridmap.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace warthog
+{
+
+namespace cpd
+{
+
+class grid_oracle
+{
+    public:
+        grid_oracle(warthog::gridmap* map);
+        ~grid_oracle();
+
+        // compute the row of every traversable tile
+        void
+        precompute();
+
+        // the first move on an optimal path from padded id @param from
+        // to padded id @param to, or CPD_FM_NONE if there is no path
+        // (or if the two are the same)
+        inline uint32_t
+        get_move(warthog::grid_id_t from, warthog::grid_id_t to)
+        {
+            uint32_t source = node_of_[from];
+            uint32_t target = node_of_[to];
+            if(source == NO_NODE || target == NO_NODE || source == target ||
+               !is_reachable(source, target))
+            { return warthog::cpd::CPD_FM_NONE; }
+
+            // the last run that begins at or before the column of @param to
+            uint32_t column = column_[target];
+            warthog::cpd::rle_run32* first = runs_.data() + row_begin_[source];
+            warthog::cpd::rle_run32* last = runs_.data() + row_begin_[source + 1];
+            warthog::cpd::rle_run32* run = std::upper_bound(first + 1, last,
+                    column, [](uint32_t col, warthog::cpd::rle_run32& r)
+                    { return col < r.get_index(); }) - 1;
+            return run->get_move();
+        }
+
+        // the padded id one @param move from padded id @param grid_id_p
+        inline warthog::grid_id_t
+        step(warthog::grid_id_t grid_id_p, uint32_t move)
+        { return (warthog::grid_id_t)((int64_t)grid_id_p + delta_[move]); }
+
+        static inline warthog::cost_t
+        move_cost(uint32_t move)
+        { return move < 4 ? 1 : warthog::DBL_ROOT_TWO; }
+
+        // true if padded ids @param from and @param to are in the same
+        // component of the map
+        inline bool
+        is_connected(warthog::grid_id_t from, warthog::grid_id_t to)
+        {
+            uint32_t source = node_of_[from];
+            uint32_t target = node_of_[to];
+            return source != NO_NODE && target != NO_NODE &&
+                is_reachable(source, target);
+        }
+
+        // read and write the database. a file is only read if it was
+        // written for a map with the same tiles; @return false otherwise
+        bool
+        load(const char* filename);
+
+        bool
+        save(const char* filename);
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+        // false if there are no rows yet, or if the map was modified
+        // after the tiles were numbered; the rows then describe another
+        // map and cannot be used
+        inline bool
+        is_current()
+        { return !row_begin_.empty() && map_->get_version() == map_version_; }
+
+        inline uint32_t
+        get_num_nodes() { return (uint32_t)ids_.size(); }
+
+        inline size_t
+        get_num_runs() { return runs_.size(); }
+
+        size_t
+        mem();
+
+        static const uint32_t NO_NODE = UINT32_MAX;
+
+    private:
+        warthog::gridmap* map_;
+        uint32_t map_version_;
+        int32_t delta_[8];  // the change in padded id of each move
+
+        // traversable tiles: padded id -> node and node -> padded id
+        std::vector<uint32_t> node_of_;
+        std::vector<warthog::grid_id_t> ids_;
+
+        // the DFS pre-order: node -> column, and the first column of
+        // each component (plus one past the last column)
+        std::vector<uint32_t> column_;
+        std::vector<uint32_t> component_begin_;
+
+        // the runs of every row, one row per node
+        std::vector<uint32_t> row_begin_;
+        std::vector<warthog::cpd::rle_run32> runs_;
+
+        inline bool
+        is_reachable(uint32_t source, uint32_t target)
+        {
+            std::vector<uint32_t>::iterator it = std::upper_bound(
+                    component_begin_.begin(), component_begin_.end(),
+                    column_[source]);
+            return column_[target] >= *(it - 1) && column_[target] < *it;
+        }
+
+        // true if @param move can be made from padded id @param grid_id_p
+        bool
+        can_move(warthog::grid_id_t grid_id_p, uint32_t move);
+
+        void
+        compute_order();
+
+        grid_oracle(const grid_oracle& other) { }
+        grid_oracle&
+        operator=(const grid_oracle& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
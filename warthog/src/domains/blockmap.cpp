@@ -1,79 +1,388 @@
 #include "blockmap.h"
-#include "gm_parser.h"
 #include "gridmap.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char BMB_MAGIC[4] = { 'W', 'B', 'M', 'B' };
+static const uint32_t BMB_VERSION = 2;
+static const uint64_t BMB_ALIGN = 4096;
+
+// the binary format holds two images, the map and its rotated copy.
+// each image is the block table followed by the blocks, in the order
+// they have in memory; both start on a page boundary
+struct bmb_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t width_;            // unpadded dimensions
+    uint32_t height_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint32_t blocksize_;
+    uint32_t reserved_;
+    uint64_t num_traversable_;
+    char type_[16];
+    uint64_t image_offset_;
+    uint64_t image_bytes_;
+    uint64_t rimage_offset_;
+    uint64_t rimage_bytes_;
+};
+
+// interleave the bits of x and y
+static uint64_t
+morton_code(uint32_t x, uint32_t y)
+{
+    uint64_t code = 0;
+    for(uint32_t i = 0; i < 32; i++)
+    {
+        code |= (uint64_t)((x >> i) & 1) << (2*i);
+        code |= (uint64_t)((y >> i) & 1) << (2*i + 1);
+    }
+    return code;
+}
+
+static uint64_t
+table_bytes(uint32_t bwidth, uint32_t bheight)
+{
+    uint64_t bytes = sizeof(uint32_t) * (uint64_t)bwidth * bheight;
+    return ((bytes + BMB_ALIGN - 1) / BMB_ALIGN) * BMB_ALIGN;
+}
+
+warthog::blockmap::blockmap(uint32_t height, uint32_t width)
+	: header_(height, width, "octile")
+{
+	filename_[0] = 0;
+	init_dims();
+	init_blocks();
+}
+
+warthog::blockmap::blockmap(warthog::gridmap* map)
+	: header_(map->header_height(), map->header_width(), "octile")
+{
+	strcpy(filename_, map->filename());
+	init_dims();
+	init_blocks();
+	copy_from(map);
+}
+
 warthog::blockmap::blockmap(const char* filename)
 {
-	warthog::gm_parser parser(filename);
-	this->header_ = new gm_header(parser.get_header());
+	strcpy(filename_, filename);
+
+	char magic[4] = { 0, 0, 0, 0 };
+	std::ifstream in(filename, std::ios::binary);
+	in.read(magic, 4);
+	in.close();
+
+	if(memcmp(magic, BMB_MAGIC, 4) == 0)
+	{
+		if(!load_binary(filename))
+		{
+			std::cerr << "err; cannot read blocked map " << filename << "\n";
+			exit(1);
+		}
+		return;
+	}
+
+	warthog::gridmap map(filename);
+	header_ = warthog::gm_header(
+			map.header_height(), map.header_width(), "octile");
+	init_dims();
+	init_blocks();
+	copy_from(&map);
+}
+
+warthog::blockmap::blockmap(const warthog::gm_header& header,
+        const char* filename, uint64_t offset, uint64_t num_traversable)
+	: header_(header)
+{
+	strcpy(filename_, filename);
+	init_dims();
+	if(!map_image(filename, offset))
+	{
+		std::cerr << "err; cannot map rotated map from " << filename << "\n";
+		exit(1);
+	}
+	num_traversable_ = num_traversable;
+}
+
+warthog::blockmap::~blockmap()
+{
+	if(mapped_) { munmap(mapped_, mapped_size_); }
+	else
+	{
+		delete [] block_slot_;
+		free(blocks_);
+	}
+}
+
+void
+warthog::blockmap::init_dims()
+{
+	// same padding as warthog::gridmap, so that padded ids agree
+	padded_rows_before_first_row_ = 3;
+	padded_rows_after_last_row_ = 3;
+	padded_height_ = header_.height_ +
+		padded_rows_after_last_row_ + padded_rows_before_first_row_;
+
+	padded_width_ = header_.width_ + 1;
+	if((padded_width_ % warthog::GRIDWORD_BITS) != 0)
+	{
+		padded_width_ = (header_.width_ / warthog::GRIDWORD_BITS + 1) *
+			warthog::GRIDWORD_BITS;
+	}
+	padding_per_row_ = padded_width_ - header_.width_;
+
+	// room for one row past the end, for reads that wrap around
+	// from the last row; blocks that hold no tiles share slot 0
+	bwidth_ = (padded_width_ + BLOCKSIZE - 1) / BLOCKSIZE;
+	bheight_ = padded_height_ / BLOCKSIZE + 1;
+	num_blocks_ = bwidth_ *
+		((padded_height_ + BLOCKSIZE - 1) / BLOCKSIZE);
+
+	row_magic_ = UINT64_C(0xFFFFFFFFFFFFFFFF) / padded_width_ + 1;
+
+	num_traversable_ = 0;
+	version_ = 0;
+	block_slot_ = 0;
+	blocks_ = 0;
+	mapped_ = 0;
+	mapped_size_ = 0;
+	rimage_offset_ = 0;
+}
+
+uint64_t
+warthog::blockmap::image_bytes()
+{
+	return table_bytes(bwidth_, bheight_) + sizeof(warthog::gridword) *
+		BLOCK_WORDS * ((uint64_t)num_blocks_ + 1);
+}
+
+void
+warthog::blockmap::init_blocks()
+{
+	// number the blocks in Z-order; slot 0 is the empty block
+	std::vector<uint32_t> order(num_blocks_);
+	for(uint32_t i = 0; i < num_blocks_; i++) { order[i] = i; }
+	std::sort(order.begin(), order.end(),
+		[this](uint32_t a, uint32_t b)
+		{
+			return morton_code(a % bwidth_, a / bwidth_) <
+				   morton_code(b % bwidth_, b / bwidth_);
+		});
 
-	blocks_ = new gridmap**[this->dbwidth()];
-	for(unsigned int i=0; i < this->dbwidth(); i++)
+	block_slot_ = new uint32_t[bwidth_ * bheight_];
+	for(uint32_t i = 0; i < bwidth_ * bheight_; i++) { block_slot_[i] = 0; }
+	for(uint32_t rank = 0; rank < num_blocks_; rank++)
 	{
-		blocks_[i] = new gridmap*[this->dbheight()];
-		for(unsigned int j=0; j < this->dbheight(); j++)
+		uint32_t bx = order[rank] % bwidth_;
+		uint32_t by = order[rank] / bwidth_;
+		block_slot_[by * bwidth_ + bx] = (rank + 1) * BLOCK_WORDS;
+	}
+
+	size_t bytes = sizeof(warthog::gridword) * BLOCK_WORDS *
+		((size_t)num_blocks_ + 1);
+	void* mem = 0;
+	if(posix_memalign(&mem, 64, bytes) != 0)
+	{
+		std::cerr << "err; cannot allocate blockmap\n";
+		exit(1);
+	}
+	blocks_ = (warthog::gridword*)mem;
+	memset(blocks_, 0, bytes);
+}
+
+void
+warthog::blockmap::copy_from(warthog::gridmap* map)
+{
+	// both maps have the same padded layout; copy one word at a time
+	uint32_t words_per_row = padded_width_ >> warthog::LOG2_GRIDWORD_BITS;
+	for(uint32_t y = 0; y < padded_height_; y++)
+	{
+		warthog::gridword* row = map->get_mem_ptr(y * padded_width_);
+		for(uint32_t w = 0; w < words_per_row; w++)
 		{
-			unsigned int blockwidth = BLOCKSIZE;
-			if((i*BLOCKSIZE+blockwidth) > header_->width_)
-			{
-				blockwidth = header_->width_ % BLOCKSIZE;
-			}
-
-			unsigned int blockheight = BLOCKSIZE;
-			if((i*BLOCKSIZE+blockheight) > header_->height_)
-			{
-				blockheight = header_->height_ % BLOCKSIZE;
-			}
-
-			blocks_[i][j] = new gridmap(blockheight, blockwidth);
+			word_at(w << warthog::LOG2_GRIDWORD_BITS, y) = row[w];
 		}
 	}
+	num_traversable_ = map->get_num_traversable_tiles();
+}
 
-	// set terrain type of each tile
-	for(unsigned int i=0; i < parser.get_num_tiles(); i++)
+bool
+warthog::blockmap::load_binary(const char* filename)
+{
+	bmb_header header;
+	std::ifstream in(filename, std::ios::binary);
+	in.read((char*)&header, sizeof(header));
+	if( !in.good() || header.version_ != BMB_VERSION ||
+		header.blocksize_ != BLOCKSIZE)
 	{
-		unsigned char c = parser.get_tile_at(i);
-		unsigned int x = i % this->width();
-		unsigned int y = i / this->width();
+		return false;
+	}
+	in.close();
+
+	header.type_[sizeof(header.type_)-1] = 0;
+	header_ = warthog::gm_header(header.height_, header.width_, header.type_);
+	init_dims();
+	if( header.padded_width_ != padded_width_ ||
+		header.padded_height_ != padded_height_ ||
+		header.image_bytes_ != image_bytes() ||
+		!map_image(filename, header.image_offset_))
+	{
+		return false;
+	}
+	num_traversable_ = header.num_traversable_;
+	rimage_offset_ = header.rimage_offset_;
+	return true;
+}
+
+bool
+warthog::blockmap::map_image(const char* filename, uint64_t offset)
+{
+	uint64_t tbytes = table_bytes(bwidth_, bheight_);
+	uint64_t bytes = image_bytes();
+	int fd = open(filename, O_RDONLY);
+	if(fd == -1) { return false; }
 
-		switch(c)
+	struct stat st;
+	if( fstat(fd, &st) == -1 || offset % BMB_ALIGN != 0 ||
+		offset + bytes > (uint64_t)st.st_size)
+	{
+		close(fd);
+		return false;
+	}
+
+	// private and writeable, as for warthog::gridmap. pages, and so
+	// blocks, are read from the file the first time they are touched
+	void* mapped = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, (off_t)offset);
+	close(fd);
+	if(mapped == MAP_FAILED) { return false; }
+
+	mapped_ = mapped;
+	mapped_size_ = bytes;
+	block_slot_ = (uint32_t*)mapped;
+	blocks_ = (warthog::gridword*)((char*)mapped + tbytes);
+
+	// a corrupt table could send reads anywhere
+	uint32_t max_slot = num_blocks_ * BLOCK_WORDS;
+	for(uint32_t i = 0; i < bwidth_ * bheight_; i++)
+	{
+		if(block_slot_[i] > max_slot || block_slot_[i] % BLOCK_WORDS)
 		{
-			case 'S':
-			case 'W': 
-			case 'T':
-			case '@':
-			case 'O':
-				this->set_label(x, y, false); // obstacle
-				break;
-			default:
-				this->set_label(x, y, true); // traversable
-				break;
+			munmap(mapped_, mapped_size_);
+			mapped_ = 0;
+			block_slot_ = 0;
+			blocks_ = 0;
+			return false;
 		}
 	}
+	return true;
 }
 
-warthog::blockmap::~blockmap()
+bool
+warthog::blockmap::save_binary(const char* filename)
+{
+	warthog::blockmap* rmap = rotated_copy();
+
+	bmb_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic_, BMB_MAGIC, 4);
+	header.version_ = BMB_VERSION;
+	header.width_ = header_.width_;
+	header.height_ = header_.height_;
+	header.padded_width_ = padded_width_;
+	header.padded_height_ = padded_height_;
+	header.num_traversable_ = num_traversable_;
+	header.blocksize_ = BLOCKSIZE;
+	strncpy(header.type_, header_.type_.c_str(), sizeof(header.type_)-1);
+
+	header.image_offset_ = BMB_ALIGN;
+	header.image_bytes_ = image_bytes();
+	header.rimage_offset_ = header.image_offset_ + header.image_bytes_;
+	header.rimage_bytes_ = rmap->image_bytes();
+
+	std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+	if(!out.good())
+	{
+		std::cerr << "err; cannot write blocked map to " << filename << "\n";
+		delete rmap;
+		return false;
+	}
+	std::vector<char> zeroes(BMB_ALIGN, 0);
+	out.write((const char*)&header, sizeof(header));
+	out.write(zeroes.data(), BMB_ALIGN - sizeof(header));
+
+	warthog::blockmap* images[2] = { this, rmap };
+	for(uint32_t i = 0; i < 2; i++)
+	{
+		warthog::blockmap* m = images[i];
+		uint64_t tsize = sizeof(uint32_t) * (uint64_t)m->bwidth_ * m->bheight_;
+		out.write((const char*)m->block_slot_, tsize);
+		out.write(zeroes.data(), table_bytes(m->bwidth_, m->bheight_) - tsize);
+		out.write((const char*)m->blocks_, sizeof(warthog::gridword) *
+				BLOCK_WORDS * ((uint64_t)m->num_blocks_ + 1));
+	}
+	delete rmap;
+	return out.good();
+}
+
+warthog::blockmap*
+warthog::blockmap::rotated_copy()
 {
-	for(unsigned int i = 0; i < this->dbwidth(); i++)
+	uint32_t maph = header_height();
+	uint32_t mapw = header_width();
+	uint32_t rmaph = mapw;
+	uint32_t rmapw = maph;
+
+	// the copy in the file is valid only if the map is unmodified
+	if(mapped_ && rimage_offset_ && version_ == 0)
+	{
+		warthog::gm_header rheader(rmaph, rmapw, header_.type_.c_str());
+		return new warthog::blockmap(
+				rheader, filename_, rimage_offset_, num_traversable_);
+	}
+
+	warthog::blockmap* rmap = new warthog::blockmap(rmaph, rmapw);
+	strcpy(rmap->filename_, filename_);
+	uint32_t ypad = padded_rows_before_first_row_;
+	for(uint32_t y = 0; y < maph; y++)
 	{
-		for(unsigned int j = 0; j < this->dbheight(); j++)
+		for(uint32_t x = 0; x < mapw; x++)
 		{
-			delete blocks_[i][j];
+			if(!get_label(x, y + ypad)) { continue; }
+			uint32_t rx = ((rmapw-1) - y);
+			uint32_t ry = x;
+			rmap->set_label(rx, ry + ypad, true);
 		}
-		delete [] blocks_[i];
 	}
-	delete [] blocks_;
-	delete header_;
+	rmap->num_traversable_ = num_traversable_;
+	return rmap;
 }
 
-void 
+void
 warthog::blockmap::print(std::ostream& out)
 {
-	for(unsigned int y = 0; y < this->height(); y++)
+	out << "printing padded map" << std::endl;
+	out << "-------------------" << std::endl;
+	out << "type "<< header_.type_ << std::endl;
+	out << "height "<< this->height() << std::endl;
+	out << "width "<< this->width() << std::endl;
+	out << "blocks "<< this->get_num_blocks() << std::endl;
+	out << "map" << std::endl;
+	for(unsigned int y=0; y < this->height(); y++)
 	{
-		for(unsigned int x = 0; x < this->width(); x++)
+		for(unsigned int x=0; x < this->width(); x++)
 		{
-			out << this->get_label(x, y);
+			out << (this->get_label(x, y) ? '.' : '@');
 		}
 		out << std::endl;
 	}
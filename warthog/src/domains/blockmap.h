@@ -7,6 +7,25 @@
 // The idea is to create a cache-efficient method for accessing sections
 // of very large grid domains.
 //
+// Each block holds BLOCKSIZE x BLOCKSIZE tiles, one bit per tile, in
+// 8KB of contiguous memory. Blocks are stored in Z-order (Morton order),
+// so blocks that are close together on the map are also close together
+// in memory. A search on a very large map only touches the blocks near
+// its frontier, and a blockmap read from a binary file (see ::save_binary)
+// loads them from disk as they are touched.
+// Reading tiles costs more than on a gridmap (a multiplication and two
+// table lookups per row read); the layout pays off only on maps that do
+// not fit comfortably in memory. On maps that do (den520d, Berlin_0_256,
+// AcrosstheCape) JPS2 is about 1.6-1.9 times slower on a blockmap than
+// on a gridmap, and prune2 about 1.3-1.5 times slower. Programs should
+// therefore use a blockmap only when asked to (e.g. warthog --blocked).
+//
+// Nodes are identified the same way as in warthog::gridmap: ids are
+// indexes into a padded row-major matrix with the same padding scheme,
+// and the interface is the same. A blockmap can therefore stand in for a
+// gridmap in the (templated) JPS expansion policies, and ids, padded
+// coordinates and anything labelled with them carry over unchanged.
+//
 // @author: dharabor
 // @created: 13/08/2012
 //
@@ -14,70 +33,321 @@
 #include "constants.h"
 #include "gridmap.h"
 
+#include <cstring>
 #include <iostream>
 
 namespace warthog
 {
-	
+
 // blockmap constants
 static const uint32_t BLOCKSIZE = 256; // NB: must be a power of 2!!
-static const uint32_t LOG_BLOCKSIZE = 
+static const uint32_t LOG_BLOCKSIZE =
     static_cast<uint32_t>(ceil(log10(BLOCKSIZE) / log10(2)));
+// gridwords per row of a block, and per block
+static const uint32_t BLOCK_ROW_WORDS = BLOCKSIZE / warthog::GRIDWORD_BITS;
+static const uint32_t BLOCK_WORDS = BLOCKSIZE * BLOCK_ROW_WORDS;
 
-class gm_parser;
-class gridmap;
 class blockmap
 {
 	public:
+		// read a map in any of the formats understood by warthog::gridmap,
+		// or in the binary format of ::save_binary
 		blockmap(const char* filename);
-		virtual ~blockmap();
+		blockmap(warthog::gridmap* map);
+		blockmap(uint32_t height, uint32_t width);
+		~blockmap();
+
+		// write the map, and its rotated copy, to @param filename.
+		// blocks are mapped from the file, on demand, when it is read
+		bool
+		save_binary(const char* filename);
+
+		// @return a copy of the map rotated by 90 degrees clockwise
+		// (see warthog::gridmap::rotated_copy). the caller owns the result
+		warthog::blockmap*
+		rotated_copy();
+
+		inline warthog::grid_id_t
+		to_padded_id(warthog::grid_id_t node_id)
+		{
+			return node_id +
+				(warthog::grid_id_t)padded_rows_before_first_row_*padded_width_ +
+				(node_id / header_.width_) * padding_per_row_;
+		}
+
+		inline warthog::grid_id_t
+		to_padded_id(uint32_t x, uint32_t y)
+		{
+			return to_padded_id((warthog::grid_id_t)y * this->header_width() + x);
+		}
+
+		inline void
+		to_padded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
+		{
+			y = row_of(grid_id_p);
+			x = (uint32_t)(grid_id_p - (warthog::grid_id_t)y * padded_width_);
+		}
+
+		inline void
+		to_unpadded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
+		{
+			to_padded_xy(grid_id_p, x, y);
+			y -= padded_rows_before_first_row_;
+		}
+
+        inline warthog::grid_id_t
+        to_unpadded_id(warthog::grid_id_t padded_id)
+        {
+            uint32_t x, y;
+            to_unpadded_xy(padded_id, x, y);
+            return (warthog::grid_id_t)y * header_.width_ + x;
+        }
 
-		void print(std::ostream& out);
+		// see warthog::gridmap::get_neighbours
+		inline void
+		get_neighbours(warthog::grid_id_t grid_id_p, uint8_t tiles[3])
+		{
+			uint32_t x, y;
+			to_padded_xy(grid_id_p - 1, x, y);
+			tiles[0] = (uint8_t)read_bits(x, y-1);
+			tiles[1] = (uint8_t)read_bits(x, y);
+			tiles[2] = (uint8_t)read_bits(x, y+1);
+		}
 
+		// see warthog::gridmap::get_neighbours_32bit
+		inline void
+		get_neighbours_32bit(warthog::grid_id_t grid_id_p, uint32_t tiles[3])
+		{
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			tiles[0] = (uint32_t)read_bits(x, y-1);
+			tiles[1] = (uint32_t)read_bits(x, y);
+			tiles[2] = (uint32_t)read_bits(x, y+1);
+		}
+
+		// see warthog::gridmap::get_neighbours_upper_32bit
+		inline void
+		get_neighbours_upper_32bit(warthog::grid_id_t grid_id_p, uint32_t tiles[3])
+		{
+			uint32_t x, y;
+			to_padded_xy(grid_id_p - 31, x, y);
+			tiles[0] = (uint32_t)read_bits(x, y-1);
+			tiles[1] = (uint32_t)read_bits(x, y);
+			tiles[2] = (uint32_t)read_bits(x, y+1);
+		}
+
+		// get the label associated with the padded coordinate pair (x, y)
 		inline bool
-		get_label(unsigned int x, unsigned int y)
+		get_label(uint32_t x, unsigned int y)
 		{
-			unsigned int block_x = x >> warthog::LOG_BLOCKSIZE;
-			unsigned int block_y = y >> warthog::LOG_BLOCKSIZE;
-			x = x & (warthog::BLOCKSIZE-1);
-			y = y & (warthog::BLOCKSIZE-1);
-			gridmap* block = blocks_[block_x][block_y];
-			return block->get_label(block->to_padded_id(x, y));
+			return (word_at(x, y) >> (x & warthog::GRIDWORD_BITS_MASK)) & 1;
 		}
 
-		inline void 
-		set_label(unsigned int x, unsigned int y, bool label)
+		inline warthog::gridword
+		get_label(warthog::grid_id_t grid_id_p)
 		{
-			unsigned int block_x = x >> warthog::LOG_BLOCKSIZE;
-			unsigned int block_y = y >> warthog::LOG_BLOCKSIZE;
-			x = x & (warthog::BLOCKSIZE-1);
-			y = y & (warthog::BLOCKSIZE-1);
-			gridmap* block = blocks_[block_x][block_y];
-			return block->set_label(block->to_padded_id(x, y), label);
+			if(grid_id_p >= padded_mapsize()) { return 0; }
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			return get_label(x, y);
 		}
 
-		inline unsigned int height() { return header_->height_; }
-		inline unsigned int width() { return header_->width_; }
+		// set the label associated with the padded coordinate pair (x, y)
+		inline void
+		set_label(uint32_t x, unsigned int y, bool label)
+		{
+			warthog::gridword bitmask = (warthog::gridword)1 <<
+				(x & warthog::GRIDWORD_BITS_MASK);
+			// blocks outside the padded map are shared and stay empty
+			if(block_slot_[block_of(x, y)] == 0) { return; }
+			warthog::gridword& word = word_at(x, y);
 
-		inline unsigned int 
-		get_num_blocks() 
-		{ 
-			return this->dbheight()*this->dbwidth(); 
+			if(label) { word |= bitmask; }
+			else { word &= ~bitmask; }
+            version_++;
+		}
+
+		inline void
+		set_label(warthog::grid_id_t grid_id_p, bool label)
+		{
+			if(grid_id_p >= padded_mapsize()) { return; }
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			set_label(x, y, label);
+		}
+
+        // see warthog::gridmap::set_label_tmp
+		inline void
+		set_label_tmp(warthog::grid_id_t grid_id_p, bool label)
+		{
+			uint32_t version = version_;
+			set_label(grid_id_p, label);
+			version_ = version;
+		}
+
+        // see warthog::gridmap::get_version
+        inline uint32_t
+        get_version() { return version_; }
+
+		inline warthog::grid_id_t
+		padded_mapsize()
+		{
+			return (warthog::grid_id_t)padded_width_ * padded_height_;
+		}
+
+		inline uint32_t
+		height() const
+		{
+			return this->padded_height_;
+		}
+
+		inline uint32_t
+		width() const
+		{
+			return this->padded_width_;
+		}
+
+		inline uint32_t
+		header_height()
+		{
+			return this->header_.height_;
+		}
+
+		inline uint32_t
+		header_width()
+		{
+			return this->header_.width_;
+		}
+
+		inline const char*
+		filename()
+		{
+			return this->filename_;
+		}
+
+        inline uint64_t
+        get_num_traversable_tiles()
+        {
+            return num_traversable_;
+        }
+
+		inline uint32_t
+		get_num_blocks()
+		{
+			return num_blocks_;
+		}
+
+		inline bool
+		is_mapped() { return mapped_ != 0; }
+
+		void
+		print(std::ostream& out);
+
+		size_t
+		mem()
+		{
+			return sizeof(*this) +
+				sizeof(uint32_t) * bwidth_ * bheight_ +
+				sizeof(warthog::gridword) * BLOCK_WORDS * (num_blocks_+1);
 		}
 
 	private:
-		inline unsigned int dbheight()
+		warthog::gm_header header_;
+		char filename_[256];
+
+		uint32_t padded_width_;
+		uint32_t padded_height_;
+		uint32_t padding_per_row_;
+		uint32_t padded_rows_before_first_row_;
+		uint32_t padded_rows_after_last_row_;
+        uint64_t num_traversable_;
+        uint32_t version_;
+
+		// blocks per row and per column of the padded map. the last
+		// row of blocks can be past the end of the map; reads that
+		// cross the bottom right corner end up there
+		uint32_t bwidth_;
+		uint32_t bheight_;
+		uint32_t num_blocks_;
+		// the offset (in words) of every block in blocks_. block 0 is
+		// all zeroes and is shared by every block that holds no tiles
+		uint32_t* block_slot_;
+		warthog::gridword* blocks_;
+
+		// for fast division by padded_width_ (see ::row_of)
+		uint64_t row_magic_;
+
+        // the file mapping that holds block_slot_ and blocks_, if any
+        void* mapped_;
+        size_t mapped_size_;
+        uint64_t rimage_offset_;    // rotated map in the binary file
+
+		blockmap(const warthog::blockmap& other) {}
+		blockmap& operator=(const warthog::blockmap& other) { return *this; }
+
+		// map the rotated copy stored at @param offset of @param filename
+		blockmap(const warthog::gm_header& header, const char* filename,
+                uint64_t offset, uint64_t num_traversable);
+
+		// @return grid_id_p / padded_width_, without a division: the
+		// high 64 bits of row_magic_ * grid_id_p. exact for all 32-bit
+		// values; see [D. Lemire, O. Kaser and N. Kurz, Faster Remainder
+		// by Direct Computation, 2019]. the product is formed from two
+		// 32x32-bit halves, which cannot overflow.
+		// 64-bit ids (GRID_ID64) fall back to dividing
+		inline uint32_t
+		row_of(warthog::grid_id_t grid_id_p)
 		{
-			return (header_->height_ >> warthog::LOG_BLOCKSIZE)+1;
+			if(sizeof(warthog::grid_id_t) > 4)
+			{
+				return (uint32_t)(grid_id_p / padded_width_);
+			}
+			uint64_t id = (uint32_t)grid_id_p;
+			uint64_t lo = (row_magic_ & UINT32_MAX) * id;
+			uint64_t hi = (row_magic_ >> 32) * id;
+			return (uint32_t)((hi + (lo >> 32)) >> 32);
 		}
 
-		inline unsigned int dbwidth()
+		inline uint32_t
+		block_of(uint32_t x, uint32_t y)
 		{
-			return (header_->width_ >> warthog::LOG_BLOCKSIZE)+1;
+			return (y >> LOG_BLOCKSIZE) * bwidth_ + (x >> LOG_BLOCKSIZE);
+		}
+
+		inline warthog::gridword&
+		word_at(uint32_t x, uint32_t y)
+		{
+			uint32_t slot = block_slot_[block_of(x, y)];
+			return blocks_[slot +
+				((y & (BLOCKSIZE-1)) * BLOCK_ROW_WORDS) +
+				((x & (BLOCKSIZE-1)) >> warthog::LOG2_GRIDWORD_BITS)];
+		}
+
+		// the 64 tiles starting at padded coordinates (x, y), in order of
+		// increasing id; the tile at (x, y) is in the lowest bit
+		// position. as with warthog::gridmap, tiles past the end of a
+		// row are those at the start of the next row. the two words
+		// involved can be in different blocks
+		inline uint64_t
+		read_bits(uint32_t x, uint32_t y)
+		{
+			uint32_t bit_offset = x & warthog::GRIDWORD_BITS_MASK;
+
+			uint32_t nx = x + warthog::GRIDWORD_BITS;
+			uint32_t ny = y;
+			if(nx >= padded_width_) { nx -= padded_width_; ny++; }
+
+			// NB: shift twice; shifting a 64-bit word by 64 is undefined
+			return (word_at(x, y) >> bit_offset) |
+				((word_at(nx, ny) << 1) << (63 - bit_offset));
 		}
 
-		gm_header* header_;
-		gridmap*** blocks_; // gridmap* matrix; each BLOCKSIZE*BLOCKSIZE cells
+		void init_dims();
+		void init_blocks();
+		void copy_from(warthog::gridmap* map);
+		bool load_binary(const char* filename);
+		bool map_image(const char* filename, uint64_t offset);
+		uint64_t image_bytes();
 };
 
 }
@@ -1,7 +1,65 @@
 #include "gridmap.h"
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char GMB_MAGIC[4] = { 'W', 'G', 'M', 'B' };
+static const uint32_t GMB_VERSION = 2;
+
+// sections of the binary format start on a page boundary, so that
+// each one can be mapped on its own
+static const uint64_t GMB_ALIGN = 4096;
+
+// the padded dimensions of a map with @param width columns and
+// @param height rows: three rows of padding above and below, and
+// rows padded to a whole number of gridwords
+static void
+padded_dims(uint32_t width, uint32_t height,
+		uint32_t& padded_width, uint32_t& padded_height)
+{
+	padded_height = height + 6;
+	padded_width = width + 1;
+	if((padded_width % warthog::GRIDWORD_BITS) != 0)
+	{
+		padded_width = (width / warthog::GRIDWORD_BITS + 1) *
+			warthog::GRIDWORD_BITS;
+	}
+}
+
+static uint64_t
+db_bytes(uint32_t width, uint32_t height)
+{
+	uint32_t padded_width, padded_height;
+	padded_dims(width, height, padded_width, padded_height);
+	return (uint64_t)(padded_width >> warthog::LOG2_GRIDWORD_BITS) *
+		padded_height * sizeof(warthog::gridword);
+}
+
+struct gmb_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t width_;            // unpadded dimensions
+    uint32_t height_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint32_t num_traversable_;  // low 32 bits
+    char type_[16];
+    uint32_t num_traversable_hi_;
+    uint64_t checksum_;
+    uint64_t db_offset_;        // the padded map
+    uint64_t db_bytes_;
+    uint64_t rdb_offset_;       // the map rotated by 90 degrees clockwise
+    uint64_t rdb_bytes_;
+};
 
 warthog::gridmap::gridmap(unsigned int h, unsigned int w)
 	: header_(h, w, "octile")
@@ -12,13 +70,47 @@ warthog::gridmap::gridmap(unsigned int h, unsigned int w)
 warthog::gridmap::gridmap(const char* filename)
 {
 	strcpy(filename_, filename);
+
+	char magic[4] = { 0, 0, 0, 0 };
+	std::ifstream in(filename, std::ios::binary);
+	in.read(magic, 4);
+	in.close();
+
+	if(memcmp(magic, GMB_MAGIC, 4) != 0)
+	{
+		load_ascii(filename);
+	}
+	else if(!load_binary(filename))
+	{
+		std::cerr << "err; cannot read binary map " << filename << "\n";
+		exit(1);
+	}
+}
+
+warthog::gridmap::gridmap(const warthog::gm_header& header,
+        const char* filename, uint64_t offset, uint64_t num_traversable)
+	: header_(header)
+{
+	strcpy(filename_, filename);
+	init_dims();
+	if(!map_db(filename, offset))
+	{
+		std::cerr << "err; cannot map rotated map from " << filename << "\n";
+		exit(1);
+	}
+	num_traversable_ = num_traversable;
+}
+
+void
+warthog::gridmap::load_ascii(const char* filename)
+{
 	warthog::gm_parser parser(filename);
 	this->header_ = parser.get_header();
 
 	init_db();
 	// populate matrix
     num_traversable_ = 0;
-	for(unsigned int i = 0; i < parser.get_num_tiles(); i++)
+	for(size_t i = 0; i < parser.get_num_tiles(); i++)
 	{
 		unsigned char c = parser.get_tile_at(i);
 		switch(c)
@@ -40,44 +132,240 @@ warthog::gridmap::gridmap(const char* filename)
 	}
 }
 
+bool
+warthog::gridmap::is_map_file(const char* filename)
+{
+	char magic[4] = { 0, 0, 0, 0 };
+	std::ifstream in(filename, std::ios::binary);
+	in.read(magic, 4);
+	if(!in.good()) { return false; }
+	if(memcmp(magic, GMB_MAGIC, 4) != 0)
+	{
+		in.close();
+		return warthog::gm_parser::is_valid(filename);
+	}
+
+	// the checks made by ::load_binary and ::rotated_copy
+	gmb_header header;
+	in.seekg(0);
+	in.read((char*)&header, sizeof(header));
+	in.seekg(0, std::ios::end);
+	uint64_t size = (uint64_t)in.tellg();
+	if(!in.good() || header.version_ != GMB_VERSION ||
+	   header.width_ == 0 || header.height_ == 0) { return false; }
+
+	uint32_t padded_width, padded_height;
+	padded_dims(header.width_, header.height_, padded_width, padded_height);
+	uint64_t bytes = db_bytes(header.width_, header.height_);
+	if(header.padded_width_ != padded_width ||
+	   header.padded_height_ != padded_height ||
+	   header.db_bytes_ != bytes || header.db_offset_ % GMB_ALIGN != 0 ||
+	   header.db_offset_ > size || size - header.db_offset_ < bytes)
+	{ return false; }
+
+	bytes = db_bytes(header.height_, header.width_);
+	return header.rdb_offset_ == 0 ||
+		(header.rdb_bytes_ == bytes && header.rdb_offset_ % GMB_ALIGN == 0 &&
+		 header.rdb_offset_ <= size && size - header.rdb_offset_ >= bytes);
+}
+
+bool
+warthog::gridmap::load_binary(const char* filename)
+{
+	gmb_header header;
+	std::ifstream in(filename, std::ios::binary);
+	in.read((char*)&header, sizeof(header));
+	if(!in.good() || header.version_ != GMB_VERSION) { return false; }
+	in.close();
+
+	header.type_[sizeof(header.type_)-1] = 0;
+	header_ = warthog::gm_header(header.height_, header.width_, header.type_);
+	init_dims();
+	if( header.padded_width_ != padded_width_ ||
+		header.padded_height_ != padded_height_ ||
+		header.db_bytes_ != db_size_ * sizeof(warthog::gridword) ||
+		!map_db(filename, header.db_offset_))
+	{
+		return false;
+	}
+	num_traversable_ = ((uint64_t)header.num_traversable_hi_ << 32) |
+		header.num_traversable_;
+	rdb_offset_ = header.rdb_offset_;
+	mapped_checksum_ = header.checksum_;
+	return true;
+}
+
+bool
+warthog::gridmap::map_db(const char* filename, uint64_t offset)
+{
+	int fd = open(filename, O_RDONLY);
+	if(fd == -1) { return false; }
+
+	struct stat st;
+	size_t bytes = db_size_ * sizeof(warthog::gridword);
+	if( fstat(fd, &st) == -1 || offset % GMB_ALIGN != 0 ||
+		offset + bytes > (uint64_t)st.st_size)
+	{
+		close(fd);
+		return false;
+	}
+
+	// private and writeable: modifying the map copies the pages
+	// concerned and leaves the file as it is
+	void* mapped = mmap(0, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+			fd, (off_t)offset);
+	close(fd);
+	if(mapped == MAP_FAILED) { return false; }
+
+	mapped_ = mapped;
+	mapped_size_ = bytes;
+	db_ = (warthog::gridword*)mapped;
+	return true;
+}
+
+bool
+warthog::gridmap::save_binary(const char* filename)
+{
+	warthog::gridmap* rmap = rotated_copy();
+
+	gmb_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic_, GMB_MAGIC, 4);
+	header.version_ = GMB_VERSION;
+	header.width_ = header_.width_;
+	header.height_ = header_.height_;
+	header.padded_width_ = padded_width_;
+	header.padded_height_ = padded_height_;
+	header.num_traversable_ = (uint32_t)num_traversable_;
+	header.num_traversable_hi_ = (uint32_t)(num_traversable_ >> 32);
+	strncpy(header.type_, header_.type_.c_str(), sizeof(header.type_)-1);
+	header.checksum_ = checksum();
+	header.db_bytes_ = db_size_ * sizeof(warthog::gridword);
+	header.db_offset_ = GMB_ALIGN;
+	header.rdb_bytes_ = rmap->db_size_ * sizeof(warthog::gridword);
+	header.rdb_offset_ = header.db_offset_ +
+		((header.db_bytes_ + GMB_ALIGN - 1) / GMB_ALIGN) * GMB_ALIGN;
+
+	std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+	if(!out.good())
+	{
+		std::cerr << "err; cannot write binary map to " << filename << "\n";
+		delete rmap;
+		return false;
+	}
+	std::vector<char> zeroes(GMB_ALIGN, 0);
+	out.write((const char*)&header, sizeof(header));
+	out.write(zeroes.data(), header.db_offset_ - sizeof(header));
+	out.write((const char*)db_, header.db_bytes_);
+	out.write(zeroes.data(),
+			header.rdb_offset_ - header.db_offset_ - header.db_bytes_);
+	out.write((const char*)rmap->db_, header.rdb_bytes_);
+	delete rmap;
+	return out.good();
+}
+
+warthog::gridmap*
+warthog::gridmap::rotated_copy()
+{
+	uint32_t maph = header_height();
+	uint32_t mapw = header_width();
+	uint32_t rmaph = mapw;
+	uint32_t rmapw = maph;
+
+	// the copy in the file is valid only if the map is unmodified
+	if(mapped_ && rdb_offset_ && version_ == 0)
+	{
+		warthog::gm_header rheader(rmaph, rmapw, header_.type_.c_str());
+		return new warthog::gridmap(
+				rheader, filename_, rdb_offset_, num_traversable_);
+	}
+
+	warthog::gridmap* rmap = new warthog::gridmap(rmaph, rmapw);
+	for(uint32_t x = 0; x < mapw; x++) 
+	{
+		for(uint32_t y = 0; y < maph; y++)
+		{
+			uint32_t label = get_label(to_padded_id(x, y));
+			uint32_t rx = ((rmapw-1) - y);
+			uint32_t ry = x;
+			uint32_t rid = rmap->to_padded_id(rx, ry);
+			rmap->set_label(rid, label);
+		}
+	}
+	rmap->num_traversable_ = num_traversable_;
+	return rmap;
+}
+
 void
-warthog::gridmap::init_db()
+warthog::gridmap::init_dims()
 {
 	// when storing the grid we pad the edges of the map with
 	// zeroes. this eliminates the need for bounds checking when
 	// fetching the neighbours of a node. 
 	this->padded_rows_before_first_row_ = 3;
 	this->padded_rows_after_last_row_ = 3;
-	this->padded_height_ = this->header_.height_ + 
-		padded_rows_after_last_row_ +
-		padded_rows_before_first_row_;
 
 	// calculate # of extra/redundant padding bits required,
-	// per row, to align map width with dbword size
-	this->padded_width_  = this->header_.width_ + 1;
-    if((padded_width_ % 32) != 0) 
-    {
-        padded_width_ = (this->header_.width_ / 32 + 1) * 32;
-    }
+	// per row, to align map width with gridword size
+	padded_dims(header_.width_, header_.height_,
+			this->padded_width_, this->padded_height_);
 	this->padding_per_row_ = this->padded_width_ - this->header_.width_;
 
     this->dbheight_ = padded_height_;
-    this->dbwidth_ = padded_width_ >> warthog::LOG2_DBWORD_BITS;
+    this->dbwidth_ = padded_width_ >> warthog::LOG2_GRIDWORD_BITS;
 	this->db_size_ = this->dbwidth_ * this->dbheight_;
 
-	// create a one dimensional dbword array to store the grid
-	this->db_ = new warthog::dbword[db_size_];
+	max_id_ = db_size_-1;
+    num_traversable_ = 0;
+    version_ = 0;
+    mapped_ = 0;
+    mapped_size_ = 0;
+    rdb_offset_ = 0;
+    mapped_checksum_ = 0;
+}
+
+void
+warthog::gridmap::init_db()
+{
+	init_dims();
+
+	// create a one dimensional gridword array to store the grid;
+	// it starts on a cache line
+	void* mem = 0;
+	if(posix_memalign(&mem, 64, sizeof(warthog::gridword) * db_size_) != 0)
+	{
+		std::cerr << "err; cannot allocate gridmap\n";
+		exit(1);
+	}
+	this->db_ = (warthog::gridword*)mem;
 	for(unsigned int i=0; i < db_size_; i++)
 	{
 		db_[i] = 0;
 	}
-
-	max_id_ = db_size_-1;
 }
 
 warthog::gridmap::~gridmap()
 {
-	delete [] db_;
+	if(mapped_) { munmap(mapped_, mapped_size_); }
+	else { free(db_); }
+}
+
+uint64_t
+warthog::gridmap::checksum()
+{
+    // binary maps store the checksum; no need to scan the map
+    if(mapped_checksum_ && version_ == 0) { return mapped_checksum_; }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    hash = (hash ^ padded_width_) * 1099511628211ull;
+    hash = (hash ^ padded_height_) * 1099511628211ull;
+    const uint8_t* bytes = (const uint8_t*)db_;
+    for(size_t i = 0; i < db_size_ * sizeof(warthog::gridword); i++)
+    {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
 }
 
 void 
@@ -93,7 +381,7 @@ warthog::gridmap::print(std::ostream& out)
 	{
 		for(unsigned int x=0; x < this->width(); x++)
 		{
-			warthog::dbword c = this->get_label(y*this->width()+x);
+			warthog::gridword c = this->get_label(x, y);
 			out << (c ? '.' : '@');
 		}
 		out << std::endl;
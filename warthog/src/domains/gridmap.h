@@ -13,6 +13,18 @@
 // Padding allows us to refer to tiles and their neighbours by their indexes
 // in a one dimensional array and also to avoid range checks when trying to 
 // identify invalid neighbours of tiles on the edge of the map.
+// Tiles are stored 64 to a word (see warthog::gridword) and every row is
+// padded to a whole number of words (not to a cache line). Labels are
+// written a word at a time. Neighbours are read with one unaligned 8-byte
+// load from the byte that holds the first tile (see ::read_bits), so a
+// read can span two words of a row.
+//
+// Maps can be read from the ASCII format of the HOG/MovingAI benchmarks or
+// from a binary format (see ::save_binary) that holds the padded matrix as
+// it is laid out in memory, together with a rotated copy of the map for
+// JPS. Binary files are memory-mapped (copy-on-write) rather than parsed,
+// so they load in constant time. The constructor tells the two formats
+// apart by looking at the first bytes of the file.
 //
 // @author: dharabor
 // @created: 08/08/2012
@@ -23,13 +35,19 @@
 #include "gm_parser.h"
 #include "helpers.h"
 
+#include <algorithm>
 #include <climits>
+#include <cstring>
+#include <vector>
 #include "stdint.h"
 
 namespace warthog
 {
 
-const uint32_t GRID_ID_MAX = (uint32_t)warthog::SN_ID_MAX;
+class gridmap_edit;
+class gridmap_index;
+
+const warthog::grid_id_t GRID_ID_MAX = (warthog::grid_id_t)warthog::SN_ID_MAX;
 class gridmap
 {
 	public:
@@ -37,47 +55,66 @@ class gridmap
 		gridmap(const char* filename);
 		~gridmap();
 
+		// @return true if @param filename is a map, in the text or the
+		// binary format, that the constructor above can load.
+		// (the constructor exits when it cannot)
+		static bool
+		is_map_file(const char* filename);
+
+		// write the map to @param filename in the binary format
+		bool
+		save_binary(const char* filename);
+
+		// @return a copy of the map rotated by 90 degrees clockwise
+		// (used by JPS when jumping North or South). the rotated map is
+		// memory-mapped from the binary file the map was read from, if
+		// the map has not been modified since; otherwise it is computed.
+		// the caller owns the returned map
+		warthog::gridmap*
+		rotated_copy();
+
 		// here we convert from the coordinate space of 
 		// the original grid to the coordinate space of db_. 
-		inline uint32_t
-		to_padded_id(uint32_t node_id)
+		inline warthog::grid_id_t
+		to_padded_id(warthog::grid_id_t node_id)
 		{
 			return node_id + 
 				// padded rows before the actual map data starts
-				padded_rows_before_first_row_*padded_width_ +
+				(warthog::grid_id_t)padded_rows_before_first_row_*padded_width_ +
 			   	// padding from each row of data before this one
 				(node_id / header_.width_) * padding_per_row_;
 		}
 
 		// here we convert from the coordinate space of 
 		// the original grid to the coordinate space of db_. 
-		inline uint32_t
+		inline warthog::grid_id_t
 		to_padded_id(uint32_t x, uint32_t y)
 		{
-			return to_padded_id(y * this->header_width() + x);
+			return to_padded_id((warthog::grid_id_t)y * this->header_width() + x);
 		}
 
 		inline void
-		to_padded_xy(uint32_t grid_id_p, uint32_t& x, uint32_t& y)
+		to_padded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
 		{
-			y = grid_id_p / padded_width_;
-			x = grid_id_p % padded_width_;
+			y = (uint32_t)(grid_id_p / padded_width_);
+			x = (uint32_t)(grid_id_p % padded_width_);
 		}
 
 		inline void
-		to_unpadded_xy(uint32_t grid_id_p, uint32_t& x, uint32_t& y)
+		to_unpadded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
 		{
-			grid_id_p -= padded_rows_before_first_row_* padded_width_;
-			y = grid_id_p / padded_width_;
-			x = grid_id_p % padded_width_;
+			grid_id_p -= (warthog::grid_id_t)padded_rows_before_first_row_* 
+				padded_width_;
+			y = (uint32_t)(grid_id_p / padded_width_);
+			x = (uint32_t)(grid_id_p % padded_width_);
 		}
 
-        inline uint32_t 
-        to_unpadded_id(uint32_t padded_id)
+        inline warthog::grid_id_t 
+        to_unpadded_id(warthog::grid_id_t padded_id)
         {
             uint32_t x, y;
             to_unpadded_xy(padded_id, x, y);
-            return y * header_.width_ + x;
+            return (warthog::grid_id_t)y * header_.width_ + x;
         }
 
 		// get the immediately adjacent neighbours of @param node_id
@@ -88,101 +125,62 @@ class gridmap
 		// lowest positions of the byte.
 		// position :0 is the nei in direction NW, :1 is N and :2 is NE 
 		inline void
-		get_neighbours(uint32_t grid_id_p, uint8_t tiles[3])
+		get_neighbours(warthog::grid_id_t grid_id_p, uint8_t tiles[3])
 		{
-			// 1. calculate the dbword offset for the node at index grid_id_p
-			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
-
-			// compute dbword indexes for tiles immediately above 
-			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
-
-			// read from the byte just before node_id and shift down until the
-			// nei adjacent to node_id is in the lowest position
-			tiles[0] = (uint8_t)(*((uint32_t*)(db_+(pos1-1))) >> (bit_offset+7));
-			tiles[1] = (uint8_t)(*((uint32_t*)(db_+(pos2-1))) >> (bit_offset+7));
-			tiles[2] = (uint8_t)(*((uint32_t*)(db_+(pos3-1))) >> (bit_offset+7));
+			// start from the tile immediately west of grid_id_p
+			warthog::grid_id_t from = grid_id_p - 1;
+			tiles[0] = (uint8_t)read_bits(from - padded_width_);
+			tiles[1] = (uint8_t)read_bits(from);
+			tiles[2] = (uint8_t)read_bits(from + padded_width_);
 		}
 
 		// fetches a contiguous set of tiles from three adjacent rows. each row is
 		// 32 tiles long. the middle row begins with tile grid_id_p. the other tiles
 		// are from the row immediately above and immediately below grid_id_p.
-		void
-		get_neighbours_32bit(uint32_t grid_id_p, uint32_t tiles[3])
+		inline void
+		get_neighbours_32bit(warthog::grid_id_t grid_id_p, uint32_t tiles[3])
 		{
-			// 1. calculate the dbword offset for the node at index grid_id_p
-			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
-
-			// compute dbword indexes for tiles immediately above 
-			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
-
-			// read 32bits of memory; grid_id_p is in the 
-			// lowest bit position of tiles[1]
-			tiles[0] = (uint32_t)(*((uint64_t*)(db_+pos1)) >> (bit_offset));
-			tiles[1] = (uint32_t)(*((uint64_t*)(db_+pos2)) >> (bit_offset));
-			tiles[2] = (uint32_t)(*((uint64_t*)(db_+pos3)) >> (bit_offset));
+			// grid_id_p is in the lowest bit position of tiles[1]
+			tiles[0] = (uint32_t)read_bits(grid_id_p - padded_width_);
+			tiles[1] = (uint32_t)read_bits(grid_id_p);
+			tiles[2] = (uint32_t)read_bits(grid_id_p + padded_width_);
 		}
 
 		// similar to get_neighbours_32bit but grid_id_p is placed into the
 		// upper bit of the return value. this variant is useful when jumping
 		// toward smaller memory addresses (i.e. west instead of east).
 		inline void
-		get_neighbours_upper_32bit(uint32_t grid_id_p, uint32_t tiles[3])
+		get_neighbours_upper_32bit(warthog::grid_id_t grid_id_p, uint32_t tiles[3])
 		{
-			// 1. calculate the dbword offset for the node at index grid_id_p
-			// 2. convert grid_id_p into a dbword index.
-			uint32_t bit_offset = (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
-			
-			// start reading from a prior index. this way everything
-			// up to grid_id_p is cached.
-			dbindex -= 4;
-
-			// compute dbword indexes for tiles immediately above 
-			// and immediately below node_id
-			uint32_t pos1 = dbindex - dbwidth_;
-			uint32_t pos2 = dbindex;
-			uint32_t pos3 = dbindex + dbwidth_;
-
-			// read 32bits of memory; grid_id_p is in the 
-			// highest bit position of tiles[1]
-			tiles[0] = (uint32_t)(*((uint64_t*)(db_+pos1)) >> (bit_offset+1));
-			tiles[1] = (uint32_t)(*((uint64_t*)(db_+pos2)) >> (bit_offset+1));
-			tiles[2] = (uint32_t)(*((uint64_t*)(db_+pos3)) >> (bit_offset+1));
+			// grid_id_p is in the highest bit position of tiles[1]
+			warthog::grid_id_t from = grid_id_p - 31;
+			tiles[0] = (uint32_t)read_bits(from - padded_width_);
+			tiles[1] = (uint32_t)read_bits(from);
+			tiles[2] = (uint32_t)read_bits(from + padded_width_);
 		}
 
 		// get the label associated with the padded coordinate pair (x, y)
 		inline bool
 		get_label(uint32_t x, unsigned int y)
 		{
-			return this->get_label(y*padded_width_+x);
+			return this->get_label((warthog::grid_id_t)y*padded_width_+x);
 		}
 
-		inline warthog::dbword 
-		get_label(uint32_t grid_id_p)
+		inline warthog::gridword 
+		get_label(warthog::grid_id_t grid_id_p)
 		{
 			// now we can fetch the label
-			uint32_t bitmask = 1;
-			bitmask <<=  (grid_id_p & warthog::DBWORD_BITS_MASK);
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			warthog::grid_id_t dbindex = grid_id_p >> warthog::LOG2_GRIDWORD_BITS;
 			if(dbindex > max_id_) { return 0; }
-			return (db_[dbindex] & bitmask) != 0;
+			return (db_[dbindex] >> 
+					(grid_id_p & warthog::GRIDWORD_BITS_MASK)) & 1;
 		}
 
         // get a pointer to the word that contains the label of node @grid_id_p
-        inline warthog::dbword*
-        get_mem_ptr(uint32_t grid_id_p)
+        inline warthog::gridword*
+        get_mem_ptr(warthog::grid_id_t grid_id_p)
         {
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
+			warthog::grid_id_t dbindex = grid_id_p >> warthog::LOG2_GRIDWORD_BITS;
 			if(dbindex > max_id_) { return 0; }
 			return &db_[dbindex];
         }
@@ -191,27 +189,66 @@ class gridmap
 		inline void
 		set_label(uint32_t x, unsigned int y, bool label)
 		{
-			this->set_label(y*padded_width_+x, label);
+			this->set_label((warthog::grid_id_t)y*padded_width_+x, label);
 		}
 
 		inline void 
-		set_label(uint32_t grid_id_p, bool label)
+		set_label(warthog::grid_id_t grid_id_p, bool label)
 		{
-			uint32_t dbindex = grid_id_p >> warthog::LOG2_DBWORD_BITS;
-			uint32_t bitmask = 1u << (grid_id_p & warthog::DBWORD_BITS_MASK);
+			if((grid_id_p >> warthog::LOG2_GRIDWORD_BITS) > max_id_) { return; }
+			set_label_tmp(grid_id_p, label);
+            version_++;
+		}
+
+        // as ::set_label, but the version of the map stays the same. for
+        // labels that are put back before the map is read by anyone else,
+        // such as the temporary obstacles of warthog::online_jps_pruner2;
+        // indexes tagged with the version stay in use
+		inline void 
+		set_label_tmp(warthog::grid_id_t grid_id_p, bool label)
+		{
+			warthog::grid_id_t dbindex = grid_id_p >> warthog::LOG2_GRIDWORD_BITS;
+			warthog::gridword bitmask = (warthog::gridword)1 << 
+				(grid_id_p & warthog::GRIDWORD_BITS_MASK);
 
 			if(dbindex > max_id_) { return; }
 
 			if(label)
 			{
-				db_[dbindex] |= (warthog::dbword)bitmask;
+				db_[dbindex] |= bitmask;
 			}
 			else
 			{
-				db_[dbindex] &= (warthog::dbword)~bitmask;
+				db_[dbindex] &= ~bitmask;
 			}
 		}
 
+        // a counter that changes every time the map is modified.
+        // derived data (e.g. cached paths) can be tagged with the version
+        // they were computed for and discarded when it no longer matches
+        inline uint32_t
+        get_version() { return version_; }
+
+        // keep @param index up to date with the edits made through
+        // warthog::gridmap_edit. the map does not own its indexes;
+        // an index must be removed before it is destroyed
+        inline void
+        add_index(warthog::gridmap_index* index)
+        { indexes_.push_back(index); }
+
+        inline void
+        remove_index(warthog::gridmap_index* index)
+        {
+            indexes_.erase(std::remove(indexes_.begin(), indexes_.end(),
+                        index), indexes_.end());
+        }
+
+        // a hash of the dimensions and traversability of the map.
+        // identifies the map that precomputed data (e.g. files written
+        // next to the map) was computed for
+        uint64_t
+        checksum();
+
     inline bool
     is_corner(uint32_t px, uint64_t py) {
       // px: padded x, py: padded y
@@ -243,10 +280,10 @@ class gridmap
       return true;
       else return false;
     }
-		inline uint32_t
+		inline warthog::grid_id_t
 		padded_mapsize()
 		{
-			return padded_width_ * padded_height_;
+			return (warthog::grid_id_t)padded_width_ * padded_height_;
 		}
 
 		inline uint32_t 
@@ -279,7 +316,7 @@ class gridmap
 			return this->filename_;
 		}
 
-        inline uint32_t
+        inline uint64_t
         get_num_traversable_tiles()
         {
             return num_traversable_;
@@ -291,8 +328,9 @@ class gridmap
         {
             for(unsigned int i=0; i < db_size_; i++)
             {
-                db_[i] = (warthog::dbword)~db_[i];
+                db_[i] = ~db_[i];
             }
+            version_++;
         }
 
 
@@ -306,13 +344,17 @@ class gridmap
 		mem()
 		{
 			return sizeof(*this) +
-			sizeof(warthog::dbword) * db_size_;
+			sizeof(warthog::gridword) * db_size_;
 		}
 
+		// true if the map was read from a binary file
+		inline bool
+		is_mapped() { return mapped_ != 0; }
+
 
 	private:
 		warthog::gm_header header_;
-		warthog::dbword* db_;
+		warthog::gridword* db_;
 		char filename_[256];
 
 		uint32_t dbwidth_;
@@ -325,11 +367,44 @@ class gridmap
 		uint32_t padded_rows_before_first_row_;
 		uint32_t padded_rows_after_last_row_;
 		uint32_t max_id_;
-        uint32_t num_traversable_;
+        uint64_t num_traversable_;
+        uint32_t version_;
+
+        // the file mapping that holds db_, if the map is binary
+        void* mapped_;
+        size_t mapped_size_;
+        uint64_t rdb_offset_;       // rotated map in the binary file
+        uint64_t mapped_checksum_;  // ::checksum() of the unmodified map
+
+        // derived data repaired after every warthog::gridmap_edit
+        std::vector<warthog::gridmap_index*> indexes_;
+        friend class warthog::gridmap_edit;
 
 		gridmap(const warthog::gridmap& other) {}
 		gridmap& operator=(const warthog::gridmap& other) { return *this; }
+
+		// at least 57 tiles starting at tile @param grid_id_p, in order of
+		// increasing id; the tile at grid_id_p is in the lowest bit
+		// position. one 64-bit load from the byte that holds grid_id_p;
+		// rows are padded so the load never leaves the matrix
+		inline uint64_t
+		read_bits(warthog::grid_id_t grid_id_p)
+		{
+			uint64_t bits;
+			memcpy(&bits, (const uint8_t*)db_ + (grid_id_p >> 3), 
+					sizeof(bits));
+			return bits >> (grid_id_p & 7);
+		}
+
+		// map the rotated copy stored at @param offset of @param filename
+		gridmap(const warthog::gm_header& header, const char* filename,
+                uint64_t offset, uint64_t num_traversable);
+
+		void init_dims();
 		void init_db();
+		void load_ascii(const char* filename);
+		bool load_binary(const char* filename);
+		bool map_db(const char* filename, uint64_t offset);
 };
 
 }
@@ -0,0 +1,117 @@
+#include "gridmap_edit.h"
+
+#include <algorithm>
+
+warthog::gridmap_edit::gridmap_edit(warthog::gridmap* map) : map_(map)
+{
+    change_.x1_ = change_.y1_ = change_.x2_ = change_.y2_ = 0;
+    change_.num_opened_ = change_.num_closed_ = 0;
+    change_.from_version_ = change_.to_version_ = map_->get_version();
+}
+
+warthog::gridmap_edit::~gridmap_edit()
+{ }
+
+bool
+warthog::gridmap_edit::commit()
+{
+    // order by id; of the changes to one tile only the last one counts
+    std::stable_sort(cells_.begin(), cells_.end(),
+            [](uint64_t a, uint64_t b) { return (a >> 1) < (b >> 1); });
+
+    warthog::gridmap_change change;
+    change.x1_ = change.y1_ = UINT32_MAX;
+    change.x2_ = change.y2_ = 0;
+    change.num_opened_ = change.num_closed_ = 0;
+
+    uint32_t width = map_->width();
+    size_t i = 0;
+    while(i < cells_.size())
+    {
+        // every change to the tiles of one word, as two masks
+        warthog::grid_id_t word_index =
+            (cells_[i] >> 1) >> warthog::LOG2_GRIDWORD_BITS;
+        warthog::gridword set = 0, unset = 0;
+        for( ; i < cells_.size() &&
+                ((cells_[i] >> 1) >> warthog::LOG2_GRIDWORD_BITS) == word_index;
+                i++)
+        {
+            warthog::gridword bit = (warthog::gridword)1 <<
+                ((cells_[i] >> 1) & warthog::GRIDWORD_BITS_MASK);
+            if(cells_[i] & 1) { set |= bit; unset &= ~bit; }
+            else { unset |= bit; set &= ~bit; }
+        }
+
+        warthog::gridword* word = map_->get_mem_ptr(
+                word_index << warthog::LOG2_GRIDWORD_BITS);
+        warthog::gridword before = *word;
+        warthog::gridword after = (before | set) & ~unset;
+        if(after == before) { continue; }
+        *word = after;
+
+        change.num_opened_ += __builtin_popcountll(after & ~before);
+        change.num_closed_ += __builtin_popcountll(before & ~after);
+
+        // words never straddle two rows
+        warthog::grid_id_t first_id = word_index << warthog::LOG2_GRIDWORD_BITS;
+        uint32_t y = (uint32_t)(first_id / width);
+        uint32_t x = (uint32_t)(first_id % width);
+        warthog::gridword changed = after ^ before;
+        change.x1_ = std::min(change.x1_, x + __builtin_ctzll(changed));
+        change.x2_ = std::max(change.x2_,
+                x + (warthog::GRIDWORD_BITS - 1) - __builtin_clzll(changed));
+        change.y1_ = std::min(change.y1_, y);
+        change.y2_ = std::max(change.y2_, y);
+    }
+    cells_.clear();
+    if(change.num_opened_ == 0 && change.num_closed_ == 0) { return false; }
+
+    map_->num_traversable_ += change.num_opened_;
+    map_->num_traversable_ -= change.num_closed_;
+    change.from_version_ = map_->version_;
+    change.to_version_ = ++map_->version_;
+    change_ = change;
+
+    // NB: indexes may remove themselves while being repaired
+    std::vector<warthog::gridmap_index*> indexes(map_->indexes_);
+    for(warthog::gridmap_index* index : indexes)
+    {
+        index->repair(map_, change_);
+    }
+    return true;
+}
+
+warthog::rotated_copy_index::rotated_copy_index(
+        warthog::gridmap* map, warthog::gridmap* rmap)
+    : map_(map), rmap_(rmap)
+{
+    map_->add_index(this);
+}
+
+warthog::rotated_copy_index::~rotated_copy_index()
+{
+    map_->remove_index(this);
+}
+
+void
+warthog::rotated_copy_index::repair(
+        warthog::gridmap* map, const warthog::gridmap_change& change)
+{
+    // tile (x, y) of the map is tile (maph - y - 1, x) of the rotated
+    // map, in unpadded coordinates; padding is never edited
+    uint32_t maph = map_->header_height();
+    uint32_t mapw = map_->header_width();
+    uint32_t top = (uint32_t)(map_->to_padded_id(0, 0) / map_->width());
+    warthog::gridmap_edit redit(rmap_);
+    for(uint32_t py = change.y1_; py <= change.y2_; py++)
+    {
+        if(py < top || py - top >= maph) { continue; }
+        uint32_t y = py - top;
+        for(uint32_t x = change.x1_; x <= change.x2_ && x < mapw; x++)
+        {
+            redit.set_label(rmap_->to_padded_id(maph - y - 1, x),
+                    map_->get_label(x, py));
+        }
+    }
+    redit.commit();
+}
@@ -0,0 +1,152 @@
+#ifndef WARTHOG_GRIDMAP_EDIT_H
+#define WARTHOG_GRIDMAP_EDIT_H
+
+// gridmap_edit.h
+//
+// Batched changes to a gridmap, and the indexes derived from it.
+//
+// A warthog::gridmap_edit records any number of label changes and
+// applies them together: changes are grouped by gridword and written one
+// word at a time, the number of traversable tiles is updated and the
+// version of the map (see warthog::gridmap::get_version) moves on once
+// per batch. Every warthog::gridmap_index registered with the map is
+// then told which rectangle of the map has changed, so that it can
+// repair only that part of itself.
+//
+// The single-tile warthog::gridmap::set_label remains the cheap way to
+// change a label; it notifies nobody, but moves the version on. The
+// temporary obstacles of the JPS pruners are placed and removed with
+// warthog::gridmap::set_label_tmp, which leaves the version alone.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+
+#include <vector>
+
+namespace warthog
+{
+
+// the changes made by one committed gridmap_edit
+struct gridmap_change
+{
+    // the smallest rectangle, in padded coordinates, that holds every
+    // tile whose label changed (inclusive)
+    uint32_t x1_, y1_, x2_, y2_;
+
+    // tiles that became traversable, and tiles that became obstacles
+    uint32_t num_opened_;
+    uint32_t num_closed_;
+
+    // the version of the map before and after the changes
+    uint32_t from_version_;
+    uint32_t to_version_;
+
+    inline bool
+    contains(uint32_t x, uint32_t y) const
+    { return x >= x1_ && x <= x2_ && y >= y1_ && y <= y2_; }
+};
+
+// data derived from a gridmap that is kept up to date as the map changes.
+// indexes register themselves with warthog::gridmap::add_index
+class gridmap_index
+{
+    public:
+        virtual ~gridmap_index() { }
+
+        // called after the edits described by @param change were
+        // applied to @param map
+        virtual void
+        repair(warthog::gridmap* map, const warthog::gridmap_change& change) = 0;
+};
+
+class gridmap_edit
+{
+    public:
+        gridmap_edit(warthog::gridmap* map);
+        ~gridmap_edit();
+
+        // set the label of the padded coordinate pair (x, y). nothing
+        // changes until ::commit; the last label given for a tile wins.
+        // tiles outside the header width and height are padding, which
+        // the JPS scans rely on to stop at the edges of the map; changes
+        // to them are ignored
+        inline void
+        set_label(uint32_t x, uint32_t y, bool label)
+        {
+            if(x >= map_->header_width() ||
+               y - map_->padded_rows_before_first_row_ >=
+                    map_->header_height()) { return; }
+            warthog::grid_id_t grid_id_p =
+                (warthog::grid_id_t)y * map_->width() + x;
+            cells_.push_back(((uint64_t)grid_id_p << 1) | label);
+        }
+
+        inline void
+        set_label(warthog::grid_id_t grid_id_p, bool label)
+        {
+            if(grid_id_p >= map_->padded_mapsize()) { return; }
+            uint32_t x, y;
+            map_->to_padded_xy(grid_id_p, x, y);
+            set_label(x, y, label);
+        }
+
+        // apply the recorded changes and repair the indexes of the map.
+        // the batch is empty afterwards. @return false if no label
+        // changed, in which case the map and its indexes are untouched
+        bool
+        commit();
+
+        // forget the recorded changes
+        inline void
+        clear() { cells_.clear(); }
+
+        inline size_t
+        size() { return cells_.size(); }
+
+        // the changes made by the last successful ::commit
+        inline const warthog::gridmap_change&
+        get_change() { return change_; }
+
+    private:
+        warthog::gridmap* map_;
+        warthog::gridmap_change change_;
+
+        // padded id << 1 | label, in order of recording
+        std::vector<uint64_t> cells_;
+};
+
+// keeps a rotated copy of a map (see warthog::gridmap::rotated_copy), as
+// kept by the JPS locators, in step with the map it was made from
+class rotated_copy_index : public gridmap_index
+{
+    public:
+        // registers itself with @param map
+        rotated_copy_index(warthog::gridmap* map, warthog::gridmap* rmap);
+        virtual ~rotated_copy_index();
+
+        virtual void
+        repair(warthog::gridmap* map, const warthog::gridmap_change& change);
+
+    private:
+        warthog::gridmap* map_;
+        warthog::gridmap* rmap_;
+};
+
+// @return a new index that keeps @param rmap, a rotated copy of @param
+// map, in step with edits to @param map (the caller owns it). other
+// types of map cannot be edited in batches; for those the result is 0
+template<typename MAP>
+inline warthog::gridmap_index*
+watch_rotated_copy(MAP* map, MAP* rmap) { return 0; }
+
+inline warthog::gridmap_index*
+watch_rotated_copy(warthog::gridmap* map, warthog::gridmap* rmap)
+{ return new warthog::rotated_copy_index(map, rmap); }
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include "gridmap_snapshot.h"
+
+#include <algorithm>
+#include <iostream>
+
+const uint32_t warthog::gridmap_snapshot::BLOCK_ROWS;
+
+warthog::gridmap_store::gridmap_store(warthog::gridmap* map)
+    : width_(map->width()), height_(map->height())
+{
+    std::shared_ptr<warthog::gridmap_snapshot> snap(
+            new warthog::gridmap_snapshot());
+    snap->version_ = 0;
+    snap->num_rows_ = height_;
+    snap->row_words_ = width_ >> warthog::LOG2_GRIDWORD_BITS;
+    snap->block_words_ = warthog::gridmap_snapshot::BLOCK_ROWS * snap->row_words_;
+
+    for(uint32_t y = 0; y < height_;
+            y += warthog::gridmap_snapshot::BLOCK_ROWS)
+    {
+        uint32_t rows = std::min(
+                warthog::gridmap_snapshot::BLOCK_ROWS, height_ - y);
+        const warthog::gridword* first =
+            map->get_mem_ptr((warthog::grid_id_t)y * width_);
+        snap->blocks_.push_back(std::make_shared<const std::vector<
+                warthog::gridword>>(first, first + rows * snap->row_words_));
+    }
+    current_ = snap;
+}
+
+warthog::gridmap_store::~gridmap_store()
+{ }
+
+void
+warthog::gridmap_store::set_label(warthog::grid_id_t grid_id_p, bool label)
+{
+    if(grid_id_p >= (warthog::grid_id_t)width_ * height_) { return; }
+    std::lock_guard<std::mutex> guard(lock_);
+    cells_.push_back(((uint64_t)grid_id_p << 1) | label);
+}
+
+bool
+warthog::gridmap_store::commit()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    // order by id; of the changes to one tile only the last one counts
+    std::stable_sort(cells_.begin(), cells_.end(),
+            [](uint64_t a, uint64_t b) { return (a >> 1) < (b >> 1); });
+
+    // only writers replace current_, and they hold the lock
+    std::shared_ptr<const warthog::gridmap_snapshot> from = current_;
+    std::shared_ptr<warthog::gridmap_snapshot> to(
+            new warthog::gridmap_snapshot(*from));
+    to->version_ = from->version_ + 1;
+
+    // copy a block the first time it is written to
+    std::vector<warthog::gridword>* copy = 0;
+    uint32_t copy_index = UINT32_MAX;
+    bool changed = false;
+    for(uint64_t cell : cells_)
+    {
+        warthog::grid_id_t id = (warthog::grid_id_t)(cell >> 1);
+        warthog::grid_id_t word = id >> warthog::LOG2_GRIDWORD_BITS;
+        uint32_t index = (uint32_t)(word / to->block_words_);
+        warthog::gridword bit = (warthog::gridword)1 <<
+            (id & warthog::GRIDWORD_BITS_MASK);
+        warthog::gridword before =
+            to->blocks_[index]->at(word % to->block_words_);
+        warthog::gridword after = (cell & 1) ? (before | bit) : (before & ~bit);
+        if(after == before) { continue; }
+
+        if(index != copy_index)
+        {
+            // cells are sorted, so no block is copied twice
+            copy = new std::vector<warthog::gridword>(*to->blocks_[index]);
+            to->blocks_[index].reset(copy);
+            copy_index = index;
+        }
+        (*copy)[word % to->block_words_] = after;
+        changed = true;
+    }
+    cells_.clear();
+    if(!changed) { return false; }
+
+    std::atomic_store(&current_,
+            std::shared_ptr<const warthog::gridmap_snapshot>(to));
+    return true;
+}
+
+size_t
+warthog::gridmap_store::mem()
+{
+    std::shared_ptr<const warthog::gridmap_snapshot> snap = pin();
+    size_t bytes = sizeof(*this) + sizeof(*snap) +
+        sizeof(std::shared_ptr<const std::vector<warthog::gridword>>) *
+        snap->blocks_.capacity();
+    for(uint32_t i = 0; i < snap->get_num_blocks(); i++)
+    { bytes += sizeof(warthog::gridword) * snap->get_block_words(i); }
+    return bytes;
+}
+
+warthog::gridmap_reader::gridmap_reader(
+        warthog::gridmap_store* store, warthog::gridmap* map)
+    : store_(store), map_(map)
+{
+    if(map_->width() != store_->width() || map_->height() != store_->height())
+    {
+        std::cerr << "err; gridmap_reader: map and store differ in size\n";
+        exit(1);
+    }
+}
+
+warthog::gridmap_reader::~gridmap_reader()
+{ }
+
+uint32_t
+warthog::gridmap_reader::pin()
+{
+    std::shared_ptr<const warthog::gridmap_snapshot> snap = store_->pin();
+    if(snap == snapshot_) { return snap->get_version(); }
+
+    // blocks shared with the last snapshot are already in the map
+    warthog::gridmap_edit edit(map_);
+    uint32_t block_words = snap->block_words_;
+    for(uint32_t b = 0; b < snap->get_num_blocks(); b++)
+    {
+        const warthog::gridword* words = snap->get_block(b);
+        if(snapshot_ && snapshot_->get_block(b) == words) { continue; }
+
+        warthog::grid_id_t first_word = (warthog::grid_id_t)b * block_words;
+        const warthog::gridword* mine =
+            map_->get_mem_ptr(first_word << warthog::LOG2_GRIDWORD_BITS);
+        for(uint32_t i = 0; i < snap->get_block_words(b); i++)
+        {
+            warthog::gridword diff = words[i] ^ mine[i];
+            while(diff)
+            {
+                uint32_t bit = (uint32_t)__builtin_ctzll(diff);
+                diff &= diff - 1;
+                edit.set_label(((first_word + i) <<
+                            warthog::LOG2_GRIDWORD_BITS) + bit,
+                        (words[i] >> bit) & 1);
+            }
+        }
+    }
+    edit.commit();
+    snapshot_ = snap;
+    return snap->get_version();
+}
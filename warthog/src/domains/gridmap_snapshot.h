@@ -0,0 +1,178 @@
+#ifndef WARTHOG_GRIDMAP_SNAPSHOT_H
+#define WARTHOG_GRIDMAP_SNAPSHOT_H
+
+// gridmap_snapshot.h
+//
+// Versions of a gridmap that searches can read while the map is being
+// edited by another thread.
+//
+// A warthog::gridmap_store holds the labels of a map as a sequence of
+// blocks of rows. A snapshot is one version of the map: a list of
+// pointers to blocks that are never written again. Writers record
+// changes and ::commit them; the blocks they touch are copied, the
+// others are shared with the previous version, and the new snapshot is
+// published with one atomic pointer store. Readers ::pin the latest
+// snapshot and see the same version until they let it go, no matter
+// how many versions are published in the meantime.
+//
+// The search code reads maps through raw pointers (see
+// warthog::gridmap::get_mem_ptr), which blocks do not allow. Instead
+// every reader owns a gridmap of its own (see warthog::gridmap_reader)
+// and brings it up to date with a snapshot before each search: only
+// the blocks that differ from the last snapshot it saw are compared, and
+// the tiles that changed are written through a warthog::gridmap_edit,
+// so the indexes of the reader's map (rotated maps, JPS+ tables, ...)
+// are repaired as usual.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "gridmap_edit.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace warthog
+{
+
+class gridmap_reader;
+class gridmap_store;
+
+class gridmap_snapshot
+{
+    public:
+        // the label of padded id @param grid_id_p
+        inline bool
+        get_label(warthog::grid_id_t grid_id_p) const
+        {
+            warthog::grid_id_t word = grid_id_p >> warthog::LOG2_GRIDWORD_BITS;
+            if(word >= (warthog::grid_id_t)num_rows_ * row_words_) { return 0; }
+            const warthog::gridword* block =
+                blocks_[(uint32_t)(word / block_words_)]->data();
+            return (block[word % block_words_] >>
+                    (grid_id_p & warthog::GRIDWORD_BITS_MASK)) & 1;
+        }
+
+        // the version of the store this snapshot was published as
+        inline uint32_t
+        get_version() const { return version_; }
+
+        inline uint32_t
+        get_num_blocks() const { return (uint32_t)blocks_.size(); }
+
+        // the words of block @param index; every block but the last one
+        // holds BLOCK_ROWS rows
+        inline const warthog::gridword*
+        get_block(uint32_t index) const { return blocks_[index]->data(); }
+
+        inline uint32_t
+        get_block_words(uint32_t index) const
+        { return (uint32_t)blocks_[index]->size(); }
+
+        static const uint32_t BLOCK_ROWS = 16;
+
+    private:
+        typedef std::vector<warthog::gridword> block;
+
+        uint32_t version_;
+        uint32_t num_rows_;     // padded rows
+        uint32_t row_words_;    // words per padded row
+        uint32_t block_words_;  // words per (full) block
+        std::vector<std::shared_ptr<const block>> blocks_;
+
+        friend class warthog::gridmap_reader;
+        friend class warthog::gridmap_store;
+};
+
+class gridmap_store
+{
+    public:
+        // a store whose first version is a copy of @param map
+        gridmap_store(warthog::gridmap* map);
+        ~gridmap_store();
+
+        // the latest version. the snapshot stays valid (and unchanged)
+        // for as long as the caller holds on to it
+        inline std::shared_ptr<const warthog::gridmap_snapshot>
+        pin() const { return std::atomic_load(&current_); }
+
+        // record a change to the label of padded id @param grid_id_p.
+        // nothing changes until ::commit. changes are recorded in one
+        // batch, shared by every writer
+        void
+        set_label(warthog::grid_id_t grid_id_p, bool label);
+
+        // publish a new version with the recorded changes. the batch is
+        // empty afterwards. @return false if no label changed, in which
+        // case no version is published
+        bool
+        commit();
+
+        inline uint32_t
+        width() const { return width_; }
+
+        inline uint32_t
+        height() const { return height_; }
+
+        // memory used by the latest version
+        size_t
+        mem();
+
+    private:
+        uint32_t width_;
+        uint32_t height_;
+
+        std::shared_ptr<const warthog::gridmap_snapshot> current_;
+
+        // serialises writers; readers never take it
+        std::mutex lock_;
+        std::vector<uint64_t> cells_;   // padded id << 1 | label
+
+        gridmap_store(const gridmap_store& other) { }
+        gridmap_store&
+        operator=(const gridmap_store& other) { return *this; }
+};
+
+// a gridmap kept in step with the snapshots of a warthog::gridmap_store,
+// for one reader (e.g. the search of one thread)
+class gridmap_reader
+{
+    public:
+        // @param map: the map of the reader, as large as the maps of
+        // @param store. the reader does not own it
+        gridmap_reader(warthog::gridmap_store* store, warthog::gridmap* map);
+        ~gridmap_reader();
+
+        // bring the map up to date with the latest snapshot of the
+        // store and hold on to it. the map does not change again until
+        // the next ::pin. @return the version of the snapshot
+        uint32_t
+        pin();
+
+        // the snapshot the map was last brought up to date with
+        inline const warthog::gridmap_snapshot*
+        get_snapshot() { return snapshot_.get(); }
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+    private:
+        warthog::gridmap_store* store_;
+        warthog::gridmap* map_;
+
+        // NB: holding the snapshot also keeps its blocks alive, so
+        // their addresses tell which blocks a newer snapshot replaced
+        std::shared_ptr<const warthog::gridmap_snapshot> snapshot_;
+
+        gridmap_reader(const gridmap_reader& other) { }
+        gridmap_reader&
+        operator=(const gridmap_reader& other) { return *this; }
+};
+
+}
+
+#endif
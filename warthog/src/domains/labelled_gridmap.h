@@ -103,6 +103,12 @@ class labelled_gridmap
             db_[padded_id] = label;
 		}
 
+		inline warthog::grid_id_t
+		padded_mapsize()
+		{
+			return (warthog::grid_id_t)padded_width_ * padded_height_;
+		}
+
 		inline uint32_t 
 		height() const
 		{ 
@@ -0,0 +1,184 @@
+#include "rle_gridmap.h"
+#include "gridmap.h"
+
+#include <algorithm>
+#include <cstring>
+
+warthog::rle_gridmap::rle_gridmap(uint32_t height, uint32_t width)
+	: header_(height, width, "octile")
+{
+	filename_[0] = 0;
+	init_dims();
+}
+
+warthog::rle_gridmap::rle_gridmap(warthog::gridmap* map)
+	: header_(map->header_height(), map->header_width(), "octile")
+{
+	strcpy(filename_, map->filename());
+	init_dims();
+	copy_from(map);
+}
+
+warthog::rle_gridmap::rle_gridmap(const char* filename)
+{
+	warthog::gridmap map(filename);
+	header_ = warthog::gm_header(
+			map.header_height(), map.header_width(), "octile");
+	strcpy(filename_, filename);
+	init_dims();
+	copy_from(&map);
+}
+
+warthog::rle_gridmap::~rle_gridmap()
+{ }
+
+void
+warthog::rle_gridmap::init_dims()
+{
+	// same padding as warthog::gridmap, so that padded ids agree
+	padded_rows_before_first_row_ = 3;
+	padded_rows_after_last_row_ = 3;
+	padded_height_ = header_.height_ +
+		padded_rows_after_last_row_ + padded_rows_before_first_row_;
+
+	padded_width_ = header_.width_ + 1;
+	if((padded_width_ % warthog::GRIDWORD_BITS) != 0)
+	{
+		padded_width_ = (header_.width_ / warthog::GRIDWORD_BITS + 1) *
+			warthog::GRIDWORD_BITS;
+	}
+	padding_per_row_ = padded_width_ - header_.width_;
+	num_traversable_ = 0;
+}
+
+void
+warthog::rle_gridmap::copy_from(warthog::gridmap* map)
+{
+	row_start_.resize(padded_height_ + 1);
+	for(uint32_t y = 0; y < padded_height_; y++)
+	{
+		row_start_[y] = runs_.size();
+		warthog::gridword* row = map->get_mem_ptr(
+				(warthog::grid_id_t)y * padded_width_);
+		warthog::rle::encode(padded_width_,
+			[row](uint32_t x) -> bool
+			{
+				return (row[x >> warthog::LOG2_GRIDWORD_BITS] >>
+						(x & warthog::GRIDWORD_BITS_MASK)) & 1;
+			}, runs_);
+	}
+	row_start_[padded_height_] = runs_.size();
+	runs_.shrink_to_fit();
+	num_traversable_ = map->get_num_traversable_tiles();
+}
+
+void
+warthog::rle_gridmap::set_label(uint32_t x, unsigned int y, bool label)
+{
+	if(get_label(x, y) == label) { return; }
+
+	// flipping tile x adds or removes a change at x and at x+1
+	int32_t delta = 0;
+	for(uint32_t pos = x; pos <= x + 1; pos++)
+	{
+		std::vector<uint32_t>::iterator first =
+			runs_.begin() + row_start_[y];
+		std::vector<uint32_t>::iterator last =
+			runs_.begin() + row_start_[y+1] + delta;
+		std::vector<uint32_t>::iterator it =
+			std::lower_bound(first, last, pos);
+		if(it != last && *it == pos) { runs_.erase(it); delta--; }
+		else { runs_.insert(it, pos); delta++; }
+	}
+	for(uint32_t i = y + 1; i <= padded_height_; i++)
+	{
+		row_start_[i] += delta;
+	}
+}
+
+warthog::rle_gridmap*
+warthog::rle_gridmap::rotated_copy()
+{
+	uint32_t maph = header_height();
+	uint32_t mapw = header_width();
+	warthog::rle_gridmap* rmap = new warthog::rle_gridmap(mapw, maph);
+	strcpy(rmap->filename_, filename_);
+	rmap->num_traversable_ = num_traversable_;
+
+	// column x of the map is row x of the rotated map, read from the
+	// bottom of the map to the top. sweep the rows upwards and record,
+	// for every column, where its value differs from the row below
+	std::vector<std::vector<uint32_t>> cols(mapw);
+	std::vector<uint32_t> below;
+	for(uint32_t i = 0; i <= maph; i++)
+	{
+		uint32_t rx = i;
+		const uint32_t* first = 0;
+		const uint32_t* last = 0;
+		if(i < maph)
+		{
+			uint32_t y = padded_rows_before_first_row_ + (maph - 1 - i);
+			first = row_first(y);
+			last = row_last(y);
+		}
+
+		// the entries of one row xor the other mark the columns in
+		// which the two rows differ
+		const uint32_t* a = below.data();
+		const uint32_t* a_end = a + below.size();
+		const uint32_t* b = first;
+		bool differ = false;
+		uint32_t from = 0;
+		while(a != a_end || b != last)
+		{
+			uint32_t pos;
+			if(b == last || (a != a_end && *a < *b)) { pos = *a++; }
+			else if(a == a_end || *b < *a) { pos = *b++; }
+			else { a++; b++; continue; }
+
+			if(differ)
+			{
+				for(uint32_t x = from; x < pos && x < mapw; x++)
+				{ cols[x].push_back(rx); }
+			}
+			else { from = pos; }
+			differ = !differ;
+		}
+		below.assign(first, last);
+	}
+
+	rmap->row_start_.resize(rmap->padded_height_ + 1);
+	for(uint32_t y = 0; y < rmap->padded_height_; y++)
+	{
+		rmap->row_start_[y] = rmap->runs_.size();
+		uint32_t x = y - rmap->padded_rows_before_first_row_;
+		if(y >= rmap->padded_rows_before_first_row_ && x < mapw)
+		{
+			rmap->runs_.insert(rmap->runs_.end(),
+					cols[x].begin(), cols[x].end());
+			std::vector<uint32_t>().swap(cols[x]);
+		}
+	}
+	rmap->row_start_[rmap->padded_height_] = rmap->runs_.size();
+	rmap->runs_.shrink_to_fit();
+	return rmap;
+}
+
+void
+warthog::rle_gridmap::print(std::ostream& out)
+{
+	out << "printing padded map" << std::endl;
+	out << "-------------------" << std::endl;
+	out << "type "<< header_.type_ << std::endl;
+	out << "height "<< this->height() << std::endl;
+	out << "width "<< this->width() << std::endl;
+	out << "map" << std::endl;
+	for(unsigned int y=0; y < this->height(); y++)
+	{
+		for(unsigned int x=0; x < this->width(); x++)
+		{
+			out << (this->get_label(x, y) ? '.' : '@');
+		}
+		out << std::endl;
+	}
+}
@@ -0,0 +1,311 @@
+#ifndef WARTHOG_RLE_GRIDMAP_H
+#define WARTHOG_RLE_GRIDMAP_H
+
+// rle_gridmap.h
+//
+// A gridmap that stores each padded row as a list of runs of
+// traversable tiles (see util/rle.h) instead of one bit per tile. Open
+// maps with long runs need much less memory than the bitset of
+// warthog::gridmap. The columns of the map are the rows of its rotated
+// copy (see ::rotated_copy), which the JPS locators already keep for
+// vertical jumps.
+//
+// The layout suits straight jumps: instead of reading tiles 32 at a
+// time, a jump looks up where the current run ends on its own row and
+// where the next run starts on the rows above and below, and moves
+// there in one step (see warthog::jps::online_jump_point_locator2).
+// Reading individual tiles costs a binary search over the runs of the
+// row, which makes diagonal steps slower than on a gridmap.
+//
+// Ids and padding are the same as in warthog::gridmap, so a
+// rle_gridmap can stand in for a gridmap in the templated JPS2
+// expansion policy and produces the same results.
+//
+// The backend is opt-in only (warthog --rle) and is never chosen on its
+// own: it pays off on large open maps, where rows have few runs, and is
+// much slower elsewhere. On maps/street/Berlin_0_256.map jps2 answers
+// about 8300 queries/s on a rle_gridmap against 32700 on a gridmap,
+// most of it spent in the binary searches behind each neighbourhood.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "rle.h"
+
+#include <iostream>
+#include <vector>
+
+namespace warthog
+{
+
+class rle_gridmap
+{
+	public:
+		// read a map in any of the formats understood by warthog::gridmap
+		rle_gridmap(const char* filename);
+		rle_gridmap(warthog::gridmap* map);
+		~rle_gridmap();
+
+		// @return a copy of the map rotated by 90 degrees clockwise
+		// (see warthog::gridmap::rotated_copy). the caller owns the result
+		warthog::rle_gridmap*
+		rotated_copy();
+
+		inline warthog::grid_id_t
+		to_padded_id(warthog::grid_id_t node_id)
+		{
+			return node_id +
+				(warthog::grid_id_t)padded_rows_before_first_row_*padded_width_ +
+				(node_id / header_.width_) * padding_per_row_;
+		}
+
+		inline warthog::grid_id_t
+		to_padded_id(uint32_t x, uint32_t y)
+		{
+			return to_padded_id((warthog::grid_id_t)y * this->header_width() + x);
+		}
+
+		inline void
+		to_padded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
+		{
+			y = (uint32_t)(grid_id_p / padded_width_);
+			x = (uint32_t)(grid_id_p % padded_width_);
+		}
+
+		inline void
+		to_unpadded_xy(warthog::grid_id_t grid_id_p, uint32_t& x, uint32_t& y)
+		{
+			to_padded_xy(grid_id_p, x, y);
+			y -= padded_rows_before_first_row_;
+		}
+
+        inline warthog::grid_id_t
+        to_unpadded_id(warthog::grid_id_t padded_id)
+        {
+            uint32_t x, y;
+            to_unpadded_xy(padded_id, x, y);
+            return (warthog::grid_id_t)y * header_.width_ + x;
+        }
+
+		// see warthog::gridmap::get_neighbours
+		inline void
+		get_neighbours(warthog::grid_id_t grid_id_p, uint8_t tiles[3])
+		{
+			tiles[0] = (uint8_t)read_bits(grid_id_p - 1 - padded_width_, 8);
+			tiles[1] = (uint8_t)read_bits(grid_id_p - 1, 8);
+			tiles[2] = (uint8_t)read_bits(grid_id_p - 1 + padded_width_, 8);
+		}
+
+		// see warthog::gridmap::get_neighbours_32bit
+		inline void
+		get_neighbours_32bit(warthog::grid_id_t grid_id_p, uint32_t tiles[3])
+		{
+			tiles[0] = (uint32_t)read_bits(grid_id_p - padded_width_, 32);
+			tiles[1] = (uint32_t)read_bits(grid_id_p, 32);
+			tiles[2] = (uint32_t)read_bits(grid_id_p + padded_width_, 32);
+		}
+
+		// see warthog::gridmap::get_neighbours_upper_32bit
+		inline void
+		get_neighbours_upper_32bit(warthog::grid_id_t grid_id_p,
+				uint32_t tiles[3])
+		{
+			tiles[0] = (uint32_t)read_bits(grid_id_p - 31 - padded_width_, 32);
+			tiles[1] = (uint32_t)read_bits(grid_id_p - 31, 32);
+			tiles[2] = (uint32_t)read_bits(grid_id_p - 31 + padded_width_, 32);
+		}
+
+		// get the label associated with the padded coordinate pair (x, y)
+		inline bool
+		get_label(uint32_t x, unsigned int y)
+		{
+			return warthog::rle::get(row_first(y), row_last(y), (int32_t)x);
+		}
+
+		inline warthog::gridword
+		get_label(warthog::grid_id_t grid_id_p)
+		{
+			if(grid_id_p >= padded_mapsize()) { return 0; }
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			return get_label(x, y);
+		}
+
+		// set the label associated with the padded coordinate pair (x, y).
+		// NB: the runs of every later row move; the cost is linear in
+		// the size of the encoding
+		void
+		set_label(uint32_t x, unsigned int y, bool label);
+
+		inline void
+		set_label(warthog::grid_id_t grid_id_p, bool label)
+		{
+			if(grid_id_p >= padded_mapsize()) { return; }
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			set_label(x, y, label);
+		}
+
+		// the first obstacle at or after padded column @param x of row
+		// @param y. every row ends in padding, so there always is one
+		inline int32_t
+		next_obstacle(int32_t x, uint32_t y)
+		{
+			const uint32_t* first = row_first(y);
+			uint32_t i = warthog::rle::rank(first, row_last(y), x);
+			return (i & 1) ? (int32_t)first[i] : x;
+		}
+
+		// the last obstacle at or before padded column @param x of row
+		// @param y. -1 stands for the padding at the end of the row above
+		inline int32_t
+		prev_obstacle(int32_t x, uint32_t y)
+		{
+			const uint32_t* first = row_first(y);
+			uint32_t i = warthog::rle::rank(first, row_last(y), x);
+			return (i & 1) ? (int32_t)first[i-1] - 1 : x;
+		}
+
+		// the first column after @param x where a run of traversable
+		// tiles starts (@param open = true) or ends, on row @param y.
+		// see warthog::rle::next_change
+		inline int32_t
+		next_change(int32_t x, uint32_t y, bool open)
+		{
+			return warthog::rle::next_change(
+					row_first(y), row_last(y), x, open);
+		}
+
+		// the last column at or before @param x where a run of
+		// traversable tiles starts (@param open = true) or ends, on row
+		// @param y. see warthog::rle::prev_change
+		inline int32_t
+		prev_change(int32_t x, uint32_t y, bool open)
+		{
+			return warthog::rle::prev_change(
+					row_first(y), row_last(y), x, open);
+		}
+
+		inline warthog::grid_id_t
+		padded_mapsize()
+		{
+			return (warthog::grid_id_t)padded_width_ * padded_height_;
+		}
+
+		inline uint32_t
+		height() const
+		{
+			return this->padded_height_;
+		}
+
+		inline uint32_t
+		width() const
+		{
+			return this->padded_width_;
+		}
+
+		inline uint32_t
+		header_height()
+		{
+			return this->header_.height_;
+		}
+
+		inline uint32_t
+		header_width()
+		{
+			return this->header_.width_;
+		}
+
+		inline const char*
+		filename()
+		{
+			return this->filename_;
+		}
+
+        inline uint64_t
+        get_num_traversable_tiles()
+        {
+            return num_traversable_;
+        }
+
+		// number of runs of traversable tiles
+		inline size_t
+		get_num_runs()
+		{
+			return runs_.size() / 2;
+		}
+
+		void
+		print(std::ostream& out);
+
+		size_t
+		mem()
+		{
+			return sizeof(*this) +
+				sizeof(uint32_t) * runs_.capacity() +
+				sizeof(warthog::grid_id_t) * row_start_.capacity();
+		}
+
+	private:
+		warthog::gm_header header_;
+		char filename_[256];
+
+		uint32_t padded_width_;
+		uint32_t padded_height_;
+		uint32_t padding_per_row_;
+		uint32_t padded_rows_before_first_row_;
+		uint32_t padded_rows_after_last_row_;
+        uint64_t num_traversable_;
+
+		// the runs of padded row y are
+		// runs_[row_start_[y]] ... runs_[row_start_[y+1]-1]
+		std::vector<uint32_t> runs_;
+		std::vector<warthog::grid_id_t> row_start_;
+
+		rle_gridmap(uint32_t height, uint32_t width);
+		rle_gridmap(const warthog::rle_gridmap& other) {}
+		rle_gridmap& operator=(const warthog::rle_gridmap& other)
+		{ return *this; }
+
+		inline const uint32_t*
+		row_first(uint32_t y)
+		{
+			return runs_.data() + row_start_[y];
+		}
+
+		inline const uint32_t*
+		row_last(uint32_t y)
+		{
+			return runs_.data() + row_start_[y+1];
+		}
+
+		// the @param n (<= 64) tiles starting at @param grid_id_p, in
+		// order of increasing id; as with warthog::gridmap, tiles past
+		// the end of a row are those at the start of the next row
+		inline uint64_t
+		read_bits(warthog::grid_id_t grid_id_p, uint32_t n)
+		{
+			uint32_t x, y;
+			to_padded_xy(grid_id_p, x, y);
+			if(y >= padded_height_) { return 0; }
+			uint64_t bits = warthog::rle::read(
+					row_first(y), row_last(y), x, n, padded_width_);
+			if(x + n > padded_width_ && y + 1 < padded_height_)
+			{
+				uint32_t done = padded_width_ - x;
+				bits |= warthog::rle::read(row_first(y+1), row_last(y+1),
+						0, n - done, padded_width_) << done;
+			}
+			return bits;
+		}
+
+		void init_dims();
+		void copy_from(warthog::gridmap* map);
+};
+
+}
+
+#endif
@@ -173,6 +173,36 @@ class xy_graph_base
             return num_edges;
         }
 
+        // a hash of the nodes, their coordinates and the outgoing edges
+        // of every node (FNV-1a, as warthog::gridmap::checksum)
+        uint64_t
+        checksum()
+        {
+            uint64_t hash = 14695981039346656037ull;
+            auto add = [&hash](const void* data, size_t size)
+            {
+                const uint8_t* bytes = (const uint8_t*)data;
+                for(size_t i = 0; i < size; i++)
+                { hash = (hash ^ bytes[i]) * 1099511628211ull; }
+            };
+
+            uint32_t num_nodes = get_num_nodes();
+            add(&num_nodes, sizeof(num_nodes));
+            add(xy_.data(), sizeof(int32_t) * xy_.size());
+            for(uint32_t i = 0; i < num_nodes; i++)
+            {
+                T_NODE* n = get_node(i);
+                uint32_t degree = n->out_degree();
+                add(&degree, sizeof(degree));
+                for(T_EDGE* e = n->outgoing_begin(); e < n->outgoing_end(); e++)
+                {
+                    add(&e->node_id_, sizeof(e->node_id_));
+                    add(&e->wt_, sizeof(e->wt_));
+                }
+            }
+            return hash;
+        }
+
         // Fetch the xy coordinates of a node
         //
         // @param id: an internal graph id
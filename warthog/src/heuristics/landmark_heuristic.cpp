@@ -0,0 +1,372 @@
+#include "landmark_heuristic.h"
+#include "flexible_astar.h"
+#include "gridmap_expansion_policy.h"
+#include "helpers.h"
+#include "pqueue.h"
+#include "problem_instance.h"
+#include "search_node.h"
+#include "solution.h"
+#include "timer.h"
+#include "zero_heuristic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// file layout: a header, the padded ids of the landmarks and then,
+// starting at offset lm_header::table_offset_, one entry per landmark
+// for every padded id of the map
+static const char LM_MAGIC[4] = { 'W', 'L', 'M', 'K' };
+static const uint32_t LM_VERSION = 1;
+
+struct lm_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t entry_bytes_;
+    uint32_t num_landmarks_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint64_t map_hash_;
+    uint64_t table_offset_;
+    double inv_scale_;
+};
+
+namespace
+{
+
+// records the distance from the source to every expanded node
+struct lm_search_listener
+{
+    std::vector<double>* dist_;
+
+    inline void
+    generate_node(warthog::search_node* from, warthog::search_node* succ,
+            warthog::cost_t edge_cost, uint32_t edge_id) { }
+
+    inline void
+    expand_node(warthog::search_node* current)
+    { dist_->at((size_t)current->get_id()) = current->get_g(); }
+
+    inline void
+    relax_node(warthog::search_node* current) { }
+};
+
+// computes the distance from padded id @param source to every cell
+// of @param map. unreachable cells are set to warthog::COST_MAX
+void
+dijkstra(warthog::gridmap* map, uint32_t source, std::vector<double>& dist)
+{
+    warthog::zero_heuristic h;
+    warthog::pqueue_min open;
+    warthog::gridmap_expansion_policy expander(map);
+    lm_search_listener listener;
+    listener.dist_ = &dist;
+
+    warthog::flexible_astar<
+        warthog::zero_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min,
+        lm_search_listener> dijk(&h, &expander, &open, &listener);
+
+    dist.assign(map->padded_mapsize(), warthog::COST_MAX);
+    warthog::problem_instance pi(
+            map->to_unpadded_id(source), warthog::SN_ID_MAX);
+    warthog::solution sol;
+    dijk.get_pathcost(pi, sol);
+}
+
+struct shared_data
+{
+    warthog::gridmap* map_;
+    const std::vector<uint32_t>* sources_; // landmarks of this round
+    uint32_t first_index_;      // landmark index of sources_->at(0)
+    uint32_t num_landmarks_;
+    uint32_t entry_bytes_;
+    double scale_;
+    char* table_;
+    std::vector<double>* min_dist_;  // shared with the selection; locked
+    std::mutex* lock_;
+};
+
+template<typename T>
+void
+store_column(shared_data* shared, uint32_t index,
+        const std::vector<double>& dist)
+{
+    const T UNREACHABLE = (T)~((T)0);
+    T* table = (T*)shared->table_;
+    for(size_t i = 0; i < dist.size(); i++)
+    {
+        T value = UNREACHABLE;
+        if(dist[i] != warthog::COST_MAX)
+        {
+            double q = std::round(dist[i] * shared->scale_);
+            value = (T)std::min<double>(q, (double)(UNREACHABLE - 1));
+        }
+        table[i * shared->num_landmarks_ + index] = value;
+    }
+}
+
+void*
+thread_compute_fn(void* args_in)
+{
+    warthog::helpers::thread_params* par =
+        (warthog::helpers::thread_params*) args_in;
+    shared_data* shared = (shared_data*) par->shared_;
+
+    std::vector<double> dist;
+    for(uint32_t i = 0; i < shared->sources_->size(); i++)
+    {
+        if((i % par->max_threads_) != par->thread_id_) { continue; }
+
+        dijkstra(shared->map_, shared->sources_->at(i), dist);
+
+        // every thread writes a different column of the table
+        uint32_t index = shared->first_index_ + i;
+        if(shared->entry_bytes_ == 2)
+        { store_column<uint16_t>(shared, index, dist); }
+        else
+        { store_column<uint32_t>(shared, index, dist); }
+
+        {
+            std::lock_guard<std::mutex> guard(*shared->lock_);
+            std::vector<double>& min_dist = *shared->min_dist_;
+            for(size_t j = 0; j < dist.size(); j++)
+            { min_dist[j] = std::min(min_dist[j], dist[j]); }
+        }
+        par->nprocessed_++;
+    }
+    return 0;
+}
+
+}
+
+warthog::landmark_heuristic::landmark_heuristic(warthog::gridmap* map,
+        const char* filename, uint32_t num_landmarks, uint32_t entry_bytes)
+    : map_(map), octile_(map->width(), map->height()), hscale_(1.0),
+      map_version_(map->get_version()), num_landmarks_(0),
+      entry_bytes_(4), inv_scale_(0), landmarks_(0), table_(0),
+      mapped_(0), mapped_size_(0)
+{
+    if(load(filename)) { return; }
+
+    std::cerr << "computing landmark tables for " << filename << "\n";
+    if(!precompute(map, num_landmarks, entry_bytes, filename) ||
+       !load(filename))
+    {
+        std::cerr << "err; could not create landmark tables "
+            << filename << "\n";
+        exit(1);
+    }
+    if(entry_bytes_ == 2)
+    {
+        std::cerr << "landmark distances are stored with a resolution of "
+            << inv_scale_ << "\n";
+    }
+}
+
+warthog::landmark_heuristic::~landmark_heuristic()
+{
+    unload();
+}
+
+size_t
+warthog::landmark_heuristic::mem()
+{
+    return sizeof(*this) + mapped_size_;
+}
+
+bool
+warthog::landmark_heuristic::load(const char* filename)
+{
+    int fd = open(filename, O_RDONLY);
+    if(fd == -1) { return false; }
+
+    struct stat st;
+    if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(lm_header))
+    {
+        close(fd);
+        return false;
+    }
+
+    void* mapped = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapped == MAP_FAILED) { return false; }
+
+    const lm_header* header = (const lm_header*)mapped;
+    size_t table_size = (size_t)map_->padded_mapsize() *
+        header->num_landmarks_ * header->entry_bytes_;
+    if( memcmp(header->magic_, LM_MAGIC, 4) != 0 ||
+        header->version_ != LM_VERSION ||
+        (header->entry_bytes_ != 2 && header->entry_bytes_ != 4) ||
+        header->padded_width_ != map_->width() ||
+        header->padded_height_ != map_->height() ||
+        header->table_offset_ + table_size != (size_t)st.st_size ||
+        header->map_hash_ != map_->checksum())
+    {
+        // stale or foreign tables
+        munmap(mapped, (size_t)st.st_size);
+        return false;
+    }
+
+    unload();
+    mapped_ = mapped;
+    mapped_size_ = (size_t)st.st_size;
+    num_landmarks_ = header->num_landmarks_;
+    entry_bytes_ = header->entry_bytes_;
+    inv_scale_ = header->inv_scale_;
+    landmarks_ = (const uint32_t*)((const char*)mapped + sizeof(lm_header));
+    table_ = (const char*)mapped + header->table_offset_;
+    map_version_ = map_->get_version();
+    return true;
+}
+
+void
+warthog::landmark_heuristic::unload()
+{
+    if(mapped_) { munmap(mapped_, mapped_size_); }
+    mapped_ = 0;
+    mapped_size_ = 0;
+    num_landmarks_ = 0;
+    landmarks_ = 0;
+    table_ = 0;
+}
+
+bool
+warthog::landmark_heuristic::precompute(warthog::gridmap* map,
+        uint32_t num_landmarks, uint32_t entry_bytes, const char* filename)
+{
+    if(entry_bytes != 2 && entry_bytes != 4)
+    {
+        std::cerr << "err; landmark entries must be 2 or 4 bytes\n";
+        return false;
+    }
+
+    warthog::timer t;
+    t.start();
+
+    // seed the selection with the traversable cell nearest the centre
+    uint32_t seed = UINT32_MAX;
+    double seed_dist = warthog::COST_MAX;
+    warthog::octile_heuristic octile(map->width(), map->height());
+    uint32_t centre = map->to_padded_id(
+            map->header_width() / 2, map->header_height() / 2);
+    for(uint32_t i = 0; i < map->padded_mapsize(); i++)
+    {
+        if(!map->get_label(i)) { continue; }
+        double d = octile.h(i, centre);
+        if(d < seed_dist) { seed = i; seed_dist = d; }
+    }
+    if(seed == UINT32_MAX)
+    {
+        std::cerr << "err; map has no traversable cells\n";
+        return false;
+    }
+
+    // distances never exceed twice the eccentricity of the seed, so the
+    // fixed-point scale can be fixed before any table is computed
+    std::vector<double> min_dist;
+    dijkstra(map, seed, min_dist);
+    double ecc = 0;
+    for(double d : min_dist)
+    { if(d != warthog::COST_MAX) { ecc = std::max(ecc, d); } }
+    double max_value = entry_bytes == 2 ? (double)(UINT16_MAX - 1)
+                                        : (double)(UINT32_MAX - 1);
+    double scale = max_value / std::max(2 * ecc, 1.0);
+
+    lm_header header;
+    memcpy(header.magic_, LM_MAGIC, 4);
+    header.version_ = LM_VERSION;
+    header.entry_bytes_ = entry_bytes;
+    header.num_landmarks_ = num_landmarks;
+    header.padded_width_ = map->width();
+    header.padded_height_ = map->height();
+    header.map_hash_ = map->checksum();
+    header.table_offset_ = sizeof(lm_header) + num_landmarks * sizeof(uint32_t);
+    header.table_offset_ = (header.table_offset_ + 63) & ~(uint64_t)63;
+    header.inv_scale_ = 1 / scale;
+
+    std::vector<uint32_t> landmarks;
+    std::vector<char> table(
+            (size_t)map->padded_mapsize() * num_landmarks * entry_bytes);
+    std::mutex lock;
+
+    shared_data shared;
+    shared.map_ = map;
+    shared.num_landmarks_ = num_landmarks;
+    shared.entry_bytes_ = entry_bytes;
+    shared.scale_ = scale;
+    shared.table_ = table.data();
+    shared.min_dist_ = &min_dist;
+    shared.lock_ = &lock;
+
+    #ifdef SINGLE_THREADED
+    const uint32_t ROUND_SIZE = 1;
+    #else
+    const uint32_t ROUND_SIZE =
+        std::max<uint32_t>(1, std::thread::hardware_concurrency());
+    #endif
+
+    while(landmarks.size() < num_landmarks)
+    {
+        // pick the cells furthest from all landmarks so far; cells not
+        // reachable from the seed are ignored
+        std::vector<uint32_t> round;
+        std::vector<double> spread(min_dist);
+        uint32_t round_size = std::min<uint32_t>(
+                ROUND_SIZE, num_landmarks - (uint32_t)landmarks.size());
+        while(round.size() < round_size)
+        {
+            uint32_t pick = UINT32_MAX;
+            double pick_dist = -1;
+            for(uint32_t i = 0; i < spread.size(); i++)
+            {
+                if(spread[i] == warthog::COST_MAX) { continue; }
+                if(spread[i] > pick_dist) { pick = i; pick_dist = spread[i]; }
+            }
+            if(pick == UINT32_MAX) { break; }
+            round.push_back(pick);
+
+            for(uint32_t i = 0; i < spread.size(); i++)
+            {
+                if(spread[i] == warthog::COST_MAX) { continue; }
+                spread[i] = std::min(spread[i], octile.h(i, pick));
+            }
+        }
+
+        shared.sources_ = &round;
+        shared.first_index_ = (uint32_t)landmarks.size();
+        warthog::helpers::parallel_compute(
+                thread_compute_fn, &shared, (uint32_t)round.size());
+        landmarks.insert(landmarks.end(), round.begin(), round.end());
+    }
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if(!out.good())
+    {
+        std::cerr << "err; cannot write landmark file " << filename << "\n";
+        return false;
+    }
+    std::vector<char> padding(header.table_offset_ - sizeof(lm_header) -
+            num_landmarks * sizeof(uint32_t), 0);
+    out.write((const char*)&header, sizeof(lm_header));
+    out.write((const char*)landmarks.data(), num_landmarks * sizeof(uint32_t));
+    out.write(padding.data(), (std::streamsize)padding.size());
+    out.write(table.data(), (std::streamsize)table.size());
+    out.close();
+
+    t.stop();
+    std::cerr << "landmarks: " << num_landmarks << " entry bytes: "
+        << entry_bytes << " time " << t.elapsed_time_nano() / 1e9 << " s\n";
+    return out.good();
+}
@@ -0,0 +1,173 @@
+#ifndef WARTHOG_LANDMARK_HEURISTIC_H
+#define WARTHOG_LANDMARK_HEURISTIC_H
+
+// heuristics/landmark_heuristic.h
+//
+// A differential (landmark) heuristic for 8C gridmaps. For a handful of
+// landmark cells L we store the exact grid distance d(L, n) to every
+// cell n. By the triangle inequality |d(L, a) - d(L, b)| is a lower
+// bound on the distance between a and b. The heuristic value is the
+// largest such bound, or the octile distance if that is larger.
+// On maze- and room-like maps this is much closer to the true distance
+// than octile alone.
+//
+// Landmarks are chosen by farthest-point selection: each new landmark is
+// the cell furthest (in grid distance) from all landmarks chosen so far.
+// Distance tables are computed with Dijkstra (using
+// warthog::gridmap_expansion_policy), one landmark per thread. To keep
+// all threads busy, landmarks are selected in rounds: within a round
+// candidates are spread using octile distance to the other picks of the
+// same round; between rounds the exact distances are used.
+//
+// Tables are indexed by padded gridmap id (the ids used by the gridmap,
+// JPS and prune2 expansion policies) and hold the distances of each cell
+// to all landmarks contiguously. Distances are stored as fixed-point
+// values of 16 or 32 bits, in a file next to the map (see ::precompute),
+// which is memory-mapped when the heuristic is loaded.
+//
+// Quantising the distances means the heuristic is not quite consistent.
+// Searches which do not re-open nodes (e.g. warthog::flexible_astar) can
+// return paths longer than optimal by at most 2 * ::get_quantum().
+// With 32-bit entries the quantum is negligible (< 1e-4 on a
+// 512x512 maze); with 16-bit entries it is reported at load time.
+//
+// The tables describe the map as it was when they were computed.
+// Once the map is modified (e.g. warthog::gridmap::set_label) the
+// heuristic ignores them and returns the octile distance; see
+// ::is_current.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "octile_heuristic.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace warthog
+{
+
+class landmark_heuristic
+{
+	public:
+        // load landmark tables for @param map from @param filename.
+        // if the file does not exist, or was computed for a different
+        // map, new tables are computed and written to @param filename.
+        // @param num_landmarks and @param entry_bytes (2 or 4) only
+        // apply in the latter case.
+		landmark_heuristic(warthog::gridmap* map, const char* filename,
+                uint32_t num_landmarks = 16, uint32_t entry_bytes = 4);
+
+		~landmark_heuristic();
+
+		inline double
+		h(warthog::sn_id_t id, warthog::sn_id_t id2)
+		{
+            // stale tables may overestimate; fall back to octile
+            double oct = octile_.h(id, id2);
+            if(!is_current()) { return oct * hscale_; }
+
+            double lm = 0;
+            if(entry_bytes_ == 2)
+            {
+                lm = landmark_bound<uint16_t>(
+                        (warthog::grid_id_t)id, (warthog::grid_id_t)id2);
+            }
+            else
+            {
+                lm = landmark_bound<uint32_t>(
+                        (warthog::grid_id_t)id, (warthog::grid_id_t)id2);
+            }
+
+			return (oct < lm ? lm : oct) * hscale_;
+		}
+
+        inline void
+        set_hscale(double hscale) { hscale_ = hscale; }
+
+        inline double
+        get_hscale() { return hscale_; }
+
+        inline uint32_t
+        get_num_landmarks() { return num_landmarks_; }
+
+        // the padded id of landmark @param index
+        inline uint32_t
+        get_landmark(uint32_t index) { return landmarks_[index]; }
+
+        // the resolution of the stored distances
+        inline double
+        get_quantum() { return inv_scale_; }
+
+        // false if the map was modified after the tables were loaded
+        inline bool
+        is_current() { return map_->get_version() == map_version_; }
+
+        size_t
+        mem();
+
+        // select @param num_landmarks landmarks on @param map, compute
+        // their distance tables with entries of @param entry_bytes bytes
+        // (2 or 4) and write everything to @param filename.
+        // @return false if the tables could not be written
+        static bool
+        precompute(warthog::gridmap* map, uint32_t num_landmarks,
+                uint32_t entry_bytes, const char* filename);
+
+	private:
+        warthog::gridmap* map_;
+        warthog::octile_heuristic octile_;
+        double hscale_;
+        uint32_t map_version_;
+
+        uint32_t num_landmarks_;
+        uint32_t entry_bytes_;
+        double inv_scale_;
+        const uint32_t* landmarks_;
+        const char* table_;
+
+        // the memory-mapped file
+        void* mapped_;
+        size_t mapped_size_;
+
+        bool
+        load(const char* filename);
+
+        void
+        unload();
+
+        template<typename T>
+        inline double
+        landmark_bound(warthog::grid_id_t id, warthog::grid_id_t id2)
+        {
+            const T* a = ((const T*)table_) + (size_t)id * num_landmarks_;
+            const T* b = ((const T*)table_) + (size_t)id2 * num_landmarks_;
+            const T UNREACHABLE = (T)~((T)0);
+
+            int64_t best = 0;
+            for(uint32_t i = 0; i < num_landmarks_; i++)
+            {
+                // skip landmarks in another component than either cell
+                if(a[i] == UNREACHABLE || b[i] == UNREACHABLE) { continue; }
+                int64_t diff = (int64_t)a[i] - (int64_t)b[i];
+                diff = diff < 0 ? -diff : diff;
+                best = diff > best ? diff : best;
+            }
+
+            // each entry is within half a quantum of the exact distance
+            return best > 1 ? (best - 1) * inv_scale_ : 0;
+        }
+
+        landmark_heuristic(const landmark_heuristic& other)
+            : octile_(other.octile_) { }
+        landmark_heuristic&
+        operator=(const landmark_heuristic& other) { return *this; }
+};
+
+}
+
+#endif
+
@@ -22,7 +22,9 @@ class octile_heuristic
 	public:
 		octile_heuristic(uint32_t mapwidth, uint32_t mapheight)
 	    	: mapwidth_(mapwidth), hscale_(1.0)
-        { }
+        { 
+            inv_mapwidth_ = 1.0 / (double)mapwidth;
+        }
 
 		~octile_heuristic() { }
 
@@ -31,11 +33,9 @@ class octile_heuristic
 		{
 			int32_t dx = abs(x-x2);
 			int32_t dy = abs(y-y2);
-			if(dx < dy)
-			{
-				return (dx * warthog::DBL_ROOT_TWO + (dy - dx)) * hscale_;
-			}
-			return (dy * warthog::DBL_ROOT_TWO + (dx - dy)) * hscale_;
+            int32_t dmin = dx < dy ? dx : dy;
+            int32_t dmax = dx < dy ? dy : dx;
+			return (dmin * warthog::DBL_ROOT_TWO + (dmax - dmin)) * hscale_;
 		}
 
 		inline double
@@ -43,11 +43,41 @@ class octile_heuristic
 		{
 			int32_t x, x2;
 			int32_t y, y2;
-			warthog::helpers::index_to_xy((uint32_t)id, mapwidth_, x, y);
-			warthog::helpers::index_to_xy((uint32_t)id2,mapwidth_, x2, y2);
+			to_xy((warthog::grid_id_t)id, x, y);
+			to_xy((warthog::grid_id_t)id2, x2, y2);
 			return this->h(x, y, x2, y2);
 		}
 
+        // evaluate the heuristic for a batch of @param num nodes, all 
+        // with the same target @param id2. results go in @param out.
+        // the loop is free of divisions and branches, so the compiler 
+        // can vectorise it.
+        inline void
+        h(const warthog::sn_id_t* ids, uint32_t num, warthog::sn_id_t id2,
+                double* out)
+        {
+			int32_t x2, y2;
+			to_xy((warthog::grid_id_t)id2, x2, y2);
+            for(uint32_t i = 0; i < num; i++)
+            {
+                int32_t x, y;
+                to_xy((warthog::grid_id_t)ids[i], x, y);
+                out[i] = this->h(x, y, x2, y2);
+            }
+        }
+
+        // as above, for callers that already know the coordinates of 
+        // each node (e.g. expansion policies)
+        inline void
+        h(const int32_t* xs, const int32_t* ys, uint32_t num, 
+                int32_t x2, int32_t y2, double* out)
+        {
+            for(uint32_t i = 0; i < num; i++)
+            {
+                out[i] = this->h(xs[i], ys[i], x2, y2);
+            }
+        }
+
         inline void
         set_hscale(double hscale) { hscale_ = hscale; }
 
@@ -59,7 +89,25 @@ class octile_heuristic
 
 	private:
 		unsigned int mapwidth_;
+        double inv_mapwidth_;
         double hscale_;
+
+        // same as warthog::helpers::index_to_xy but multiplies by the 
+        // reciprocal of the map width instead of dividing by it. 
+        // the quotient can be off by one due to rounding; we correct it.
+        // ids are padded grid ids, 64 bit with -DGRID_ID64
+        inline void
+        to_xy(warthog::grid_id_t id, int32_t& x, int32_t& y)
+        {
+            int64_t q = (int64_t)(id * inv_mapwidth_);
+            int64_t r = (int64_t)id - q * mapwidth_;
+            q -= (r < 0);
+            r += (r < 0) ? mapwidth_ : 0;
+            q += (r >= mapwidth_);
+            r -= (r >= mapwidth_) ? mapwidth_ : 0;
+            x = (int32_t)r;
+            y = (int32_t)q;
+        }
 };
 
 }
@@ -0,0 +1,136 @@
+#include "hpa_expansion_policy.h"
+
+warthog::hpa::hpa_expansion_policy::hpa_expansion_policy(
+        warthog::hpa::hpa_graph* g)
+    : expansion_policy(g->get_map()->padded_mapsize()),
+      g_(g), map_(g->get_map())
+{
+    search_ = new warthog::hpa::cluster_search(g_);
+    start_id_ = target_id_ = warthog::GRID_ID_MAX;
+    target_cluster_ = UINT32_MAX;
+}
+
+warthog::hpa::hpa_expansion_policy::~hpa_expansion_policy()
+{
+    delete search_;
+}
+
+void
+warthog::hpa::hpa_expansion_policy::expand(
+        warthog::search_node* current, warthog::problem_instance* problem)
+{
+    reset();
+
+    warthog::grid_id_t id = (warthog::grid_id_t)current->get_id();
+    uint32_t index = g_->find(id);
+    if(index != warthog::hpa::hpa_graph::NO_TRANSITION)
+    {
+        for(const warthog::hpa::hpa_edge* e = g_->edges_begin(index);
+                e != g_->edges_end(index); e++)
+        {
+            add_neighbour(generate(e->to_), e->cost_);
+        }
+    }
+
+    if(id == start_id_)
+    {
+        for(warthog::hpa::hpa_edge& e : start_edges_)
+        {
+            add_neighbour(generate(e.to_), e.cost_);
+        }
+    }
+
+    if(problem->target_id_ == target_id_ &&
+       g_->get_cluster(id) == target_cluster_)
+    {
+        for(warthog::hpa::hpa_edge& e : target_edges_)
+        {
+            if(e.to_ == id)
+            {
+                add_neighbour(generate(target_id_), e.cost_);
+                break;
+            }
+        }
+    }
+}
+
+void
+warthog::hpa::hpa_expansion_policy::get_xy(
+        warthog::sn_id_t node_id, int32_t& x, int32_t& y)
+{
+    map_->to_unpadded_xy((warthog::grid_id_t)node_id,
+            (uint32_t&)x, (uint32_t&)y);
+}
+
+warthog::search_node*
+warthog::hpa::hpa_expansion_policy::generate_start_node(
+        warthog::problem_instance* pi)
+{
+    start_id_ = to_padded_id(pi->start_id_);
+    if(start_id_ == warthog::GRID_ID_MAX) { return 0; }
+
+    start_edges_.clear();
+    search_->run(start_id_);
+    for(const uint32_t* i = g_->cluster_begin(g_->get_cluster(start_id_));
+            i != g_->cluster_end(g_->get_cluster(start_id_)); i++)
+    {
+        warthog::grid_id_t to = g_->get_transition_id(*i);
+        warthog::cost_t d = search_->dist(to);
+        if(to != start_id_ && d != warthog::COST_MAX)
+        { start_edges_.push_back(warthog::hpa::hpa_edge(to, d)); }
+    }
+
+    // a path inside the cluster; there may be shorter ones that leave it.
+    // (the target was generated first and its id is now padded)
+    if(pi->target_id_ == target_id_ &&
+       g_->get_cluster(start_id_) == target_cluster_)
+    {
+        warthog::cost_t d = search_->dist(target_id_);
+        if(d != warthog::COST_MAX)
+        { start_edges_.push_back(warthog::hpa::hpa_edge(target_id_, d)); }
+    }
+    return generate(start_id_);
+}
+
+warthog::search_node*
+warthog::hpa::hpa_expansion_policy::generate_target_node(
+        warthog::problem_instance* pi)
+{
+    target_id_ = to_padded_id(pi->target_id_);
+    target_cluster_ = UINT32_MAX;
+    if(target_id_ == warthog::GRID_ID_MAX) { return 0; }
+
+    // the graph is undirected: distances from the target are distances
+    // to it
+    target_cluster_ = g_->get_cluster(target_id_);
+    target_edges_.clear();
+    search_->run(target_id_);
+    for(const uint32_t* i = g_->cluster_begin(target_cluster_);
+            i != g_->cluster_end(target_cluster_); i++)
+    {
+        warthog::grid_id_t from = g_->get_transition_id(*i);
+        warthog::cost_t d = search_->dist(from);
+        if(from != target_id_ && d != warthog::COST_MAX)
+        { target_edges_.push_back(warthog::hpa::hpa_edge(from, d)); }
+    }
+    return generate(target_id_);
+}
+
+warthog::grid_id_t
+warthog::hpa::hpa_expansion_policy::to_padded_id(warthog::sn_id_t id)
+{
+    warthog::grid_id_t max_id =
+        (warthog::grid_id_t)map_->header_width() * map_->header_height();
+    if(id >= max_id) { return warthog::GRID_ID_MAX; }
+    warthog::grid_id_t padded_id = map_->to_padded_id((warthog::grid_id_t)id);
+    if(map_->get_label(padded_id) == 0) { return warthog::GRID_ID_MAX; }
+    return padded_id;
+}
+
+size_t
+warthog::hpa::hpa_expansion_policy::mem()
+{
+    return expansion_policy::mem() + search_->mem() +
+        sizeof(warthog::hpa::hpa_edge) *
+            (start_edges_.capacity() + target_edges_.capacity());
+}
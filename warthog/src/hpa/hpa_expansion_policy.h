@@ -0,0 +1,79 @@
+#ifndef WARTHOG_HPA_HPA_EXPANSION_POLICY_H
+#define WARTHOG_HPA_HPA_EXPANSION_POLICY_H
+
+// hpa/hpa_expansion_policy.h
+//
+// Searches the abstract graph of a warthog::hpa::hpa_graph. The start
+// and the target of each query are connected to the transitions of
+// their clusters (and to each other, if they share a cluster) by a
+// Dijkstra search inside the cluster. Use with the octile heuristic;
+// node ids are padded ids of the gridmap.
+//
+// The result is a path of transitions, which warthog::hpa::hpa_search
+// refines into a path on the grid.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "expansion_policy.h"
+#include "gridmap.h"
+#include "hpa_graph.h"
+#include "search_node.h"
+
+#include <vector>
+
+namespace warthog
+{
+
+namespace hpa
+{
+
+class hpa_expansion_policy : public warthog::expansion_policy
+{
+    public:
+        hpa_expansion_policy(warthog::hpa::hpa_graph* g);
+        virtual ~hpa_expansion_policy();
+
+        virtual void
+        expand(warthog::search_node*, warthog::problem_instance*);
+
+        virtual void
+        get_xy(warthog::sn_id_t node_id, int32_t& x, int32_t& y);
+
+        virtual warthog::search_node*
+        generate_start_node(warthog::problem_instance* pi);
+
+        virtual warthog::search_node*
+        generate_target_node(warthog::problem_instance* pi);
+
+        inline warthog::hpa::hpa_graph*
+        get_graph() { return g_; }
+
+        virtual size_t
+        mem();
+
+    private:
+        warthog::hpa::hpa_graph* g_;
+        warthog::gridmap* map_;
+        warthog::hpa::cluster_search* search_;
+
+        // the edges of the start, and the transitions of the cluster of
+        // the target with their distance to it
+        warthog::grid_id_t start_id_;
+        warthog::grid_id_t target_id_;
+        uint32_t target_cluster_;
+        std::vector<warthog::hpa::hpa_edge> start_edges_;
+        std::vector<warthog::hpa::hpa_edge> target_edges_;
+
+        // padded id of the unpadded id @param id; GRID_ID_MAX for
+        // obstacles and ids outside the map
+        warthog::grid_id_t
+        to_padded_id(warthog::sn_id_t id);
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,407 @@
+#include "hpa/hpa_graph.h"
+#include "global.h"
+#include "helpers.h"
+#include "timer.h"
+
+#include <functional>
+#include <iostream>
+
+namespace
+{
+
+// entrances at least this long get a crossing at each end; shorter ones
+// get one in the middle
+const uint32_t HPA_MAX_ENTRANCE = 6;
+
+typedef std::pair<uint32_t, warthog::hpa::hpa_edge> hpa_intra_edge;
+
+struct hpa_shared_data
+{
+    warthog::hpa::hpa_graph* g_;
+    std::vector<std::vector<hpa_intra_edge>>* intra_;
+};
+
+}
+
+const uint32_t warthog::hpa::hpa_graph::NO_TRANSITION;
+
+warthog::hpa::hpa_graph::hpa_graph(
+        warthog::gridmap* map, uint32_t cluster_size, bool exact)
+    : map_(map), cluster_size_(cluster_size), exact_(exact)
+{
+    if(cluster_size_ < 4)
+    {
+        std::cerr << "err; hpa clusters must be at least 4x4. aborting.\n";
+        exit(1);
+    }
+    map_version_ = map_->get_version();
+    top_ = (uint32_t)(map_->to_padded_id(0, 0) / map_->width());
+    clusters_per_row_ =
+        (map_->header_width() + cluster_size_ - 1) / cluster_size_;
+    map_->add_index(this);
+}
+
+warthog::hpa::hpa_graph::~hpa_graph()
+{
+    map_->remove_index(this);
+}
+
+void
+warthog::hpa::hpa_graph::repair(
+        warthog::gridmap* map, const warthog::gridmap_change& change)
+{
+    precompute();
+}
+
+void
+warthog::hpa::hpa_graph::find_transitions(
+        std::vector<std::pair<warthog::grid_id_t, warthog::hpa::hpa_edge>>&
+        crossings)
+{
+    uint32_t mapw = map_->header_width();
+    uint32_t maph = map_->header_height();
+    uint32_t c = cluster_size_;
+
+    // tiles outside the map are obstacles
+    auto open = [this, mapw, maph](int32_t x, int32_t y) -> bool
+    {
+        if(x < 0 || y < 0 || (uint32_t)x >= mapw || (uint32_t)y >= maph)
+        { return false; }
+        return map_->get_label(map_->to_padded_id((uint32_t)x, (uint32_t)y));
+    };
+    auto add = [this, &crossings](uint32_t x, uint32_t y,
+            uint32_t x2, uint32_t y2, warthog::cost_t cost) -> void
+    {
+        warthog::grid_id_t p = map_->to_padded_id(x, y);
+        warthog::grid_id_t q = map_->to_padded_id(x2, y2);
+        crossings.push_back(std::make_pair(p, warthog::hpa::hpa_edge(q, cost)));
+        crossings.push_back(std::make_pair(q, warthog::hpa::hpa_edge(p, cost)));
+    };
+
+    if(exact_)
+    {
+        // every crossing, from the tiles on the east and south side of
+        // each cluster (and the west side, for moves to the south-west)
+        for(uint32_t y = 0; y < maph; y++)
+        {
+            for(uint32_t x = 0; x < mapw; x++)
+            {
+                bool south = (y % c) == c - 1;
+                bool east = (x % c) == c - 1;
+                bool west = (x % c) == 0;
+                if(!(south || east || west) || !open(x, y)) { continue; }
+
+                if(east && open(x+1, y)) { add(x, y, x+1, y, 1); }
+                if(south && open(x, y+1)) { add(x, y, x, y+1, 1); }
+                if((east || south) && open(x+1, y+1) &&
+                        open(x+1, y) && open(x, y+1))
+                { add(x, y, x+1, y+1, warthog::DBL_ROOT_TWO); }
+                if((west || south) && open(x-1, y+1) &&
+                        open(x-1, y) && open(x, y+1))
+                { add(x, y, x-1, y+1, warthog::DBL_ROOT_TWO); }
+            }
+        }
+        return;
+    }
+
+    // one or two crossings per entrance
+    auto entrance = [](uint32_t first, uint32_t last,
+            const std::function<void(uint32_t)>& cross) -> void
+    {
+        if(last - first + 1 < HPA_MAX_ENTRANCE)
+        { cross((first + last) / 2); }
+        else { cross(first); cross(last); }
+    };
+
+    // the boundaries between columns of clusters. entrances end where
+    // the boundary does, at the corners of the clusters
+    for(uint32_t x = c - 1; x + 1 < mapw; x += c)
+    {
+        std::function<void(uint32_t)> cross =
+            [&add, x](uint32_t y) { add(x, y, x+1, y, 1); };
+        uint32_t first = UINT32_MAX;
+        for(uint32_t y = 0; y <= maph; y++)
+        {
+            bool crossing = y < maph && open(x, y) && open(x+1, y);
+            if(first != UINT32_MAX && (!crossing || (y % c) == 0))
+            {
+                entrance(first, y - 1, cross);
+                first = UINT32_MAX;
+            }
+            if(crossing && first == UINT32_MAX) { first = y; }
+        }
+    }
+
+    // the boundaries between rows of clusters
+    for(uint32_t y = c - 1; y + 1 < maph; y += c)
+    {
+        std::function<void(uint32_t)> cross =
+            [&add, y](uint32_t x) { add(x, y, x, y+1, 1); };
+        uint32_t first = UINT32_MAX;
+        for(uint32_t x = 0; x <= mapw; x++)
+        {
+            bool crossing = x < mapw && open(x, y) && open(x, y+1);
+            if(first != UINT32_MAX && (!crossing || (x % c) == 0))
+            {
+                entrance(first, x - 1, cross);
+                first = UINT32_MAX;
+            }
+            if(crossing && first == UINT32_MAX) { first = x; }
+        }
+    }
+}
+
+void
+warthog::hpa::hpa_graph::precompute()
+{
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        hpa_shared_data* shared = (hpa_shared_data*) par->shared_;
+        warthog::hpa::hpa_graph* g = shared->g_;
+
+        // clusters are evenly divided among all threads
+        warthog::hpa::cluster_search search(g);
+        for(uint32_t c = par->thread_id_; c < g->get_num_clusters();
+                c += par->max_threads_)
+        {
+            std::vector<hpa_intra_edge>& edges = shared->intra_->at(c);
+            for(const uint32_t* i = g->cluster_begin(c);
+                    i != g->cluster_end(c); i++)
+            {
+                // paths are symmetric; search each pair once
+                warthog::grid_id_t from = g->get_transition_id(*i);
+                for(const uint32_t* j = i + 1; j != g->cluster_end(c); j++)
+                {
+                    warthog::grid_id_t to = g->get_transition_id(*j);
+                    warthog::solution sol;
+                    search.get_pathcost(from, to, sol);
+                    if(sol.status_ != warthog::solution::FOUND) { continue; }
+                    warthog::cost_t d = sol.sum_of_edge_costs_;
+                    edges.push_back(hpa_intra_edge(*i,
+                        warthog::hpa::hpa_edge(to, d)));
+                    edges.push_back(hpa_intra_edge(*j,
+                        warthog::hpa::hpa_edge(from, d)));
+                }
+            }
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    warthog::timer t;
+    t.start();
+    std::cerr << "computing hpa abstraction (clusters of " << cluster_size_
+        << (exact_ ? ", exact)\n" : ")\n");
+
+    std::vector<std::pair<warthog::grid_id_t, warthog::hpa::hpa_edge>>
+        crossings;
+    find_transitions(crossings);
+
+    ids_.clear();
+    for(auto& e : crossings) { ids_.push_back(e.first); }
+    std::sort(ids_.begin(), ids_.end());
+    ids_.erase(std::unique(ids_.begin(), ids_.end()), ids_.end());
+
+    // the transitions of each cluster, in order of id
+    uint32_t num_rows =
+        (map_->header_height() + cluster_size_ - 1) / cluster_size_;
+    uint32_t num_clusters = num_rows * clusters_per_row_;
+    cluster_begin_.assign(num_clusters + 1, 0);
+    for(warthog::grid_id_t id : ids_) { cluster_begin_[get_cluster(id) + 1]++; }
+    for(uint32_t c = 0; c < num_clusters; c++)
+    { cluster_begin_[c+1] += cluster_begin_[c]; }
+    cluster_nodes_.resize(ids_.size());
+    std::vector<uint32_t> next(cluster_begin_.begin(), cluster_begin_.end() - 1);
+    for(uint32_t i = 0; i < ids_.size(); i++)
+    { cluster_nodes_[next[get_cluster(ids_[i])]++] = i; }
+
+    std::vector<std::vector<hpa_intra_edge>> intra(num_clusters);
+    hpa_shared_data shared;
+    shared.g_ = this;
+    shared.intra_ = &intra;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, num_clusters);
+
+    // all edges, grouped by transition
+    edge_begin_.assign(ids_.size() + 1, 0);
+    for(auto& e : crossings) { edge_begin_[find(e.first) + 1]++; }
+    for(auto& edges : intra)
+    {
+        for(auto& e : edges) { edge_begin_[e.first + 1]++; }
+    }
+    for(uint32_t i = 0; i < ids_.size(); i++)
+    { edge_begin_[i+1] += edge_begin_[i]; }
+
+    edges_.resize(edge_begin_.back());
+    next.assign(edge_begin_.begin(), edge_begin_.end() - 1);
+    for(auto& e : crossings) { edges_[next[find(e.first)]++] = e.second; }
+    for(auto& edges : intra)
+    {
+        for(auto& e : edges) { edges_[next[e.first]++] = e.second; }
+    }
+    map_version_ = map_->get_version();
+
+    t.stop();
+    std::cerr << "done. transitions: " << ids_.size()
+        << " edges: " << edges_.size()
+        << " time " << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+size_t
+warthog::hpa::hpa_graph::mem()
+{
+    return sizeof(*this) +
+        sizeof(warthog::grid_id_t) * ids_.capacity() +
+        sizeof(uint32_t) * edge_begin_.capacity() +
+        sizeof(warthog::hpa::hpa_edge) * edges_.capacity() +
+        sizeof(uint32_t) *
+            (cluster_begin_.capacity() + cluster_nodes_.capacity());
+}
+
+warthog::hpa::cluster_search::cluster_search(warthog::hpa::hpa_graph* g)
+    : g_(g), cluster_(UINT32_MAX), version_(0), x0_(0), y0_(0)
+{
+    uint32_t size = g_->get_cluster_size();
+    cmap_ = new warthog::gridmap(size, size);
+    expander_ = new warthog::gridmap_expansion_policy(cmap_);
+    dijkstra_ = new warthog::flexible_astar<
+        warthog::zero_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min>(&heuristic_, expander_, &open_);
+
+    octile_ = new warthog::octile_heuristic(cmap_->width(), cmap_->height());
+    jps_expander_ = new warthog::jps2_expansion_policy(cmap_);
+    jps_ = new warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::jps2_expansion_policy,
+        warthog::pqueue_min>(octile_, jps_expander_, &jps_open_);
+}
+
+warthog::hpa::cluster_search::~cluster_search()
+{
+    delete jps_;
+    delete jps_expander_;
+    delete octile_;
+    delete dijkstra_;
+    delete expander_;
+    delete cmap_;
+}
+
+void
+warthog::hpa::cluster_search::load(uint32_t c)
+{
+    warthog::gridmap* map = g_->get_map();
+    if(c == cluster_ && map->get_version() == version_) { return; }
+
+    // through an edit, which keeps the rotated copy of the JPS2
+    // locator in step; only the tiles that differ from the cluster
+    // copied last are written
+    uint32_t size = g_->get_cluster_size();
+    g_->get_cluster_origin(c, x0_, y0_);
+    warthog::gridmap_edit edit(cmap_);
+    for(uint32_t y = 0; y < size; y++)
+    {
+        for(uint32_t x = 0; x < size; x++)
+        {
+            bool label = x0_ + x < map->header_width() &&
+                y0_ + y < map->header_height() &&
+                map->get_label(map->to_padded_id(x0_ + x, y0_ + y));
+            warthog::grid_id_t id = cmap_->to_padded_id(x, y);
+            if(label != (bool)cmap_->get_label(id))
+            { edit.set_label(id, label); }
+        }
+    }
+    edit.commit();
+    cluster_ = c;
+    version_ = map->get_version();
+}
+
+bool
+warthog::hpa::cluster_search::run(warthog::grid_id_t from)
+{
+    load(g_->get_cluster(from));
+    warthog::grid_id_t id = to_cluster_id(from);
+    if(!cmap_->get_label(id)) { return false; }
+
+    uint32_t x, y;
+    cmap_->to_unpadded_xy(id, x, y);
+    warthog::problem_instance pi(y * g_->get_cluster_size() + x);
+    warthog::solution sol;
+    dijkstra_->get_pathcost(pi, sol);
+    return true;
+}
+
+warthog::cost_t
+warthog::hpa::cluster_search::dist(warthog::grid_id_t to)
+{
+    warthog::grid_id_t id = to_cluster_id(to);
+    if(id >= cmap_->padded_mapsize()) { return warthog::COST_MAX; }
+    warthog::search_node* n = dijkstra_->get_generated_node(id);
+    return n ? n->get_g() : warthog::COST_MAX;
+}
+
+void
+warthog::hpa::cluster_search::get_path(warthog::grid_id_t from,
+        warthog::grid_id_t to, warthog::solution& sol)
+{
+    jps(from, to, sol, true);
+}
+
+void
+warthog::hpa::cluster_search::get_pathcost(warthog::grid_id_t from,
+        warthog::grid_id_t to, warthog::solution& sol)
+{
+    jps(from, to, sol, false);
+}
+
+void
+warthog::hpa::cluster_search::jps(warthog::grid_id_t from,
+        warthog::grid_id_t to, warthog::solution& sol, bool path)
+{
+    load(g_->get_cluster(from));
+    warthog::grid_id_t cfrom = to_cluster_id(from);
+    warthog::grid_id_t cto = to_cluster_id(to);
+    if(cto >= cmap_->padded_mapsize())
+    {
+        sol.reset();
+        sol.status_ = warthog::solution::NO_PATH;
+        return;
+    }
+
+    uint32_t size = g_->get_cluster_size();
+    uint32_t x, y, x2, y2;
+    cmap_->to_unpadded_xy(cfrom, x, y);
+    cmap_->to_unpadded_xy(cto, x2, y2);
+    warthog::problem_instance pi(y * size + x, y2 * size + x2);
+
+    // the statistics of jps2 (see global.h) read the node pool of the
+    // running search, which here is not that of the query
+    warthog::mem::node_pool* query_pool = global::nodepool;
+    global::nodepool = jps_expander_->get_nodepool();
+    if(path) { jps_->get_path(pi, sol); }
+    else { jps_->get_pathcost(pi, sol); }
+    global::nodepool = query_pool;
+    if(!path) { return; }
+
+    // back to padded ids of the map
+    warthog::gridmap* map = g_->get_map();
+    for(warthog::sn_id_t& id : sol.path_)
+    {
+        cmap_->to_unpadded_xy((warthog::grid_id_t)id, x, y);
+        id = map->to_padded_id(x0_ + x, y0_ + y);
+    }
+}
+
+warthog::grid_id_t
+warthog::hpa::cluster_search::to_cluster_id(warthog::grid_id_t grid_id_p)
+{
+    uint32_t x, y;
+    g_->get_map()->to_unpadded_xy(grid_id_p, x, y);
+    if(x < x0_ || y < y0_ ||
+       x - x0_ >= g_->get_cluster_size() || y - y0_ >= g_->get_cluster_size())
+    { return cmap_->padded_mapsize(); }
+    return cmap_->to_padded_id(x - x0_, y - y0_);
+}
@@ -0,0 +1,284 @@
+#ifndef WARTHOG_HPA_HPA_GRAPH_H
+#define WARTHOG_HPA_HPA_GRAPH_H
+
+// hpa/hpa_graph.h
+//
+// A cluster-based abstraction of a gridmap, after HPA* (Botea, Mueller
+// and Schaeffer, 2004). The map is cut into square clusters; tiles on
+// either side of the boundary between two clusters that a path can
+// cross are "transitions". The abstract graph has one node per
+// transition and two kinds of edges: between the two sides of a
+// crossing, and between the transitions of one cluster, with the cost
+// of the shortest path that stays inside the cluster.
+//
+// Transitions are chosen in one of two modes:
+//
+//  - near-optimal (the HPA* default): every run of boundary tiles that
+//    is open on both sides (an entrance) gets one crossing in its
+//    middle, or one at each end if it is long. The abstract graph is
+//    small but paths must pass through the chosen crossings, so they
+//    are not always optimal.
+//
+//  - exact: every straight and diagonal crossing is a transition.
+//    Every path is a sequence of in-cluster segments and crossings, so
+//    abstract distances equal grid distances. The graph is much larger:
+//    about (4 * cluster_size)^2 edges per cluster.
+//
+// In-cluster distances are found by a JPS2 search between every pair
+// of transitions of a cluster, on a copy of the cluster (see
+// ::cluster_search); the clusters are divided among threads.
+//
+// Node ids in the abstract graph are padded ids of the gridmap, so the
+// octile heuristic applies as is (see warthog::hpa::hpa_expansion_policy).
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "flexible_astar.h"
+#include "gridmap.h"
+#include "gridmap_edit.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "zero_heuristic.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace warthog
+{
+
+namespace hpa
+{
+
+struct hpa_edge
+{
+    hpa_edge() : to_(0), cost_(0) { }
+    hpa_edge(warthog::grid_id_t to, warthog::cost_t cost)
+        : to_(to), cost_(cost) { }
+
+    warthog::grid_id_t to_;
+    warthog::cost_t cost_;
+};
+
+class hpa_graph : public warthog::gridmap_index
+{
+    public:
+        // @param cluster_size: the width and height of a cluster (>= 4)
+        // @param exact: make every crossing a transition (see above)
+        hpa_graph(warthog::gridmap* map, uint32_t cluster_size,
+                bool exact = false);
+        virtual ~hpa_graph();
+
+        // find the transitions and the edges between them
+        void
+        precompute();
+
+        // NB: the abstraction is rebuilt in full
+        virtual void
+        repair(warthog::gridmap* map, const warthog::gridmap_change& change);
+
+        // @return the index of the transition at padded id @param grid_id_p
+        // or NO_TRANSITION if there is none
+        inline uint32_t
+        find(warthog::grid_id_t grid_id_p) const
+        {
+            std::vector<warthog::grid_id_t>::const_iterator it =
+                std::lower_bound(ids_.begin(), ids_.end(), grid_id_p);
+            if(it == ids_.end() || *it != grid_id_p) { return NO_TRANSITION; }
+            return (uint32_t)(it - ids_.begin());
+        }
+
+        inline warthog::grid_id_t
+        get_transition_id(uint32_t index) const { return ids_[index]; }
+
+        // the edges of transition @param index
+        inline const warthog::hpa::hpa_edge*
+        edges_begin(uint32_t index) const
+        { return edges_.data() + edge_begin_[index]; }
+
+        inline const warthog::hpa::hpa_edge*
+        edges_end(uint32_t index) const
+        { return edges_.data() + edge_begin_[index + 1]; }
+
+        // the cluster of padded id @param grid_id_p
+        inline uint32_t
+        get_cluster(warthog::grid_id_t grid_id_p) const
+        {
+            uint32_t x = (uint32_t)(grid_id_p % map_->width());
+            uint32_t y = (uint32_t)(grid_id_p / map_->width()) - top_;
+            return (y / cluster_size_) * clusters_per_row_ + x / cluster_size_;
+        }
+
+        // the transitions of cluster @param cluster, as indexes
+        inline const uint32_t*
+        cluster_begin(uint32_t cluster) const
+        { return cluster_nodes_.data() + cluster_begin_[cluster]; }
+
+        inline const uint32_t*
+        cluster_end(uint32_t cluster) const
+        { return cluster_nodes_.data() + cluster_begin_[cluster + 1]; }
+
+        // the unpadded coordinates of the top-left tile of @param cluster
+        inline void
+        get_cluster_origin(uint32_t cluster, uint32_t& x, uint32_t& y) const
+        {
+            x = (cluster % clusters_per_row_) * cluster_size_;
+            y = (cluster / clusters_per_row_) * cluster_size_;
+        }
+
+        // false if the map changed other than through a
+        // warthog::gridmap_edit since ::precompute
+        inline bool
+        is_current()
+        { return !edge_begin_.empty() && map_->get_version() == map_version_; }
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+        inline uint32_t
+        get_cluster_size() const { return cluster_size_; }
+
+        inline uint32_t
+        get_num_clusters() const
+        { return (uint32_t)cluster_begin_.size() - 1; }
+
+        inline bool
+        is_exact() const { return exact_; }
+
+        inline uint32_t
+        get_num_transitions() const { return (uint32_t)ids_.size(); }
+
+        inline size_t
+        get_num_edges() const { return edges_.size(); }
+
+        size_t
+        mem();
+
+        static const uint32_t NO_TRANSITION = UINT32_MAX;
+
+    private:
+        warthog::gridmap* map_;
+        uint32_t map_version_;
+        uint32_t cluster_size_;
+        uint32_t clusters_per_row_;
+        uint32_t top_;          // padded rows above the first row
+        bool exact_;
+
+        // transitions sorted by padded id, and their edges
+        std::vector<warthog::grid_id_t> ids_;
+        std::vector<uint32_t> edge_begin_;
+        std::vector<warthog::hpa::hpa_edge> edges_;
+
+        // the transitions of every cluster
+        std::vector<uint32_t> cluster_begin_;
+        std::vector<uint32_t> cluster_nodes_;
+
+        void
+        find_transitions(std::vector<std::pair<warthog::grid_id_t,
+                warthog::hpa::hpa_edge>>& crossings);
+
+        hpa_graph(const hpa_graph& other) { }
+        hpa_graph&
+        operator=(const hpa_graph& other) { return *this; }
+};
+
+// Searches inside one cluster: a Dijkstra search from one tile to every
+// tile of its cluster, and JPS2 searches between two tiles of a
+// cluster. The cluster is copied into a map of its own, which makes
+// every tile outside it an obstacle and bounds every search by the
+// size of the cluster.
+class cluster_search
+{
+    public:
+        cluster_search(warthog::hpa::hpa_graph* g);
+        ~cluster_search();
+
+        // Dijkstra search from padded id @param from. @return false if
+        // it is an obstacle
+        bool
+        run(warthog::grid_id_t from);
+
+        // the cost of the shortest path inside the cluster from the
+        // source of the last ::run to padded id @param to;
+        // warthog::COST_MAX if there is none
+        warthog::cost_t
+        dist(warthog::grid_id_t to);
+
+        // the shortest path inside the cluster of padded id @param from
+        // to padded id @param to, found with JPS2. the path is made of
+        // padded ids of the map. NO_PATH if @param to is outside the
+        // cluster or either tile is an obstacle
+        void
+        get_path(warthog::grid_id_t from, warthog::grid_id_t to,
+                warthog::solution& sol);
+
+        // as ::get_path, without the path
+        void
+        get_pathcost(warthog::grid_id_t from, warthog::grid_id_t to,
+                warthog::solution& sol);
+
+        // limits of the JPS2 searches (see warthog::search)
+        inline void
+        set_time_cutoff_nano(double cutoff)
+        { jps_->set_time_cutoff_nano(cutoff); }
+
+        inline void
+        set_cancel_token(std::atomic<bool>* token)
+        { jps_->set_cancel_token(token); }
+
+        size_t
+        mem() { return cmap_->mem() + dijkstra_->mem() + jps_->mem(); }
+
+    private:
+        warthog::hpa::hpa_graph* g_;
+        uint32_t cluster_;      // the cluster copied into cmap_
+        uint32_t version_;      // and the version of the map it was in
+        uint32_t x0_, y0_;      // its top-left tile, unpadded
+
+        warthog::gridmap* cmap_;
+        warthog::gridmap_expansion_policy* expander_;
+        warthog::zero_heuristic heuristic_;
+        warthog::pqueue_min open_;
+        warthog::flexible_astar<
+            warthog::zero_heuristic,
+            warthog::gridmap_expansion_policy,
+            warthog::pqueue_min>* dijkstra_;
+
+        warthog::octile_heuristic* octile_;
+        warthog::jps2_expansion_policy* jps_expander_;
+        warthog::pqueue_min jps_open_;
+        warthog::flexible_astar<
+            warthog::octile_heuristic,
+            warthog::jps2_expansion_policy,
+            warthog::pqueue_min>* jps_;
+
+        // copy cluster @param c into cmap_, unless it is there already
+        void
+        load(uint32_t c);
+
+        // run JPS2 from @param from to @param to, both padded ids of
+        // the map; @param path: also find the path
+        void
+        jps(warthog::grid_id_t from, warthog::grid_id_t to,
+                warthog::solution& sol, bool path);
+
+        // the padded id of cmap_ of padded id @param grid_id_p of the
+        // map; cmap_->padded_mapsize() if it is outside the cluster
+        warthog::grid_id_t
+        to_cluster_id(warthog::grid_id_t grid_id_p);
+
+        cluster_search(const cluster_search& other) { }
+        cluster_search&
+        operator=(const cluster_search& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef WARTHOG_HPA_HPA_SEARCH_H
+#define WARTHOG_HPA_HPA_SEARCH_H
+
+// hpa/hpa_search.h
+//
+// HPA* queries: a search of the abstract graph of a
+// warthog::hpa::hpa_graph (see warthog::hpa::hpa_expansion_policy)
+// finds a path of transitions, and JPS2 refines each leg of it into a
+// grid path. Every leg but the crossings between clusters stays inside
+// one cluster, and is refined on a copy of that cluster (see
+// warthog::hpa::cluster_search): a refinement search never touches
+// more than cluster_size^2 tiles, and needs no memory in proportion to
+// the map, no matter how long the query is.
+//
+// ::get_pathcost only runs the abstract search. The refined path has
+// the cost of the abstract path, which is optimal with an exact
+// abstraction.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "hpa_graph.h"
+#include "problem_instance.h"
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+
+#include <atomic>
+#include <cfloat>
+#include <cstdlib>
+
+namespace warthog
+{
+
+namespace hpa
+{
+
+class hpa_search : public warthog::search
+{
+    public:
+        // @param abstract: searches the abstract graph @param g
+        hpa_search(warthog::search* abstract, warthog::hpa::hpa_graph* g)
+            : abstract_(abstract), map_(g->get_map())
+        { refine_ = new warthog::hpa::cluster_search(g); }
+
+        virtual ~hpa_search() { delete refine_; }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            sol.reset();
+
+            warthog::solution abs_sol;
+            abstract_->get_path(pi, abs_sol);
+            add_metrics(abs_sol, sol);
+            sol.status_ = abs_sol.status_;
+            if(abs_sol.status_ != warthog::solution::FOUND ||
+               abs_sol.path_.size() == 0)
+            {
+                finish(sol, mytimer);
+                return;
+            }
+
+            sol.sum_of_edge_costs_ = 0;
+            sol.path_.push_back(abs_sol.path_.front());
+            for(uint32_t i = 1; i < abs_sol.path_.size(); i++)
+            {
+                warthog::grid_id_t from =
+                    (warthog::grid_id_t)abs_sol.path_[i-1];
+                warthog::grid_id_t to = (warthog::grid_id_t)abs_sol.path_[i];
+
+                // crossings are single steps
+                uint32_t x, y, x2, y2;
+                map_->to_padded_xy(from, x, y);
+                map_->to_padded_xy(to, x2, y2);
+                if(abs((int32_t)x - (int32_t)x2) <= 1 &&
+                   abs((int32_t)y - (int32_t)y2) <= 1 &&
+                   map_->get_label(x2, y) && map_->get_label(x, y2))
+                {
+                    sol.sum_of_edge_costs_ +=
+                        (x != x2 && y != y2) ? warthog::DBL_ROOT_TWO : 1;
+                    sol.path_.push_back(to);
+                    continue;
+                }
+
+                // each leg gets the time that is left of the query
+                double remaining = get_time_cutoff_nano();
+                if(remaining != DBL_MAX)
+                {
+                    mytimer.stop();
+                    remaining -= mytimer.elapsed_time_nano();
+                    if(remaining <= 0)
+                    {
+                        fail(sol, warthog::solution::TIMED_OUT, mytimer);
+                        return;
+                    }
+                    refine_->set_time_cutoff_nano(remaining);
+                }
+
+                warthog::solution leg_sol;
+                refine_->get_path(from, to, leg_sol);
+                add_metrics(leg_sol, sol);
+                if(leg_sol.status_ != warthog::solution::FOUND)
+                {
+                    // out of time, cancelled, or the map changed since
+                    // the abstraction was built
+                    fail(sol, leg_sol.status_, mytimer);
+                    return;
+                }
+                sol.sum_of_edge_costs_ += leg_sol.sum_of_edge_costs_;
+                sol.path_.insert(sol.path_.end(),
+                        leg_sol.path_.begin() + 1, leg_sol.path_.end());
+            }
+            finish(sol, mytimer);
+        }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            abstract_->get_pathcost(pi, sol);
+        }
+
+        virtual size_t
+        mem() { return sizeof(*this) + abstract_->mem() + refine_->mem(); }
+
+        // both searches get the limits; refinement gets whatever time
+        // the abstract search and earlier legs left over
+        virtual void
+        set_time_cutoff_nano(double cutoff)
+        {
+            warthog::search::set_time_cutoff_nano(cutoff);
+            abstract_->set_time_cutoff_nano(cutoff);
+            refine_->set_time_cutoff_nano(cutoff);
+        }
+
+        virtual void
+        set_cancel_token(std::atomic<bool>* token)
+        {
+            warthog::search::set_cancel_token(token);
+            abstract_->set_cancel_token(token);
+            refine_->set_cancel_token(token);
+        }
+
+    private:
+        warthog::search* abstract_;
+        warthog::hpa::cluster_search* refine_;
+        warthog::gridmap* map_;
+
+        inline void
+        add_metrics(warthog::solution& from, warthog::solution& to)
+        {
+            to.nodes_expanded_ += from.nodes_expanded_;
+            to.nodes_inserted_ += from.nodes_inserted_;
+            to.nodes_updated_ += from.nodes_updated_;
+            to.nodes_touched_ += from.nodes_touched_;
+            to.nodes_surplus_ += from.nodes_surplus_;
+        }
+
+        inline void
+        finish(warthog::solution& sol, warthog::timer& mytimer)
+        {
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        }
+
+        // a leg could not be refined. when interrupted, the path up to
+        // the start of the leg is kept
+        inline void
+        fail(warthog::solution& sol, warthog::solution::status status,
+                warthog::timer& mytimer)
+        {
+            sol.status_ = status;
+            if(status == warthog::solution::NO_PATH)
+            {
+                sol.path_.clear();
+                sol.sum_of_edge_costs_ = warthog::COST_MAX;
+            }
+            finish(sol, mytimer);
+        }
+};
+
+}
+
+}
+
+#endif
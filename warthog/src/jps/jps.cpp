@@ -212,9 +212,9 @@ warthog::jps::create_jump_point_graph(warthog::gridmap* gm)
         for(uint32_t i = 0; i < 8; i++)
         {
             warthog::jps::direction d = (warthog::jps::direction)(1 << i);
-            std::vector<uint32_t> jpoints;
+            std::vector<warthog::grid_id_t> jpoints;
             std::vector<double> jcosts;
-            jpl.jump(d, gm_id, warthog::INF32, jpoints, jcosts);
+            jpl.jump(d, gm_id, warthog::GRID_ID_MAX, jpoints, jcosts);
             for(uint32_t idx = 0; idx < jpoints.size(); idx++)
             {
                 uint32_t jp_id = jpoints[idx] & ((1 << 24) - 1);
@@ -1,27 +1,41 @@
 #include "jps2_expansion_policy.h"
 #include "global.h"
+#include "jps_bb_labelling.h"
+#include "trace_listener.h"
 namespace G = global;
 
-warthog::jps2_expansion_policy::jps2_expansion_policy(warthog::gridmap* map)
-    : expansion_policy(map->height() * map->width())
+template<typename MAP>
+warthog::jps2_expansion_policy_base<MAP>::jps2_expansion_policy_base(MAP* map)
+    : expansion_policy(map->padded_mapsize())
 {
 	map_ = map;
-	jpl_ = new warthog::jps::online_jump_point_locator2(map);
+	jpl_ = new warthog::jps::online_jump_point_locator2_base<MAP>(map);
 	jp_ids_.reserve(100);
+	jp_xs_.reserve(100);
+	jp_ys_.reserve(100);
+	target_x_ = target_y_ = 0;
+	tracer_ = 0;
+	bbl_ = 0;
+	cl_ = 0;
+	target_instance_ = UINT32_MAX;
 }
 
-warthog::jps2_expansion_policy::~jps2_expansion_policy()
+template<typename MAP>
+warthog::jps2_expansion_policy_base<MAP>::~jps2_expansion_policy_base()
 {
 	delete jpl_;
 }
 
+template<typename MAP>
 void 
-warthog::jps2_expansion_policy::expand(
+warthog::jps2_expansion_policy_base<MAP>::expand(
 		warthog::search_node* current, warthog::problem_instance* problem)
 {
     reset();
     jp_ids_.clear();
     jp_costs_.clear();
+    jp_xs_.clear();
+    jp_ys_.clear();
 
 #ifdef CNT
     G::statis::update_subopt_expd(current->get_id(), current->get_g());
@@ -31,28 +45,45 @@ warthog::jps2_expansion_policy::expand(
 	// compute the direction of travel used to reach the current node.
     // TODO: store this value with the jump point location so we don't need
     // to compute it all the time
-    uint32_t p_id = current->get_parent();
-    uint32_t c_id = current->get_id();
+    warthog::grid_id_t p_id = current->get_parent();
+    warthog::grid_id_t c_id = current->get_id();
+    uint32_t cx, cy;
+    map_->to_padded_xy(c_id, cx, cy);
 	warthog::jps::direction dir_c =
-	   	//this->compute_direction((uint32_t)current->get_parent(), (uint32_t)current->get_id());
-	   	this->compute_direction(p_id, c_id);
+	   	//this->compute_direction((warthog::grid_id_t)current->get_parent(), (warthog::grid_id_t)current->get_id());
+	   	this->compute_direction(p_id, (int32_t)cx, (int32_t)cy);
 
 	// get the tiles around the current node c
 	uint32_t c_tiles;
-	uint32_t current_id = (uint32_t)current->get_id();
+	warthog::grid_id_t current_id = (warthog::grid_id_t)current->get_id();
 	map_->get_neighbours(current_id, (uint8_t*)&c_tiles);
 
 	// look for jump points in the direction of each natural 
 	// and forced neighbour
 	uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
-	uint32_t goal_id = (uint32_t)problem->target_id_;
+	warthog::grid_id_t goal_id = (warthog::grid_id_t)problem->target_id_;
+	// boxes computed before the map was modified may prune optimal paths
+	if(bbl_ && bbl_->is_current() &&
+	   problem->target_id_ != warthog::SN_ID_MAX)
+	{
+		uint32_t gx, gy;
+		map_->to_padded_xy(goal_id, gx, gy);
+		succ_dirs &= bbl_->get_dirs(current_id, gx, gy);
+	}
 
 	for(uint32_t i = 0; i < 8; i++)
 	{
 		warthog::jps::direction d = (warthog::jps::direction) (1 << i);
 		if(succ_dirs & d)
 		{
-			jpl_->jump(d, current_id, goal_id, jp_ids_, jp_costs_);
+			uint32_t first = (uint32_t)jp_ids_.size();
+			jpl_->jump(d, current_id, goal_id, jp_ids_, jp_costs_,
+					jp_xs_, jp_ys_);
+			if(tracer_)
+			{
+				for(uint32_t j = first; j < jp_ids_.size(); j++)
+				{ tracer_->jump_segment(current_id, jp_ids_[j], d, jp_costs_[j]); }
+			}
 		}
 	}
 
@@ -61,10 +92,13 @@ warthog::jps2_expansion_policy::expand(
 	{
 		// bits 0-23 store the id of the jump point
 		// bits 24-31 store the direction to the parent
-		uint32_t jp_id = jp_ids_.at(i);
+		warthog::grid_id_t jp_id = jp_ids_.at(i);
     warthog::cost_t jp_cost = jp_costs_.at(i);
 		warthog::search_node* mynode = generate(jp_id);
 		add_neighbour(mynode, jp_cost);
+		// the locator gives offsets from the current node
+		jp_xs_[i] += (int32_t)cx;
+		jp_ys_[i] += (int32_t)cy;
 #ifdef CNT
     G::statis::update_subopt_touch(mynode->get_id(), current->get_g()+jp_cost);
     G::statis::sanity_checking(mynode->get_id(), current->get_g()+jp_cost);
@@ -73,56 +107,78 @@ warthog::jps2_expansion_policy::expand(
 }
 
 //void
-//warthog::jps2_expansion_policy::update_parent_direction(warthog::search_node* n)
+//warthog::jps2_expansion_policy_base<MAP>::update_parent_direction(warthog::search_node* n)
 //{
-//    uint32_t jp_id = jp_ids_.at(this->get_current_successor_index());
+//    warthog::grid_id_t jp_id = jp_ids_.at(this->get_current_successor_index());
 //    assert(n->get_id() == (jp_id & warthog::jps::JPS_ID_MASK));
 //    warthog::jps::direction pdir = 
 //        (warthog::jps::direction)*(((uint8_t*)(&jp_id))+3);
 //    n->set_pdir(pdir);
 //}
 
+template<typename MAP>
 void
-warthog::jps2_expansion_policy::get_xy(warthog::sn_id_t sn_id, int32_t& x, int32_t& y)
+warthog::jps2_expansion_policy_base<MAP>::get_xy(warthog::sn_id_t sn_id, int32_t& x, int32_t& y)
 {
-    map_->to_unpadded_xy((uint32_t)sn_id, (uint32_t&)x, (uint32_t&)y);
+    map_->to_unpadded_xy((warthog::grid_id_t)sn_id, (uint32_t&)x, (uint32_t&)y);
 }
 
+template<typename MAP>
 warthog::search_node* 
-warthog::jps2_expansion_policy::generate_start_node(
+warthog::jps2_expansion_policy_base<MAP>::generate_start_node(
         warthog::problem_instance* pi)
 { 
-    uint32_t start_id = (uint32_t)pi->start_id_;
-    uint32_t max_id = map_->header_width() * map_->header_height();
+    warthog::grid_id_t start_id = (warthog::grid_id_t)pi->start_id_;
+    warthog::grid_id_t max_id =
+        (warthog::grid_id_t)map_->header_width() * map_->header_height();
 
     if(start_id >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id(start_id);
+    warthog::grid_id_t padded_id = map_->to_padded_id(start_id);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    // no path to a target in another component
+    if(cl_ && target_instance_ == pi->instance_id_ &&
+       cl_->get_component(padded_id) != target_comp_) { return 0; }
     return generate(padded_id);
 }
 
+template<typename MAP>
 warthog::search_node*
-warthog::jps2_expansion_policy::generate_target_node(
+warthog::jps2_expansion_policy_base<MAP>::generate_target_node(
         warthog::problem_instance* pi)
 {
-    uint32_t target_id = (uint32_t)pi->target_id_;
-    uint32_t max_id = map_->header_width() * map_->header_height();
+    warthog::grid_id_t target_id = (warthog::grid_id_t)pi->target_id_;
+    warthog::grid_id_t max_id =
+        (warthog::grid_id_t)map_->header_width() * map_->header_height();
 
     if(target_id  >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id(target_id);
+    warthog::grid_id_t padded_id = map_->to_padded_id(target_id);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    uint32_t x, y;
+    map_->to_padded_xy(padded_id, x, y);
+    target_x_ = (int32_t)x;
+    target_y_ = (int32_t)y;
+
+    // checked against the start in ::generate_start_node
+    if(cl_ && cl_->is_current())
+    {
+        target_comp_ = cl_->get_component(padded_id);
+        target_instance_ = pi->instance_id_;
+    }
     return generate(padded_id);
 }
 
+template<typename MAP>
 warthog::jps::direction
-warthog::jps2_expansion_policy::compute_direction(
-        uint32_t n1_id, uint32_t n2_id)
+warthog::jps2_expansion_policy_base<MAP>::compute_direction(
+        warthog::grid_id_t n1_id, int32_t x2, int32_t y2)
 {
     if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
 
-    int32_t x, y, x2, y2;
-    warthog::helpers::index_to_xy(n1_id, map_->width(), x, y);
-    warthog::helpers::index_to_xy(n2_id, map_->width(), x2, y2);
+    uint32_t ux, uy;
+    map_->to_padded_xy(n1_id, ux, uy);
+    int32_t x = (int32_t)ux, y = (int32_t)uy;
     int32_t dx = abs(x2 - x);
     int32_t dy = abs(y2 - y);
 
@@ -139,3 +195,7 @@ warthog::jps2_expansion_policy::compute_direction(
 
     return warthog::jps::NORTH;
 }
+
+template class warthog::jps2_expansion_policy_base<warthog::gridmap>;
+template class warthog::jps2_expansion_policy_base<warthog::blockmap>;
+template class warthog::jps2_expansion_policy_base<warthog::rle_gridmap>;
@@ -11,8 +11,12 @@
 // @author: dharabor
 // @created: 06/01/2010
 
+#include "blockmap.h"
+#include "component_labelling.h"
 #include "expansion_policy.h"
+#include "forward.h"
 #include "gridmap.h"
+#include "rle_gridmap.h"
 #include "helpers.h"
 #include "jps.h"
 #include "online_jump_point_locator2.h"
@@ -24,11 +28,12 @@
 namespace warthog
 {
 
-class jps2_expansion_policy : public expansion_policy
+template<typename MAP>
+class jps2_expansion_policy_base : public expansion_policy
 {
 	public:
-		jps2_expansion_policy(warthog::gridmap* map);
-		virtual ~jps2_expansion_policy();
+		jps2_expansion_policy_base(MAP* map);
+		virtual ~jps2_expansion_policy_base();
 
 		virtual void 
 		expand(warthog::search_node*, warthog::problem_instance*);
@@ -51,8 +56,8 @@ class jps2_expansion_policy : public expansion_policy
 
         // set loc to be empty(empty=true) or blocked(empty=false)
         inline void perturbation(sn_id_t loc, bool empty) {
-          warthog::gridmap* mapptr = jpl_->get_map();
-          warthog::gridmap* rmapptr = jpl_->get_rmap();
+          MAP* mapptr = jpl_->get_map();
+          MAP* rmapptr = jpl_->get_rmap();
           mapptr->set_label(loc, empty);
           // map id to rmap id
           uint32_t x, y, rx, ry;
@@ -60,7 +65,42 @@ class jps2_expansion_policy : public expansion_policy
           ry = x, rx = mapptr->header_height() - y - 1;
           sn_id_t rloc = rmapptr->to_padded_id(rx, ry);
           rmapptr->set_label(rloc, empty);
+          if(cl_) { cl_->set_label(loc, empty); }
         }
+        // report every jump segment found by the locator to @param tracer
+        // (pass 0 to disable)
+        inline void
+        set_trace_listener(warthog::trace_listener* tracer)
+        { tracer_ = tracer; }
+
+        // skip jumps in directions whose bounding box (see
+        // warthog::label::jps_bb_labelling) does not contain the target
+        // (pass 0 to disable). ignored once the map has been modified
+        inline void
+        set_bb_labelling(warthog::label::jps_bb_labelling* bbl)
+        { bbl_ = bbl; }
+
+        // fail at once on queries whose start and target are in
+        // different components (pass 0 to disable). ::perturbation
+        // keeps the labels up to date
+        inline void
+        set_component_labelling(warthog::label::component_labelling* cl)
+        { cl_ = cl; }
+
+        // the padded (x, y) of the successors of the last expansion, in
+        // the order they were added, and of the target of the current
+        // query; lets a heuristic skip turning ids into coordinates (see
+        // warthog::flexible_astar)
+        inline void
+        get_successor_xy(const int32_t*& xs, const int32_t*& ys,
+                int32_t& target_x, int32_t& target_y)
+        {
+            xs = jp_xs_.data();
+            ys = jp_ys_.data();
+            target_x = target_x_;
+            target_y = target_y_;
+        }
+
         // this function gets called whenever a successor node is relaxed. at that
         // point we set the node currently being expanded (==current) as the 
         // parent of n and label node n with the direction of travel, 
@@ -69,19 +109,39 @@ class jps2_expansion_policy : public expansion_policy
         //update_parent_direction(warthog::search_node* n);
 
 	private:
-		warthog::gridmap* map_;
-        warthog::jps::online_jump_point_locator2* jpl_;
-		std::vector<uint32_t> jp_ids_;
+		MAP* map_;
+        warthog::jps::online_jump_point_locator2_base<MAP>* jpl_;
+		std::vector<warthog::grid_id_t> jp_ids_;
         std::vector<warthog::cost_t> jp_costs_;
+        std::vector<int32_t> jp_xs_;
+        std::vector<int32_t> jp_ys_;
+        int32_t target_x_, target_y_;
+        warthog::trace_listener* tracer_;
+        warthog::label::jps_bb_labelling* bbl_;
+        warthog::label::component_labelling* cl_;
+
+        // the component of the last target, and its problem instance
+        uint32_t target_comp_;
+        uint32_t target_instance_;
 
 		// computes the direction of travel; from a node n1
-		// to a node n2.
+		// to a node n2 at (@param x2, @param y2).
         // NB: since JPS2 prunes intermediate diagonals the parent
         // directions are always cardinal.
 		inline warthog::jps::direction
-		compute_direction(uint32_t n1_id, uint32_t n2_id);
+		compute_direction(warthog::grid_id_t n1_id, int32_t x2, int32_t y2);
 };
 
+typedef jps2_expansion_policy_base<warthog::gridmap> jps2_expansion_policy;
+
+// JPS2 on very large maps; see warthog::blockmap
+typedef jps2_expansion_policy_base<warthog::blockmap>
+    blocked_jps2_expansion_policy;
+
+// JPS2 with run-skipping straight jumps; see warthog::rle_gridmap
+typedef jps2_expansion_policy_base<warthog::rle_gridmap>
+    rle_jps2_expansion_policy;
+
 }
 
 #endif
@@ -2,62 +2,85 @@
 #include "constants.h"
 #include "forward.h"
 #include "global.h"
+#include "jps_bb_labelling.h"
+#include "trace_listener.h"
 namespace G = global;
 
-typedef warthog::jps2_expansion_policy_prune2 jps2_exp_prune2;
-
-jps2_exp_prune2::jps2_expansion_policy_prune2(warthog::gridmap* map)
-  : expansion_policy(map->height() * map->width())
+template<typename MAP>
+warthog::jps2_expansion_policy_prune2_base<MAP>::jps2_expansion_policy_prune2_base(MAP* map)
+  : expansion_policy(map->padded_mapsize())
 {
 	map_ = map;
-	jpl_ = new warthog::online_jump_point_locator2_prune2(map, &jpruner);
+	jpl_ = new warthog::online_jump_point_locator2_prune2_base<MAP>(map, &jpruner);
   jpl_->init_tables();
 	reset();
   costs_.clear();
   jp_ids_.clear();
 	costs_.reserve(100);
 	jp_ids_.reserve(100);
+  tracer_ = 0;
+  bbl_ = 0;
+  cl_ = 0;
+  target_instance_ = UINT32_MAX;
 }
 
-jps2_exp_prune2::~jps2_expansion_policy_prune2()
+template<typename MAP>
+warthog::jps2_expansion_policy_prune2_base<MAP>::~jps2_expansion_policy_prune2_base()
 {
 	delete jpl_;
 }
 
+template<typename MAP>
 void
-warthog::jps2_expansion_policy_prune2::get_xy(warthog::sn_id_t sn_id, int32_t& x, int32_t& y)
+warthog::jps2_expansion_policy_prune2_base<MAP>::get_xy(warthog::sn_id_t sn_id, int32_t& x, int32_t& y)
 {
-    map_->to_unpadded_xy((uint32_t)sn_id, (uint32_t&)x, (uint32_t&)y);
+    map_->to_unpadded_xy((warthog::grid_id_t)sn_id, (uint32_t&)x, (uint32_t&)y);
 }
 
+template<typename MAP>
 warthog::search_node* 
-warthog::jps2_expansion_policy_prune2::generate_start_node(
+warthog::jps2_expansion_policy_prune2_base<MAP>::generate_start_node(
         warthog::problem_instance* pi)
 { 
-    uint32_t start_id = (uint32_t)pi->start_id_;
-    uint32_t max_id = map_->header_width() * map_->header_height();
+    warthog::grid_id_t start_id = (warthog::grid_id_t)pi->start_id_;
+    warthog::grid_id_t max_id =
+        (warthog::grid_id_t)map_->header_width() * map_->header_height();
 
     if(start_id >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id(start_id);
+    warthog::grid_id_t padded_id = map_->to_padded_id(start_id);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    // no path to a target in another component
+    if(cl_ && target_instance_ == pi->instance_id_ &&
+       cl_->get_component(padded_id) != target_comp_) { return 0; }
     return generate(padded_id);
 }
 
+template<typename MAP>
 warthog::search_node*
-warthog::jps2_expansion_policy_prune2::generate_target_node(
+warthog::jps2_expansion_policy_prune2_base<MAP>::generate_target_node(
         warthog::problem_instance* pi)
 {
-    uint32_t target_id = (uint32_t)pi->target_id_;
-    uint32_t max_id = map_->header_width() * map_->header_height();
+    warthog::grid_id_t target_id = (warthog::grid_id_t)pi->target_id_;
+    warthog::grid_id_t max_id =
+        (warthog::grid_id_t)map_->header_width() * map_->header_height();
 
     if(target_id  >= max_id) { return 0; }
-    uint32_t padded_id = map_->to_padded_id(target_id);
+    warthog::grid_id_t padded_id = map_->to_padded_id(target_id);
     if(map_->get_label(padded_id) == 0) { return 0; }
+
+    // checked against the start in ::generate_start_node
+    if(cl_ && cl_->is_current())
+    {
+        target_comp_ = cl_->get_component(padded_id);
+        target_instance_ = pi->instance_id_;
+    }
     return generate(padded_id);
 }
 
+template<typename MAP>
 void 
-jps2_exp_prune2::expand(
+warthog::jps2_expansion_policy_prune2_base<MAP>::expand(
 		warthog::search_node* current, warthog::problem_instance* problem)
 {
 	reset();
@@ -78,20 +101,34 @@ jps2_exp_prune2::expand(
 
 	// get the tiles around the current node c
 	uint32_t c_tiles;
-	uint32_t current_id = current->get_id();
+	warthog::grid_id_t current_id = current->get_id();
 	map_->get_neighbours(current_id, (uint8_t*)&c_tiles);
 
 	// look for jump points in the direction of each natural 
 	// and forced neighbour
 	uint32_t succ_dirs = warthog::jps::compute_successors(dir_c, c_tiles);
-	uint32_t goal_id = problem->target_id_;
+	warthog::grid_id_t goal_id = problem->target_id_;
+  // boxes computed before the map was modified may prune optimal paths
+  if(bbl_ && bbl_->is_current() &&
+     problem->target_id_ != warthog::SN_ID_MAX)
+  {
+    uint32_t gx, gy;
+    map_->to_padded_xy(goal_id, gx, gy);
+    succ_dirs &= bbl_->get_dirs(current_id, gx, gy);
+  }
 
 	for(uint32_t i = 0; i < 8; i++)
 	{
 		warthog::jps::direction d = (warthog::jps::direction) (1 << i);
 		if(succ_dirs & d)
 		{
+      uint32_t first = (uint32_t)jp_ids_.size();
 			jpl_->jump(d, current_id, goal_id, jp_ids_, costs_);
+      if(tracer_)
+      {
+        for(uint32_t j = first; j < jp_ids_.size(); j++)
+        { tracer_->jump_segment(current_id, jp_ids_[j], d, costs_[j]); }
+      }
 		}
 	}
 
@@ -99,7 +136,7 @@ jps2_exp_prune2::expand(
 	{
 		// bits 0-23 store the id of the jump point
 		// bits 24-31 store the direction to the parent
-		uint32_t jp_id = jp_ids_.at(i);
+		warthog::grid_id_t jp_id = jp_ids_.at(i);
 		warthog::search_node* mynode = generate(jp_id);
     add_neighbour(mynode, costs_.at(i));
 
@@ -109,3 +146,6 @@ jps2_exp_prune2::expand(
 #endif
 	}
 }
+
+template class warthog::jps2_expansion_policy_prune2_base<warthog::gridmap>;
+template class warthog::jps2_expansion_policy_prune2_base<warthog::blockmap>;
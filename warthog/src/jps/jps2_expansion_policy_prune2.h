@@ -4,7 +4,10 @@
 // @author: shizhe
 // @created: 30/06/2021
 
+#include "forward.h"
 #include "node_pool.h"
+#include "blockmap.h"
+#include "component_labelling.h"
 #include "gridmap.h"
 #include "helpers.h"
 #include "jps.h"
@@ -19,11 +22,12 @@
 namespace warthog
 {
 
-class jps2_expansion_policy_prune2: public expansion_policy
+template<typename MAP>
+class jps2_expansion_policy_prune2_base: public expansion_policy
 {
 	public:
-		jps2_expansion_policy_prune2(warthog::gridmap* map);
-		~jps2_expansion_policy_prune2();
+		jps2_expansion_policy_prune2_base(MAP* map);
+		~jps2_expansion_policy_prune2_base();
 
 		virtual void 
 		expand(warthog::search_node*, warthog::problem_instance*);
@@ -44,7 +48,7 @@ class jps2_expansion_policy_prune2: public expansion_policy
     virtual warthog::search_node*
     generate_target_node(warthog::problem_instance* pi);
 
-    warthog::online_jump_point_locator2_prune2* get_locator() {
+    warthog::online_jump_point_locator2_prune2_base<MAP>* get_locator() {
       return this->jpl_;
     }
 
@@ -52,10 +56,28 @@ class jps2_expansion_policy_prune2: public expansion_policy
       this->jpl_->init_tables();
     }
 
+    // report every jump segment found by the locator to @param tracer
+    // (pass 0 to disable)
+    inline void
+    set_trace_listener(warthog::trace_listener* tracer) { tracer_ = tracer; }
+
+    // skip jumps in directions whose bounding box (see
+    // warthog::label::jps_bb_labelling) does not contain the target
+    // (pass 0 to disable). ignored once the map has been modified
+    inline void
+    set_bb_labelling(warthog::label::jps_bb_labelling* bbl) { bbl_ = bbl; }
+
+    // fail at once on queries whose start and target are in different
+    // components (pass 0 to disable). ::perturbation keeps the labels
+    // up to date
+    inline void
+    set_component_labelling(warthog::label::component_labelling* cl)
+    { cl_ = cl; }
+
     // set loc to be empty(empty=true) or blocked(empty=false)
     inline void perturbation(sn_id_t loc, bool empty) {
-      warthog::gridmap* mapptr = jpl_->get_map();
-      warthog::gridmap* rmapptr = jpl_->get_rmap();
+      MAP* mapptr = jpl_->get_map();
+      MAP* rmapptr = jpl_->get_rmap();
       mapptr->set_label(loc, empty);
       // map id to rmap id
       uint32_t x, y, rx, ry;
@@ -63,17 +85,25 @@ class jps2_expansion_policy_prune2: public expansion_policy
       ry = x, rx = mapptr->header_height() - y - 1;
       sn_id_t rloc = rmapptr->to_padded_id(rx, ry);
       rmapptr->set_label(rloc, empty);
+      if(cl_) { cl_->set_label(loc, empty); }
     }
 
 	private:
-		warthog::gridmap* map_;
-		online_jump_point_locator2_prune2* jpl_;
+		MAP* map_;
+		online_jump_point_locator2_prune2_base<MAP>* jpl_;
 		std::vector<warthog::cost_t> costs_;
-		std::vector<uint32_t> jp_ids_;
+		std::vector<warthog::grid_id_t> jp_ids_;
     online_jps_pruner2 jpruner;
+    warthog::trace_listener* tracer_;
+    warthog::label::jps_bb_labelling* bbl_;
+    warthog::label::component_labelling* cl_;
+
+    // the component of the last target, and its problem instance
+    uint32_t target_comp_;
+    uint32_t target_instance_;
 
     inline warthog::jps::direction compute_direction (
-            uint32_t n1_id, uint32_t n2_id)
+            warthog::grid_id_t n1_id, warthog::grid_id_t n2_id)
     {
         if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
 
@@ -98,4 +128,9 @@ class jps2_expansion_policy_prune2: public expansion_policy
     }
 };
 
+typedef jps2_expansion_policy_prune2_base<warthog::gridmap>
+    jps2_expansion_policy_prune2;
+typedef jps2_expansion_policy_prune2_base<warthog::blockmap>
+    blocked_jps2_expansion_policy_prune2;
+
 }
@@ -1,10 +1,11 @@
 #include "jps2plus_expansion_policy.h"
 
-warthog::jps2plus_expansion_policy::jps2plus_expansion_policy(warthog::gridmap* map)
-    : expansion_policy(map->height() * map->width())
+warthog::jps2plus_expansion_policy::jps2plus_expansion_policy(
+        warthog::gridmap* map, bool compact)
+    : expansion_policy(map->padded_mapsize())
 {
 	map_ = map;
-	jpl_ = new warthog::offline_jump_point_locator2(map);
+	jpl_ = new warthog::offline_jump_point_locator2(map, compact);
 
 	costs_.reserve(100);
 	jp_ids_.reserve(100);
@@ -26,7 +27,8 @@ warthog::jps2plus_expansion_policy::expand(
 
 	// compute the direction of travel used to reach the current node.
 	warthog::jps::direction dir_c = this->compute_direction(
-            (uint32_t)current->get_parent(), (uint32_t)current->get_id());
+            (warthog::grid_id_t)current->get_parent(),
+            (warthog::grid_id_t)current->get_id());
 
 	// get the tiles around the current node c
 	uint32_t c_tiles;
@@ -92,43 +94,26 @@ warthog::jps2plus_expansion_policy::generate_target_node(
 
 warthog::jps::direction
 warthog::jps2plus_expansion_policy::compute_direction(
-        uint32_t n1_id, uint32_t n2_id)
+        warthog::grid_id_t n1_id, warthog::grid_id_t n2_id)
 {
     if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
 
     int32_t x, y, x2, y2;
     warthog::helpers::index_to_xy(n1_id, map_->width(), x, y);
     warthog::helpers::index_to_xy(n2_id, map_->width(), x2, y2);
-    warthog::jps::direction dir = warthog::jps::NONE;
-    if(y2 == y)
+    int32_t dx = abs(x2 - x);
+    int32_t dy = abs(y2 - y);
+
+    if(dx > dy)
     {
         if(x2 > x)
-            dir = warthog::jps::EAST;
-        else
-            dir = warthog::jps::WEST;
-    }
-    else if(y2 < y)
-    {
-        if(x2 == x)
-            dir = warthog::jps::NORTH;
-        else if(x2 < x)
-            //dir = warthog::jps::NORTHWEST;
-            dir = warthog::jps::WEST;
-        else // x2 > x
-            //dir = warthog::jps::NORTHEAST;
-            dir = warthog::jps::EAST;
-    }
-    else // y2 > y 
-    {
-        if(x2 == x)
-            dir = warthog::jps::SOUTH;
-        else if(x2 < x)
-            //dir = warthog::jps::SOUTHWEST;
-            dir = warthog::jps::WEST;
-        else // x2 > x
-            //dir = warthog::jps::SOUTHEAST;
-            dir = warthog::jps::EAST;
+        { return warthog::jps::EAST; }
+
+        return warthog::jps::WEST;
     }
-    assert(dir != warthog::jps::NONE);
-    return dir;
+
+    if(y2 > y) 
+    { return warthog::jps::SOUTH; }
+
+    return warthog::jps::NORTH;
 }
@@ -25,7 +25,9 @@ namespace warthog
 class jps2plus_expansion_policy : public expansion_policy
 {
 	public:
-		jps2plus_expansion_policy(warthog::gridmap* map);
+		// @param compact: keep jump tables in 8 bits per entry (see
+		// warthog::offline_jump_point_locator2)
+		jps2plus_expansion_policy(warthog::gridmap* map, bool compact = false);
 		virtual ~jps2plus_expansion_policy();
 
 		virtual void 
@@ -60,7 +62,7 @@ class jps2plus_expansion_policy : public expansion_policy
         // NB: since JPS2 prunes intermediate diagonals the parent
         // directions are always cardinal.
 		inline warthog::jps::direction
-		compute_direction(uint32_t n1_id, uint32_t n2_id);
+		compute_direction(warthog::grid_id_t n1_id, warthog::grid_id_t n2_id);
 };
 
 }
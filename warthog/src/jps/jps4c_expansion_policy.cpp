@@ -1,7 +1,7 @@
 #include "jps4c_expansion_policy.h"
 
 warthog::jps4c_expansion_policy::jps4c_expansion_policy(warthog::gridmap* map)
-    : expansion_policy(map->height()*map->width())
+    : expansion_policy(map->padded_mapsize())
 {
 	map_ = map;
 	jpl_ = new warthog::four_connected_jps_locator(map);
@@ -20,7 +20,7 @@ warthog::jps4c_expansion_policy::expand(
 	reset();
 
 	uint32_t current_id = (uint32_t)current->get_id();
-    uint32_t parent_id = (uint32_t)current->get_parent();
+    warthog::grid_id_t parent_id = (warthog::grid_id_t)current->get_parent();
 	uint32_t goal_id = (uint32_t)problem->target_id_;
 
 	// compute the direction of travel used to reach the current node.
@@ -86,7 +86,7 @@ warthog::jps4c_expansion_policy::generate_target_node(
 
 warthog::jps::direction
 warthog::jps4c_expansion_policy::compute_direction(
-        uint32_t n1_id, uint32_t n2_id)
+        warthog::grid_id_t n1_id, warthog::grid_id_t n2_id)
 {
     if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
 
@@ -53,7 +53,7 @@ class jps4c_expansion_policy : public expansion_policy
 		warthog::four_connected_jps_locator* jpl_;
 
         warthog::jps::direction
-        compute_direction(uint32_t n1_id, uint32_t n2_id);
+        compute_direction(warthog::grid_id_t n1_id, warthog::grid_id_t n2_id);
 };
 
 }
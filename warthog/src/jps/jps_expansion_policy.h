@@ -18,6 +18,7 @@
 // @author: dharabor
 // @created: 06/01/2010
 
+#include "component_labelling.h"
 #include "expansion_policy.h"
 #include "gridmap.h"
 #include "helpers.h"
@@ -56,14 +57,25 @@ class jps_expansion_policy : public expansion_policy
                 sizeof(*this) + map_->mem() + jpl_->mem();
 		}
 
+        // fail at once on queries whose start and target are in
+        // different components (pass 0 to disable)
+        inline void
+        set_component_labelling(warthog::label::component_labelling* cl)
+        { cl_ = cl; }
+
 	private:
 		warthog::gridmap* map_;
 		warthog::online_jump_point_locator* jpl_;
+        warthog::label::component_labelling* cl_;
+
+        // the component of the last target, and its problem instance
+        uint32_t target_comp_;
+        uint32_t target_instance_;
 
 		// computes the direction of travel; from a node n1
 		// to a node n2.
 		inline warthog::jps::direction
-		compute_direction(uint32_t n1_id, uint32_t n2_id);
+		compute_direction(warthog::grid_id_t n1_id, warthog::grid_id_t n2_id);
 };
 
 }
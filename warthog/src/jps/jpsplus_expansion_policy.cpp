@@ -1,7 +1,7 @@
 #include "jpsplus_expansion_policy.h"
 
 warthog::jpsplus_expansion_policy::jpsplus_expansion_policy(warthog::gridmap* map)
-    : expansion_policy(map->width() * map->height())
+    : expansion_policy(map->padded_mapsize())
 {
 	map_ = map;
 	jpl_ = new warthog::offline_jump_point_locator(map);
@@ -20,7 +20,8 @@ warthog::jpsplus_expansion_policy::expand(
 
 	// compute the direction of travel used to reach the current node.
 	warthog::jps::direction dir_c = this->compute_direction(
-            (uint32_t)current->get_parent(), (uint32_t)current->get_id());
+            (warthog::grid_id_t)current->get_parent(),
+            (warthog::grid_id_t)current->get_id());
 
 	// get the tiles around the current node c
 	uint32_t c_tiles;
@@ -59,7 +59,7 @@ class jpsplus_expansion_policy : public expansion_policy
 		// computes the direction of travel; from a node n1
 		// to a node n2.
 		inline warthog::jps::direction
-		compute_direction(uint32_t n1_id, uint32_t n2_id)
+		compute_direction(warthog::grid_id_t n1_id, warthog::grid_id_t n2_id)
 		{
 			if(n1_id == warthog::GRID_ID_MAX) { return warthog::jps::NONE; }
 
@@ -11,13 +11,22 @@ warthog::offline_jump_point_locator::offline_jump_point_locator(
 		warthog::gridmap* map) : map_(map)
 {
 	preproc();
+	map_->add_index(this);
 }
 
 warthog::offline_jump_point_locator::~offline_jump_point_locator()
 {
+	map_->remove_index(this);
 	delete [] db_;
 }
 
+void
+warthog::offline_jump_point_locator::repair(
+		warthog::gridmap* map, const warthog::gridmap_change& change)
+{
+	compute();
+}
+
 void
 warthog::offline_jump_point_locator::preproc()
 {
@@ -25,6 +34,13 @@ warthog::offline_jump_point_locator::preproc()
 
 	dbsize_ = 8*map_->padded_mapsize();
 	db_ = new uint16_t[dbsize_];
+	compute();
+	save(map_->filename());
+}
+
+void
+warthog::offline_jump_point_locator::compute()
+{
 	for(uint32_t i=0; i < dbsize_; i++) db_[i] = 0;
 
 	warthog::online_jump_point_locator jpl(map_);
@@ -39,10 +55,10 @@ warthog::offline_jump_point_locator::preproc()
 				warthog::jps::direction dir = 
 					(warthog::jps::direction)(1 << i);
 //				std::cout << dir << ": ";
-				uint32_t jumpnode_id;
+				warthog::grid_id_t jumpnode_id;
 				double jumpcost;
 				jpl.jump(dir, mapid,
-						warthog::INF32, jumpnode_id, jumpcost);
+						warthog::GRID_ID_MAX, jumpnode_id, jumpcost);
 				
 				// convert from cost to number of steps
 				if(dir > 8)
@@ -53,7 +69,7 @@ warthog::offline_jump_point_locator::preproc()
 //				std::cout << (jumpnode_id == warthog::INF ? 0 : num_steps) << " ";
 
 				// set the leading bit if the jump leads to a dead-end
-				if(jumpnode_id == warthog::INF32)
+				if(jumpnode_id == warthog::GRID_ID_MAX)
 				{
 					db_[mapid*8 + i] |= 32768;
 				}
@@ -76,8 +92,6 @@ warthog::offline_jump_point_locator::preproc()
 //			std::cout << std::endl;
 		}
 	}
-
-	save(map_->filename());
 }
 
 
@@ -10,22 +10,28 @@
 // @created: 05/05/2013
 //
 
+#include "gridmap_edit.h"
 #include "jps.h"
 
 namespace warthog
 {
 
 class gridmap;
-class offline_jump_point_locator
+class offline_jump_point_locator : public warthog::gridmap_index
 {
 	public:
 		offline_jump_point_locator(warthog::gridmap* map);
-		~offline_jump_point_locator();
+		virtual ~offline_jump_point_locator();
 
 		void
 		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
 				uint32_t& jumpnode_id, double& jumpcost);
 
+		// recompute the jump table after the map is edited (see
+		// warthog::gridmap_edit). NB: every entry is recomputed
+		virtual void
+		repair(warthog::gridmap* map, const warthog::gridmap_change& change);
+
 		uint32_t
 		mem()
 		{
@@ -38,6 +44,10 @@ class offline_jump_point_locator
 		void
 		preproc();
 
+		// fill the jump table from the current map
+		void
+		compute();
+
 		bool
 		load(const char* filename);
 
@@ -1,140 +1,625 @@
 #define __STDC_FORMAT_MACROS
 #include "gridmap.h"
-#include "online_jump_point_locator.h"
+#include "helpers.h"
 #include "offline_jump_point_locator2.h"
 
+#include <algorithm>
 #include <assert.h>
+#include <atomic>
+#include <climits>
 #include <cstring>
+#include <fstream>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// file layout: a header and then, starting at offset jt_header::table_offset_,
+// the 8 entries of every padded id of the map
+static const char JT_MAGIC[4] = { 'W', 'J', 'P', 'T' };
+static const uint32_t JT_VERSION = 1;
+
+// written as is; reads back differently on a machine of the other
+// byte order
+static const uint32_t JT_BYTE_ORDER = 0x01020304;
+
+struct jt_header
+{
+	char magic_[4];
+	uint32_t version_;
+	uint32_t byte_order_;
+	uint32_t entry_bytes_;
+	uint32_t padded_width_;
+	uint32_t padded_height_;
+	uint64_t map_hash_;
+	uint64_t table_offset_;
+	uint64_t num_entries_;
+};
+
+namespace
+{
+
+// the jump table holds, for every tile and direction, the number of steps
+// to the next jump point, or to the last tile before a dead-end (with the
+// leading bit set). jumps are computed with the rules of
+// warthog::online_jump_point_locator, so the two always agree, but
+// all at once: the jump from a tile follows from the jump from its
+// successor in the same direction, so every row, column and diagonal is
+// filled in one pass that starts at its far end.
+
+const uint16_t JT_DEADEND = 32768;
+const uint16_t JT_STEPS = 32767;
+
+// the offsets of the successor of a tile in each direction, in the order
+// of the entries of the table (see warthog::jps::direction)
+const int32_t JT_DX[8] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+const int32_t JT_DY[8] = { -1, 1, 0, 0, -1, -1, 1, 1 };
+
+struct jt_shared_data
+{
+	jt_shared_data() : overflow_(false) { }
+
+	warthog::gridmap* map_;
+	uint16_t* db_;
+	uint32_t top_;				// padded rows above the first row
+	bool diagonal_;				// straight or diagonal directions
+	uint32_t line_begin_[5];	// the first line of every direction
+	uint32_t num_lines_;
+	std::atomic<bool> overflow_;
+};
+
+// traversability of unpadded (x, y); tiles outside the map are obstacles
+inline bool
+jt_label(const jt_shared_data& sh, int32_t x, int32_t y)
+{
+	if(x < 0 || y < 0 || x >= (int32_t)sh.map_->header_width() ||
+			y >= (int32_t)sh.map_->header_height())
+	{ return false; }
+	return sh.map_->get_label((uint32_t)x, (uint32_t)y + sh.top_);
+}
+
+inline uint16_t&
+jt_entry(const jt_shared_data& sh, int32_t x, int32_t y, uint32_t d)
+{
+	return sh.db_[8 * sh.map_->to_padded_id((uint32_t)x, (uint32_t)y) + d];
+}
+
+// the entry of unpadded (x, y) in direction @param d, where obstacles
+// (and tiles outside the map) are dead-ends
+inline uint16_t
+jt_get(const jt_shared_data& sh, int32_t x, int32_t y, uint32_t d)
+{
+	if(!jt_label(sh, x, y)) { return JT_DEADEND; }
+	return jt_entry(sh, x, y, d);
+}
+
+// one more step than @param label
+inline uint16_t
+jt_step(jt_shared_data& sh, uint16_t label)
+{
+	if((label & JT_STEPS) == JT_STEPS) { sh.overflow_ = true; return label; }
+	return label + 1;
+}
+
+// the entry of unpadded (x, y) in straight direction @param d (0-3),
+// given the entry of its successor @param next. a jump from a tile
+// stops at its successor q if q is an obstacle (a dead-end), or if q
+// has a forced neighbour: a tile beside q that is traversable while the
+// tile behind it (beside the jump tile) is not
+inline uint16_t
+jt_straight(jt_shared_data& sh, uint32_t d, int32_t x, int32_t y,
+		uint16_t next)
+{
+	if(!jt_label(sh, x, y)) { return JT_DEADEND; }
+
+	int32_t dx = JT_DX[d], dy = JT_DY[d];
+	int32_t sx = dy, sy = dx;	// one side of the line of travel
+	int32_t qx = x + dx, qy = y + dy;
+	if(!jt_label(sh, qx, qy)) { return JT_DEADEND; }
+	if((jt_label(sh, qx + sx, qy + sy) && !jt_label(sh, x + sx, y + sy)) ||
+	   (jt_label(sh, qx - sx, qy - sy) && !jt_label(sh, x - sx, y - sy)))
+	{ return 1; }
+	return jt_step(sh, next);
+}
+
+// the jump from unpadded (x, y) in diagonal direction @param d (4-7),
+// ignoring its first step, given that of its successor @param next. it
+// stops at the successor q if a straight jump from q, in one of the two
+// directions the diagonal is made of, reaches a jump point, or if q
+// cannot step in both of those directions (a dead-end). @param ends is
+// set if the jump stops at q, i.e. does not depend on @param next
+inline uint16_t
+jt_diagonal(jt_shared_data& sh, uint32_t d, int32_t x, int32_t y,
+		uint16_t next, bool& ends)
+{
+	int32_t qx = x + JT_DX[d], qy = y + JT_DY[d];
+	uint16_t vert = jt_get(sh, qx, qy, JT_DY[d] < 0 ? 0 : 1);
+	uint16_t horz = jt_get(sh, qx, qy, JT_DX[d] > 0 ? 2 : 3);
+	ends = true;
+	if(!(vert & JT_DEADEND) || !(horz & JT_DEADEND)) { return 1; }
+	if(!(vert & JT_STEPS) || !(horz & JT_STEPS)) { return JT_DEADEND | 1; }
+	ends = false;
+	return jt_step(sh, next);
+}
+
+// a jump from unpadded (x, y) in diagonal direction @param d first
+// needs a valid diagonal step (no corner cutting)
+inline bool
+jt_diagonal_step(jt_shared_data& sh, uint32_t d, int32_t x, int32_t y)
+{
+	int32_t qx = x + JT_DX[d], qy = y + JT_DY[d];
+	return jt_label(sh, x, y) && jt_label(sh, qx, y) &&
+		jt_label(sh, x, qy) && jt_label(sh, qx, qy);
+}
+
+inline bool
+jt_inside(jt_shared_data& sh, int32_t x, int32_t y)
+{
+	return x >= 0 && y >= 0 && x < (int32_t)sh.map_->header_width() &&
+		y < (int32_t)sh.map_->header_height();
+}
+
+// fill straight direction @param d (0-3) for the tiles of row or column
+// @param line, walking against the direction of travel
+void
+sweep_straight(jt_shared_data& sh, uint32_t d, uint32_t line)
+{
+	int32_t dx = JT_DX[d], dy = JT_DY[d];
+	int32_t w = (int32_t)sh.map_->header_width();
+	int32_t h = (int32_t)sh.map_->header_height();
+	int32_t x, y;
+	if(dx) { y = (int32_t)line; x = dx > 0 ? w - 1 : 0; }
+	else { x = (int32_t)line; y = dy > 0 ? h - 1 : 0; }
+
+	uint16_t next = JT_DEADEND;
+	for( ; jt_inside(sh, x, y); x -= dx, y -= dy)
+	{
+		next = jt_straight(sh, d, x, y, next);
+		jt_entry(sh, x, y, d) = next;
+	}
+}
+
+// fill diagonal direction @param d (4-7) for the tiles of diagonal line
+// @param line, walking against the direction of travel
+void
+sweep_diagonal(jt_shared_data& sh, uint32_t d, uint32_t line)
+{
+	int32_t dx = JT_DX[d], dy = JT_DY[d];
+	int32_t w = (int32_t)sh.map_->header_width();
+	int32_t h = (int32_t)sh.map_->header_height();
+
+	// lines start on the row, or else the column, that jumps leave by
+	int32_t x, y;
+	if(line < (uint32_t)w)
+	{
+		x = (int32_t)line;
+		y = dy < 0 ? 0 : h - 1;
+	}
+	else
+	{
+		x = dx > 0 ? w - 1 : 0;
+		y = (int32_t)line - w + (dy < 0 ? 1 : 0);
+	}
+
+	// the jump from the successor, ignoring its first step
+	uint16_t next = JT_DEADEND;
+	bool ends;
+	for( ; jt_inside(sh, x, y); x -= dx, y -= dy)
+	{
+		next = jt_diagonal(sh, d, x, y, next, ends);
+		jt_entry(sh, x, y, d) =
+			jt_diagonal_step(sh, d, x, y) ? next : JT_DEADEND;
+	}
+}
+
+// refill straight direction @param d from unpadded (x, y), walking
+// against the direction of travel. the first @param count tiles are
+// always refilled; after that the walk stops at the first entry that
+// does not change, since the entries before it cannot change either.
+// the tiles whose entries changed are added to @param changed
+void
+repair_straight(jt_shared_data& sh, uint32_t d, int32_t x, int32_t y,
+		int32_t count, std::vector<std::pair<int32_t, int32_t>>& changed)
+{
+	int32_t dx = JT_DX[d], dy = JT_DY[d];
+	uint16_t next = jt_get(sh, x + dx, y + dy, d);
+	for( ; jt_inside(sh, x, y); x -= dx, y -= dy, count--)
+	{
+		uint16_t label = jt_straight(sh, d, x, y, next);
+		uint16_t& entry = jt_entry(sh, x, y, d);
+		if(label != entry)
+		{
+			entry = label;
+			changed.push_back(std::make_pair(x, y));
+		}
+		else if(count <= 0) { break; }
+		next = label;
+	}
+}
+
+// as ::repair_straight, for diagonal direction @param d. the walk stops
+// at an entry that does not change only if the jump from its tile is
+// known not to change either: the entry of a tile without a valid first
+// step is a dead-end, whatever the jump from it
+void
+repair_diagonal(jt_shared_data& sh, uint32_t d, int32_t x, int32_t y,
+		int32_t count)
+{
+	int32_t dx = JT_DX[d], dy = JT_DY[d];
+
+	// the jump from the successor follows from the first tile ahead
+	// whose jump ends at its own successor (at the latest, the last
+	// tile of the line)
+	int32_t n = 0;
+	int32_t zx = x + dx, zy = y + dy;
+	uint16_t next = JT_DEADEND;
+	bool ends = true;
+	if(jt_inside(sh, zx, zy))
+	{
+		while(true)
+		{
+			next = jt_diagonal(sh, d, zx, zy, JT_DEADEND, ends);
+			if(ends) { break; }
+			zx += dx; zy += dy; n++;
+		}
+		for( ; n > 0; n--)
+		{
+			zx -= dx; zy -= dy;
+			next = jt_diagonal(sh, d, zx, zy, next, ends);
+		}
+	}
+
+	for( ; jt_inside(sh, x, y); x -= dx, y -= dy, count--)
+	{
+		uint16_t cont = jt_diagonal(sh, d, x, y, next, ends);
+		bool valid = jt_diagonal_step(sh, d, x, y);
+		uint16_t label = valid ? cont : JT_DEADEND;
+		uint16_t& entry = jt_entry(sh, x, y, d);
+		if(label != entry) { entry = label; }
+		else if(count <= 0 && (valid || ends)) { break; }
+		next = cont;
+	}
+}
+
+}
+
+const uint8_t warthog::offline_jump_point_locator2::JT8_DEADEND;
+const uint8_t warthog::offline_jump_point_locator2::JT8_STEPS;
+const uint8_t warthog::offline_jump_point_locator2::JT8_ESCAPE;
+const uint8_t warthog::offline_jump_point_locator2::JT8_LEAP;
 
 warthog::offline_jump_point_locator2::offline_jump_point_locator2(
-		warthog::gridmap* map) : map_(map)
+		warthog::gridmap* map, bool compact) 
+	: map_(map), dbsize_(0), db_(0), heap_(0), mapped_(0), mapped_size_(0),
+	  compact_(compact), db8_(0)
 {
-	if(map_->padded_mapsize() > ((1 << 23)-1)) 
+	if((uint64_t)map_->padded_mapsize() * 8 > UINT32_MAX) 
 	{
-		// search nodes are stored as 32bit quantities.
-		// bit 0 stores the expansion status
-		// bits 1-23 store the unique node id
-		// bits 24-31 store the direction from the parent
+		// the jump table holds 8 entries per padded cell and
+		// is indexed with 32bit quantities; ids of jump points
+		// are 32bit too (see ::jump)
 		std::cerr << "map size too big for this implementation of JPS+."
 			<< " aborting."<< std::endl;
 		exit(1);
 	}
 	preproc();
+	map_->add_index(this);
 }
 
 warthog::offline_jump_point_locator2::~offline_jump_point_locator2()
 {
-	delete [] db_;
+	map_->remove_index(this);
+	unload();
+	delete [] db8_;
+}
+
+void
+warthog::offline_jump_point_locator2::repair(
+		warthog::gridmap* map, const warthog::gridmap_change& change)
+{
+	// compact tables are rebuilt from a table of 16 bit entries
+	if(compact_)
+	{
+		dbsize_ = 8*map_->padded_mapsize();
+		compute();
+		compress();
+		return;
+	}
+
+	// a mapped table is read-only; the repaired one is kept in memory
+	if(!heap_)
+	{
+		uint16_t* heap = new uint16_t[dbsize_];
+		memcpy(heap, db_, sizeof(*db_) * dbsize_);
+		unload();
+		heap_ = heap;
+		db_ = heap_;
+	}
+
+	int32_t w = (int32_t)map_->header_width();
+	int32_t h = (int32_t)map_->header_height();
+	jt_shared_data shared;
+	shared.map_ = map_;
+	shared.db_ = heap_;
+	shared.top_ = (uint32_t)(map_->to_padded_id(0, 0) / map_->width());
+
+	// the changed tiles, unpadded
+	int32_t x1 = (int32_t)change.x1_;
+	int32_t x2 = std::min((int32_t)change.x2_, w - 1);
+	int32_t y1 = std::max((int32_t)change.y1_ - (int32_t)shared.top_, 0);
+	int32_t y2 = std::min((int32_t)change.y2_ - (int32_t)shared.top_, h - 1);
+	if(x1 > x2 || y1 > y2) { return; }
+
+	// straight jumps from a tile read the tiles beside it and beside
+	// its successor, so the rows and columns next to the changed ones
+	// are repaired too; along a line, the jumps from the tile before
+	// the changed ones onwards
+	std::vector<std::pair<int32_t, int32_t>> changed;
+	for(int32_t y = std::max(y1 - 1, 0); y <= std::min(y2 + 1, h - 1); y++)
+	{
+		repair_straight(shared, 2, x2, y, x2 - x1 + 2, changed);
+		repair_straight(shared, 3, x1, y, x2 - x1 + 2, changed);
+	}
+	for(int32_t x = std::max(x1 - 1, 0); x <= std::min(x2 + 1, w - 1); x++)
+	{
+		repair_straight(shared, 0, x, y1, y2 - y1 + 2, changed);
+		repair_straight(shared, 1, x, y2, y2 - y1 + 2, changed);
+	}
+
+	// a diagonal jump reads the tiles around its first step and the
+	// straight jumps from its successor. for each diagonal line that
+	// crosses such a tile, track the first and last of them in the
+	// direction of travel (as t = x * dx)
+	for(uint32_t d = 4; d < 8; d++)
+	{
+		int32_t dx = JT_DX[d], dy = JT_DY[d];
+		std::vector<int32_t> first(w + h - 1, INT32_MIN);
+		std::vector<int32_t> last(w + h - 1, INT32_MAX);
+		auto add = [&](int32_t x, int32_t y)
+		{
+			if(!jt_inside(shared, x, y)) { return; }
+			uint32_t line = (uint32_t)(dx == dy ? x - y + h - 1 : x + y);
+			first[line] = std::max(first[line], x * dx);
+			last[line] = std::min(last[line], x * dx);
+		};
+		for(int32_t y = y1 - 1; y <= y2 + 1; y++)
+		{
+			for(int32_t x = x1 - 1; x <= x2 + 1; x++) { add(x, y); }
+		}
+		for(std::pair<int32_t, int32_t>& c : changed)
+		{ add(c.first - dx, c.second - dy); }
+
+		for(uint32_t line = 0; line < first.size(); line++)
+		{
+			if(first[line] == INT32_MIN) { continue; }
+			int32_t x = first[line] * dx;
+			int32_t y = dx == dy ? x - ((int32_t)line - h + 1) :
+				(int32_t)line - x;
+			repair_diagonal(shared, d, x, y, first[line] - last[line] + 1);
+		}
+	}
+
+	if(shared.overflow_)
+	{
+		std::cerr << "label overflow; maximum jump distance exceeded. aborting\n";
+		exit(1);
+	}
 }
 
 void
 warthog::offline_jump_point_locator2::preproc()
 {
-	if(load(map_->filename())) { return; }
+	std::string fname = std::string(map_->filename()) + ".jps+";
+	if(!load(fname.c_str()))
+	{
+		dbsize_ = 8*map_->padded_mapsize();
+		compute();
+
+		// share the new table with other processes too
+		if(save(fname.c_str()))
+		{
+			uint16_t* heap = heap_;
+			heap_ = 0;
+			if(load(fname.c_str())) { delete [] heap; }
+			else { heap_ = heap; }
+		}
+	}
+	if(compact_) { compress(); }
+}
 
-	dbsize_ = 8*map_->padded_mapsize();
-	db_ = new uint16_t[dbsize_];
-	for(uint32_t i=0; i < dbsize_; i++) db_[i] = 0;
+void
+warthog::offline_jump_point_locator2::compress()
+{
+	int32_t w = (int32_t)map_->width();
+	int32_t delta[8] = { -w, w, 1, -1, 1-w, -1-w, w+1, w-1 };
+	for(uint32_t d = 0; d < 8; d++) { step_delta_[d] = delta[d]; }
 
-	warthog::online_jump_point_locator jpl(map_);
-	for(uint32_t y = 0; y < map_->header_height(); y++)
+	delete [] db8_;
+	db8_ = new uint8_t[dbsize_];
+	for(uint32_t i = 0; i < dbsize_; i++)
 	{
-		for(uint32_t x = 0; x < map_->header_width(); x++)
+		uint16_t label = db_[i];
+		uint16_t num_steps = label & JT_STEPS;
+		db8_[i] = num_steps < JT8_ESCAPE
+			? (uint8_t)(((label & JT_DEADEND) >> 8) | num_steps)
+			: JT8_ESCAPE;
+	}
+	unload();
+}
+
+void
+warthog::offline_jump_point_locator2::unload()
+{
+	if(mapped_) { munmap(mapped_, mapped_size_); }
+	delete [] heap_;
+	mapped_ = 0;
+	mapped_size_ = 0;
+	heap_ = 0;
+	db_ = 0;
+}
+
+void
+warthog::offline_jump_point_locator2::compute()
+{
+	void*(*thread_compute_fn)(void*) =
+	[] (void* args_in) -> void*
+	{
+		warthog::helpers::thread_params* par =
+			(warthog::helpers::thread_params*) args_in;
+		jt_shared_data* shared = (jt_shared_data*) par->shared_;
+
+		// lines are evenly divided among all threads
+		for(uint32_t i = par->thread_id_; i < shared->num_lines_;
+				i += par->max_threads_)
 		{
-			uint32_t mapid = map_->to_padded_id(x, y);
-//			std::cout << mapid << " ";
-			for(uint32_t i = 0; i < 8; i++)
-			{
-				warthog::jps::direction dir = 
-					(warthog::jps::direction)(1 << i);
-//				std::cout << dir << ": ";
-				uint32_t jumpnode_id;
-				double jumpcost;
-				jpl.jump(dir, mapid,
-						warthog::INF32, jumpnode_id, jumpcost);
-				
-				// convert from cost to number of steps
-				if(dir > 8)
-				{
-					jumpcost = (jumpcost / warthog::DBL_ROOT_TWO);
-				}
-				uint32_t num_steps = (uint16_t)floor((jumpcost + 0.5));
-//				std::cout << (jumpnode_id == warthog::INF ? 0 : num_steps) << " ";
-
-				// set the leading bit if the jump leads to a dead-end
-				if(jumpnode_id == warthog::INF32)
-				{
-					db_[mapid*8 + i] |= 32768;
-				}
-
-				// truncate jump cost so we can fit the label into a single byte
-				//if(num_steps > 32767)
-				//{
-				//	num_steps = 32767;
-				//	jumpnode_id = 0; 
-				//}
-
-				db_[mapid*8 + i] |= num_steps;
-
-				if(num_steps > 32768)
-				{
-					std::cerr << "label overflow; maximum jump distance exceeded. aborting\n";
-					exit(1);
-				}
-			}
-//			std::cout << std::endl;
+			uint32_t d = 0;
+			while(i >= shared->line_begin_[d+1]) { d++; }
+			if(shared->diagonal_)
+			{ sweep_diagonal(*shared, 4 + d, i - shared->line_begin_[d]); }
+			else
+			{ sweep_straight(*shared, d, i - shared->line_begin_[d]); }
+			par->nprocessed_++;
 		}
+		return 0;
+	};
+
+	// a mapped table is read-only; the new one is kept in memory
+	if(!heap_)
+	{
+		unload();
+		heap_ = new uint16_t[dbsize_];
 	}
+	for(uint32_t i=0; i < dbsize_; i++) heap_[i] = 0;
+	db_ = heap_;
+
+	uint32_t w = map_->header_width();
+	uint32_t h = map_->header_height();
+	jt_shared_data shared;
+	shared.map_ = map_;
+	shared.db_ = heap_;
+	shared.top_ = (uint32_t)(map_->to_padded_id(0, 0) / map_->width());
+
+	// straight jumps first, one row (east, west) or column (north,
+	// south) at a time; diagonal jumps need them
+	shared.diagonal_ = false;
+	shared.line_begin_[0] = 0;
+	for(uint32_t d = 0; d < 4; d++)
+	{
+		shared.line_begin_[d+1] =
+			shared.line_begin_[d] + (JT_DX[d] ? h : w);
+	}
+	shared.num_lines_ = shared.line_begin_[4];
+	warthog::helpers::parallel_compute(
+			thread_compute_fn, &shared, shared.num_lines_);
+
+	// then diagonal jumps, one diagonal line at a time
+	shared.diagonal_ = true;
+	for(uint32_t d = 0; d < 4; d++)
+	{ shared.line_begin_[d+1] = shared.line_begin_[d] + (w + h - 1); }
+	shared.num_lines_ = shared.line_begin_[4];
+	warthog::helpers::parallel_compute(
+			thread_compute_fn, &shared, shared.num_lines_);
 
-	save(map_->filename());
+	if(shared.overflow_)
+	{
+		std::cerr << "label overflow; maximum jump distance exceeded. aborting\n";
+		exit(1);
+	}
 }
 
 
 bool
 warthog::offline_jump_point_locator2::load(const char* filename)
 {
-	char fname[256];
-	strcpy(fname, filename);
-	strcat(fname, ".jps+");
-	FILE* f = fopen(fname, "rb");
-	std::cerr << "loading "<<fname << "... ";
-	if(f == NULL) 
+	int fd = open(filename, O_RDONLY);
+	if(fd == -1) { return false; }
+
+	struct stat st;
+	if(fstat(fd, &st) == -1 || (size_t)st.st_size < sizeof(jt_header))
 	{
-		std::cerr << "no dice. oh well. keep going.\n"<<std::endl;
+		close(fd);
+		return false;
+	}
+
+	void* mapped = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(mapped == MAP_FAILED) { return false; }
+
+	const jt_header* header = (const jt_header*)mapped;
+	uint64_t num_entries = 8 * (uint64_t)map_->padded_mapsize();
+	if( memcmp(header->magic_, JT_MAGIC, 4) != 0 ||
+		header->version_ != JT_VERSION ||
+		header->byte_order_ != JT_BYTE_ORDER ||
+		header->entry_bytes_ != sizeof(uint16_t) ||
+		header->padded_width_ != map_->width() ||
+		header->padded_height_ != map_->height() ||
+		header->num_entries_ != num_entries ||
+		header->table_offset_ % sizeof(uint16_t) != 0 ||
+		header->table_offset_ + num_entries * sizeof(uint16_t) !=
+			(uint64_t)st.st_size ||
+		header->map_hash_ != map_->checksum())
+	{
+		// stale or foreign tables
+		std::cerr << "jump table in " << filename
+			<< " does not match the map\n";
+		munmap(mapped, (size_t)st.st_size);
 		return false;
 	}
-	
-	fread(&dbsize_, sizeof(dbsize_), 1, f);
-	std::cerr <<"#labels="<<dbsize_<<std::endl;
 
-	db_ = new uint16_t[dbsize_];
-	fread(db_, sizeof(uint16_t), dbsize_, f);
-	fclose(f);
+	unload();
+	mapped_ = mapped;
+	mapped_size_ = (size_t)st.st_size;
+	dbsize_ = (uint32_t)num_entries;
+	db_ = (const uint16_t*)((const char*)mapped + header->table_offset_);
 	return true;
 }
 
-void 
+bool
 warthog::offline_jump_point_locator2::save(const char* filename)
 {
-	char fname[256];
-	strcpy(fname, filename);
-	strcat(fname, ".jps+");
-	std::cerr << "saving to file "<<fname<<"; nodes="<<dbsize_<<" size: "<<sizeof(db_[0])<<std::endl;
-
-	FILE* f = fopen(fname, "wb");
-	if(f == NULL) 
+	// other processes may have the file mapped (see ::load), so it is
+	// never written in place: the table goes to a file of its own in the
+	// same directory, which then replaces the old one in one rename
+	static std::atomic<uint32_t> num_saves(0);
+	std::string tmpname = std::string(filename) + ".tmp" +
+		std::to_string(getpid()) + "." + std::to_string(num_saves++);
+	std::ofstream out(tmpname.c_str(), std::ios::binary | std::ios::trunc);
+	if(!out.good())
 	{
-		std::cerr << "err; cannot write jump-point graph to file "
-			<<fname<<". oh well. try to keep going.\n"<<std::endl;
-		return;
+		std::cerr << "err; cannot write jump table to " << tmpname << "\n";
+		return false;
 	}
 
-	fwrite(&dbsize_, sizeof(dbsize_), 1, f);
-	fwrite(db_, sizeof(*db_), dbsize_, f);
-	fclose(f);
-	std::cerr << "jump table saved to disk. file="<<fname<<std::endl;
+	jt_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic_, JT_MAGIC, 4);
+	header.version_ = JT_VERSION;
+	header.byte_order_ = JT_BYTE_ORDER;
+	header.entry_bytes_ = sizeof(uint16_t);
+	header.padded_width_ = map_->width();
+	header.padded_height_ = map_->height();
+	header.map_hash_ = map_->checksum();
+	header.table_offset_ = (sizeof(jt_header) + 63) & ~(uint64_t)63;
+	header.num_entries_ = dbsize_;
+
+	std::vector<char> zeroes(header.table_offset_ - sizeof(header), 0);
+	out.write((const char*)&header, sizeof(header));
+	out.write(zeroes.data(), zeroes.size());
+	out.write((const char*)db_, sizeof(*db_) * (size_t)dbsize_);
+	out.close();
+	if(!out.good() || rename(tmpname.c_str(), filename) != 0)
+	{
+		std::cerr << "err; cannot write jump table to " << filename << "\n";
+		remove(tmpname.c_str());
+		return false;
+	}
+	return true;
 }
 
 void
@@ -190,13 +675,13 @@ warthog::offline_jump_point_locator2::jump_northwest(uint32_t node_id,
 	uint32_t jump_from = node_id;
 	
 	// step diagonally to an intermediate location jump_from
-	label = db_[8*jump_from + 5];
+	label = get_entry(8*jump_from + 5);
 	num_steps += label & 32767;
 	jump_from = node_id - num_steps * diag_step_delta;
 	while(!(label & 32768))
 	{
 		// north of jump_from
-		uint16_t label_straight1 = db_[8*jump_from]; 
+		uint16_t label_straight1 = get_entry(8*jump_from); 
 		if(!(label_straight1 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight1 & 32767);
@@ -206,7 +691,7 @@ warthog::offline_jump_point_locator2::jump_northwest(uint32_t node_id,
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
 		// west of jump_from
-		uint16_t label_straight2 = db_[8*jump_from+3]; // west of next jp
+		uint16_t label_straight2 = get_entry(8*jump_from+3); // west of next jp
 		if(!(label_straight2 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight2 & 32767);
@@ -215,7 +700,7 @@ warthog::offline_jump_point_locator2::jump_northwest(uint32_t node_id,
 			neighbours.push_back(jp_id);
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
-		label = db_[8*jump_from + 5];
+		label = get_entry(8*jump_from + 5);
 		num_steps += label & 32767;
 		jump_from = node_id - num_steps * diag_step_delta;
 	}
@@ -259,14 +744,14 @@ warthog::offline_jump_point_locator2::jump_northeast(uint32_t node_id,
 	
 	uint32_t jump_from = node_id;
 	// step diagonally to an intermediate location jump_from
-	label = db_[8*jump_from + 4];
+	label = get_entry(8*jump_from + 4);
 	num_steps += label & 32767;
 	jump_from = node_id - num_steps * diag_step_delta;
 	while(!(label & 32768))
 	{
 
 		// north of jump_from
-		uint16_t label_straight1 = db_[8*jump_from]; 
+		uint16_t label_straight1 = get_entry(8*jump_from); 
 		if(!(label_straight1 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight1 & 32767);
@@ -276,7 +761,7 @@ warthog::offline_jump_point_locator2::jump_northeast(uint32_t node_id,
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
 		// east of jump_from
-		uint16_t label_straight2 = db_[8*jump_from+2]; 
+		uint16_t label_straight2 = get_entry(8*jump_from+2); 
 		if(!(label_straight2 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight2 & 32767);
@@ -285,7 +770,7 @@ warthog::offline_jump_point_locator2::jump_northeast(uint32_t node_id,
 			neighbours.push_back(jp_id);
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
-		label = db_[8*jump_from + 4];
+		label = get_entry(8*jump_from + 4);
 		num_steps += label & 32767;
 		jump_from = node_id - num_steps * diag_step_delta;
 	}
@@ -329,13 +814,13 @@ warthog::offline_jump_point_locator2::jump_southwest(uint32_t node_id,
 
 	uint32_t jump_from = node_id;
 	// step diagonally to an intermediate location jump_from
-	label = db_[8*jump_from + 7];
+	label = get_entry(8*jump_from + 7);
 	num_steps += label & 32767;
 	jump_from = node_id + num_steps * diag_step_delta;
 	while(!(label & 32768))
 	{
 		// south of jump_from
-		uint16_t label_straight1 = db_[8*jump_from+1]; 
+		uint16_t label_straight1 = get_entry(8*jump_from+1); 
 		if(!(label_straight1 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight1 & 32767);
@@ -345,7 +830,7 @@ warthog::offline_jump_point_locator2::jump_southwest(uint32_t node_id,
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
 		// west of jump_from
-		uint16_t label_straight2 = db_[8*jump_from+3]; 
+		uint16_t label_straight2 = get_entry(8*jump_from+3); 
 		if(!(label_straight2 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight2 & 32767);
@@ -354,7 +839,7 @@ warthog::offline_jump_point_locator2::jump_southwest(uint32_t node_id,
 			neighbours.push_back(jp_id);
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
-		label = db_[8*jump_from + 7];
+		label = get_entry(8*jump_from + 7);
 		num_steps += label & 32767;
 		jump_from = node_id + num_steps * diag_step_delta;
 	}
@@ -400,13 +885,13 @@ warthog::offline_jump_point_locator2::jump_southeast(uint32_t node_id,
 	uint32_t jump_from = node_id;
 	
 	// step diagonally to an intermediate location jump_from
-	label = db_[8*jump_from + 6];
+	label = get_entry(8*jump_from + 6);
 	num_steps += label & 32767;
 	jump_from = node_id + num_steps * diag_step_delta;
 	while(!(label & 32768))
 	{
 		// south of jump_from
-		uint16_t label_straight1 = db_[8*jump_from + 1]; 
+		uint16_t label_straight1 = get_entry(8*jump_from + 1); 
 		if(!(label_straight1 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight1 & 32767);
@@ -416,7 +901,7 @@ warthog::offline_jump_point_locator2::jump_southeast(uint32_t node_id,
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
 		// east of jump_from
-		uint16_t label_straight2 = db_[8*jump_from + 2]; 
+		uint16_t label_straight2 = get_entry(8*jump_from + 2); 
 		if(!(label_straight2 & 32768)) 
 		{ 
 			uint32_t jp_cost = (label_straight2 & 32767);
@@ -426,7 +911,7 @@ warthog::offline_jump_point_locator2::jump_southeast(uint32_t node_id,
 			costs.push_back(jp_cost + num_steps * warthog::DBL_ROOT_TWO);
 		}
 		// step diagonally to an intermediate location jump_from
-		label = db_[8*jump_from + 6];
+		label = get_entry(8*jump_from + 6);
 		num_steps += label & 32767;
 		jump_from = node_id + num_steps * diag_step_delta;
 	}
@@ -463,7 +948,7 @@ warthog::offline_jump_point_locator2::jump_north(uint32_t node_id,
 	  	uint32_t goal_id, double cost_to_node_id,
 		std::vector<uint32_t>& neighbours, std::vector<double>& costs)
 {
-	uint16_t label = db_[8*node_id];
+	uint16_t label = get_entry(8*node_id);
 	uint16_t num_steps = label & 32767;
 
 	// do not jump over the goal
@@ -497,7 +982,7 @@ warthog::offline_jump_point_locator2::jump_south(uint32_t node_id,
 	  	uint32_t goal_id, double cost_to_node_id, 
 		std::vector<uint32_t>& neighbours, std::vector<double>& costs)
 {
-	uint16_t label = db_[8*node_id + 1];
+	uint16_t label = get_entry(8*node_id + 1);
 	uint16_t num_steps = label & 32767;
 	
 	// do not jump over the goal
@@ -531,7 +1016,7 @@ warthog::offline_jump_point_locator2::jump_east(uint32_t node_id,
 	  	uint32_t goal_id, double cost_to_node_id,
 		std::vector<uint32_t>& neighbours, std::vector<double>& costs)
 {
-	uint16_t label = db_[8*node_id + 2];
+	uint16_t label = get_entry(8*node_id + 2);
 	uint32_t num_steps = label & 32767;
 
 	// do not jump over the goal
@@ -559,7 +1044,7 @@ warthog::offline_jump_point_locator2::jump_west(uint32_t node_id,
 	  	uint32_t goal_id, double cost_to_node_id,
 		std::vector<uint32_t>& neighbours, std::vector<double>& costs)
 {
-	uint16_t label = db_[8*node_id + 3];
+	uint16_t label = get_entry(8*node_id + 3);
 	uint32_t num_steps = label & 32767;
 
 	// do not jump over the goal
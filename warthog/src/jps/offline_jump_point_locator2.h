@@ -9,44 +9,115 @@
 // This version additionally prunes all jump points that do not have at
 // least one forced neighbour. 
 //
+// The table is filled one row, column or diagonal at a time: the jump
+// from a tile follows from the jump from the next tile along, so every
+// line takes one pass, and lines are divided among threads.
+//
+// Tables are saved next to the map (as <map>.jps+) with the dimensions
+// and checksum of the map they were computed for, and are memory-mapped
+// read-only when loaded, so processes that search the same map share
+// one copy. A table that does not match the map is recomputed and the
+// file is replaced: the new table is written to a temporary file which
+// is then renamed over the old one, so processes that have the old
+// file mapped keep reading it unchanged.
+//
+// Compact tables hold each entry in 8 bits: the dead-end bit and up to
+// 126 steps. Longer jumps are marked with an escape value that says to
+// move JT8_LEAP steps and read the entry of the tile there: it cannot
+// be a jump point, and at least two steps remain (the last step of a
+// dead-end diagonal jump may be one its predecessor cannot make), so
+// it holds the rest of the jump. This halves the memory of the table;
+// only long jumps cost extra reads. Compact tables live in memory only:
+// the file always holds the 16 bit table, which is compressed after it
+// is loaded, so every process keeps a compact copy of its own.
+//
 // @author: dharabor
 // @created: 05/05/2013
 //
 
+#include "gridmap_edit.h"
 #include "jps.h"
 
 namespace warthog
 {
 
 class gridmap;
-class offline_jump_point_locator2
+class offline_jump_point_locator2 : public warthog::gridmap_index
 {
 	public:
-		offline_jump_point_locator2(warthog::gridmap* map);
-		~offline_jump_point_locator2();
+		// @param compact: keep the table in 8 bits per entry
+		offline_jump_point_locator2(warthog::gridmap* map,
+				bool compact = false);
+		virtual ~offline_jump_point_locator2();
 
 		void
 		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
 				std::vector<uint32_t>& neighbours, std::vector<double>& costs);
 
+		// update the jump table after the map is edited (see
+		// warthog::gridmap_edit). only the rows, columns and diagonals
+		// that cross the changed tiles are walked again, from the
+		// changes back to the first jump that stays the same. a table
+		// mapped from a file is first copied into memory of its own.
+		// NB: compact tables are recomputed in full
+		virtual void
+		repair(warthog::gridmap* map, const warthog::gridmap_change& change);
+
 		uint32_t
 		mem()
 		{
+			if(db8_) { return sizeof(this) + dbsize_; }
 			return sizeof(this) + sizeof(*db_)*dbsize_;
 		}
 
+		// true if the table is mapped from a file
+		inline bool
+		is_mapped() { return mapped_ != 0; }
+
 
 	private:
 
+		// entry @param index of the table
+		inline uint16_t
+		get_entry(uint32_t index)
+		{
+			if(!db8_) { return db_[index]; }
+			uint8_t entry = db8_[index];
+			uint16_t num_steps = 0;
+			while((entry & JT8_STEPS) == JT8_ESCAPE)
+			{
+				num_steps += JT8_LEAP;
+				index += 8 * JT8_LEAP * step_delta_[index & 7];
+				entry = db8_[index];
+			}
+			return (uint16_t)(((entry & JT8_DEADEND) << 8) |
+					(num_steps + (entry & JT8_STEPS)));
+		}
+
+		// replace the table with a compact copy
+		void
+		compress();
+
 		void
 		preproc();
 
+		// fill the jump table from the current map
+		void
+		compute();
+
+		// map the table in @param filename, if it was computed for
+		// the map as it is now
 		bool
 		load(const char* filename);
 
-		void 
+		// write the table to @param filename through a temporary file
+		// in the same directory
+		bool
 		save(const char* filename);
 
+		void
+		unload();
+
 		void
 		jump_northwest(uint32_t node_id, uint32_t goal_id, 
 				std::vector<uint32_t>& neighbours, std::vector<double>& costs);
@@ -74,7 +145,23 @@ class offline_jump_point_locator2
 
 		warthog::gridmap* map_;
 		uint32_t dbsize_;
-		uint16_t* db_;	
+		const uint16_t* db_;	// heap_, or the table in mapped_
+		uint16_t* heap_;
+
+		// the file mapping that holds db_, if any
+		void* mapped_;
+		size_t mapped_size_;
+
+		// the compact table, if any, and the change in padded id of one
+		// step in the direction of each entry
+		bool compact_;
+		uint8_t* db8_;
+		int32_t step_delta_[8];
+
+		static const uint8_t JT8_DEADEND = 128;
+		static const uint8_t JT8_STEPS = 127;
+		static const uint8_t JT8_ESCAPE = 127;
+		static const uint8_t JT8_LEAP = 125;
 };
 
 }
@@ -127,7 +127,7 @@ public:
     else c.deactivate();
   }
   bool t_labelv, t_labelh; // store the original label before setting artificial obstacle
-  int t_mapid, t_rmapid;
+  warthog::grid_id_t t_mapid, t_rmapid;
   uint32_t jump_step;      // the step of previous cardinal scanning
   cost_t jumpcost;         // the cost (step) of previous scanning
 
@@ -165,21 +165,23 @@ public:
   /*
    * before scan: if the constraint is active, set temp obstacle based on jlimt
    */
-  inline void before_scanv(gridmap* rmap, int rmapid, int direct) {
+  template<typename MAP>
+  inline void before_scanv(MAP* rmap, warthog::grid_id_t rmapid, int direct) {
     if (v.i>0) {
-      t_rmapid = rmapid + direct * (v.jlimt() + 1);
-      assert(t_rmapid >= 0);
+      t_rmapid = rmapid + (int64_t)direct * (v.jlimt() + 1);
+      assert(t_rmapid < rmap->padded_mapsize());
       t_labelv = rmap->get_label(t_rmapid);
-      rmap->set_label(t_rmapid, false);
+      rmap->set_label_tmp(t_rmapid, false);
     }
   }
 
-  inline void before_scanh(gridmap* map, int mapid, int direct) {
+  template<typename MAP>
+  inline void before_scanh(MAP* map, warthog::grid_id_t mapid, int direct) {
     if (h.i>0){
-      t_mapid = mapid + direct * (h.jlimt() + 1);
-      assert(t_mapid >= 0);
+      t_mapid = mapid + (int64_t)direct * (h.jlimt() + 1);
+      assert(t_mapid < map->padded_mapsize());
       t_labelh = map->get_label(t_mapid);
-      map->set_label(t_mapid, false);
+      map->set_label_tmp(t_mapid, false);
     }
   }
 
@@ -192,16 +194,17 @@ public:
    *   e.g. it has a smaller gvalue due to the previous expansion;
    * return true if continue, false terminate the expansion
    */
-  inline bool after_scanv(gridmap* rmap, uint32_t node_id, 
-      uint32_t &jpid, cost_t& cost) {
+  template<typename MAP>
+  inline bool after_scanv(MAP* rmap, warthog::grid_id_t node_id, 
+      warthog::grid_id_t &jpid, cost_t& cost) {
     if (v.i>0) { // the constraint is active
-      rmap->set_label(t_rmapid, t_labelv); // 1.1
+      rmap->set_label_tmp(t_rmapid, t_labelv); // 1.1
       if ((int)jump_step < v.jlimt()) {
         if (v.better_from_b(jump_step)) {
           int dy = v.i-1;
           int dx = v.d-v.i-jump_step+1;
           update_constraint(v, dx, dy, (cost_t)jump_step, global::query::gval(node_id));
-          jpid = INF32;
+          jpid = warthog::GRID_ID_MAX;
           if (v.dominated()) return false;
         }
         else { // the constraint is no longer applicable
@@ -219,16 +222,17 @@ public:
     return true;
   }
 
-  inline bool after_scanh(gridmap* map, uint32_t node_id, 
-      uint32_t &jpid, cost_t& cost) {
+  template<typename MAP>
+  inline bool after_scanh(MAP* map, warthog::grid_id_t node_id, 
+      warthog::grid_id_t &jpid, cost_t& cost) {
     if (h.i>0) {
-      map->set_label(t_mapid, t_labelh);
+      map->set_label_tmp(t_mapid, t_labelh);
       if ((int)jump_step < h.jlimt()) {
         if (h.better_from_b(jump_step)) {
           int dy = h.i-1;
           int dx = h.d-h.i-jump_step+1;
           update_constraint(h, dx, dy, (cost_t)jump_step, global::query::gval(node_id));
-          jpid = INF32;
+          jpid = warthog::GRID_ID_MAX;
           if (h.dominated()) return false;
         }
         else {
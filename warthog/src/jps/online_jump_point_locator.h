@@ -16,6 +16,7 @@
 
 #include "jps.h"
 #include "gridmap.h"
+#include "gridmap_edit.h"
 
 namespace warthog
 {
@@ -27,8 +28,8 @@ class online_jump_point_locator
 		~online_jump_point_locator();
 
 		void
-		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump(warthog::jps::direction d, warthog::grid_id_t node_id, warthog::grid_id_t goalid, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 
 		size_t 
 		mem()
@@ -38,54 +39,54 @@ class online_jump_point_locator
 
 	private:
 		void
-		jump_northwest(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_northwest(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_northeast(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_northeast(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_southwest(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_southwest(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_southeast(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_southeast(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_north(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_south(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_east(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 		void
-		jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost);
+		jump_west(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost);
 
 		// these versions can be passed a map parameter to
 		// use when jumping. they allow switching between
 		// map_ and rmap_ (a rotated counterpart).
 		void
-		__jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		__jump_east(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
 				warthog::gridmap* mymap);
 		void
-		__jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		__jump_west(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
 				warthog::gridmap* mymap);
 		void
-		__jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
+		__jump_north(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
 				warthog::gridmap* mymap);
 		void
-		__jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		__jump_south(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
 				warthog::gridmap* mymap);
 
-		inline uint32_t
-		map_id_to_rmap_id(uint32_t mapid)
+		inline warthog::grid_id_t
+		map_id_to_rmap_id(warthog::grid_id_t mapid)
 		{
-			if(mapid == warthog::INF32) { return mapid; }
+			if(mapid == warthog::GRID_ID_MAX) { return mapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -95,10 +96,10 @@ class online_jump_point_locator
 			return rmap_->to_padded_id(rx, ry);
 		}
 
-		inline uint32_t
-		rmap_id_to_map_id(uint32_t rmapid)
+		inline warthog::grid_id_t
+		rmap_id_to_map_id(warthog::grid_id_t rmapid)
 		{
-			if(rmapid == warthog::INF32) { return rmapid; }
+			if(rmapid == warthog::GRID_ID_MAX) { return rmapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -113,6 +114,8 @@ class online_jump_point_locator
 
 		warthog::gridmap* map_;
 		warthog::gridmap* rmap_;
+		// keeps rmap_ in step with edits to map_ (see warthog::gridmap_edit)
+		warthog::gridmap_index* rsync_;
 		//uint32_t jumplimit_;
 };
 
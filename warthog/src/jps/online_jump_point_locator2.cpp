@@ -3,47 +3,37 @@
 #include "global.h"
 #include "online_jump_point_locator2.h"
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 
 namespace G = global::statis;
 
-warthog::jps::online_jump_point_locator2::online_jump_point_locator2(
-        warthog::gridmap* map) : map_(map)//, jumplimit_(UINT32_MAX)
+template<typename MAP>
+warthog::jps::online_jump_point_locator2_base<MAP>::online_jump_point_locator2_base(
+        MAP* map) : map_(map)//, jumplimit_(UINT32_MAX)
 {
 	rmap_ = create_rmap();
-	current_node_id_ = current_rnode_id_ = warthog::INF32;
-	current_goal_id_ = current_rgoal_id_ = warthog::INF32;
+	rsync_ = warthog::watch_rotated_copy(map_, rmap_);
+	current_node_id_ = current_rnode_id_ = warthog::GRID_ID_MAX;
+	current_goal_id_ = current_rgoal_id_ = warthog::GRID_ID_MAX;
+	dxs_ = dys_ = 0;
 }
 
-warthog::jps::online_jump_point_locator2::~online_jump_point_locator2()
+template<typename MAP>
+warthog::jps::online_jump_point_locator2_base<MAP>::~online_jump_point_locator2_base()
 {
+	delete rsync_;
 	delete rmap_;
 }
 
 // create a copy of the grid map which is rotated by 90 degrees clockwise.
 // this version will be used when jumping North or South. 
-warthog::gridmap*
-warthog::jps::online_jump_point_locator2::create_rmap()
+template<typename MAP>
+MAP*
+warthog::jps::online_jump_point_locator2_base<MAP>::create_rmap()
 {
-	uint32_t maph = map_->header_height();
-	uint32_t mapw = map_->header_width();
-	uint32_t rmaph = mapw;
-	uint32_t rmapw = maph;
-	warthog::gridmap* rmap = new warthog::gridmap(rmaph, rmapw);
-
-	for(uint32_t x = 0; x < mapw; x++) 
-	{
-		for(uint32_t y = 0; y < maph; y++)
-		{
-			uint32_t label = map_->get_label(map_->to_padded_id(x, y));
-			uint32_t rx = ((rmapw-1) - y);
-			uint32_t ry = x;
-			uint32_t rid = rmap->to_padded_id(rx, ry);
-			rmap->set_label(rid, label);
-		}
-	}
-	return rmap;
+	return map_->rotated_copy();
 }
 
 
@@ -53,14 +43,15 @@ warthog::jps::online_jump_point_locator2::create_rmap()
 // jump point successor.
 //
 // @return: the id of a jump point successor or warthog::INF if no jp exists.
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump(warthog::jps::direction d,
-	   	uint32_t node_id, uint32_t goal_id, 
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump(warthog::jps::direction d,
+	   	warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-    __jump_east_fp = &warthog::jps::online_jump_point_locator2::__jump_east;
-    __jump_west_fp = &warthog::jps::online_jump_point_locator2::__jump_west;
+    __jump_east_fp = &warthog::jps::online_jump_point_locator2_base<MAP>::__jump_east;
+    __jump_west_fp = &warthog::jps::online_jump_point_locator2_base<MAP>::__jump_west;
 
 	// cache node and goal ids so we don't need to convert all the time
 	if(goal_id != current_goal_id_)
@@ -106,19 +97,34 @@ warthog::jps::online_jump_point_locator2::jump(warthog::jps::direction d,
 	}
 }
 
+template<typename MAP>
+void
+warthog::jps::online_jump_point_locator2_base<MAP>::jump(warthog::jps::direction d,
+	   	warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+		std::vector<warthog::grid_id_t>& jpoints,
+		std::vector<warthog::cost_t>& costs,
+		std::vector<int32_t>& dxs, std::vector<int32_t>& dys)
+{
+	dxs_ = &dxs;
+	dys_ = &dys;
+	jump(d, node_id, goal_id, jpoints, costs);
+	dxs_ = dys_ = 0;
+}
+
 // Similar to ::jump. The main difference is that, when jumping, the parent
 // is assumed to be reversed; i.e. in the opposite direction to the jump 
 // direction (usually the parent and the jump direction are the same)
 //
 // @return: the id of a jump point successor or warthog::INF if no jp exists.
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::rjump(warthog::jps::direction d,
-	   	uint32_t node_id, uint32_t goal_id, 
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::rjump(warthog::jps::direction d,
+	   	warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-    __jump_east_fp = &warthog::jps::online_jump_point_locator2::__rjump_east;
-    __jump_west_fp = &warthog::jps::online_jump_point_locator2::__rjump_west;
+    __jump_east_fp = &warthog::jps::online_jump_point_locator2_base<MAP>::__rjump_east;
+    __jump_west_fp = &warthog::jps::online_jump_point_locator2_base<MAP>::__rjump_west;
 
 	// cache node and goal ids so we don't need to convert all the time
 	if(goal_id != current_goal_id_)
@@ -164,93 +170,102 @@ warthog::jps::online_jump_point_locator2::rjump(warthog::jps::direction d,
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_north(
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_north(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_north(rnode_id, rgoal_id, jumpnode_id, jumpcost, rmap_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
-		jumpnode_id = current_node_id_ - (uint32_t)(jumpcost) * map_->width();
+		jumpnode_id = current_node_id_ - (warthog::grid_id_t)(jumpcost) * map_->width();
 		//*(((uint8_t*)&jumpnode_id)+3) = warthog::jps::NORTH;
 		jpoints.push_back(jumpnode_id);
 		costs.push_back(jumpcost);
+		add_offset(0, -(int32_t)jumpcost);
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_north(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_north(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		MAP* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// east when we use a version of the map rotated 90 degrees.
 	(this->*(__jump_east_fp))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_south(
-		std::vector<uint32_t>& jpoints, 
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_south(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_south(rnode_id, rgoal_id, jumpnode_id, jumpcost, rmap_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
-		jumpnode_id = current_node_id_ + (uint32_t)(jumpcost ) * map_->width();
+		jumpnode_id = current_node_id_ + (warthog::grid_id_t)(jumpcost ) * map_->width();
 		//*(((uint8_t*)&jumpnode_id)+3) = warthog::jps::SOUTH;
 		jpoints.push_back(jumpnode_id);
 		costs.push_back(jumpcost);
+		add_offset(0, (int32_t)jumpcost);
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_south(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_south(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		MAP* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// west when we use a version of the map rotated 90 degrees.
 	(this->*(__jump_west_fp))(node_id, goal_id, jumpnode_id, jumpcost, mymap);
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_east(
-		std::vector<uint32_t>& jpoints, 
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_east(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	(this->*(__jump_east_fp))(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
 		//*(((uint8_t*)&jumpnode_id)+3) = warthog::jps::EAST;
 		jpoints.push_back(jumpnode_id);
 		costs.push_back(jumpcost);
+		add_offset((int32_t)jumpcost, 0);
 	}
 }
 
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_east(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_east(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	jumpnode_id = node_id;
 
@@ -293,7 +308,7 @@ warthog::jps::online_jump_point_locator2::__jump_east(uint32_t node_id,
 	}
 
 	uint32_t num_steps = jumpnode_id - node_id;
-	uint32_t goal_dist = goal_id - node_id;
+	warthog::grid_id_t goal_dist = goal_id - node_id;
 #ifdef CNT
   G::scan_cnt += (num_steps >> 5);
 #endif
@@ -310,16 +325,17 @@ warthog::jps::online_jump_point_locator2::__jump_east(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// looked for the first set bit. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps ;
 	
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__rjump_east(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__rjump_east(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	jumpnode_id = node_id;
 
@@ -366,7 +382,7 @@ warthog::jps::online_jump_point_locator2::__rjump_east(uint32_t node_id,
 	}
 
 	uint32_t num_steps = jumpnode_id - node_id;
-	uint32_t goal_dist = goal_id - node_id;
+	warthog::grid_id_t goal_dist = goal_id - node_id;
 #ifdef CNT
   G::scan_cnt += (num_steps >> 5);
 #endif
@@ -384,37 +400,40 @@ warthog::jps::online_jump_point_locator2::__rjump_east(uint32_t node_id,
 		// looked for the first set bit. need -1 to fix it.
 		num_steps -= (1 && num_steps);
         //num_steps++; // fix sideeffect of previous hacky fix
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps ;
 	
 }
 
 // analogous to ::jump_east 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_west(
-		std::vector<uint32_t>& jpoints, 
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_west(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	(this->*(__jump_west_fp))(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
 		//*(((uint8_t*)&jumpnode_id)+3) = warthog::jps::WEST;
 		jpoints.push_back(jumpnode_id);
 		costs.push_back(jumpcost);
+		add_offset(-(int32_t)jumpcost, 0);
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_west(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_west(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	bool deadend = false;
 	uint32_t neis[3] = {0, 0, 0};
@@ -449,7 +468,7 @@ warthog::jps::online_jump_point_locator2::__jump_west(uint32_t node_id,
 	}
 
 	uint32_t num_steps = node_id - jumpnode_id;
-	uint32_t goal_dist = node_id - goal_id;
+	warthog::grid_id_t goal_dist = node_id - goal_id;
 	if(num_steps > goal_dist)
 	{
 		jumpnode_id = goal_id;
@@ -463,15 +482,16 @@ warthog::jps::online_jump_point_locator2::__jump_west(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// counted leading zeroes. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps ;
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__rjump_west(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::jps::online_jump_point_locator2_base<MAP>::__rjump_west(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	bool deadend = false;
 	uint32_t neis[3] = {0, 0, 0};
@@ -508,7 +528,7 @@ warthog::jps::online_jump_point_locator2::__rjump_west(uint32_t node_id,
 	}
 
 	uint32_t num_steps = node_id - jumpnode_id;
-	uint32_t goal_dist = node_id - goal_id;
+	warthog::grid_id_t goal_dist = node_id - goal_id;
 	if(num_steps > goal_dist)
 	{
 		jumpnode_id = goal_id;
@@ -523,25 +543,27 @@ warthog::jps::online_jump_point_locator2::__rjump_west(uint32_t node_id,
 		// counted leading zeroes. need -1 to fix it.
 		num_steps -= (1 && num_steps);
         //num_steps++;  // fix sideeffect of hacky fix
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps ;
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_northeast(
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_northeast(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	int32_t steps = 0; // diagonal steps to node_id
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. node_id at centre. Assume little endian format.
@@ -552,42 +574,48 @@ warthog::jps::online_jump_point_locator2::jump_northeast(
 	// (validity of subsequent steps is checked by straight jump functions)
 	if((neis & 1542) != 1542) { return; }
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
 		__jump_northeast(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
+		int32_t k = steps +
+			(int32_t)(jumpcost * warthog::DBL_ONE_OVER_ROOT_TWO + 0.5);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-			jp1_id = node_id - (uint32_t)(jp1_cost ) * map_->width();
+			jp1_id = node_id - (warthog::grid_id_t)(jp1_cost ) * map_->width();
 			//*(((uint8_t*)&jp1_id)+3) = warthog::jps::NORTH;
 			jpoints.push_back(jp1_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp1_cost);
+			add_offset(k, -(k + (int32_t)jp1_cost));
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
 			//*(((uint8_t*)&jp2_id)+3) = warthog::jps::EAST;
 			jpoints.push_back(jp2_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp2_cost);
+			add_offset(k + (int32_t)jp2_cost, -k);
 			if(jp1_cost == 0) { break; } // no corner cutting
 		}
 		node_id = jumpnode_id;
 		cost_to_nodeid += jumpcost;
+		steps = k;
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_northeast(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		uint32_t& jp_id1, warthog::cost_t& cost1,
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_northeast(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1,
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 {
 	uint32_t num_steps = 0;
 
@@ -604,12 +632,12 @@ warthog::jps::online_jump_point_locator2::__jump_northeast(
 		// (ensures we do not miss any optimal turning points)
 		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
 		(this->*(__jump_east_fp))(node_id, goal_id, jp_id2, cost2, map_);
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
 		if(!((uint64_t)cost1 && (uint64_t)cost2)) 
 		{ 
-			node_id = jp_id1 = jp_id2 = warthog::INF32; 
+			node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; 
 			break; 
 		}
 
@@ -621,20 +649,22 @@ warthog::jps::online_jump_point_locator2::__jump_northeast(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_northwest(
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_northwest(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	int32_t steps = 0; // diagonal steps to node_id
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. node_id at centre. Assume little endian format.
@@ -645,42 +675,48 @@ warthog::jps::online_jump_point_locator2::jump_northwest(
 	// (validity of subsequent steps is checked by straight jump functions)
 	if((neis & 771) != 771) { return; }
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
 		__jump_northwest(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
+		int32_t k = steps +
+			(int32_t)(jumpcost * warthog::DBL_ONE_OVER_ROOT_TWO + 0.5);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-			jp1_id = node_id - (uint32_t)(jp1_cost ) * map_->width();
+			jp1_id = node_id - (warthog::grid_id_t)(jp1_cost ) * map_->width();
 			//*(((uint8_t*)&jp1_id)+3) = warthog::jps::NORTH;
 			jpoints.push_back(jp1_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp1_cost);
+			add_offset(-k, -(k + (int32_t)jp1_cost));
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
 			//*(((uint8_t*)&jp2_id)+3) = warthog::jps::WEST;
 			jpoints.push_back(jp2_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp2_cost);
+			add_offset(-(k + (int32_t)jp2_cost), -k);
 			if(jp1_cost == 0) { break; } // no corner cutting
 		}
 		node_id = jumpnode_id;
 		cost_to_nodeid += jumpcost;
+		steps = k;
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_northwest(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_northwest(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 
 {
 	uint32_t num_steps = 0;
@@ -698,12 +734,12 @@ warthog::jps::online_jump_point_locator2::__jump_northwest(
 		// (ensures we do not miss any optimal turning points)
 		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
 		(this->*(__jump_west_fp))(node_id, goal_id, jp_id2, cost2, map_);
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
 		if(!((uint64_t)cost1 && (uint64_t)cost2)) 
 		{ 
-			node_id = jp_id1 = jp_id2 = warthog::INF32;
+			node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX;
 		   	break; 
 		}
 	}
@@ -714,20 +750,22 @@ warthog::jps::online_jump_point_locator2::__jump_northwest(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_southeast(
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_southeast(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	int32_t steps = 0; // diagonal steps to node_id
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
@@ -738,42 +776,48 @@ warthog::jps::online_jump_point_locator2::jump_southeast(
 	// (validity of subsequent steps is checked by straight jump functions)
 	if((neis & 394752) != 394752) { return; }
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
 		__jump_southeast(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
+		int32_t k = steps +
+			(int32_t)(jumpcost * warthog::DBL_ONE_OVER_ROOT_TWO + 0.5);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-			jp1_id = node_id + (uint32_t)(jp1_cost ) * map_->width();
+			jp1_id = node_id + (warthog::grid_id_t)(jp1_cost ) * map_->width();
 			//*(((uint8_t*)&jp1_id)+3) = warthog::jps::SOUTH;
 			jpoints.push_back(jp1_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp1_cost);
+			add_offset(k, k + (int32_t)jp1_cost);
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
 			//*(((uint8_t*)&jp2_id)+3) = warthog::jps::EAST;
 			jpoints.push_back(jp2_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp2_cost);
+			add_offset(k + (int32_t)jp2_cost, k);
 			if(jp1_cost == 0) { break; } // no corner cutting
 		}
 		node_id = jumpnode_id;
 		cost_to_nodeid += jumpcost;
+		steps = k;
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_southeast(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_southeast(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 
 {
 	uint32_t num_steps = 0;
@@ -791,12 +835,12 @@ warthog::jps::online_jump_point_locator2::__jump_southeast(
 		// (ensures we do not miss any optimal turning points)
 		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
 		(this->*(__jump_east_fp))(node_id, goal_id, jp_id2, cost2, map_);
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
 		if(!((uint64_t)cost1 && (uint64_t)cost2)) 
 		{ 
-			node_id = jp_id1 = jp_id2 = warthog::INF32; 
+			node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; 
 			break; 
 		}
 	}
@@ -807,20 +851,22 @@ warthog::jps::online_jump_point_locator2::__jump_southeast(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::jump_southwest(
-		std::vector<uint32_t>& jpoints,
+warthog::jps::online_jump_point_locator2_base<MAP>::jump_southwest(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	int32_t steps = 0; // diagonal steps to node_id
 	
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. next_id at centre. Assume little endian format.
@@ -830,42 +876,48 @@ warthog::jps::online_jump_point_locator2::jump_southwest(
 	// early termination (first step is invalid)
 	if((neis & 197376) != 197376) { return; }
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
 		__jump_southwest(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, 
 				jp1_id, jp1_cost, jp2_id, jp2_cost);
+		int32_t k = steps +
+			(int32_t)(jumpcost * warthog::DBL_ONE_OVER_ROOT_TWO + 0.5);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-			jp1_id = node_id + (uint32_t)(jp1_cost ) * map_->width();
+			jp1_id = node_id + (warthog::grid_id_t)(jp1_cost ) * map_->width();
 			//*(((uint8_t*)&jp1_id)+3) = warthog::jps::SOUTH;
 			jpoints.push_back(jp1_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp1_cost);
+			add_offset(-k, k + (int32_t)jp1_cost);
 			if(jp2_cost == 0) { break; }
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
 			//*(((uint8_t*)&jp2_id)+3) = warthog::jps::WEST;
 			jpoints.push_back(jp2_id);
 			costs.push_back(cost_to_nodeid + jumpcost + jp2_cost);
+			add_offset(-(k + (int32_t)jp2_cost), k);
 			if(jp1_cost == 0) { break; }
 		}
 		node_id = jumpnode_id;
 		cost_to_nodeid += jumpcost;
+		steps = k;
 	}
 }
 
+template<typename MAP>
 void
-warthog::jps::online_jump_point_locator2::__jump_southwest(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::jps::online_jump_point_locator2_base<MAP>::__jump_southwest(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 {
 	// jump a single step (no corner cutting)
 	uint32_t num_steps = 0;
@@ -881,12 +933,12 @@ warthog::jps::online_jump_point_locator2::__jump_southwest(
 		// (ensures we do not miss any optimal turning points)
 		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
 		(this->*(__jump_west_fp))(node_id, goal_id, jp_id2, cost2, map_);
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 
 		// couldn't move in a straight dir; next step is an obstacle
 		if(!((uint64_t)cost1 && (uint64_t)cost2)) 
 		{ 
-			node_id = jp_id1 = jp_id2 = warthog::INF32;
+			node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX;
 		   	break; 
 		}
 	}
@@ -896,3 +948,124 @@ warthog::jps::online_jump_point_locator2::__jump_southwest(
 	jumpnode_id = node_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
+
+// the jumps below find the tile where the equivalent bitset scan
+// (::__jump_east etc.) stops, from the runs of three rows, and finish
+// the same way. @param num_steps is the distance to that tile and
+// @param deadend tells if it is the obstacle that ends the scan
+static inline void
+finish_rle_jump(warthog::grid_id_t stop_id, uint32_t num_steps,
+		bool deadend, warthog::grid_id_t goal_dist,
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id,
+		warthog::cost_t& jumpcost)
+{
+	if(num_steps > goal_dist)
+	{
+		jumpnode_id = goal_id;
+		jumpcost = goal_dist;
+		return;
+	}
+
+	jumpnode_id = stop_id;
+	if(deadend)
+	{
+		num_steps -= (1 && num_steps);
+		jumpnode_id = warthog::GRID_ID_MAX;
+	}
+	jumpcost = num_steps;
+}
+
+// stop at the first obstacle on the row, or at the first tile after
+// the current one where a run of traversable tiles starts on the row
+// above or below (a forced neighbour), whichever comes first
+template<>
+void
+warthog::jps::online_jump_point_locator2_base<warthog::rle_gridmap>::__jump_east(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap)
+{
+	uint32_t x, y;
+	mymap->to_padded_xy(node_id, x, y);
+	int32_t deadend_x = mymap->next_obstacle((int32_t)x, y);
+	int32_t forced_x = std::min(
+			mymap->next_change((int32_t)x, y-1, true),
+			mymap->next_change((int32_t)x, y+1, true));
+
+	int32_t stop_x = std::min(deadend_x, forced_x);
+	uint32_t num_steps = (uint32_t)(stop_x - (int32_t)x);
+#ifdef CNT
+  G::scan_cnt += (num_steps >> 5);
+#endif
+	finish_rle_jump(node_id + num_steps, num_steps, deadend_x <= forced_x,
+			goal_id - node_id, goal_id, jumpnode_id, jumpcost);
+}
+
+// as ::__jump_east, with the parent behind the jump direction: stop
+// at the tile before an obstacle on the row, or on the last tile of a
+// run of traversable tiles on the row above or below
+template<>
+void
+warthog::jps::online_jump_point_locator2_base<warthog::rle_gridmap>::__rjump_east(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap)
+{
+	uint32_t x, y;
+	mymap->to_padded_xy(node_id, x, y);
+	int32_t deadend_x = mymap->next_obstacle((int32_t)x + 1, y) - 1;
+	int32_t forced_x = std::min(
+			mymap->next_change((int32_t)x, y-1, false),
+			mymap->next_change((int32_t)x, y+1, false)) - 1;
+
+	int32_t stop_x = std::min(deadend_x, forced_x);
+	uint32_t num_steps = (uint32_t)(stop_x - (int32_t)x);
+	finish_rle_jump(node_id + num_steps, num_steps, deadend_x <= forced_x,
+			goal_id - node_id, goal_id, jumpnode_id, jumpcost);
+}
+
+// analogous to ::__jump_east
+template<>
+void
+warthog::jps::online_jump_point_locator2_base<warthog::rle_gridmap>::__jump_west(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap)
+{
+	uint32_t x, y;
+	mymap->to_padded_xy(node_id, x, y);
+	int32_t deadend_x = mymap->prev_obstacle((int32_t)x, y);
+	int32_t forced_x = std::max(
+			mymap->prev_change((int32_t)x, y-1, false),
+			mymap->prev_change((int32_t)x, y+1, false)) - 1;
+
+	int32_t stop_x = std::max(deadend_x, forced_x);
+	uint32_t num_steps = (uint32_t)((int32_t)x - stop_x);
+	finish_rle_jump(node_id - num_steps, num_steps, deadend_x >= forced_x,
+			node_id - goal_id, goal_id, jumpnode_id, jumpcost);
+}
+
+// analogous to ::__rjump_east
+template<>
+void
+warthog::jps::online_jump_point_locator2_base<warthog::rle_gridmap>::__rjump_west(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap)
+{
+	uint32_t x, y;
+	mymap->to_padded_xy(node_id, x, y);
+	int32_t deadend_x = mymap->prev_obstacle((int32_t)x - 1, y) + 1;
+	int32_t forced_x = std::max(
+			mymap->prev_change((int32_t)x, y-1, true),
+			mymap->prev_change((int32_t)x, y+1, true));
+
+	int32_t stop_x = std::max(deadend_x, forced_x);
+	uint32_t num_steps = (uint32_t)((int32_t)x - stop_x);
+	finish_rle_jump(node_id - num_steps, num_steps, deadend_x >= forced_x,
+			node_id - goal_id, goal_id, jumpnode_id, jumpcost);
+}
+
+template class warthog::jps::online_jump_point_locator2_base<warthog::gridmap>;
+template class warthog::jps::online_jump_point_locator2_base<warthog::blockmap>;
+template class warthog::jps::online_jump_point_locator2_base<warthog::rle_gridmap>;
@@ -16,7 +16,10 @@
 
 #include "jps.h"
 #include <vector>
+#include "blockmap.h"
 #include "gridmap.h"
+#include "gridmap_edit.h"
+#include "rle_gridmap.h"
 
 namespace warthog
 {
@@ -24,22 +27,31 @@ namespace warthog
 namespace jps
 {
 
-class online_jump_point_locator2
+template<typename MAP>
+class online_jump_point_locator2_base
 {
 	public: 
-		online_jump_point_locator2(warthog::gridmap* map);
-		~online_jump_point_locator2();
+		online_jump_point_locator2_base(MAP* map);
+		~online_jump_point_locator2_base();
 
 		void
-		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
-				std::vector<uint32_t>& jpoints,
+		jump(warthog::jps::direction d, warthog::grid_id_t node_id, warthog::grid_id_t goalid, 
+				std::vector<warthog::grid_id_t>& jpoints,
 				std::vector<warthog::cost_t>& costs);
 
+        // as ::jump, also giving the offset (dx, dy) of each jump point
+        // from @param node_id, in @param dxs and @param dys
+		void
+		jump(warthog::jps::direction d, warthog::grid_id_t node_id, warthog::grid_id_t goalid, 
+				std::vector<warthog::grid_id_t>& jpoints,
+				std::vector<warthog::cost_t>& costs,
+				std::vector<int32_t>& dxs, std::vector<int32_t>& dys);
+
         // similar to ::jump but assuming the parent is in the opposite 
         // direction to @param d
 		void
-		rjump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
-				std::vector<uint32_t>& jpoints,
+		rjump(warthog::jps::direction d, warthog::grid_id_t node_id, warthog::grid_id_t goalid, 
+				std::vector<warthog::grid_id_t>& jpoints,
 				std::vector<warthog::cost_t>& costs);
 
 		size_t 
@@ -48,113 +60,123 @@ class online_jump_point_locator2
 			return sizeof(this) + rmap_->mem();
 		}
 
-    inline warthog::gridmap* get_rmap() { return rmap_; }
-    inline warthog::gridmap* get_map() { return map_; }
+    inline MAP* get_rmap() { return rmap_; }
+    inline MAP* get_map() { return map_; }
 
 	private:
+        // offsets of the jump points found, if asked for; see ::jump
+        std::vector<int32_t>* dxs_;
+        std::vector<int32_t>* dys_;
+
+        inline void
+        add_offset(int32_t dx, int32_t dy)
+        {
+            if(dxs_) { dxs_->push_back(dx); dys_->push_back(dy); }
+        }
+
 		void
 		jump_north(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_south(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_east(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_west(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_northeast(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_northwest(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_southeast(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_southwest(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 
 		// these versions can be passed a map parameter to
 		// use when jumping. they allow switching between
 		// map_ and rmap_ (a rotated counterpart).
 		void
-		__jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				warthog::gridmap* mymap);
+		__jump_north(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				MAP* mymap);
 		void
-		__jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_south(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 		void
-		__jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_east(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 		void
-		__jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_west(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 
 		// these versions perform a single diagonal jump, returning
 		// the intermediate diagonal jump point and the straight 
 		// jump points that caused the jumping process to stop
 		void
 		__jump_northeast(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_northwest(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_southeast(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_southwest(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 
         // these jump functions assume the parent is in
         // the opposite direction to the jump direction
 		void
-		__rjump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__rjump_east(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 
 		void
-		__rjump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__rjump_west(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 
 
 		// functions to convert map indexes to rmap indexes
-		inline uint32_t
-		map_id_to_rmap_id(uint32_t mapid)
+		inline warthog::grid_id_t
+		map_id_to_rmap_id(warthog::grid_id_t mapid)
 		{
-            if(mapid == warthog::INF32) { return mapid; }
+            if(mapid == warthog::GRID_ID_MAX) { return mapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -165,10 +187,10 @@ class online_jump_point_locator2
 		}
 
 		// convert rmap indexes to map indexes
-		inline uint32_t
-		rmap_id_to_map_id(uint32_t rmapid)
+		inline warthog::grid_id_t
+		rmap_id_to_map_id(warthog::grid_id_t rmapid)
 		{
-            if(rmapid == warthog::INF32) { return rmapid; }
+            if(rmapid == warthog::GRID_ID_MAX) { return rmapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -178,29 +200,62 @@ class online_jump_point_locator2
 			return map_->to_padded_id(x, y);
 		}
 
-		warthog::gridmap*
+		MAP*
 		create_rmap();
 
-		warthog::gridmap* map_;
-		warthog::gridmap* rmap_;
+		MAP* map_;
+		MAP* rmap_;
+		// keeps rmap_ in step with edits to map_ (see warthog::gridmap_edit)
+		warthog::gridmap_index* rsync_;
 		//uint32_t jumplimit_;
 
-		uint32_t current_goal_id_;
-		uint32_t current_rgoal_id_;
-		uint32_t current_node_id_;
-		uint32_t current_rnode_id_;
+		warthog::grid_id_t current_goal_id_;
+		warthog::grid_id_t current_rgoal_id_;
+		warthog::grid_id_t current_node_id_;
+		warthog::grid_id_t current_rnode_id_;
 
         // these function pointers allow us to switch between forward jumping
         // and backward jumping (i.e. with the parent direction reversed)
-        void (warthog::jps::online_jump_point_locator2::*__jump_east_fp)
-            (uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
-             warthog::cost_t& jumpcost, warthog::gridmap* mymap);
+        void (warthog::jps::online_jump_point_locator2_base<MAP>::*__jump_east_fp)
+            (warthog::grid_id_t node_id, warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, 
+             warthog::cost_t& jumpcost, MAP* mymap);
 
-        void (warthog::jps::online_jump_point_locator2::*__jump_west_fp)
-            (uint32_t node_id, uint32_t goal_id, uint32_t& jumpnode_id, 
-             warthog::cost_t& jumpcost, warthog::gridmap* mymap);
+        void (warthog::jps::online_jump_point_locator2_base<MAP>::*__jump_west_fp)
+            (warthog::grid_id_t node_id, warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, 
+             warthog::cost_t& jumpcost, MAP* mymap);
 
 };
+
+typedef online_jump_point_locator2_base<warthog::gridmap>
+    online_jump_point_locator2;
+typedef online_jump_point_locator2_base<warthog::blockmap>
+    blocked_jump_point_locator2;
+typedef online_jump_point_locator2_base<warthog::rle_gridmap>
+    rle_jump_point_locator2;
+
+// on a warthog::rle_gridmap, straight jumps move from run to run
+// instead of reading tiles (see online_jump_point_locator2.cpp)
+template<> void
+online_jump_point_locator2_base<warthog::rle_gridmap>::__jump_east(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap);
+template<> void
+online_jump_point_locator2_base<warthog::rle_gridmap>::__jump_west(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap);
+template<> void
+online_jump_point_locator2_base<warthog::rle_gridmap>::__rjump_east(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap);
+template<> void
+online_jump_point_locator2_base<warthog::rle_gridmap>::__rjump_west(
+		warthog::grid_id_t node_id, warthog::grid_id_t goal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::rle_gridmap* mymap);
+
 }
 
 }
@@ -6,49 +6,36 @@
 #include <cassert>
 #include <climits>
 
-typedef warthog::online_jump_point_locator2_prune2 jlp;
 namespace G = global::query;
 namespace S = global::statis;
 
-jlp::online_jump_point_locator2_prune2(
-gridmap* map,
+template<typename MAP>
+warthog::online_jump_point_locator2_prune2_base<MAP>::online_jump_point_locator2_prune2_base(
+MAP* map,
 online_jps_pruner2* pruner)
 	: map_(map)//, jumplimit_(UINT32_MAX)
 {
 	rmap_ = create_rmap();
+	rsync_ = warthog::watch_rotated_copy(map_, rmap_);
   jp = pruner;
-	current_node_id_ = current_rnode_id_ = warthog::INF32;
-	current_goal_id_ = current_rgoal_id_ = warthog::INF32;
+	current_node_id_ = current_rnode_id_ = warthog::GRID_ID_MAX;
+	current_goal_id_ = current_rgoal_id_ = warthog::GRID_ID_MAX;
 }
 
-jlp::~online_jump_point_locator2_prune2()
+template<typename MAP>
+warthog::online_jump_point_locator2_prune2_base<MAP>::~online_jump_point_locator2_prune2_base()
 {
+	delete rsync_;
 	delete rmap_;
 }
 
 // create a copy of the grid map which is rotated by 90 degrees clockwise.
 // this version will be used when jumping North or South. 
-warthog::gridmap*
-jlp::create_rmap()
+template<typename MAP>
+MAP*
+warthog::online_jump_point_locator2_prune2_base<MAP>::create_rmap()
 {
-	uint32_t maph = map_->header_height();
-	uint32_t mapw = map_->header_width();
-	uint32_t rmaph = mapw;
-	uint32_t rmapw = maph;
-	warthog::gridmap* rmap = new warthog::gridmap(rmaph, rmapw);
-
-	for(uint32_t x = 0; x < mapw; x++) 
-	{
-		for(uint32_t y = 0; y < maph; y++)
-		{
-			uint32_t label = map_->get_label(map_->to_padded_id(x, y));
-			uint32_t rx = ((rmapw-1) - y);
-			uint32_t ry = x;
-			uint32_t rid = rmap->to_padded_id(rx, ry);
-			rmap->set_label(rid, label);
-		}
-	}
-	return rmap;
+	return map_->rotated_copy();
 }
 
 
@@ -58,10 +45,11 @@ jlp::create_rmap()
 // jump point successor.
 //
 // @return: the id of a jump point successor or warthog::INF if no jp exists.
+template<typename MAP>
 void
-jlp::jump(warthog::jps::direction d,
-	   	uint32_t node_id, uint32_t goal_id, 
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump(warthog::jps::direction d,
+	   	warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
 	// cache node and goal ids so we don't need to convert all the time
@@ -108,22 +96,23 @@ jlp::jump(warthog::jps::direction d,
 	}
 }
 
+template<typename MAP>
 void
-jlp::jump_north(
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_north(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_north(rnode_id, rgoal_id, jumpnode_id, jumpcost, rmap_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
-    // uint32_t rjp_id = jumpnode_id;
-		jumpnode_id = current_node_id_ - jp->jump_step * map_->width();
+    // warthog::grid_id_t rjp_id = jumpnode_id;
+		jumpnode_id = current_node_id_ - (warthog::grid_id_t)jp->jump_step * map_->width();
     // _backwards_gval_update(jumpnode_id, jumpcost, pa->get_g(), 1); // update south
     // backwards_gval_update_NS(jumpnode_id, rjp_id, jumpcost, pa->get_g(), jps::SOUTH);
     jp->setup(jp->north, pa->get_g(), G::gval(jumpnode_id), jumpcost);
@@ -136,32 +125,34 @@ jlp::jump_north(
 	} else jp->north.deactivate();
 }
 
+template<typename MAP>
 void
-jlp::__jump_north(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_north(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		MAP* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// east when we use a version of the map rotated 90 degrees.
 	__jump_east(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 }
 
+template<typename MAP>
 void
-jlp::jump_south(
-		std::vector<uint32_t>& jpoints, 
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_south(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_south(rnode_id, rgoal_id, jumpnode_id, jumpcost, rmap_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
-    // uint32_t rjp_id = jumpnode_id;
-    jumpnode_id = current_node_id_ + jp->jump_step * map_->width();
+    // warthog::grid_id_t rjp_id = jumpnode_id;
+    jumpnode_id = current_node_id_ + (warthog::grid_id_t)jp->jump_step * map_->width();
     // _backwards_gval_update(jumpnode_id, jumpcost, pa->get_g(), 0); // update north
     // backwards_gval_update_NS(jumpnode_id, rjp_id, jumpcost, pa->get_g(), jps::NORTH);
     jp->setup(jp->south, pa->get_g(), G::gval(jumpnode_id), jumpcost);
@@ -174,29 +165,31 @@ jlp::jump_south(
 	} else jp->south.deactivate();
 }
 
+template<typename MAP>
 void
-jlp::__jump_south(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_south(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		MAP* mymap)
 {
 	// jumping north in the original map is the same as jumping
 	// west when we use a version of the map rotated 90 degrees.
 	__jump_west(node_id, goal_id, jumpnode_id, jumpcost, rmap_);
 }
 
+template<typename MAP>
 void
-jlp::jump_east(
-		std::vector<uint32_t>& jpoints, 
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_east(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_east(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
     // _backwards_gval_update(jumpnode_id, jumpcost, pa->get_g(), 3); // update west
     // backwards_gval_update_EW(jumpnode_id, jumpcost, pa->get_g(), jps::WEST);
@@ -210,10 +203,11 @@ jlp::jump_east(
 }
 
 
+template<typename MAP>
 void
-jlp::__jump_east(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_east(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	jumpnode_id = node_id;
 
@@ -260,7 +254,7 @@ jlp::__jump_east(uint32_t node_id,
 #ifdef CNT
   S::scan_cnt += (num_steps >> 5) ;
 #endif
-	uint32_t goal_dist = goal_id - node_id;
+	warthog::grid_id_t goal_dist = goal_id - node_id;
 	if(num_steps > goal_dist)
 	{
     num_steps = goal_dist;
@@ -275,26 +269,27 @@ jlp::__jump_east(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// looked for the first set bit. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps;
 	
 }
 
 // analogous to ::jump_east 
+template<typename MAP>
 void
-jlp::jump_west(
-		std::vector<uint32_t>& jpoints, 
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_west(
+		std::vector<warthog::grid_id_t>& jpoints, 
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t jumpnode_id;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t jumpnode_id;
 	warthog::cost_t jumpcost;
 
 	__jump_west(node_id, goal_id, jumpnode_id, jumpcost, map_);
 
-	if(jumpnode_id != warthog::INF32)
+	if(jumpnode_id != warthog::GRID_ID_MAX)
 	{
     // _backwards_gval_update(jumpnode_id, jumpcost, pa->get_g(), 2); // update east
     // backwards_gval_update_EW(jumpnode_id, jumpcost, pa->get_g(), jps::EAST);
@@ -308,10 +303,11 @@ jlp::jump_west(
 	} else jp->west.deactivate();
 }
 
+template<typename MAP>
 void
-jlp::__jump_west(uint32_t node_id, 
-		uint32_t goal_id, uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		warthog::gridmap* mymap)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_west(warthog::grid_id_t node_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		MAP* mymap)
 {
 	bool deadend = false;
 	uint32_t neis[3] = {0, 0, 0};
@@ -347,7 +343,7 @@ jlp::__jump_west(uint32_t node_id,
 
   uint32_t& num_steps = jp->jump_step;
 	num_steps = node_id - jumpnode_id;
-	uint32_t goal_dist = node_id - goal_id;
+	warthog::grid_id_t goal_dist = node_id - goal_id;
 #ifdef CNT
   S::scan_cnt += (num_steps >> 5);
 #endif
@@ -365,25 +361,26 @@ jlp::__jump_west(uint32_t node_id,
 		// correct here since we just inverted neis[1] and then
 		// counted leading zeroes. need -1 to fix it.
 		num_steps -= (1 && num_steps);
-		jumpnode_id = warthog::INF32;
+		jumpnode_id = warthog::GRID_ID_MAX;
 	}
 	jumpcost = num_steps;
 }
 
+template<typename MAP>
 void
-jlp::jump_northeast(
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_northeast(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. node_id at centre. Assume little endian format.
@@ -400,19 +397,19 @@ jlp::jump_northeast(
   jp->setup(jp->v, jp->north.ga, jp->north.gb, jp->north.dC);
   jp->setup(jp->h, jp->east.ga, jp->east.gb, jp->east.dC);
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
-    jp1_id = jp2_id = warthog::INF32;
+    jp1_id = jp2_id = warthog::GRID_ID_MAX;
 		__jump_northeast(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-      // uint32_t rjp_id = jp1_id;
-			jp1_id = node_id - (uint32_t)(jp1_cost) * map_->width();
+      // warthog::grid_id_t rjp_id = jp1_id;
+			jp1_id = node_id - (warthog::grid_id_t)(jp1_cost) * map_->width();
       // update in south
       // _backwards_gval_update(jp1_id, jp1_cost, G::cur_diag_gval, 1);
       // backwards_gval_update_NS(jp1_id, rjp_id, jp1_cost, G::cur_diag_gval, jps::SOUTH);
@@ -424,7 +421,7 @@ jlp::jump_northeast(
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
       cost_t gp = pa->get_g() + cost_to_nodeid + jumpcost;
       // update in west
@@ -442,13 +439,14 @@ jlp::jump_northeast(
 	}
 }
 
+template<typename MAP>
 void
-jlp::__jump_northeast(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-		uint32_t& jp_id1, warthog::cost_t& cost1,
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_northeast(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1,
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 {
 	uint32_t num_steps = 0;
 
@@ -457,7 +455,7 @@ jlp::__jump_northeast(
 	uint32_t mapw = map_->width();
 
   if (jp->v.dominated() || jp->h.dominated()) {
-    jumpnode_id = warthog::INF32; jumpcost = 0; return;
+    jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
   }
 	while(true)
 	{
@@ -469,15 +467,15 @@ jlp::__jump_northeast(
     //   global::query::set_corner_gv(node_id, G::cur_diag_gval);
 
     if ((!jp->v.next()) || (!jp->h.next())) {
-      jumpnode_id = warthog::INF32; jumpcost = 0; return;
+      jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
     }
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
     jp->before_scanv(rmap_, rnode_id, 1);
 		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
     jp->jumpcost = cost1;
-    if (!jp->after_scanv(rmap_, node_id-jp->jump_step*mapw, jp_id1, cost1)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+    if (!jp->after_scanv(rmap_, node_id-(warthog::grid_id_t)jp->jump_step * mapw, jp_id1, cost1)) {
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
@@ -486,15 +484,15 @@ jlp::__jump_northeast(
 		__jump_east(node_id, goal_id, jp_id2, cost2, map_);
     jp->jumpcost = cost2;
     if (!jp->after_scanh(map_, node_id+jp->jump_step, jp_id2, cost2)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 
 		// couldn't move in either straight dir; node_id is an obstacle
 		if(!(cost1 && cost2)) 
 		{ 
-			node_id = jp_id1 = jp_id2 = warthog::INF32; 
+			node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; 
 			break; 
 		}
 
@@ -506,20 +504,21 @@ jlp::__jump_northeast(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-jlp::jump_northwest(
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_northwest(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
 	// from the grid. node_id at centre. Assume little endian format.
@@ -537,19 +536,19 @@ jlp::jump_northwest(
   jp->setup(jp->v, jp->north.ga, jp->north.gb, jp->north.dC);
   jp->setup(jp->h, jp->west.ga, jp->west.gb, jp->west.dC);
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
-    jp1_id = jp2_id = warthog::INF32;
+    jp1_id = jp2_id = warthog::GRID_ID_MAX;
 		__jump_northwest(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-      // uint32_t rjp_id = jp1_id;
-      jp1_id = node_id - (uint32_t)(jp1_cost) * map_->width();
+      // warthog::grid_id_t rjp_id = jp1_id;
+      jp1_id = node_id - (warthog::grid_id_t)(jp1_cost) * map_->width();
       // update in south
       // _backwards_gval_update(jp1_id, jp1_cost, G::cur_diag_gval, 1);
       // backwards_gval_update_NS(jp1_id, rjp_id, jp1_cost, G::cur_diag_gval, jps::SOUTH);
@@ -561,7 +560,7 @@ jlp::jump_northwest(
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
       // update in east
       // _backwards_gval_update(jp2_id, jp2_cost, G::cur_diag_gval, 2);
@@ -578,13 +577,14 @@ jlp::jump_northwest(
 	}
 }
 
+template<typename MAP>
 void
-jlp::__jump_northwest(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_northwest(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 
 {
 	uint32_t num_steps = 0;
@@ -594,7 +594,7 @@ jlp::__jump_northwest(
 	uint32_t mapw = map_->width();
 
   if (jp->v.dominated() || jp->h.dominated()) {
-    jumpnode_id = warthog::INF32; jumpcost = 0; return;
+    jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
   }
 	while(true)
 	{
@@ -606,15 +606,15 @@ jlp::__jump_northwest(
     //   global::query::set_corner_gv(node_id, G::cur_diag_gval);
 
     if ((!jp->v.next()) || (!jp->h.next())) {
-      jumpnode_id = warthog::INF32; jumpcost = 0; return;
+      jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
     }
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
     jp->before_scanv(rmap_,  rnode_id, 1);
 		__jump_north(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
     jp->jumpcost = cost1;
-    if (!jp->after_scanv(rmap_, node_id-jp->jump_step*mapw, jp_id1, cost1)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+    if (!jp->after_scanv(rmap_, node_id-(warthog::grid_id_t)jp->jump_step * mapw, jp_id1, cost1)) {
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
@@ -622,13 +622,13 @@ jlp::__jump_northwest(
 		__jump_west(node_id, goal_id, jp_id2, cost2, map_);
     jp->jumpcost = cost2;
     if (!jp->after_scanh(map_, node_id-jp->jump_step, jp_id2, cost2)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::INF32; break; 
+		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; break; 
 		}
 	}
 #ifdef CNT
@@ -638,20 +638,21 @@ jlp::__jump_northwest(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-jlp::jump_southeast(
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_southeast(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
   G::cur_diag_gval = pa->get_g();
 
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
@@ -669,19 +670,19 @@ jlp::jump_southeast(
   jp->setup(jp->v, jp->south.ga, jp->south.gb, jp->south.dC);
   jp->setup(jp->h, jp->east.ga, jp->east.gb, jp->east.dC);
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
-    jp1_id = jp2_id = warthog::INF32;
+    jp1_id = jp2_id = warthog::GRID_ID_MAX;
 		__jump_southeast(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, jp1_id, jp1_cost, 
 				jp2_id, jp2_cost);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
     {
-      // uint32_t rjp_id = jp1_id;
-			jp1_id = node_id + (uint32_t)(jp1_cost) * map_->width();
+      // warthog::grid_id_t rjp_id = jp1_id;
+			jp1_id = node_id + (warthog::grid_id_t)(jp1_cost) * map_->width();
       // update in north
       // _backwards_gval_update(jp1_id, jp1_cost, G::cur_diag_gval, 0);
       // backwards_gval_update_NS(jp1_id, rjp_id, jp1_cost, G::cur_diag_gval, jps::NORTH);
@@ -693,7 +694,7 @@ jlp::jump_southeast(
 			if(jp2_cost == 0) { break; } // no corner cutting
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
       // update in west
       // _backwards_gval_update(jp2_id, jp2_cost, G::cur_diag_gval, 3);
@@ -710,13 +711,14 @@ jlp::jump_southeast(
 	}
 }
 
+template<typename MAP>
 void
-jlp::__jump_southeast(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_southeast(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 
 {
 	uint32_t num_steps = 0;
@@ -726,7 +728,7 @@ jlp::__jump_southeast(
 	uint32_t mapw = map_->width();
 
   if (jp->v.dominated() || jp->h.dominated()) {
-    jumpnode_id = warthog::INF32; jumpcost = 0; return;
+    jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
   }
 	while(true)
 	{
@@ -738,15 +740,15 @@ jlp::__jump_southeast(
     //   global::query::set_corner_gv(node_id, G::cur_diag_gval);
 
     if ((!jp->v.next()) || (!jp->h.next())) {
-      jumpnode_id = warthog::INF32; jumpcost = 0; return;
+      jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
     }
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
     jp->before_scanv(rmap_, rnode_id, -1);
 		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
     jp->jumpcost = cost1;
-    if (!jp->after_scanv(rmap_, node_id+jp->jump_step*mapw, jp_id1, cost1)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+    if (!jp->after_scanv(rmap_, node_id+(warthog::grid_id_t)jp->jump_step * mapw, jp_id1, cost1)) {
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
@@ -754,12 +756,12 @@ jlp::__jump_southeast(
 		__jump_east(node_id, goal_id, jp_id2, cost2, map_);
     jp->jumpcost = cost2;
     if (!jp->after_scanh(map_, node_id+jp->jump_step, jp_id2, cost2)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
-    if ((jp_id1 & jp_id2) != warthog::INF32) break;
+    if ((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) break;
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::INF32; break; 
+		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; break; 
 		}
 	}
 #ifdef CNT
@@ -769,20 +771,21 @@ jlp::__jump_southeast(
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
 
+template<typename MAP>
 void
-jlp::jump_southwest(
-		std::vector<uint32_t>& jpoints,
+warthog::online_jump_point_locator2_prune2_base<MAP>::jump_southwest(
+		std::vector<warthog::grid_id_t>& jpoints,
 		std::vector<warthog::cost_t>& costs)
 {
-	uint32_t jumpnode_id, jp1_id, jp2_id;
+	warthog::grid_id_t jumpnode_id, jp1_id, jp2_id;
 	warthog::cost_t jumpcost, jp1_cost, jp2_cost, cost_to_nodeid;
 	jumpnode_id = jp1_id = jp2_id = 0;
 	jumpcost = jp1_cost = jp2_cost = cost_to_nodeid = 0;
 
-	uint32_t node_id = current_node_id_;
-	uint32_t goal_id = current_goal_id_;
-	uint32_t rnode_id = current_rnode_id_;
-	uint32_t rgoal_id = current_rgoal_id_;
+	warthog::grid_id_t node_id = current_node_id_;
+	warthog::grid_id_t goal_id = current_goal_id_;
+	warthog::grid_id_t rnode_id = current_rnode_id_;
+	warthog::grid_id_t rgoal_id = current_rgoal_id_;
   G::cur_diag_gval = pa->get_g();
 	
 	// first 3 bits of first 3 bytes represent a 3x3 cell of tiles
@@ -800,20 +803,20 @@ jlp::jump_southwest(
   jp->setup(jp->v, jp->south.ga, jp->south.gb, jp->south.dC);
   jp->setup(jp->h, jp->west.ga, jp->west.gb, jp->west.dC);
 
-	while(node_id != warthog::INF32)
+	while(node_id != warthog::GRID_ID_MAX)
 	{
 
-    jp1_id = jp2_id = warthog::INF32;
+    jp1_id = jp2_id = warthog::GRID_ID_MAX;
 		__jump_southwest(
 				node_id, rnode_id,
 				goal_id, rgoal_id,
 				jumpnode_id, jumpcost, 
 				jp1_id, jp1_cost, jp2_id, jp2_cost);
 
-		if(jp1_id != warthog::INF32)
+		if(jp1_id != warthog::GRID_ID_MAX)
 		{
-      // uint32_t rjp_id = jp1_id;
-      jp1_id = node_id + (uint32_t)(jp1_cost) * map_->width();
+      // warthog::grid_id_t rjp_id = jp1_id;
+      jp1_id = node_id + (warthog::grid_id_t)(jp1_cost) * map_->width();
       // update in north
       // _backwards_gval_update(jp1_id, jp1_cost, G::cur_diag_gval, 0);
       // backwards_gval_update_NS(jp1_id, rjp_id, jp1_cost, G::cur_diag_gval, jps::NORTH);
@@ -825,7 +828,7 @@ jlp::jump_southwest(
 			if(jp2_cost == 0) { break; }
 		}
 
-		if(jp2_id != warthog::INF32)
+		if(jp2_id != warthog::GRID_ID_MAX)
 		{
       // update in east
       // _backwards_gval_update(jp2_id, jp2_cost, G::cur_diag_gval, 2);
@@ -842,13 +845,14 @@ jlp::jump_southwest(
 	}
 }
 
+template<typename MAP>
 void
-jlp::__jump_southwest(
-		uint32_t& node_id, uint32_t& rnode_id, 
-		uint32_t goal_id, uint32_t rgoal_id,
-		uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-		uint32_t& jp_id1, warthog::cost_t& cost1, 
-		uint32_t& jp_id2, warthog::cost_t& cost2)
+warthog::online_jump_point_locator2_prune2_base<MAP>::__jump_southwest(
+		warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+		warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+		warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+		warthog::grid_id_t& jp_id1, warthog::cost_t& cost1, 
+		warthog::grid_id_t& jp_id2, warthog::cost_t& cost2)
 {
 	// jump a single step (no corner cutting)
 	uint32_t num_steps = 0;
@@ -856,7 +860,7 @@ jlp::__jump_southwest(
 	uint32_t rmapw = rmap_->width();
 
   if (jp->v.dominated() || jp->h.dominated()) {
-    jumpnode_id = warthog::INF32; jumpcost = 0; return;
+    jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
   }
 	while(true)
 	{
@@ -868,15 +872,15 @@ jlp::__jump_southwest(
     //   global::query::set_corner_gv(node_id, G::cur_diag_gval);
 
     if ((!jp->v.next()) || (!jp->h.next())) {
-      jumpnode_id = warthog::INF32; jumpcost = 0; return;
+      jumpnode_id = warthog::GRID_ID_MAX; jumpcost = 0; return;
     }
 		// recurse straight before stepping again diagonally;
 		// (ensures we do not miss any optimal turning points)
     jp->before_scanv(rmap_, rnode_id, -1);
 		__jump_south(rnode_id, rgoal_id, jp_id1, cost1, rmap_);
     jp->jumpcost = cost1;
-    if (!jp->after_scanv(rmap_, node_id+jp->jump_step*mapw, jp_id1, cost1)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+    if (!jp->after_scanv(rmap_, node_id+(warthog::grid_id_t)jp->jump_step * mapw, jp_id1, cost1)) {
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
@@ -884,15 +888,18 @@ jlp::__jump_southwest(
 		__jump_west(node_id, goal_id, jp_id2, cost2, map_);
     jp->jumpcost = cost2;
     if (!jp->after_scanh(map_, node_id-jp->jump_step, jp_id2, cost2)) {
-      jp_id1 = jp_id2 = jumpnode_id = INF32;
+      jp_id1 = jp_id2 = jumpnode_id = warthog::GRID_ID_MAX;
       jumpcost = 0; return;
     }
 
-		if((jp_id1 & jp_id2) != warthog::INF32) { break; }
+		if((jp_id1 & jp_id2) != warthog::GRID_ID_MAX) { break; }
 		// couldn't move in either straight dir; node_id is an obstacle
-		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::INF32; break; 
+		if(!(cost1 && cost2)) { node_id = jp_id1 = jp_id2 = warthog::GRID_ID_MAX; break; 
 		}
 	}
 	jumpnode_id = node_id;
 	jumpcost = num_steps*warthog::DBL_ROOT_TWO;
 }
+
+template class warthog::online_jump_point_locator2_prune2_base<warthog::gridmap>;
+template class warthog::online_jump_point_locator2_prune2_base<warthog::blockmap>;
@@ -5,7 +5,9 @@
 //
 
 #include "constants.h"
+#include "blockmap.h"
 #include "gridmap.h"
+#include "gridmap_edit.h"
 #include "jps.h"
 #include "online_jps_pruner2.h"
 #include "node_pool.h"
@@ -15,15 +17,16 @@
 namespace warthog
 {
 
-class online_jump_point_locator2_prune2
+template<typename MAP>
+class online_jump_point_locator2_prune2_base
 {
 	public: 
-		online_jump_point_locator2_prune2(gridmap* map, online_jps_pruner2* pruner);
-		~online_jump_point_locator2_prune2();
+		online_jump_point_locator2_prune2_base(MAP* map, online_jps_pruner2* pruner);
+		~online_jump_point_locator2_prune2_base();
 
 		void
-		jump(warthog::jps::direction d, uint32_t node_id, uint32_t goalid, 
-				std::vector<uint32_t>& jpoints,
+		jump(warthog::jps::direction d, warthog::grid_id_t node_id, warthog::grid_id_t goalid, 
+				std::vector<warthog::grid_id_t>& jpoints,
 				std::vector<warthog::cost_t>& costs);
 
 		uint32_t 
@@ -34,100 +37,100 @@ class online_jump_point_locator2_prune2
     online_jps_pruner2* jp;
     search_node* pa;
 
-    inline warthog::gridmap* get_rmap() { return rmap_; }
-    inline warthog::gridmap* get_map() { return map_; }
+    inline MAP* get_rmap() { return rmap_; }
+    inline MAP* get_map() { return map_; }
 
 	private:
 		void
 		jump_north(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_south(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_east(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_west(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_northeast(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_northwest(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_southeast(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 		void
 		jump_southwest(
-				std::vector<uint32_t>& jpoints, 
+				std::vector<warthog::grid_id_t>& jpoints, 
 				std::vector<warthog::cost_t>& costs);
 
 		// these versions can be passed a map parameter to
 		// use when jumping. they allow switching between
 		// map_ and rmap_ (a rotated counterpart).
 		void
-		__jump_north(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				warthog::gridmap* mymap);
+		__jump_north(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				MAP* mymap);
 		void
-		__jump_south(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_south(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 		void
-		__jump_east(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_east(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 		void
-		__jump_west(uint32_t node_id, uint32_t goal_id, 
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost, 
-				warthog::gridmap* mymap);
+		__jump_west(warthog::grid_id_t node_id, warthog::grid_id_t goal_id, 
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost, 
+				MAP* mymap);
 
 		// these versions perform a single diagonal jump, returning
 		// the intermediate diagonal jump point and the straight 
 		// jump points that caused the jumping process to stop
 		void
 		__jump_northeast(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_northwest(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_southeast(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 		void
 		__jump_southwest(
-				uint32_t& node_id, uint32_t& rnode_id, 
-				uint32_t goal_id, uint32_t rgoal_id,
-				uint32_t& jumpnode_id, warthog::cost_t& jumpcost,
-				uint32_t& jp1_id, warthog::cost_t& jp1_cost,
-				uint32_t& jp2_id, warthog::cost_t& jp2_cost);
+				warthog::grid_id_t& node_id, warthog::grid_id_t& rnode_id, 
+				warthog::grid_id_t goal_id, warthog::grid_id_t rgoal_id,
+				warthog::grid_id_t& jumpnode_id, warthog::cost_t& jumpcost,
+				warthog::grid_id_t& jp1_id, warthog::cost_t& jp1_cost,
+				warthog::grid_id_t& jp2_id, warthog::cost_t& jp2_cost);
 
 		// functions to convert map indexes to rmap indexes
-		inline uint32_t
-		map_id_to_rmap_id(uint32_t mapid)
+		inline warthog::grid_id_t
+		map_id_to_rmap_id(warthog::grid_id_t mapid)
 		{
-			if(mapid == warthog::INF32) { return mapid; }
+			if(mapid == warthog::GRID_ID_MAX) { return mapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -138,10 +141,10 @@ class online_jump_point_locator2_prune2
 		}
 
 		// convert rmap indexes to map indexes
-		inline uint32_t
-		rmap_id_to_map_id(uint32_t rmapid)
+		inline warthog::grid_id_t
+		rmap_id_to_map_id(warthog::grid_id_t rmapid)
 		{
-			if(rmapid == warthog::INF32) { return rmapid; }
+			if(rmapid == warthog::GRID_ID_MAX) { return rmapid; }
 
 			uint32_t x, y;
 			uint32_t rx, ry;
@@ -151,17 +154,19 @@ class online_jump_point_locator2_prune2
 			return map_->to_padded_id(x, y);
 		}
 
-		warthog::gridmap*
+		MAP*
 		create_rmap();
 
-		warthog::gridmap* map_;
-		warthog::gridmap* rmap_;
+		MAP* map_;
+		MAP* rmap_;
+		// keeps rmap_ in step with edits to map_ (see warthog::gridmap_edit)
+		warthog::gridmap_index* rsync_;
 		//uint32_t jumplimit_;
 
-		uint32_t current_goal_id_;
-		uint32_t current_rgoal_id_;
-		uint32_t current_node_id_;
-		uint32_t current_rnode_id_;
+		warthog::grid_id_t current_goal_id_;
+		warthog::grid_id_t current_rgoal_id_;
+		warthog::grid_id_t current_node_id_;
+		warthog::grid_id_t current_rnode_id_;
     // vector<bool> iscorner;
 
     // nxtjp[d][id] stores next jump point in direction `d` (NSEW) at `id`
@@ -201,7 +206,7 @@ class online_jump_point_locator2_prune2
       //   for (int x=0; x<mw; x++)
       //   for (int y=0; y<mh; y++) {
       //     int cx = x + dx[i], cy = y + dy[i];
-      //     uint32_t pid;
+      //     warthog::grid_id_t pid;
       //     pid = map_->to_padded_id(y*mw+x);
       //     if (!iscorner[pid]) continue;
       //     cost_t pcost = 0;
@@ -220,7 +225,7 @@ class online_jump_point_locator2_prune2
       // }
     }
 
-    // inline void _backwards_gval_update(uint32_t jpid, cost_t jpc, cost_t pgv, int dirid) {
+    // inline void _backwards_gval_update(warthog::grid_id_t jpid, cost_t jpc, cost_t pgv, int dirid) {
     //   cost_t cur_cost = 0;
     //   while (cur_cost + nxtjp[dirid][jpid].second < jpc) {
     //     cur_cost += nxtjp[dirid][jpid].second;
@@ -229,10 +234,10 @@ class online_jump_point_locator2_prune2
     //   }
     // }
 
-    inline void backwards_gval_update_NS(uint32_t jpid, uint32_t r_jpid, 
+    inline void backwards_gval_update_NS(warthog::grid_id_t jpid, warthog::grid_id_t r_jpid, 
         cost_t jpc, cost_t pgv, jps::direction dir) {
       cost_t cur_cost = 0, nxt_cost;
-      uint32_t nxtjp;
+      warthog::grid_id_t nxtjp;
       while (true) {
         nxtjp = jpid;
         _backwards_gval_update_online_NS(nxtjp, r_jpid, nxt_cost, dir);
@@ -243,11 +248,11 @@ class online_jump_point_locator2_prune2
       }
     }
 
-    inline void backwards_gval_update_EW(uint32_t jpid,
+    inline void backwards_gval_update_EW(warthog::grid_id_t jpid,
         cost_t jpc, cost_t pgv, jps::direction dir) {
       cost_t cur_cost = 0, nxt_cost;
       int cnt = 0;
-      uint32_t nxtjp;
+      warthog::grid_id_t nxtjp;
       while (true) {
         nxtjp = jpid;
         _backwards_gval_update_online_EW(nxtjp, nxt_cost, dir);
@@ -260,18 +265,18 @@ class online_jump_point_locator2_prune2
     }
 
     inline void _backwards_gval_update_online_NS(
-        uint32_t& jpid, uint32_t& r_jpid, cost_t& jcost, jps::direction dir) {
+        warthog::grid_id_t& jpid, warthog::grid_id_t& r_jpid, cost_t& jcost, jps::direction dir) {
       switch (dir) {
-        uint32_t rid;
+        warthog::grid_id_t rid;
         case jps::NORTH: {
-                           __jump_north(r_jpid, INF32, rid, jcost, rmap_);
-                           jpid -= jp->jump_step * map_->width();
+                           __jump_north(r_jpid, warthog::GRID_ID_MAX, rid, jcost, rmap_);
+                           jpid -= (warthog::grid_id_t)jp->jump_step * map_->width();
                            r_jpid = rid;
                            break;
                          }
         case jps::SOUTH: {
-                           __jump_south(r_jpid, INF32, rid, jcost, rmap_);
-                           jpid += jp->jump_step * map_->width();
+                           __jump_south(r_jpid, warthog::GRID_ID_MAX, rid, jcost, rmap_);
+                           jpid += (warthog::grid_id_t)jp->jump_step * map_->width();
                            r_jpid = rid;
                            break;
                          }
@@ -280,17 +285,17 @@ class online_jump_point_locator2_prune2
     }
 
     inline void _backwards_gval_update_online_EW(
-        uint32_t& jpid, cost_t& jcost, jps::direction dir) {
+        warthog::grid_id_t& jpid, cost_t& jcost, jps::direction dir) {
 
-      uint32_t id;
+      warthog::grid_id_t id;
       switch (dir) {
         case jps::EAST: {
-                          __jump_east(jpid, INF32, id, jcost, map_);
+                          __jump_east(jpid, warthog::GRID_ID_MAX, id, jcost, map_);
                           jpid += jp->jump_step;
                           break;
                         }
         case jps::WEST: {
-                          __jump_west(jpid, INF32, id, jcost, map_);
+                          __jump_west(jpid, warthog::GRID_ID_MAX, id, jcost, map_);
                           jpid -= jp->jump_step;
                           break;
                         }
@@ -299,4 +304,9 @@ class online_jump_point_locator2_prune2
     }
 };
 
+typedef online_jump_point_locator2_prune2_base<warthog::gridmap>
+    online_jump_point_locator2_prune2;
+typedef online_jump_point_locator2_prune2_base<warthog::blockmap>
+    blocked_jump_point_locator2_prune2;
+
 }
@@ -0,0 +1,174 @@
+#include "path_unpacker.h"
+
+#include <cassert>
+#include <cstdlib>
+
+// split the segment from @param from to @param to into a diagonal prefix
+// and a straight suffix. both ids are padded; @param width is the
+// padded width of the map
+static inline void
+split_segment(uint32_t width, warthog::grid_id_t from, warthog::grid_id_t to,
+        uint32_t& num_diag, uint32_t& num_straight,
+        int64_t& diag_step, int64_t& straight_step)
+{
+    int64_t dx = (int64_t)(to % width) - (int64_t)(from % width);
+    int64_t dy = (int64_t)(to / width) - (int64_t)(from / width);
+    int64_t sx = (dx > 0) - (dx < 0);
+    int64_t sy = (dy > 0) - (dy < 0);
+    uint32_t adx = (uint32_t)(dx < 0 ? -dx : dx);
+    uint32_t ady = (uint32_t)(dy < 0 ? -dy : dy);
+
+    diag_step = sy * (int64_t)width + sx;
+    if(adx > ady)
+    {
+        num_diag = ady;
+        num_straight = adx - ady;
+        straight_step = sx;
+    }
+    else
+    {
+        num_diag = adx;
+        num_straight = ady - adx;
+        straight_step = sy * (int64_t)width;
+    }
+}
+
+// write @param num ids into @param out, starting one step beyond
+// @param first. kept branch-free so the compiler can vectorise it
+static inline void
+fill_steps(warthog::grid_id_t* __restrict out, warthog::grid_id_t first,
+        int64_t step, uint32_t num)
+{
+    for(uint32_t k = 0; k < num; k++)
+    {
+        out[k] = first + (warthog::grid_id_t)((int64_t)(k+1) * step);
+    }
+}
+
+uint32_t
+warthog::jps::unpacked_length(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>& path)
+{
+    if(path.size() == 0) { return 0; }
+
+    uint32_t length = 1;
+    uint32_t width = map->width();
+    for(uint32_t i = 1; i < path.size(); i++)
+    {
+        uint32_t num_diag, num_straight;
+        int64_t diag_step, straight_step;
+        split_segment(width, (warthog::grid_id_t)path[i-1],
+                (warthog::grid_id_t)path[i],
+                num_diag, num_straight, diag_step, straight_step);
+        length += num_diag + num_straight;
+    }
+    return length;
+}
+
+warthog::cost_t
+warthog::jps::path_cost(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>& path)
+{
+    warthog::cost_t cost = 0;
+    uint32_t width = map->width();
+    for(uint32_t i = 1; i < path.size(); i++)
+    {
+        uint32_t num_diag, num_straight;
+        int64_t diag_step, straight_step;
+        split_segment(width, (warthog::grid_id_t)path[i-1],
+                (warthog::grid_id_t)path[i],
+                num_diag, num_straight, diag_step, straight_step);
+        cost += num_diag * warthog::DBL_ROOT_TWO + num_straight;
+    }
+    return cost;
+}
+
+uint32_t
+warthog::jps::unpack_path(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>& path,
+        warthog::grid_id_t* out, uint32_t capacity)
+{
+    uint32_t length = warthog::jps::unpacked_length(map, path);
+    if(length == 0 || length > capacity) { return length; }
+
+    uint32_t width = map->width();
+    uint32_t pos = 0;
+    out[pos++] = (warthog::grid_id_t)path[0];
+    for(uint32_t i = 1; i < path.size(); i++)
+    {
+        uint32_t num_diag, num_straight;
+        int64_t diag_step, straight_step;
+        warthog::grid_id_t from = (warthog::grid_id_t)path[i-1];
+        split_segment(width, from, (warthog::grid_id_t)path[i],
+                num_diag, num_straight, diag_step, straight_step);
+
+        fill_steps(&out[pos], from, diag_step, num_diag);
+        pos += num_diag;
+        from += (warthog::grid_id_t)((int64_t)num_diag * diag_step);
+
+        fill_steps(&out[pos], from, straight_step, num_straight);
+        pos += num_straight;
+    }
+    assert(pos == length);
+    return length;
+}
+
+void
+warthog::jps::unpack_path(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>& path,
+        std::vector<warthog::sn_id_t>& out)
+{
+    warthog::jps::path_unpacker it(map, &path);
+    out.reserve(out.size() + warthog::jps::unpacked_length(map, path));
+    for(warthog::grid_id_t id; it.next(id); ) { out.push_back(id); }
+}
+
+warthog::jps::path_unpacker::path_unpacker(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>* path)
+    : map_(map), path_(path)
+{
+    reset();
+}
+
+void
+warthog::jps::path_unpacker::reset()
+{
+    index_ = UINT32_MAX;
+    current_ = 0;
+    diag_left_ = straight_left_ = 0;
+    diag_step_ = straight_step_ = 0;
+}
+
+bool
+warthog::jps::path_unpacker::next_segment()
+{
+    if(index_ == UINT32_MAX)
+    {
+        if(path_->size() == 0) { return false; }
+        index_ = 0;
+        current_ = (warthog::grid_id_t)path_->at(0);
+        return true;
+    }
+
+    // skip zero-length segments (i.e. repeated jump points)
+    while(index_ + 1 < path_->size())
+    {
+        index_++;
+        split_segment(map_->width(), current_,
+                (warthog::grid_id_t)path_->at(index_),
+                diag_left_, straight_left_, diag_step_, straight_step_);
+        if(diag_left_)
+        {
+            current_ += diag_step_;
+            diag_left_--;
+            return true;
+        }
+        if(straight_left_)
+        {
+            current_ += straight_step_;
+            straight_left_--;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,118 @@
+#ifndef WARTHOG_JPS_PATH_UNPACKER_H
+#define WARTHOG_JPS_PATH_UNPACKER_H
+
+// jps/path_unpacker.h
+//
+// Jump point search returns paths made up only of jump points
+// (see warthog::solution::path_). This file converts such paths into
+// cell-level paths: every grid cell visited on the way from the
+// start to the target.
+//
+// Consecutive jump points are joined by a canonical segment: a diagonal
+// prefix followed by a straight (cardinal) suffix, the same ordering
+// in which the jump point locators scan. Cells are identified by their
+// padded gridmap ids, so each step is a single addition.
+//
+// Three interfaces are provided:
+//  - ::unpack_path fills a caller-supplied buffer in one pass;
+//  - warthog::jps::path_unpacker yields one cell at a time and never
+//  materialises the whole path;
+//  - ::unpacked_length and ::path_cost answer "how far" questions
+//  without visiting any cell. clients that need only the cost of a
+//  path should call warthog::search::get_pathcost instead of
+//  ::get_path, which skips path extraction altogether.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace warthog
+{
+
+namespace jps
+{
+
+// the number of cells on the cell-level version of @param path,
+// including the first and last jump point
+uint32_t
+unpacked_length(warthog::gridmap* map,
+        const std::vector<warthog::sn_id_t>& path);
+
+// the octile cost of @param path (which should equal the
+// sum_of_edge_costs_ reported by the search)
+warthog::cost_t
+path_cost(warthog::gridmap* map, const std::vector<warthog::sn_id_t>& path);
+
+// write the padded ids of every cell on @param path into @param out.
+// @param capacity: number of elements available at @param out
+// @return the number of cells on the unpacked path. if this is larger
+// than @param capacity nothing is written and the caller should retry
+// with a buffer of (at least) the returned size
+uint32_t
+unpack_path(warthog::gridmap* map, const std::vector<warthog::sn_id_t>& path,
+        warthog::grid_id_t* out, uint32_t capacity);
+
+// as above, but appends the padded ids of each cell to @param out
+void
+unpack_path(warthog::gridmap* map, const std::vector<warthog::sn_id_t>& path,
+        std::vector<warthog::sn_id_t>& out);
+
+// iterates over the cells of a jump point path, one at a time.
+// e.g.
+//      warthog::jps::path_unpacker it(&map, &sol.path_);
+//      for(warthog::grid_id_t id; it.next(id); ) { ... }
+//
+// NB: the jump point path must outlive the iterator
+class path_unpacker
+{
+    public:
+        path_unpacker(warthog::gridmap* map,
+                const std::vector<warthog::sn_id_t>* path);
+
+        // retrieve the next cell on the path.
+        // @return false if the path is exhausted
+        inline bool
+        next(warthog::grid_id_t& padded_id)
+        {
+            if(diag_left_ == 0 && straight_left_ == 0)
+            {
+                if(!next_segment()) { return false; }
+                padded_id = current_;
+                return true;
+            }
+
+            if(diag_left_) { current_ += diag_step_; diag_left_--; }
+            else { current_ += straight_step_; straight_left_--; }
+            padded_id = current_;
+            return true;
+        }
+
+        // start again from the first cell
+        void
+        reset();
+
+    private:
+        warthog::gridmap* map_;
+        const std::vector<warthog::sn_id_t>* path_;
+        uint32_t index_;     // the jump point last reached
+        warthog::grid_id_t current_;
+        uint32_t diag_left_;
+        uint32_t straight_left_;
+        int64_t diag_step_;
+        int64_t straight_step_;
+
+        bool
+        next_segment();
+};
+
+}
+
+}
+
+#endif
@@ -0,0 +1,355 @@
+#include "label/component_labelling.h"
+#include "util/helpers.h"
+#include "util/timer.h"
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+
+// the horizontal runs of traversable cells found in one band of rows,
+// joined into components of that band
+struct cl_band
+{
+    uint32_t first_row_;
+    uint32_t last_row_;                 // one past the end
+    std::vector<uint32_t> row_begin_;   // first run of every row, and end
+    std::vector<uint32_t> run_x0_;
+    std::vector<uint32_t> run_x1_;      // one past the end of the run
+    std::vector<uint32_t> parent_;      // union-find over the runs
+    std::vector<uint32_t> comp_;        // the component of every run
+};
+
+struct cl_shared_data
+{
+    warthog::gridmap* map_;
+    std::vector<cl_band>* bands_;
+    std::vector<uint16_t>* labels_;
+    std::vector<uint32_t>* wide_labels_;
+    bool write_labels_;
+};
+
+inline uint32_t
+uf_find(std::vector<uint32_t>& parent, uint32_t i)
+{
+    while(parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+inline void
+uf_join(std::vector<uint32_t>& parent, uint32_t a, uint32_t b)
+{
+    a = uf_find(parent, a);
+    b = uf_find(parent, b);
+    if(a < b) { parent[b] = a; }
+    else { parent[a] = b; }
+}
+
+// the first position >= @param x of @param row whose bit equals
+// @param value; @param width if there is none
+inline uint32_t
+next_bit(const warthog::gridword* row, uint32_t x, uint32_t width, bool value)
+{
+    while(x < width)
+    {
+        warthog::gridword word = row[x >> warthog::LOG2_GRIDWORD_BITS];
+        if(!value) { word = ~word; }
+        word >>= (x & warthog::GRIDWORD_BITS_MASK);
+        if(word) { return std::min(x + (uint32_t)__builtin_ctzll(word), width); }
+        x = (x | warthog::GRIDWORD_BITS_MASK) + 1;
+    }
+    return width;
+}
+
+// join runs [i, i_last) of one row with runs [j, j_last) of the row
+// below wherever they overlap. runs are those of bands @param a and
+// @param b, which start at @param a_offset and @param b_offset in
+// @param parent
+void
+join_rows(const cl_band& a, uint32_t i, uint32_t i_last,
+          const cl_band& b, uint32_t j, uint32_t j_last,
+          std::vector<uint32_t>& parent, uint32_t a_offset, uint32_t b_offset)
+{
+    while(i < i_last && j < j_last)
+    {
+        if(a.run_x0_[i] < b.run_x1_[j] && b.run_x0_[j] < a.run_x1_[i])
+        { uf_join(parent, a_offset + i, b_offset + j); }
+        if(a.run_x1_[i] < b.run_x1_[j]) { i++; }
+        else { j++; }
+    }
+}
+
+// find the runs of every row of @param band and join those that
+// overlap on consecutive rows
+void
+find_runs(cl_band& band, warthog::gridmap* map)
+{
+    uint32_t width = map->width();
+    for(uint32_t y = band.first_row_; y < band.last_row_; y++)
+    {
+        const warthog::gridword* row =
+            map->get_mem_ptr((warthog::grid_id_t)y * width);
+        uint32_t x = next_bit(row, 0, width, true);
+        while(x < width)
+        {
+            uint32_t end = next_bit(row, x, width, false);
+            band.parent_.push_back((uint32_t)band.run_x0_.size());
+            band.run_x0_.push_back(x);
+            band.run_x1_.push_back(end);
+            x = next_bit(row, end, width, true);
+        }
+        band.row_begin_.push_back((uint32_t)band.run_x0_.size());
+
+        uint32_t r = y - band.first_row_;
+        if(r > 0)
+        {
+            join_rows(band, band.row_begin_[r-1], band.row_begin_[r],
+                      band, band.row_begin_[r], band.row_begin_[r+1],
+                      band.parent_, 0, 0);
+        }
+    }
+}
+
+// label every cell of @param band with the component of its run
+template<typename LABEL>
+void
+write_labels(const cl_band& band, uint32_t width, std::vector<LABEL>& labels)
+{
+    for(uint32_t y = band.first_row_; y < band.last_row_; y++)
+    {
+        uint32_t r = y - band.first_row_;
+        for(uint32_t i = band.row_begin_[r]; i < band.row_begin_[r+1]; i++)
+        {
+            warthog::grid_id_t id =
+                (warthog::grid_id_t)y * width + band.run_x0_[i];
+            std::fill(labels.begin() + id,
+                    labels.begin() + id + (band.run_x1_[i] - band.run_x0_[i]),
+                    (LABEL)band.comp_[i]);
+        }
+    }
+}
+
+}
+
+const uint32_t warthog::label::component_labelling::NO_COMPONENT;
+
+warthog::label::component_labelling::component_labelling(
+        warthog::gridmap* map) : map_(map)
+{
+    map_version_ = map_->get_version();
+    parent_.push_back(NO_COMPONENT);
+    map_->add_index(this);
+}
+
+warthog::label::component_labelling::~component_labelling()
+{
+    map_->remove_index(this);
+}
+
+void
+warthog::label::component_labelling::precompute()
+{
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        cl_shared_data* shared = (cl_shared_data*) par->shared_;
+
+        // bands are evenly divided among all threads
+        for(uint32_t b = par->thread_id_; b < shared->bands_->size();
+                b += par->max_threads_)
+        {
+            cl_band& band = shared->bands_->at(b);
+            uint32_t width = shared->map_->width();
+            if(!shared->write_labels_) { find_runs(band, shared->map_); }
+            else if(shared->wide_labels_->empty())
+            { write_labels(band, width, *shared->labels_); }
+            else { write_labels(band, width, *shared->wide_labels_); }
+            par->nprocessed_ += band.last_row_ - band.first_row_;
+        }
+        return 0;
+    };
+
+    if(map_->padded_mapsize() / 2 >= UINT32_MAX)
+    {
+        std::cerr << "err; map too large for component_labelling\n";
+        return;
+    }
+
+    warthog::timer t;
+    t.start();
+    std::cerr << "computing connected components\n";
+
+    // one band of rows per thread
+    #ifdef SINGLE_THREADED
+    uint32_t num_bands = 1;
+    #else
+    uint32_t num_bands = std::max(1u, std::thread::hardware_concurrency());
+    #endif
+    std::vector<cl_band> bands(num_bands);
+    for(uint32_t b = 0; b < num_bands; b++)
+    {
+        bands[b].first_row_ =
+            (uint32_t)((uint64_t)map_->height() * b / num_bands);
+        bands[b].last_row_ =
+            (uint32_t)((uint64_t)map_->height() * (b+1) / num_bands);
+        bands[b].row_begin_.push_back(0);
+    }
+
+    cl_shared_data shared;
+    shared.map_ = map_;
+    shared.bands_ = &bands;
+    shared.labels_ = &labels_;
+    shared.wide_labels_ = &wide_labels_;
+    shared.write_labels_ = false;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, map_->height());
+
+    // join the bands along their boundaries, in one union-find over
+    // the runs of all bands
+    std::vector<uint32_t> offset(num_bands + 1, 0);
+    for(uint32_t b = 0; b < num_bands; b++)
+    { offset[b+1] = offset[b] + (uint32_t)bands[b].run_x0_.size(); }
+
+    std::vector<uint32_t> parent(offset[num_bands]);
+    for(uint32_t b = 0; b < num_bands; b++)
+    {
+        for(uint32_t i = 0; i < bands[b].parent_.size(); i++)
+        { parent[offset[b] + i] = offset[b] + uf_find(bands[b].parent_, i); }
+    }
+
+    // bands can be empty when the map has fewer rows than threads
+    uint32_t above = 0;
+    for(uint32_t b = 1; b < num_bands; b++)
+    {
+        if(bands[b].first_row_ == bands[b].last_row_) { continue; }
+        if(bands[above].first_row_ != bands[above].last_row_)
+        {
+            uint32_t rows = bands[above].last_row_ - bands[above].first_row_;
+            join_rows(bands[above], bands[above].row_begin_[rows-1],
+                      bands[above].row_begin_[rows],
+                      bands[b], 0, bands[b].row_begin_[1],
+                      parent, offset[above], offset[b]);
+        }
+        above = b;
+    }
+
+    // number the components in order of their first run
+    parent_.assign(1, NO_COMPONENT);
+    std::vector<uint32_t> comp_of_root(parent.size(), NO_COMPONENT);
+    for(uint32_t b = 0; b < num_bands; b++)
+    {
+        bands[b].comp_.resize(bands[b].run_x0_.size());
+        for(uint32_t i = 0; i < bands[b].run_x0_.size(); i++)
+        {
+            uint32_t root = uf_find(parent, offset[b] + i);
+            if(comp_of_root[root] == NO_COMPONENT)
+            {
+                comp_of_root[root] = (uint32_t)parent_.size();
+                parent_.push_back((uint32_t)parent_.size());
+            }
+            bands[b].comp_[i] = comp_of_root[root];
+        }
+    }
+
+    std::vector<uint16_t>().swap(labels_);
+    std::vector<uint32_t>().swap(wide_labels_);
+    if(parent_.size() <= UINT16_MAX)
+    { labels_.assign(map_->padded_mapsize(), NO_COMPONENT); }
+    else { wide_labels_.assign(map_->padded_mapsize(), NO_COMPONENT); }
+    shared.write_labels_ = true;
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, map_->height());
+    map_version_ = map_->get_version();
+
+    t.stop();
+    std::cerr << "done. components: " << get_num_components()
+        << " time " << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+void
+warthog::label::component_labelling::set_label(
+        warthog::grid_id_t grid_id_p, bool traversable)
+{
+    map_version_ = map_->get_version();
+    if(grid_id_p >= num_labels()) { return; }
+    if(!traversable)
+    {
+        set_component(grid_id_p, NO_COMPONENT);
+        return;
+    }
+    if(label(grid_id_p) != NO_COMPONENT) { return; }
+
+    // the new cell joins the components of its neighbours. padding
+    // keeps the neighbours of traversable cells inside the map
+    warthog::grid_id_t w = map_->width();
+    warthog::grid_id_t nbs[4] =
+        { grid_id_p - w, grid_id_p - 1, grid_id_p + 1, grid_id_p + w };
+    uint32_t comp = NO_COMPONENT;
+    bool merged = false;
+    for(uint32_t i = 0; i < 4; i++)
+    {
+        if(nbs[i] >= num_labels()) { continue; }
+        uint32_t c = find(label(nbs[i]));
+        if(c == NO_COMPONENT || c == comp) { continue; }
+        if(comp == NO_COMPONENT) { comp = c; continue; }
+
+        // keep the smaller id
+        if(c < comp) { std::swap(c, comp); }
+        parent_[c] = comp;
+        merged = true;
+    }
+
+    if(comp == NO_COMPONENT)
+    {
+        comp = (uint32_t)parent_.size();
+        parent_.push_back(comp);
+    }
+    set_component(grid_id_p, comp);
+
+    // merges are rare; flatten the components so that ::find takes
+    // at most one step
+    if(merged)
+    {
+        for(uint32_t c = 0; c < parent_.size(); c++)
+        { parent_[c] = find(c); }
+    }
+}
+
+void
+warthog::label::component_labelling::repair(
+        warthog::gridmap* map, const warthog::gridmap_change& change)
+{
+    if(num_labels() == 0) { return; }
+    for(uint32_t y = change.y1_; y <= change.y2_; y++)
+    {
+        for(uint32_t x = change.x1_; x <= change.x2_; x++)
+        {
+            warthog::grid_id_t id = (warthog::grid_id_t)y * map_->width() + x;
+            bool traversable = map_->get_label(id);
+            if(traversable != (label(id) != NO_COMPONENT))
+            { set_label(id, traversable); }
+        }
+    }
+    map_version_ = map_->get_version();
+}
+
+void
+warthog::label::component_labelling::set_component(
+        warthog::grid_id_t grid_id_p, uint32_t comp)
+{
+    if(wide_labels_.empty() && comp > UINT16_MAX)
+    {
+        wide_labels_.assign(labels_.begin(), labels_.end());
+        std::vector<uint16_t>().swap(labels_);
+    }
+    if(wide_labels_.empty()) { labels_[grid_id_p] = (uint16_t)comp; }
+    else { wide_labels_[grid_id_p] = comp; }
+}
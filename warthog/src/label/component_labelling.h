@@ -0,0 +1,155 @@
+#ifndef WARTHOG_COMPONENT_LABELLING_H
+#define WARTHOG_COMPONENT_LABELLING_H
+
+// label/component_labelling.h
+//
+// Connected components of a gridmap. Every traversable cell is labelled
+// with the component it belongs to; two cells are connected iff their
+// labels agree. The JPS expansion policies consult the labels when a
+// search starts and fail at once on queries whose start and target are
+// disconnected, instead of exploring the whole component of the start.
+//
+// Diagonal moves may not cut corners, so a diagonal step between two
+// cells is only possible if both cells beside it are traversable; the
+// components are therefore those of the 4-connected grid.
+//
+// Labels are computed one horizontal run of traversable cells at a
+// time: runs of the same band of rows are joined with a union-find
+// structure by one thread per band, and the bands are then joined along
+// their boundary rows.
+//
+// Changing the map through ::set_label, or through a warthog::gridmap_edit
+// (the labelling is an index of its map), keeps the labels up to date:
+// a new traversable cell joins the components of its neighbours. A new
+// obstacle can split a component; this is not detected, the labels stay
+// conservative (cells can share a label and yet be disconnected) until
+// the next ::precompute.
+//
+// Labels take 16 bits per padded cell while the map has fewer than
+// 2^16 components, which covers the maps we know of, and 32 bits
+// otherwise; ::set_label widens them when it creates the 2^16th
+// component.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "gridmap_edit.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+class component_labelling : public warthog::gridmap_index
+{
+    public:
+        component_labelling(warthog::gridmap* map);
+        virtual ~component_labelling();
+
+        // label every traversable cell of the map
+        void
+        precompute();
+
+        // @return false if there is no path between the padded ids
+        // @param from_id and @param to_id; true otherwise
+        inline bool
+        connected(warthog::grid_id_t from_id, warthog::grid_id_t to_id) const
+        {
+            return find(label(from_id)) == find(label(to_id));
+        }
+
+        // @return the component of padded id @param grid_id_p, or
+        // NO_COMPONENT for obstacles
+        inline uint32_t
+        get_component(warthog::grid_id_t grid_id_p) const
+        { return find(label(grid_id_p)); }
+
+        // record a change of the label of padded id @param grid_id_p
+        // (see warthog::gridmap::set_label). call this after changing
+        // the map
+        void
+        set_label(warthog::grid_id_t grid_id_p, bool traversable);
+
+        // relabel the tiles changed by a warthog::gridmap_edit
+        virtual void
+        repair(warthog::gridmap* map, const warthog::gridmap_change& change);
+
+        // false if the labels were not computed, or if the map was
+        // modified other than through ::set_label after they were
+        inline bool
+        is_current()
+        {
+            return num_labels() != 0 && map_->get_version() == map_version_;
+        }
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+        // number of components, including those merged by ::set_label
+        inline uint32_t
+        get_num_components() { return (uint32_t)parent_.size() - 1; }
+
+        inline size_t
+        mem()
+        {
+            return sizeof(*this) +
+                sizeof(uint16_t) * labels_.capacity() +
+                sizeof(uint32_t) *
+                    (wide_labels_.capacity() + parent_.capacity());
+        }
+
+        static const uint32_t NO_COMPONENT = 0;
+
+    private:
+        warthog::gridmap* map_;
+        uint32_t map_version_;
+
+        // the component of every padded id; NO_COMPONENT for obstacles.
+        // one of the two is empty: labels_ while every component fits
+        // in 16 bits, wide_labels_ after
+        std::vector<uint16_t> labels_;
+        std::vector<uint32_t> wide_labels_;
+
+        // components joined by ::set_label point to the component they
+        // were merged into; others point to themselves. this is what
+        // lets ::connected read the labels without writing to them
+        std::vector<uint32_t> parent_;
+
+        inline uint32_t
+        label(warthog::grid_id_t grid_id_p) const
+        {
+            return wide_labels_.empty() ?
+                labels_[grid_id_p] : wide_labels_[grid_id_p];
+        }
+
+        inline size_t
+        num_labels() const
+        { return labels_.size() + wide_labels_.size(); }
+
+        void
+        set_component(warthog::grid_id_t grid_id_p, uint32_t comp);
+
+        inline uint32_t
+        find(uint32_t comp) const
+        {
+            while(parent_[comp] != comp) { comp = parent_[comp]; }
+            return comp;
+        }
+
+        component_labelling(const component_labelling& other) { }
+        component_labelling&
+        operator=(const component_labelling& other) { return *this; }
+};
+
+}
+
+}
+
+#endif
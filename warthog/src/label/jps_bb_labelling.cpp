@@ -0,0 +1,270 @@
+#include "heuristics/zero_heuristic.h"
+#include "label/jps_bb_labelling.h"
+#include "jps/jps.h"
+#include "search/flexible_astar.h"
+#include "search/gridmap_expansion_policy.h"
+#include "search/problem_instance.h"
+#include "search/search_node.h"
+#include "search/solution.h"
+#include "util/helpers.h"
+#include "util/pqueue.h"
+#include "util/timer.h"
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static const char JBB_MAGIC[4] = { 'W', 'J', 'B', 'B' };
+static const uint32_t JBB_VERSION = 1;
+
+struct jbb_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint64_t map_hash_;
+    uint64_t num_labelled_;
+};
+
+namespace
+{
+
+// g-values that differ by less than this are considered equal
+const double JBB_TIE_EPSILON = 1e-6;
+
+struct jbb_shared_data
+{
+    warthog::label::jps_bb_labelling* lab_;
+    std::vector<warthog::label::jps_bb_box>* boxes_;
+};
+
+// the direction of the move from @param from to the adjacent cell @param to
+inline uint8_t
+move_direction(warthog::gridmap* map, uint32_t from, uint32_t to)
+{
+    int32_t delta = (int32_t)to - (int32_t)from;
+    int32_t w = (int32_t)map->width();
+    if(delta == -w)     { return warthog::jps::NORTH; }
+    if(delta == w)      { return warthog::jps::SOUTH; }
+    if(delta == 1)      { return warthog::jps::EAST; }
+    if(delta == -1)     { return warthog::jps::WEST; }
+    if(delta == -w + 1) { return warthog::jps::NORTHEAST; }
+    if(delta == -w - 1) { return warthog::jps::NORTHWEST; }
+    if(delta == w + 1)  { return warthog::jps::SOUTHEAST; }
+    return warthog::jps::SOUTHWEST;
+}
+
+// tracks, for every node, the set of first moves that begin an optimal
+// path from the source; grows the boxes of the source as nodes are
+// expanded
+struct jbb_search_listener
+{
+    warthog::gridmap* map_;
+    std::vector<uint8_t>* first_moves_;
+    warthog::label::jps_bb_box* boxes_; // the 8 boxes of the source
+    uint32_t source_id_;
+
+    inline void
+    generate_node(warthog::search_node* from,
+                  warthog::search_node* succ,
+                  warthog::cost_t edge_cost,
+                  uint32_t edge_id)
+    {
+        if(from == 0) { return; } // start node
+
+        uint32_t f_id = (uint32_t)from->get_id();
+        uint32_t s_id = (uint32_t)succ->get_id();
+        uint8_t moves = f_id == source_id_ ?
+            move_direction(map_, f_id, s_id) : first_moves_->at(f_id);
+
+        double alt_g = from->get_g() + edge_cost;
+        double g_val =
+            succ->get_search_number() == from->get_search_number() ?
+            succ->get_g() : warthog::INF32;
+
+        if(alt_g < g_val - JBB_TIE_EPSILON)
+        { first_moves_->at(s_id) = moves; }
+        else if(alt_g <= g_val + JBB_TIE_EPSILON)
+        { first_moves_->at(s_id) |= moves; }
+    }
+
+    inline void
+    expand_node(warthog::search_node* current)
+    {
+        uint32_t node_id = (uint32_t)current->get_id();
+        if(node_id == source_id_) { return; }
+
+        uint32_t x, y;
+        map_->to_padded_xy(node_id, x, y);
+        uint8_t moves = first_moves_->at(node_id);
+        for(uint32_t i = 0; i < 8; i++)
+        {
+            if(moves & (1 << i)) { boxes_[i].grow(x, y); }
+        }
+    }
+
+    inline void
+    relax_node(warthog::search_node* current) { }
+};
+
+}
+
+warthog::label::jps_bb_labelling::jps_bb_labelling(warthog::gridmap* map)
+    : map_(map), map_version_(map->get_version())
+{
+    clear();
+}
+
+warthog::label::jps_bb_labelling::~jps_bb_labelling()
+{ }
+
+void
+warthog::label::jps_bb_labelling::clear()
+{
+    jps_bb_box empty;
+    empty.x1 = empty.y1 = UINT16_MAX;
+    empty.x2 = empty.y2 = 0;
+    boxes_.assign((size_t)map_->padded_mapsize() * 8, empty);
+}
+
+void
+warthog::label::jps_bb_labelling::precompute()
+{
+    void*(*thread_compute_fn)(void*) =
+    [] (void* args_in) -> void*
+    {
+        warthog::helpers::thread_params* par =
+            (warthog::helpers::thread_params*) args_in;
+        jbb_shared_data* shared = (jbb_shared_data*) par->shared_;
+        warthog::gridmap* map = shared->lab_->get_map();
+
+        std::vector<uint8_t> first_moves(map->padded_mapsize(), 0);
+
+        warthog::zero_heuristic h;
+        warthog::pqueue_min open;
+        jbb_search_listener listener;
+        warthog::gridmap_expansion_policy expander(map);
+
+        warthog::flexible_astar
+            <warthog::zero_heuristic,
+            warthog::gridmap_expansion_policy,
+            warthog::pqueue_min,
+            jbb_search_listener>
+                dijk(&h, &expander, &open, &listener);
+
+        listener.map_ = map;
+        listener.first_moves_ = &first_moves;
+        uint32_t task = 0;
+        for(uint32_t i = 0; i < map->padded_mapsize(); i++)
+        {
+            if(!map->get_label(i)) { continue; }
+
+            // source nodes are evenly divided among all threads;
+            // skip any source nodes not intended for current thread
+            if((task++ % par->max_threads_) != par->thread_id_)
+            { continue; }
+
+            listener.source_id_ = i;
+            listener.boxes_ = &shared->boxes_->at((size_t)i * 8);
+
+            warthog::problem_instance problem(
+                    map->to_unpadded_id(i), warthog::SN_ID_MAX);
+            warthog::solution sol;
+            dijk.get_pathcost(problem, sol);
+            par->nprocessed_++;
+        }
+        return 0;
+    };
+
+    if(map_->width() > UINT16_MAX || map_->height() > UINT16_MAX)
+    {
+        std::cerr << "err; map too large for jps_bb_labelling\n";
+        return;
+    }
+
+    warthog::timer t;
+    t.start();
+
+    clear();
+    map_version_ = map_->get_version();
+
+    jbb_shared_data shared;
+    shared.lab_ = this;
+    shared.boxes_ = &boxes_;
+
+    std::cerr << "computing jps bounding boxes\n";
+    warthog::helpers::parallel_compute(
+            thread_compute_fn, &shared, map_->get_num_traversable_tiles());
+    t.stop();
+    std::cerr << "done. time " << t.elapsed_time_nano() / 1e9 << " s\n";
+}
+
+bool
+warthog::label::jps_bb_labelling::save(const char* filename)
+{
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if(!out.good())
+    {
+        std::cerr << "err; cannot write jps bounding boxes to "
+            << filename << "\n";
+        return false;
+    }
+
+    jbb_header header;
+    memcpy(header.magic_, JBB_MAGIC, 4);
+    header.version_ = JBB_VERSION;
+    header.padded_width_ = map_->width();
+    header.padded_height_ = map_->height();
+    header.map_hash_ = map_->checksum();
+    header.num_labelled_ = 0;
+    for(uint32_t i = 0; i < map_->padded_mapsize(); i++)
+    { header.num_labelled_ += map_->get_label(i) != 0; }
+    out.write((const char*)&header, sizeof(header));
+
+    // obstacles have no labels; they are not written
+    for(uint32_t i = 0; i < map_->padded_mapsize(); i++)
+    {
+        if(!map_->get_label(i)) { continue; }
+        out.write((const char*)&boxes_[(size_t)i * 8],
+                sizeof(jps_bb_box) * 8);
+    }
+    return out.good();
+}
+
+bool
+warthog::label::jps_bb_labelling::load(const char* filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    if(!in.good()) { return false; }
+
+    jbb_header header;
+    in.read((char*)&header, sizeof(header));
+    if( !in.good() ||
+        memcmp(header.magic_, JBB_MAGIC, 4) != 0 ||
+        header.version_ != JBB_VERSION ||
+        header.padded_width_ != map_->width() ||
+        header.padded_height_ != map_->height() ||
+        header.map_hash_ != map_->checksum())
+    {
+        std::cerr << "jps bounding boxes in " << filename
+            << " do not match the map\n";
+        return false;
+    }
+
+    clear();
+    for(uint32_t i = 0; i < map_->padded_mapsize(); i++)
+    {
+        if(!map_->get_label(i)) { continue; }
+        in.read((char*)&boxes_[(size_t)i * 8], sizeof(jps_bb_box) * 8);
+    }
+    if(!in.good())
+    {
+        std::cerr << "unexpected error while reading " << filename << "\n";
+        clear();
+        return false;
+    }
+    map_version_ = map_->get_version();
+    return true;
+}
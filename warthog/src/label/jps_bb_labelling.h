@@ -0,0 +1,124 @@
+#ifndef WARTHOG_JPS_BB_LABELLING_H
+#define WARTHOG_JPS_BB_LABELLING_H
+
+// label/jps_bb_labelling.h
+//
+// Geometric containers for jump point search on gridmaps.
+// For every traversable cell and every one of the 8 directions of travel
+// we store a bounding box. Inside the box can be found all cells that are
+// reached optimally by some path whose first move is in that direction.
+// When JPS expands a node it only needs to jump in the directions whose
+// box contains the target; the other directions cannot lead to the
+// target optimally and are skipped altogether.
+//
+// The idea is the same as warthog::label::bb_labelling but stored per
+// direction (cf. per edge) so that it plugs into the online JPS
+// expansion policies. For the combination with JPS see:
+//
+// [S. Rabin and N. Sturtevant, Combining Bounding Boxes and JPS to
+// Prune Grid Pathfinding, AAAI, 2016]
+//
+// Ties are kept: a box is grown for every direction that begins an
+// optimal path (not just the first one found). This ensures the
+// canonical path that JPS follows is never pruned.
+//
+// Labels are indexed by padded id and boxes use padded coordinates,
+// 16 bits each. The on-disk format (see ::save) stores the labels of
+// traversable cells only.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "gridmap.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace label
+{
+
+struct jps_bb_box
+{
+    // an empty box has x1 > x2
+    uint16_t x1, y1, x2, y2;
+
+    inline bool
+    contains(uint32_t x, uint32_t y) const
+    { return x >= x1 && x <= x2 && y >= y1 && y <= y2; }
+
+    inline void
+    grow(uint32_t x, uint32_t y)
+    {
+        if(x < x1) { x1 = (uint16_t)x; }
+        if(y < y1) { y1 = (uint16_t)y; }
+        if(x > x2) { x2 = (uint16_t)x; }
+        if(y > y2) { y2 = (uint16_t)y; }
+    }
+};
+
+class jps_bb_labelling
+{
+    public:
+        jps_bb_labelling(warthog::gridmap* map);
+        ~jps_bb_labelling();
+
+        // @return the set of directions (see warthog::jps::direction) in
+        // which an optimal path from @param padded_id to the cell at
+        // padded coordinates (@param tx, @param ty) can begin
+        inline uint32_t
+        get_dirs(uint32_t padded_id, uint32_t tx, uint32_t ty) const
+        {
+            const jps_bb_box* box = &boxes_[(size_t)padded_id * 8];
+            uint32_t dirs = 0;
+            for(uint32_t i = 0; i < 8; i++)
+            { dirs |= (uint32_t)box[i].contains(tx, ty) << i; }
+            return dirs;
+        }
+
+        // the box of direction (1 << @param dir_index) at @param padded_id
+        inline const jps_bb_box&
+        get_label(uint32_t padded_id, uint32_t dir_index) const
+        { return boxes_[(size_t)padded_id * 8 + dir_index]; }
+
+        inline warthog::gridmap*
+        get_map() { return map_; }
+
+        // false if the map was modified after the labels were computed
+        inline bool
+        is_current() { return map_->get_version() == map_version_; }
+
+        inline size_t
+        mem()
+        { return sizeof(*this) + sizeof(jps_bb_box) * boxes_.capacity(); }
+
+        // compute labels for every traversable cell of the map.
+        // one Dijkstra search per cell, distributed over all cores
+        void
+        precompute();
+
+        // write the labels to / read them from @param filename.
+        // reading fails if the labels were computed for another map
+        bool
+        save(const char* filename);
+
+        bool
+        load(const char* filename);
+
+    private:
+        warthog::gridmap* map_;
+        uint32_t map_version_;
+        std::vector<jps_bb_box> boxes_;
+
+        void
+        clear();
+};
+
+}
+
+}
+
+#endif
@@ -57,7 +57,6 @@ class anytime_astar : public warthog::search
 			open_ = queue;
             cost_cutoff_ = warthog::COST_MAX;
             exp_cutoff_ = UINT32_MAX;
-            time_cutoff_nanos_ = UINT64_MAX;
             on_relax_fn_ = 0;
             on_generate_fn_ = 0;
             on_expand_fn_ = 0;
@@ -206,10 +205,11 @@ class anytime_astar : public warthog::search
         inline void
         set_cost_cutoff(warthog::cost_t cutoff) { cost_cutoff_ = cutoff; }
 
+        // see warthog::search::set_time_cutoff_nano
         inline void
         set_time_cutoff(uint64_t nanos)
         {
-            time_cutoff_nanos_ = nanos;
+            set_time_cutoff_nano((double)nanos);
         }
 
         inline warthog::cost_t
@@ -249,7 +249,6 @@ class anytime_astar : public warthog::search
         // early termination limits
         warthog::cost_t cost_cutoff_; 
         uint32_t exp_cutoff_;
-        uint64_t time_cutoff_nanos_;
 
         // callback for when a node is relaxed
         std::function<void(warthog::search_node*)>* on_relax_fn_;
@@ -353,13 +352,14 @@ class anytime_astar : public warthog::search
                     incumbent = current;
                     incumbent_lb = current_lb;
                     incumbent_ub = current_ub;
+                    sol.status_ = warthog::solution::FOUND;
                     break;
                 }
                     
                 // other termination criteria 
                 if(current->get_f() > cost_cutoff_) { break; } 
                 if(sol.nodes_expanded_ >= exp_cutoff_) { break; }
-                if(mytimer.elapsed_time_nano() >= time_cutoff_nanos_) { break; }
+                if(interrupted(mytimer, sol)) { break; }
 
 
                 // generate successors
@@ -208,6 +208,7 @@ class bch_search : public warthog::search
             // init
             best_cost_ = warthog::INF32;
             v_ = w_ = 0;
+            sol.status_ = warthog::solution::NO_PATH;
 
             #ifndef NDEBUG
             if(pi_.verbose_)
@@ -257,6 +258,7 @@ class bch_search : public warthog::search
 
                 if(best_bound > cost_cutoff_) { break; } 
                 if(sol.nodes_expanded_ >= exp_cutoff_) { break; }
+                if(interrupted(mytimer, sol)) { break; }
 
                 // terminate if we cannot improve the best solution so far.
                 // NB: bidirectional dijkstra stops when the two search 
@@ -327,6 +329,11 @@ class bch_search : public warthog::search
 
             assert(best_cost_ != warthog::INF32 || (v_ == 0 && w_ == 0));
 
+            // when interrupted, the best path found so far (if any) 
+            // is the partial result
+            if(sol.status_ == warthog::solution::NO_PATH && (v_ || w_))
+            { sol.status_ = warthog::solution::FOUND; }
+
 			mytimer.stop();
 			sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
             sol.nodes_surplus_ = fopen_->size() + bopen_->size();
@@ -228,6 +228,7 @@ class bidirectional_search : public warthog::search
             v_ = 0;
             w_ = 0;
             pi_ = pi_new;
+            sol.status_ = warthog::solution::NO_PATH;
 
             uint32_t fwd_instance_id;
             uint32_t bwd_instance_id;
@@ -304,6 +305,7 @@ class bidirectional_search : public warthog::search
                 if(best_bound >= best_cost_) { break; }
                 if(best_bound > cost_cutoff_) { break; }
                 if(sol.nodes_expanded_ >= exp_cutoff_) { break; }
+                if(interrupted(mytimer, sol)) { break; }
 
                 // always expand the most promising node in either direction
                 if(forward_next())
@@ -333,6 +335,11 @@ class bidirectional_search : public warthog::search
                 best_cost_ = warthog::COST_MAX;
             }
 
+            // when interrupted, the best path found so far (if any) 
+            // is the partial result
+            if(sol.status_ == warthog::solution::NO_PATH && (v_ || w_))
+            { sol.status_ = warthog::solution::FOUND; }
+
 			mytimer.stop();
 			sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
             sol.nodes_surplus_ = fopen_->size() + bopen_->size();
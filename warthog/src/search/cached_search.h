@@ -0,0 +1,316 @@
+#ifndef WARTHOG_CACHED_SEARCH_H
+#define WARTHOG_CACHED_SEARCH_H
+
+// search/cached_search.h
+//
+// Puts a warthog::query_cache in front of any warthog::search.
+//
+// Queries are first answered from the cache: either by an exact match
+// or, when possible, by a sub-path of a previously cached optimal path
+// that visits both the start and the target. Only when both lookups
+// fail is the underlying search invoked; its result is then cached.
+//
+// Sub-path reuse requires the cost of every segment of a cached path.
+// When searching a gridmap these are octile distances between
+// consecutive path nodes (which holds for the paths returned by A* and
+// by the JPS variants); in other domains the caller must supply a
+// segment cost function via ::set_segment_cost_fn.
+//
+// Cached entries are tagged with the version of the gridmap (see
+// warthog::gridmap::get_version). Any modification of the map, e.g.
+// through the perturbation() methods of the JPS expansion policies,
+// makes the entries computed before it stale. Batches of changes made
+// through a warthog::gridmap_edit that only add obstacles keep the
+// entries whose paths stay clear of the changed tiles. In other domains
+// use warthog::query_cache::invalidate after changing the graph.
+//
+// A single cache can be shared by many cached_search objects (e.g. one
+// per thread); the cached_search object itself is not thread-safe.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "gridmap.h"
+#include "gridmap_edit.h"
+#include "octile_heuristic.h"
+#include "problem_instance.h"
+#include "query_cache.h"
+#include "search.h"
+#include "solution.h"
+#include "timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <memory>
+
+namespace warthog
+{
+
+class cached_search
+    : public warthog::search, public warthog::gridmap_index
+{
+    public:
+        // @param algo: the search used to answer cache misses
+        // @param cache: the cache; may be shared with other objects
+        // @param map_id: identifies the map that @param algo searches
+        // @param map: (optional) the gridmap that @param algo searches
+        cached_search(warthog::search* algo, warthog::query_cache* cache,
+                uint32_t map_id, warthog::gridmap* map = 0)
+            : algo_(algo), cache_(cache), map_id_(map_id), map_(map),
+              symmetric_(map != 0)
+        {
+            if(map_)
+            {
+                warthog::octile_heuristic octile(map_->width(), map_->height());
+                segment_cost_fn_ =
+                    [octile](warthog::sn_id_t a, warthog::sn_id_t b) mutable
+                    { return octile.h(a, b); };
+                map_->add_index(this);
+            }
+        }
+
+        virtual ~cached_search()
+        {
+            if(map_) { map_->remove_index(this); }
+        }
+
+        // @param fn returns the cost of the path segment between two
+        // consecutive path nodes. enables sub-path reuse.
+        inline void
+        set_segment_cost_fn(
+                std::function<warthog::cost_t(
+                    warthog::sn_id_t, warthog::sn_id_t)> fn)
+        { segment_cost_fn_ = fn; }
+
+        // when true, cached paths can also be used in reverse
+        // (i.e. the graph is undirected). default: true for gridmaps.
+        inline void
+        set_symmetric(bool symmetric) { symmetric_ = symmetric; }
+
+        virtual void
+        get_path(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            sol.reset();
+
+            std::shared_ptr<const warthog::cache_entry> e =
+                cache_->find(map_id_, version(), pi.start_id_, pi.target_id_);
+            if(e && !(e->path_.size() == 0 && e->cost_ != warthog::COST_MAX))
+            {
+                sol.sum_of_edge_costs_ = e->cost_;
+                sol.path_ = e->path_;
+                finish(e->cost_, sol, mytimer);
+                return;
+            }
+
+            if(answer_from_subpath(pi, sol, true))
+            {
+                finish(sol.sum_of_edge_costs_, sol, mytimer);
+                return;
+            }
+
+            algo_->get_path(pi, sol);
+            store(pi, sol, true);
+        }
+
+        virtual void
+        get_pathcost(warthog::problem_instance& pi, warthog::solution& sol)
+        {
+            warthog::timer mytimer;
+            mytimer.start();
+            sol.reset();
+
+            std::shared_ptr<const warthog::cache_entry> e =
+                cache_->find(map_id_, version(), pi.start_id_, pi.target_id_);
+            if(e)
+            {
+                sol.sum_of_edge_costs_ = e->cost_;
+                finish(e->cost_, sol, mytimer);
+                return;
+            }
+
+            if(answer_from_subpath(pi, sol, false))
+            {
+                finish(sol.sum_of_edge_costs_, sol, mytimer);
+                return;
+            }
+
+            algo_->get_pathcost(pi, sol);
+            store(pi, sol, false);
+        }
+
+        // cache misses are answered by the wrapped search, which gets the
+        // same limits
+        virtual void
+        set_time_cutoff_nano(double cutoff)
+        {
+            warthog::search::set_time_cutoff_nano(cutoff);
+            algo_->set_time_cutoff_nano(cutoff);
+        }
+
+        virtual void
+        set_cancel_token(std::atomic<bool>* token)
+        {
+            warthog::search::set_cancel_token(token);
+            algo_->set_cancel_token(token);
+        }
+
+        inline warthog::query_cache*
+        get_cache() { return cache_; }
+
+        // new obstacles leave optimal those paths that avoid them, and
+        // leave unsolvable queries unsolvable. new traversable tiles can
+        // shorten any path; every entry then goes stale
+        virtual void
+        repair(warthog::gridmap* map, const warthog::gridmap_change& change)
+        {
+            if(change.num_opened_) { return; }
+
+            // diagonal steps may not cut corners; a path that touches the
+            // changed tiles diagonally is affected too
+            uint32_t x1 = change.x1_ - 1, y1 = change.y1_ - 1;
+            uint32_t x2 = change.x2_ + 1, y2 = change.y2_ + 1;
+            cache_->carry_over(map_id_, change.from_version_,
+                    change.to_version_,
+                [this, x1, y1, x2, y2](const warthog::cache_entry& e) -> bool
+                {
+                    if(e.cost_ == warthog::COST_MAX) { return true; }
+                    if(e.path_.size() == 0) { return false; }
+                    for(uint32_t i = 0; i < e.path_.size(); i++)
+                    {
+                        // each segment is a straight or diagonal line
+                        // that stays inside the box of its endpoints
+                        uint32_t ax, ay, bx, by;
+                        map_->to_padded_xy(e.path_[i], ax, ay);
+                        uint32_t j = i + 1 < e.path_.size() ? i + 1 : i;
+                        map_->to_padded_xy(e.path_[j], bx, by);
+                        if(std::max(ax, bx) >= x1 && std::min(ax, bx) <= x2 &&
+                           std::max(ay, by) >= y1 && std::min(ay, by) <= y2)
+                        { return false; }
+                    }
+                    return true;
+                });
+        }
+
+        virtual size_t
+        mem() { return sizeof(*this) + algo_->mem(); }
+
+    private:
+        warthog::search* algo_;
+        warthog::query_cache* cache_;
+        uint32_t map_id_;
+        warthog::gridmap* map_;
+        bool symmetric_;
+        std::function<warthog::cost_t(warthog::sn_id_t, warthog::sn_id_t)>
+            segment_cost_fn_;
+
+        inline uint32_t
+        version() { return map_ ? map_->get_version() : 0; }
+
+        // convert the id of a query endpoint into the id of a path node
+        inline bool
+        to_path_id(warthog::sn_id_t id, warthog::sn_id_t& path_id)
+        {
+            if(!map_) { path_id = id; return true; }
+            if(id >= (warthog::sn_id_t)map_->header_width() *
+                    map_->header_height()) { return false; }
+            path_id = map_->to_padded_id((uint32_t)id);
+            return true;
+        }
+
+        inline void
+        finish(warthog::cost_t cost, warthog::solution& sol,
+                warthog::timer& mytimer)
+        {
+            sol.status_ = cost == warthog::COST_MAX ?
+                warthog::solution::NO_PATH : warthog::solution::FOUND;
+            mytimer.stop();
+            sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
+        }
+
+        bool
+        answer_from_subpath(warthog::problem_instance& pi,
+                warthog::solution& sol, bool want_path)
+        {
+            if(!segment_cost_fn_) { return false; }
+
+            warthog::sn_id_t from, to;
+            if(!to_path_id(pi.start_id_, from) ||
+               !to_path_id(pi.target_id_, to)) { return false; }
+
+            uint32_t first, last;
+            std::shared_ptr<const warthog::cache_entry> e =
+                cache_->find_subpath(map_id_, version(), from, to,
+                        symmetric_, first, last);
+            if(!e) { return false; }
+
+            if(first <= last)
+            {
+                sol.sum_of_edge_costs_ = e->g_[last] - e->g_[first];
+                if(want_path)
+                {
+                    sol.path_.assign(e->path_.begin() + first,
+                            e->path_.begin() + last + 1);
+                }
+            }
+            else
+            {
+                sol.sum_of_edge_costs_ = e->g_[first] - e->g_[last];
+                if(want_path)
+                {
+                    sol.path_.assign(e->path_.begin() + last,
+                            e->path_.begin() + first + 1);
+                    std::reverse(sol.path_.begin(), sol.path_.end());
+                }
+            }
+            return true;
+        }
+
+        // cache the result of a query answered by the underlying search
+        void
+        store(warthog::problem_instance& pi, warthog::solution& sol,
+                bool has_path)
+        {
+            // interrupted searches are not necessarily optimal
+            if(sol.status_ != warthog::solution::FOUND &&
+               sol.status_ != warthog::solution::NO_PATH) { return; }
+
+            std::shared_ptr<warthog::cache_entry> e =
+                std::make_shared<warthog::cache_entry>();
+            e->map_id_ = map_id_;
+            e->version_ = version();
+            e->start_id_ = pi.start_id_;
+            e->target_id_ = pi.target_id_;
+            e->cost_ = sol.status_ == warthog::solution::FOUND ?
+                sol.sum_of_edge_costs_ : warthog::COST_MAX;
+
+            if(has_path && sol.status_ == warthog::solution::FOUND)
+            {
+                e->path_ = sol.path_;
+                if(segment_cost_fn_ && e->path_.size())
+                {
+                    e->g_.resize(e->path_.size());
+                    e->g_[0] = 0;
+                    for(uint32_t i = 1; i < e->path_.size(); i++)
+                    {
+                        e->g_[i] = e->g_[i-1] +
+                            segment_cost_fn_(e->path_[i-1], e->path_[i]);
+                    }
+
+                    // the segment costs do not add up; the path is not
+                    // made of octile segments. don't reuse its sub-paths
+                    if(std::fabs(e->g_.back() - e->cost_) > 1e-6)
+                    { e->g_.clear(); }
+                }
+            }
+            cache_->insert(e);
+        }
+};
+
+}
+
+#endif
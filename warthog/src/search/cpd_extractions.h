@@ -67,6 +67,8 @@ class cpd_extractions_base : public warthog::search
                 sol.nodes_touched_++;
             }
             sol.path_.push_back(source_id);
+            if(source_id == target_id)
+            { sol.status_ = warthog::solution::FOUND; }
 
             mytimer.stop();
             sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
@@ -103,6 +105,8 @@ class cpd_extractions_base : public warthog::search
                 sol.sum_of_edge_costs_ += e->wt_;
                 sol.nodes_touched_++;
             }
+            if(source_id == target_id)
+            { sol.status_ = warthog::solution::FOUND; }
 
             mytimer.stop();
             sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
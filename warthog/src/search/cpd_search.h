@@ -70,6 +70,10 @@ class cpd_search : public warthog::search
         if(target)
         {
             sol.sum_of_edge_costs_ = target->get_g();
+            if (sol.status_ == warthog::solution::NO_PATH)
+            {
+                sol.status_ = warthog::solution::FOUND;
+            }
         }
     }
 
@@ -86,6 +90,10 @@ class cpd_search : public warthog::search
 
             // follow backpointers to extract the path
             assert(expander_->is_target(target, &pi_));
+            if (sol.status_ == warthog::solution::NO_PATH)
+            {
+                sol.status_ = warthog::solution::FOUND;
+            }
             warthog::search_node* current = target;
             while(true)
             {
@@ -308,6 +316,12 @@ class cpd_search : public warthog::search
                   exp_cutoff_);
             stop = true;
         }
+        // Cancelled, or exceeded the wall-clock limit of warthog::search
+        if (interrupted(*mytimer, *sol))
+        {
+            info(pi_.verbose_, "Interrupted", sol->status_);
+            stop = true;
+        }
         // Exceeded time limit
         if (mytimer->elapsed_time_nano() > time_cutoff_)
         {
@@ -87,7 +87,8 @@ class depth_first_search : public warthog::search
                 sol.sum_of_edge_costs_ = target->get_g();
 
 				// follow backpointers to extract the path
-				assert(expander_->is_target(target, &pi_));
+				assert(sol.status_ != warthog::solution::FOUND ||
+                        expander_->is_target(target, &pi_));
                 warthog::search_node* current = target;
 				while(true)
                 {
@@ -240,6 +241,14 @@ class depth_first_search : public warthog::search
                 // terminate if we've reached the limit for expanded nodes
                 if(sol.nodes_expanded_ > exp_cutoff_) { break; }
 
+                // stop if cancelled or out of time; the current branch 
+                // is the partial result
+                if(interrupted(mytimer, sol))
+                {
+                    target = stack_.back().first;
+                    break;
+                }
+
                 // search continues; pop a node off the stack
                 dfs_pair& c_pair = stack_.back();
 				warthog::search_node* current = c_pair.first;
@@ -248,6 +257,7 @@ class depth_first_search : public warthog::search
                 if(expander_->is_target(current, &pi_))
                 {
                     target = current;
+                    sol.status_ = warthog::solution::FOUND;
                     break;
                 }
 
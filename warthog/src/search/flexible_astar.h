@@ -29,11 +29,64 @@
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace warthog
 {
 
+// true if heuristic H can evaluate a batch of nodes in one call
+// (see e.g. warthog::octile_heuristic)
+template<class H>
+struct has_batch_h
+{
+    template<class T>
+    static auto test(int) -> decltype(
+            std::declval<T*>()->h((const warthog::sn_id_t*)0, (uint32_t)0,
+                (warthog::sn_id_t)0, (double*)0), std::true_type());
+
+    template<class>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<H>(0))::value;
+};
+
+// true if heuristic H can evaluate a batch of (x, y) coordinates
+template<class H>
+struct has_batch_xy_h
+{
+    template<class T>
+    static auto test(int) -> decltype(
+            std::declval<T*>()->h((const int32_t*)0, (const int32_t*)0,
+                (uint32_t)0, (int32_t)0, (int32_t)0, (double*)0),
+            std::true_type());
+
+    template<class>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<H>(0))::value;
+};
+
+// true if expansion policy E knows the coordinates of its successors
+// (see e.g. warthog::jps2_expansion_policy)
+template<class E>
+struct has_successor_xy
+{
+    template<class T>
+    static auto test(int) -> decltype(
+            std::declval<T*>()->get_successor_xy(
+                std::declval<const int32_t*&>(),
+                std::declval<const int32_t*&>(),
+                std::declval<int32_t&>(), std::declval<int32_t&>()),
+            std::true_type());
+
+    template<class>
+    static std::false_type test(...);
+
+    static const bool value = decltype(test<E>(0))::value;
+};
+
 // H is a heuristic function
 // E is an expansion policy
 template< class H,
@@ -81,7 +134,8 @@ class flexible_astar: public warthog::search
                 sol.sum_of_edge_costs_ = target->get_g();
 
 				// follow backpointers to extract the path
-				assert(expander_->is_target(target, &pi_));
+				assert(sol.status_ != warthog::solution::FOUND ||
+                        expander_->is_target(target, &pi_));
                 warthog::search_node* current = target;
 				while(true)
                 {
@@ -198,6 +252,69 @@ class flexible_astar: public warthog::search
         warthog::cost_t cost_cutoff_;
         uint32_t exp_cutoff_;
 
+        // successors of the current node and their heuristic values,
+        // for heuristics that support batch evaluation
+        typedef std::integral_constant<bool,
+                warthog::has_batch_h<H>::value> batch_h;
+        std::vector<warthog::sn_id_t> succ_ids_;
+        std::vector<double> succ_h_;
+
+        // ... and from coordinates, if the expansion policy has them
+        typedef std::integral_constant<bool,
+                warthog::has_batch_xy_h<H>::value &&
+                warthog::has_successor_xy<E>::value> batch_xy_h;
+
+        inline void
+        eval_successors(std::true_type)
+        {
+            uint32_t num = (uint32_t)expander_->num_successors();
+            if(num == 0) { return; }
+            if(succ_ids_.size() < num)
+            {
+                succ_ids_.resize(num);
+                succ_h_.resize(num);
+            }
+            if(pi_.target_id_ != warthog::SN_ID_MAX &&
+               eval_successors_xy(num, batch_xy_h()))
+            { return; }
+
+            for(uint32_t i = 0; i < num; i++)
+            {
+                warthog::search_node* n;
+                warthog::cost_t cost_to_n;
+                expander_->get_successor(i, n, cost_to_n);
+                succ_ids_[i] = n->get_id();
+            }
+            heuristic_->h(succ_ids_.data(), num, pi_.target_id_,
+                    succ_h_.data());
+        }
+
+        inline bool
+        eval_successors_xy(uint32_t num, std::true_type)
+        {
+            const int32_t* xs;
+            const int32_t* ys;
+            int32_t x2, y2;
+            expander_->get_successor_xy(xs, ys, x2, y2);
+            heuristic_->h(xs, ys, num, x2, y2, succ_h_.data());
+            return true;
+        }
+
+        inline bool
+        eval_successors_xy(uint32_t num, std::false_type) { return false; }
+
+        inline void
+        eval_successors(std::false_type) { }
+
+        // the heuristic value of the @param index-th successor, @param n
+        inline double
+        successor_h(uint32_t index, warthog::search_node* n, std::true_type)
+        { return succ_h_[index]; }
+
+        inline double
+        successor_h(uint32_t index, warthog::search_node* n, std::false_type)
+        { return heuristic_->h(n->get_id(), pi_.target_id_); }
+
 		// no copy ctor
 		flexible_astar(const flexible_astar& other) { }
 		flexible_astar&
@@ -213,6 +330,11 @@ class flexible_astar: public warthog::search
 			warthog::search_node* start;
 			warthog::search_node* target = 0;
 
+            // the expanded node closest to the target (by h-value);
+            // returned as a partial result if the search is interrupted
+			warthog::search_node* best = 0;
+            warthog::cost_t best_h = warthog::COST_MAX;
+
       // get the internal target id
       if(pi_.target_id_ != warthog::SN_ID_MAX)
       {
@@ -226,8 +348,8 @@ class flexible_astar: public warthog::search
       // initialise and push the start node
       if(pi_.start_id_ == warthog::SN_ID_MAX) { return 0; }
       start = expander_->generate_start_node(&pi_);
-      assert(start->get_search_number() != pi_.instance_id_);
       if(!start) { return 0; } // invalid start location
+      assert(start->get_search_number() != pi_.instance_id_);
       pi_.start_id_ = start->get_id();
 
 			start->init(pi_.instance_id_, warthog::SN_ID_MAX,
@@ -252,6 +374,7 @@ class flexible_astar: public warthog::search
                 // search or if we want to impose some memory limit
                 if(open_->peek()->get_f() > cost_cutoff_) { break; }
                 if(sol.nodes_expanded_ >= exp_cutoff_) { break; }
+                if(interrupted(mytimer, sol)) { break; }
 
 				warthog::search_node* current = open_->pop();
 				current->set_expanded(true); // NB: set before generating
@@ -263,9 +386,16 @@ class flexible_astar: public warthog::search
                 if(expander_->is_target(current, &pi_))
                 {
                     target = current;
+                    sol.status_ = warthog::solution::FOUND;
                     break;
                 }
 
+                if(current->get_f() - current->get_g() < best_h)
+                {
+                    best_h = current->get_f() - current->get_g();
+                    best = current;
+                }
+
 				#ifndef NDEBUG
 				if(pi_.verbose_)
 				{
@@ -281,6 +411,7 @@ class flexible_astar: public warthog::search
 
                 // generate successors
 				expander_->expand(current, &pi_);
+                eval_successors(batch_h());
 				warthog::search_node* n = 0;
 				warthog::cost_t cost_to_n = 0;
                 uint32_t edge_id = 0;
@@ -297,7 +428,7 @@ class flexible_astar: public warthog::search
 						warthog::cost_t gval = current->get_g() + cost_to_n;
                         n->init(current->get_search_number(), current->get_id(),
                             gval,
-                            gval + heuristic_->h(n->get_id(),pi_.target_id_));
+                            gval + successor_h(edge_id-1, n, batch_h()));
 
                         open_->push(n);
                         sol.nodes_inserted_++;
@@ -383,7 +514,7 @@ class flexible_astar: public warthog::search
           else if (gval < n->get_g()) {
             n->init(current->get_search_number(), current->get_id(),
               gval,
-              gval + heuristic_->h(n->get_id(), pi_.target_id_));
+              gval + successor_h(edge_id-1, n, batch_h()));
             open_->push(n);
             sol.nodes_inserted_++;
             #ifdef CNT
@@ -413,6 +544,10 @@ class flexible_astar: public warthog::search
 			sol.time_elapsed_nano_ = mytimer.elapsed_time_nano();
             sol.nodes_surplus_ = open_->size();
 
+            if(sol.status_ == warthog::solution::TIMED_OUT ||
+               sol.status_ == warthog::solution::CANCELLED)
+            { target = best; }
+
             #ifndef NDEBUG
             if(pi_.verbose_)
             {
@@ -425,7 +560,10 @@ class flexible_astar: public warthog::search
                 {
                     int32_t x, y;
                     expander_->get_xy(target->get_id(), x, y);
-                    std::cerr << "target found ("<<x<<", "<<y<<")...";
+                    if(sol.status_ == warthog::solution::FOUND)
+                    { std::cerr << "target found ("<<x<<", "<<y<<")..."; }
+                    else
+                    { std::cerr << "interrupted; partial path to ("<<x<<", "<<y<<")..."; }
                     target->print(std::cerr);
                     std::cerr << std::endl;
                 }
@@ -5,7 +5,7 @@
 
 warthog::gridmap_expansion_policy::gridmap_expansion_policy(
 		warthog::gridmap* map, bool manhattan)
-: expansion_policy(map->height()*map->width()), map_(map), manhattan_(manhattan)
+: expansion_policy(map->padded_mapsize()), map_(map), manhattan_(manhattan)
 {
 }
 
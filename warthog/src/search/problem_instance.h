@@ -3,6 +3,8 @@
 
 #include "search_node.h"
 
+#include <atomic>
+
 namespace warthog
 {
 
@@ -77,7 +79,8 @@ class problem_instance
         void* extra_params_;
 
         private:
-            static uint32_t instance_counter_;
+            // shared by all threads; instance ids must never repeat
+            static std::atomic<uint32_t> instance_counter_;
 
 };
 
@@ -0,0 +1,261 @@
+#include "query_cache.h"
+
+#include <algorithm>
+
+warthog::query_cache::query_cache(uint32_t capacity, uint32_t num_shards)
+    : hits_(0), subpath_hits_(0), misses_(0), evictions_(0)
+{
+    if(num_shards == 0) { num_shards = 1; }
+    shard_capacity_ = std::max<uint32_t>(1, capacity / num_shards);
+    for(uint32_t i = 0; i < num_shards; i++)
+    {
+        shards_.push_back(new shard());
+        node_shards_.push_back(new node_shard());
+    }
+}
+
+warthog::query_cache::~query_cache()
+{
+    for(uint32_t i = 0; i < shards_.size(); i++)
+    {
+        delete shards_[i];
+        delete node_shards_[i];
+    }
+}
+
+std::shared_ptr<const warthog::cache_entry>
+warthog::query_cache::find(uint32_t map_id, uint32_t version,
+        warthog::sn_id_t start_id, warthog::sn_id_t target_id)
+{
+    key k = { map_id, start_id, target_id };
+    shard* s = get_shard(k);
+    entry_ptr ret, stale;
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        auto it = s->table_.find(k);
+        if(it != s->table_.end())
+        {
+            entry_ptr e = *(it->second);
+            if(e->version_ == version)
+            {
+                // move to the front of the recency list
+                s->lru_.splice(s->lru_.begin(), s->lru_, it->second);
+                ret = e;
+            }
+            else
+            {
+                stale = e;
+                s->lru_.erase(it->second);
+                s->table_.erase(it);
+            }
+        }
+    }
+
+    if(stale) { unindex_nodes(stale); }
+    if(ret) { hits_++; } else { misses_++; }
+    return ret;
+}
+
+std::shared_ptr<const warthog::cache_entry>
+warthog::query_cache::find_subpath(uint32_t map_id, uint32_t version,
+        warthog::sn_id_t from, warthog::sn_id_t to, bool symmetric,
+        uint32_t& first, uint32_t& last)
+{
+    // NB: only the most recent entries through @param from are examined
+    const uint32_t MAX_CANDIDATES = 16;
+
+    std::vector<entry_ptr> candidates;
+    {
+        key k = { map_id, from, 0 };
+        node_shard* ns = get_node_shard(k);
+        std::lock_guard<std::mutex> guard(ns->lock_);
+        auto it = ns->table_.find(k);
+        if(it == ns->table_.end()) { return 0; }
+        std::vector<entry_ptr>& vec = it->second;
+        for(size_t i = vec.size(); i > 0 &&
+                candidates.size() < MAX_CANDIDATES; i--)
+        {
+            candidates.push_back(vec[i-1]);
+        }
+    }
+
+    for(entry_ptr& e : candidates)
+    {
+        if(e->version_ != version || e->g_.size() == 0) { continue; }
+
+        uint32_t i_from = UINT32_MAX, i_to = UINT32_MAX;
+        for(uint32_t i = 0; i < e->path_.size(); i++)
+        {
+            if(e->path_[i] == from && i_from == UINT32_MAX) { i_from = i; }
+            if(e->path_[i] == to && i_to == UINT32_MAX) { i_to = i; }
+        }
+        if(i_from == UINT32_MAX || i_to == UINT32_MAX) { continue; }
+        if(i_from > i_to && !symmetric) { continue; }
+
+        first = i_from;
+        last = i_to;
+        subpath_hits_++;
+        return e;
+    }
+    return 0;
+}
+
+void
+warthog::query_cache::insert(std::shared_ptr<warthog::cache_entry> entry)
+{
+    // index first, so the entry is never evictable before it is indexed
+    if(entry->g_.size()) { index_nodes(entry); }
+
+    key k = { entry->map_id_, entry->start_id_, entry->target_id_ };
+    shard* s = get_shard(k);
+    std::vector<entry_ptr> evicted;
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        auto it = s->table_.find(k);
+        if(it != s->table_.end())
+        {
+            evicted.push_back(*(it->second));
+            s->lru_.erase(it->second);
+            s->table_.erase(it);
+        }
+
+        s->lru_.push_front(entry);
+        s->table_[k] = s->lru_.begin();
+
+        while(s->lru_.size() > shard_capacity_)
+        {
+            entry_ptr victim = s->lru_.back();
+            key vk = { victim->map_id_, victim->start_id_, victim->target_id_ };
+            s->table_.erase(vk);
+            s->lru_.pop_back();
+            evicted.push_back(victim);
+            evictions_++;
+        }
+    }
+
+    for(entry_ptr& e : evicted) { unindex_nodes(e); }
+}
+
+void
+warthog::query_cache::invalidate(uint32_t map_id)
+{
+    std::vector<entry_ptr> removed;
+    for(shard* s : shards_)
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        for(auto it = s->lru_.begin(); it != s->lru_.end(); )
+        {
+            if((*it)->map_id_ != map_id) { it++; continue; }
+            key k = { (*it)->map_id_, (*it)->start_id_, (*it)->target_id_ };
+            s->table_.erase(k);
+            removed.push_back(*it);
+            it = s->lru_.erase(it);
+        }
+    }
+    for(entry_ptr& e : removed) { unindex_nodes(e); }
+}
+
+void
+warthog::query_cache::carry_over(uint32_t map_id, uint32_t from_version,
+        uint32_t to_version,
+        std::function<bool(const warthog::cache_entry&)> keep)
+{
+    std::vector<entry_ptr> candidates;
+    for(shard* s : shards_)
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        for(entry_ptr& e : s->lru_)
+        {
+            if(e->map_id_ == map_id && e->version_ == from_version)
+            { candidates.push_back(e); }
+        }
+    }
+
+    // entries are immutable; insert updated copies, least recent first
+    // so that the order of recency is preserved
+    for(size_t i = candidates.size(); i > 0; i--)
+    {
+        if(!keep(*candidates[i-1])) { continue; }
+        entry_ptr copy = std::make_shared<warthog::cache_entry>(
+                *candidates[i-1]);
+        copy->version_ = to_version;
+        insert(copy);
+    }
+}
+
+void
+warthog::query_cache::clear()
+{
+    for(shard* s : shards_)
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        s->lru_.clear();
+        s->table_.clear();
+    }
+    for(node_shard* ns : node_shards_)
+    {
+        std::lock_guard<std::mutex> guard(ns->lock_);
+        ns->table_.clear();
+    }
+}
+
+uint32_t
+warthog::query_cache::size()
+{
+    uint32_t total = 0;
+    for(shard* s : shards_)
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        total += (uint32_t)s->lru_.size();
+    }
+    return total;
+}
+
+size_t
+warthog::query_cache::mem()
+{
+    size_t bytes = sizeof(*this);
+    for(shard* s : shards_)
+    {
+        std::lock_guard<std::mutex> guard(s->lock_);
+        for(entry_ptr& e : s->lru_)
+        {
+            bytes += sizeof(warthog::cache_entry) +
+                sizeof(warthog::sn_id_t) * e->path_.capacity() +
+                sizeof(warthog::cost_t) * e->g_.capacity() +
+                // list node, hash table node and node index references
+                4 * sizeof(void*) + sizeof(key) +
+                (sizeof(entry_ptr) + sizeof(key)) * e->path_.size();
+        }
+    }
+    return bytes;
+}
+
+void
+warthog::query_cache::index_nodes(const entry_ptr& entry)
+{
+    for(uint32_t i = 0; i < entry->path_.size(); i++)
+    {
+        key nk = { entry->map_id_, entry->path_[i], 0 };
+        node_shard* ns = get_node_shard(nk);
+        std::lock_guard<std::mutex> guard(ns->lock_);
+        std::vector<entry_ptr>& vec = ns->table_[nk];
+        if(vec.size() == 0 || vec.back() != entry) { vec.push_back(entry); }
+    }
+}
+
+void
+warthog::query_cache::unindex_nodes(const entry_ptr& entry)
+{
+    for(uint32_t i = 0; i < entry->path_.size(); i++)
+    {
+        key nk = { entry->map_id_, entry->path_[i], 0 };
+        node_shard* ns = get_node_shard(nk);
+        std::lock_guard<std::mutex> guard(ns->lock_);
+        auto it = ns->table_.find(nk);
+        if(it == ns->table_.end()) { continue; }
+        std::vector<entry_ptr>& vec = it->second;
+        vec.erase(std::remove(vec.begin(), vec.end(), entry), vec.end());
+        if(vec.size() == 0) { ns->table_.erase(it); }
+    }
+}
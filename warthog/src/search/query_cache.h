@@ -0,0 +1,195 @@
+#ifndef WARTHOG_QUERY_CACHE_H
+#define WARTHOG_QUERY_CACHE_H
+
+// search/query_cache.h
+//
+// A bounded, thread-safe cache of solved queries. Entries are keyed by
+// (map id, start id, target id) and distributed over a number of
+// independently locked shards; each shard evicts its least recently
+// used entries once it is full.
+//
+// Every entry is tagged with the version of the map it was computed on
+// (see warthog::gridmap::get_version). Lookups made with a different
+// version treat the entry as stale and discard it.
+//
+// Besides exact lookups the cache can answer queries using sub-paths
+// of previously cached optimal paths: if the start and the target of a
+// query both appear, in that order, on a cached path then the segment
+// between them is itself an optimal path. For this each node of a
+// cached path is indexed (the index is sharded by node id).
+//
+// The cache is normally used through warthog::cached_search.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace warthog
+{
+
+struct cache_entry
+{
+    uint32_t map_id_;
+    uint32_t version_;
+
+    // the query, as given to the search (i.e. external ids)
+    warthog::sn_id_t start_id_;
+    warthog::sn_id_t target_id_;
+
+    // the solution; cost_ is warthog::COST_MAX when no path exists
+    warthog::cost_t cost_;
+    std::vector<warthog::sn_id_t> path_;
+
+    // g_[i] is the cost of the path from path_[0] to path_[i].
+    // left empty when segment costs are unknown, in which case the
+    // entry is not used to answer sub-path queries.
+    std::vector<warthog::cost_t> g_;
+};
+
+class query_cache
+{
+    public:
+        // @param capacity: maximum number of entries (over all shards)
+        // @param num_shards: number of independently locked partitions
+        query_cache(uint32_t capacity, uint32_t num_shards = 16);
+        ~query_cache();
+
+        // look for an exact match for the query (@param start_id,
+        // @param target_id) on map @param map_id.
+        // @return the entry or null if no up-to-date entry exists
+        std::shared_ptr<const warthog::cache_entry>
+        find(uint32_t map_id, uint32_t version,
+                warthog::sn_id_t start_id, warthog::sn_id_t target_id);
+
+        // look for a cached path that visits @param from and then
+        // @param to. both ids refer to path nodes (i.e. internal ids).
+        // if @param symmetric is true, paths visiting @param to before
+        // @param from are also accepted (e.g. for undirected graphs).
+        // @return the entry, with the positions of @param from and @param
+        // to on its path written to @param first and @param last, or null
+        std::shared_ptr<const warthog::cache_entry>
+        find_subpath(uint32_t map_id, uint32_t version,
+                warthog::sn_id_t from, warthog::sn_id_t to,
+                bool symmetric, uint32_t& first, uint32_t& last);
+
+        // add a solved query to the cache.
+        // entries are immutable once inserted
+        void
+        insert(std::shared_ptr<warthog::cache_entry> entry);
+
+        // drop every entry computed on map @param map_id
+        void
+        invalidate(uint32_t map_id);
+
+        // carry the entries of map @param map_id computed at version
+        // @param from_version over to version @param to_version, for
+        // changes to the map that leave them optimal. entries for which
+        // @param keep returns false are not carried over (they are
+        // discarded as stale when next found)
+        void
+        carry_over(uint32_t map_id, uint32_t from_version,
+                uint32_t to_version,
+                std::function<bool(const warthog::cache_entry&)> keep);
+
+        void
+        clear();
+
+        uint32_t
+        size();
+
+        size_t
+        mem();
+
+        // statistics
+        inline uint64_t get_hits() { return hits_; }
+        inline uint64_t get_subpath_hits() { return subpath_hits_; }
+        inline uint64_t get_misses() { return misses_; }
+        inline uint64_t get_evictions() { return evictions_; }
+
+    private:
+        typedef std::shared_ptr<warthog::cache_entry> entry_ptr;
+
+        struct key
+        {
+            uint32_t map_id_;
+            warthog::sn_id_t first_;
+            warthog::sn_id_t second_;
+
+            bool
+            operator==(const key& other) const
+            {
+                return map_id_ == other.map_id_ &&
+                    first_ == other.first_ && second_ == other.second_;
+            }
+        };
+
+        struct key_hash
+        {
+            size_t
+            operator()(const key& k) const
+            {
+                uint64_t h = k.first_ * 0x9E3779B97F4A7C15ull;
+                h ^= (k.second_ + 0x632BE59BD9B4E019ull) + (h << 6) + (h >> 2);
+                h ^= k.map_id_ + (h << 6) + (h >> 2);
+                return (size_t)h;
+            }
+        };
+
+        // entries, in order of recency (most recent first)
+        struct shard
+        {
+            std::mutex lock_;
+            std::list<entry_ptr> lru_;
+            std::unordered_map<key,
+                std::list<entry_ptr>::iterator, key_hash> table_;
+        };
+
+        // the cached paths that visit each node;
+        // nodes are keyed as (map_id, node_id, 0)
+        struct node_shard
+        {
+            std::mutex lock_;
+            std::unordered_map<key, std::vector<entry_ptr>, key_hash> table_;
+        };
+
+        std::vector<shard*> shards_;
+        std::vector<node_shard*> node_shards_;
+        uint32_t shard_capacity_;
+
+        std::atomic<uint64_t> hits_;
+        std::atomic<uint64_t> subpath_hits_;
+        std::atomic<uint64_t> misses_;
+        std::atomic<uint64_t> evictions_;
+
+        inline shard*
+        get_shard(const key& k)
+        { return shards_[key_hash()(k) % shards_.size()]; }
+
+        inline node_shard*
+        get_node_shard(const key& k)
+        { return node_shards_[key_hash()(k) % node_shards_.size()]; }
+
+        void
+        index_nodes(const entry_ptr& entry);
+
+        void
+        unindex_nodes(const entry_ptr& entry);
+
+        query_cache(const query_cache& other) { }
+        query_cache&
+        operator=(const query_cache& other) { return *this; }
+};
+
+}
+
+#endif
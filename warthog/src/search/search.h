@@ -12,7 +12,10 @@
 
 #include "problem_instance.h"
 #include "solution.h"
+#include "timer.h"
 
+#include <atomic>
+#include <cfloat>
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -23,7 +26,8 @@ class search
 {
     public:
 
-        search() { }
+        search() 
+            : time_cutoff_nano_(DBL_MAX), check_mask_(63), cancel_(0) { }
         virtual ~search() { }
         
         virtual void
@@ -34,6 +38,66 @@ class search
 
         virtual size_t
         mem() = 0;
+
+        // set a wall-clock limit, in nanoseconds, on the time spent 
+        // answering a single query. the search terminates with status 
+        // warthog::solution::TIMED_OUT once the limit is reached.
+        // searches that wrap other searches pass the limit on to them.
+        virtual void
+        set_time_cutoff_nano(double cutoff) { time_cutoff_nano_ = cutoff; }
+
+        inline double
+        get_time_cutoff_nano() { return time_cutoff_nano_; }
+
+        // the search terminates with status warthog::solution::CANCELLED
+        // as soon as (*token == true). the token belongs to the caller and 
+        // can be set from any thread. pass 0 to remove the token.
+        virtual void
+        set_cancel_token(std::atomic<bool>* token) { cancel_ = token; }
+
+        // the time limit and cancellation token are checked once every 
+        // @param interval expansions (rounded down to a power of two). 
+        inline void
+        set_check_interval(uint32_t interval)
+        {
+            check_mask_ = 0;
+            while(interval > 1)
+            {
+                interval >>= 1;
+                check_mask_ = (check_mask_ << 1) | 1;
+            }
+        }
+
+    protected:
+        // returns true if the current query should stop early, because 
+        // it was cancelled or because it ran out of time. in that case 
+        // the reason is recorded in @param sol. 
+        // @param t: a timer, started at the beginning of the query
+        inline bool
+        interrupted(warthog::timer& t, warthog::solution& sol)
+        {
+            if(sol.nodes_expanded_ & check_mask_) { return false; }
+            if(cancel_ && cancel_->load(std::memory_order_relaxed))
+            {
+                sol.status_ = warthog::solution::CANCELLED;
+                return true;
+            }
+            if(time_cutoff_nano_ != DBL_MAX)
+            {
+                t.stop();
+                if(t.elapsed_time_nano() >= time_cutoff_nano_)
+                {
+                    sol.status_ = warthog::solution::TIMED_OUT;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+    private:
+        double time_cutoff_nano_;
+        uint32_t check_mask_;
+        std::atomic<bool>* cancel_;
 };
 
 }
@@ -1,6 +1,6 @@
 #include "search_node.h"
 
-unsigned int warthog::search_node::refcount_ = 0;
+std::atomic<uint32_t> warthog::search_node::refcount_(0);
 
 std::ostream& operator<<(std::ostream& str, const warthog::search_node& sn)
 {
@@ -11,6 +11,7 @@
 #include "cpool.h"
 #include "jps.h"
 
+#include <atomic>
 #include <iostream>
 
 namespace warthog
@@ -239,7 +240,7 @@ class search_node
 
 		uint32_t search_number_;
 
-        static uint32_t refcount_;
+        static std::atomic<uint32_t> refcount_;
 };
 
 struct cmp_less_search_node
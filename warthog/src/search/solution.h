@@ -18,6 +18,17 @@ namespace warthog
 class solution
 {
     public:
+        // the outcome of a search. when a search is cancelled or runs out 
+        // of time ::path_ and ::sum_of_edge_costs_ describe the best 
+        // partial path found so far (if any)
+        enum status
+        {
+            FOUND = 0,      // a path to the target was found
+            NO_PATH = 1,    // no path exists (or none within the cutoffs)
+            TIMED_OUT = 2,  // the time limit was reached
+            CANCELLED = 3   // the search was cancelled by the caller
+        };
+
         solution()
         { 
             reset (); 
@@ -32,6 +43,7 @@ class solution
             nodes_updated_(other.nodes_updated_), 
             nodes_touched_(other.nodes_updated_),
             nodes_surplus_(other.nodes_updated_),
+            status_(other.status_),
             path_(other.path_)
         { }
 
@@ -55,7 +67,8 @@ class solution
                 << "inserted=" << nodes_inserted_ 
                 << "updated=" << nodes_updated_ 
                 << "touched= " << nodes_touched_
-                << "surplus= " << nodes_surplus_;
+                << "surplus= " << nodes_surplus_
+                << "status= " << status_;
         }
 
         inline void
@@ -75,6 +88,7 @@ class solution
             nodes_updated_ = 0;
             nodes_touched_ = 0;
             nodes_surplus_ = 0;
+            status_ = warthog::solution::NO_PATH;
             path_.clear();
         }
 
@@ -86,6 +100,7 @@ class solution
         uint32_t nodes_updated_;
         uint32_t nodes_touched_;
         uint32_t nodes_surplus_;
+        warthog::solution::status status_;
 
         // the sequence of states that comprise 
         // a solution path
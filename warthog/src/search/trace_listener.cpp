@@ -0,0 +1,111 @@
+#include "gridmap.h"
+#include "trace_listener.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+warthog::trace_listener::trace_listener(const char* filename,
+        warthog::gridmap* map, uint32_t chunk_size, uint32_t num_chunks)
+    : chunk_size_(chunk_size == 0 ? 1 : chunk_size),
+      num_chunks_(num_chunks < 2 ? 2 : num_chunks),
+      cur_(0), fill_(0), num_events_(0), stop_(false)
+{
+    ring_.resize((size_t)chunk_size_ * num_chunks_);
+    busy_.resize(num_chunks_, false);
+
+    fd_ = fopen(filename, "wb");
+    if(fd_ == 0)
+    {
+        std::cerr << "err; cannot open trace file " << filename << "\n";
+    }
+    else
+    {
+        warthog::trace::header hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic_, warthog::trace::TRACE_MAGIC, 4);
+        hdr.version_ = warthog::trace::TRACE_VERSION;
+        if(map)
+        {
+            hdr.padded_width_ = map->width();
+            hdr.origin_ = map->to_padded_id(0);
+            hdr.width_ = map->header_width();
+            hdr.height_ = map->header_height();
+        }
+        fwrite(&hdr, sizeof(hdr), 1, fd_);
+    }
+
+    writer_ = std::thread(&warthog::trace_listener::write_loop, this);
+}
+
+warthog::trace_listener::~trace_listener()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    work_cv_.notify_one();
+    writer_.join();
+    if(fd_) { fclose(fd_); }
+}
+
+void
+warthog::trace_listener::submit()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    busy_[cur_] = true;
+    queue_.push_back(std::make_pair(cur_, fill_));
+    work_cv_.notify_one();
+
+    cur_ = (cur_ + 1) % num_chunks_;
+    fill_ = 0;
+    free_cv_.wait(lock, [this]{ return !busy_[cur_]; });
+}
+
+void
+warthog::trace_listener::flush()
+{
+    if(fill_ > 0) { submit(); }
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    free_cv_.wait(lock, [this]{ return queue_.empty() &&
+            std::find(busy_.begin(), busy_.end(), true) == busy_.end(); });
+    if(fd_) { fflush(fd_); }
+}
+
+void
+warthog::trace_listener::write_loop()
+{
+    while(true)
+    {
+        std::pair<uint32_t, uint32_t> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            work_cv_.wait(lock, [this]{ return stop_ || !queue_.empty(); });
+            if(queue_.empty()) { return; }
+            job = queue_.front();
+            queue_.pop_front();
+        }
+
+        if(fd_)
+        {
+            fwrite(&ring_[(size_t)job.first * chunk_size_],
+                    sizeof(warthog::trace::event), job.second, fd_);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            busy_[job.first] = false;
+        }
+        free_cv_.notify_all();
+    }
+}
+
+size_t
+warthog::trace_listener::mem()
+{
+    return sizeof(*this) +
+        sizeof(warthog::trace::event) * ring_.capacity() +
+        busy_.capacity() / 8;
+}
@@ -0,0 +1,206 @@
+#ifndef WARTHOG_TRACE_LISTENER_H
+#define WARTHOG_TRACE_LISTENER_H
+
+// search/trace_listener.h
+//
+// A search listener that records search events to a compact binary
+// trace file, for offline replay and visualisation of slow queries in
+// optimised (NDEBUG) builds.
+//
+// Events are 16 bytes each (24 with -DGRID_ID64) and are appended to a ring of fixed-size
+// chunks. Whenever a chunk fills up it is handed over to a background
+// writer thread, so the search thread never touches the file.
+// If the writer falls behind by the entire ring the search thread
+// waits for a chunk to become free; no events are ever dropped.
+//
+// One listener records one search thread; when running several
+// searches in parallel give each thread its own listener (and file).
+//
+// Besides the usual listener events, expansion policies can report
+// the individual jump segments found by their locator via
+// ::jump_segment. A new query is marked by the generation of the
+// start node (i.e. ::generate_node with a null parent).
+//
+// Traces are decoded with programs/trace_decode.cpp
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "constants.h"
+#include "forward.h"
+#include "search_node.h"
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace warthog
+{
+
+namespace trace
+{
+
+static const char TRACE_MAGIC[4] = {'W', 'T', 'R', 'C'};
+// ids in events are warthog::grid_id_t; the version tells the two
+// widths apart, so a trace is decoded by a build of the same flavour
+#ifdef GRID_ID64
+static const uint32_t TRACE_VERSION = 2;
+#else
+static const uint32_t TRACE_VERSION = 1;
+#endif
+
+enum event_type
+{
+    QUERY = 0,      // new query; id_ is the start node, from_ is none
+    EXPAND = 1,     // id_ was expanded
+    GENERATE = 2,   // id_ was generated as a successor of from_
+    RELAX = 3,      // id_ was added to open or its g-value improved
+    JUMP = 4        // the locator jumped from from_ to id_
+};
+
+// file header. for grid domains we record enough of the gridmap geometry
+// to convert padded ids into (x, y) coordinates; for other domains all
+// geometry fields are zero.
+struct header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t padded_width_;  // row stride of the padded id space
+    uint32_t origin_;        // padded id of the cell (0, 0)
+    uint32_t width_;         // width of the map, without padding
+    uint32_t height_;        // height of the map, without padding
+};
+
+// from_ is warthog::GRID_ID_MAX for events without a predecessor
+struct event
+{
+    warthog::grid_id_t id_;
+    warthog::grid_id_t from_;
+    float g_;       // g-value, or edge cost for GENERATE and JUMP events
+    uint8_t type_;
+    uint8_t dir_;   // warthog::jps::direction of JUMP events
+    uint16_t reserved_;
+};
+
+}
+
+class trace_listener
+{
+    public:
+        // @param filename: where to write the trace
+        // @param map: (optional) the grid, used to record geometry
+        // @param chunk_size: number of events per chunk
+        // @param num_chunks: number of chunks in the ring
+        trace_listener(const char* filename,
+                warthog::gridmap* map = 0,
+                uint32_t chunk_size = (1 << 16),
+                uint32_t num_chunks = 4);
+        ~trace_listener();
+
+        inline void
+        generate_node(warthog::search_node* parent,
+                      warthog::search_node* child,
+                      warthog::cost_t edge_cost,
+                      uint32_t edge_id)
+        {
+            if(parent == 0)
+            {
+                push(warthog::trace::QUERY, (warthog::grid_id_t)child->get_id(),
+                        warthog::GRID_ID_MAX, 0, 0);
+                return;
+            }
+            push(warthog::trace::GENERATE, (warthog::grid_id_t)child->get_id(),
+                    (warthog::grid_id_t)parent->get_id(), edge_cost, 0);
+        }
+
+        inline void
+        expand_node(warthog::search_node* current)
+        {
+            push(warthog::trace::EXPAND, (warthog::grid_id_t)current->get_id(),
+                    (warthog::grid_id_t)current->get_parent(),
+                    current->get_g(), 0);
+        }
+
+        inline void
+        relax_node(warthog::search_node* current)
+        {
+            push(warthog::trace::RELAX, (warthog::grid_id_t)current->get_id(),
+                    (warthog::grid_id_t)current->get_parent(),
+                    current->get_g(), 0);
+        }
+
+        // record a jump segment found by a jump point locator
+        inline void
+        jump_segment(warthog::grid_id_t from_id, warthog::grid_id_t to_id,
+                uint32_t dir, warthog::cost_t cost)
+        {
+            push(warthog::trace::JUMP, to_id, from_id, cost, (uint8_t)dir);
+        }
+
+        // hand over all buffered events to the writer and wait until
+        // they are on disk
+        void
+        flush();
+
+        inline bool
+        good() { return fd_ != 0; }
+
+        // total number of events recorded so far
+        inline uint64_t
+        num_events() { return num_events_; }
+
+        size_t
+        mem();
+
+    private:
+        FILE* fd_;
+        std::vector<warthog::trace::event> ring_;
+        std::vector<bool> busy_;   // chunk is queued for writing
+        uint32_t chunk_size_;
+        uint32_t num_chunks_;
+        uint32_t cur_;      // chunk currently being filled
+        uint32_t fill_;     // events in the current chunk
+        uint64_t num_events_;
+
+        // writer thread state; protected by mutex_
+        std::deque<std::pair<uint32_t, uint32_t>> queue_;
+        std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::condition_variable free_cv_;
+        bool stop_;
+        std::thread writer_;
+
+        inline void
+        push(uint8_t type, warthog::grid_id_t id, warthog::grid_id_t from,
+                warthog::cost_t g, uint8_t dir)
+        {
+            warthog::trace::event& e = ring_[cur_ * chunk_size_ + fill_];
+            e.id_ = id;
+            e.from_ = from;
+            e.g_ = (float)g;
+            e.type_ = type;
+            e.dir_ = dir;
+            e.reserved_ = 0;
+            num_events_++;
+            if(++fill_ == chunk_size_) { submit(); }
+        }
+
+        // queue the current chunk for writing and move to the next one
+        void
+        submit();
+
+        void
+        write_loop();
+
+        trace_listener(const trace_listener& other) { }
+        trace_listener&
+        operator=(const trace_listener& other) { return *this; }
+};
+
+}
+
+#endif
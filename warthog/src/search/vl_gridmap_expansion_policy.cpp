@@ -4,7 +4,7 @@
 
 warthog::vl_gridmap_expansion_policy::vl_gridmap_expansion_policy(
 		warthog::vl_gridmap* map) 
-    : expansion_policy(map->height() * map->width()), map_(map)
+    : expansion_policy(map->padded_mapsize()), map_(map)
 {
 }
 
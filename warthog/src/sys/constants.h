@@ -19,8 +19,7 @@ namespace warthog
     static const sn_id_t NO_PARENT = SN_ID_MAX;
 
 	// each node in a weighted grid map uses sizeof(dbword) memory.
-	// in a uniform-cost grid map each dbword is a contiguous set
-	// of nodes s.t. every bit represents a node.
+	// dbwords are also the unit of the bitfield filters.
 	typedef uint8_t dbword;
 
 	// gridmap constants
@@ -28,6 +27,25 @@ namespace warthog
 	static const uint32_t DBWORD_BITS_MASK = (warthog::DBWORD_BITS-1);
 	static const uint32_t LOG2_DBWORD_BITS = static_cast<uint32_t>(ceil(log10(warthog::DBWORD_BITS) / log10(2)));
 
+	// in a uniform-cost grid map each gridword is a contiguous set
+	// of nodes s.t. every bit represents a node. labels are written a
+	// word at a time; runs of tiles are read with one unaligned 8-byte
+	// load from the byte that holds the first tile, which may span two
+	// words (see warthog::gridmap::read_bits).
+	typedef uint64_t gridword;
+	static const uint32_t GRIDWORD_BITS = sizeof(warthog::gridword)*8;
+	static const uint32_t GRIDWORD_BITS_MASK = (warthog::GRIDWORD_BITS-1);
+	static const uint32_t LOG2_GRIDWORD_BITS = 6;
+
+	// padded ids of grid cells (see warthog::gridmap). 32 bits unless
+	// built with -DGRID_ID64 (make fast64), for maps with more than 2^32
+	// padded cells. the default keeps per-node memory as it is
+#ifdef GRID_ID64
+	typedef uint64_t grid_id_t;
+#else
+	typedef uint32_t grid_id_t;
+#endif
+
 	// search and sort constants
 	static const double DBL_ONE = 1.0f;
 	static const double DBL_TWO = 2.0f;
@@ -27,6 +27,7 @@ class gridmap_expansion_policy;
 class problem_instance;
 class search_node;
 class solution;
+class trace_listener;
 class zero_heuristic;
 
 template<typename H, typename E, typename Q, typename L>
@@ -56,8 +57,10 @@ namespace label
 class af_labelling;
 class bb_labelling;
 class bbaf_labelling;
+class component_labelling;
 class dfs_labelling;
 class firstmove_labelling;
+class jps_bb_labelling;
 
 }
 
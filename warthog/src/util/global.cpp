@@ -3,23 +3,23 @@
 #include "node_pool.h"
 #include "pqueue.h"
 using namespace global;
-uint32_t statis::subopt_expd = 0;
-uint32_t statis::subopt_gen = 0;
-uint32_t statis::scan_cnt = 0;
-uint32_t statis::subopt_insert = 0;
-string global::alg = "";
-uint32_t statis::prunable = 0;
-vector<warthog::cost_t> statis::dist = vector<warthog::cost_t>();
-vector<statis::Log> statis::logs = vector<statis::Log>();
-warthog::problem_instance* query::pi = nullptr;
-warthog::mem::node_pool* global::nodepool = nullptr;
-uint32_t query::startid = warthog::INF32;
-uint32_t query::goalid = warthog::INF32;
-warthog::cost_t query::cur_diag_gval = warthog::INFTY;
-warthog::gridmap* query::map = nullptr;
-warthog::pqueue_min* query::open = nullptr;
-uint32_t global::query::jump_step = 0;
-warthog::solution* global::sol = nullptr;
+thread_local uint32_t statis::subopt_expd = 0;
+thread_local uint32_t statis::subopt_gen = 0;
+thread_local uint32_t statis::scan_cnt = 0;
+thread_local uint32_t statis::subopt_insert = 0;
+thread_local string global::alg = "";
+thread_local uint32_t statis::prunable = 0;
+thread_local vector<warthog::cost_t> statis::dist = vector<warthog::cost_t>();
+thread_local vector<statis::Log> statis::logs = vector<statis::Log>();
+thread_local warthog::problem_instance* query::pi = nullptr;
+thread_local warthog::mem::node_pool* global::nodepool = nullptr;
+thread_local uint32_t query::startid = warthog::INF32;
+thread_local uint32_t query::goalid = warthog::INF32;
+thread_local warthog::cost_t query::cur_diag_gval = warthog::INFTY;
+thread_local warthog::gridmap* query::map = nullptr;
+thread_local warthog::pqueue_min* query::open = nullptr;
+thread_local uint32_t global::query::jump_step = 0;
+thread_local warthog::solution* global::sol = nullptr;
 
 global::statis::Log global::statis::gen(uint32_t id, warthog::cost_t gval, bool subopt) {
   global::statis::Log c;
@@ -9,12 +9,13 @@
 #include "search_node.h"
 #include "solution.h"
 using namespace std;
-// set global variable that can be accessed everywhere
+// set global variable that can be accessed everywhere.
+// NB: every thread has its own copy (e.g. one per batch worker)
 namespace global{
 
-extern string alg;
-extern warthog::mem::node_pool* nodepool;
-extern warthog::solution* sol;
+extern thread_local string alg;
+extern thread_local warthog::mem::node_pool* nodepool;
+extern thread_local warthog::solution* sol;
 
 namespace statis {
 
@@ -45,15 +46,15 @@ namespace statis {
     }
   };
 
-  extern vector<warthog::cost_t> dist;
-  extern uint32_t subopt_expd;
-  extern uint32_t subopt_gen;
-  extern uint32_t subopt_insert;
-  extern uint32_t scan_cnt;
-  extern vector<Log> logs;
+  extern thread_local vector<warthog::cost_t> dist;
+  extern thread_local uint32_t subopt_expd;
+  extern thread_local uint32_t subopt_gen;
+  extern thread_local uint32_t subopt_insert;
+  extern thread_local uint32_t scan_cnt;
+  extern thread_local vector<Log> logs;
 
-  extern uint32_t prunable;
-  extern vector<Log> logs;
+  extern thread_local uint32_t prunable;
+  extern thread_local vector<Log> logs;
 
   Log gen(uint32_t id, warthog::cost_t gval, bool subopt);
 
@@ -131,14 +132,14 @@ namespace statis {
 };
 
 namespace query {
-  extern uint32_t startid, goalid;
-  extern warthog::cost_t cur_diag_gval;
-  extern warthog::gridmap *map;
-extern warthog::problem_instance* pi;
-extern warthog::pqueue_min* open;
-  extern uint32_t jump_step;
-
-  inline warthog::cost_t gval(uint32_t id) {
+  extern thread_local uint32_t startid, goalid;
+  extern thread_local warthog::cost_t cur_diag_gval;
+  extern thread_local warthog::gridmap *map;
+extern thread_local warthog::problem_instance* pi;
+extern thread_local warthog::pqueue_min* open;
+  extern thread_local uint32_t jump_step;
+
+  inline warthog::cost_t gval(warthog::grid_id_t id) {
     warthog::cost_t res = warthog::INFTY;
     warthog::search_node* s = nodepool->get_ptr(id);
     if (s != nullptr && s->get_search_number() == pi->instance_id_) 
@@ -147,7 +148,7 @@ extern warthog::pqueue_min* open;
   }
 
   // set gvalue on corner point
-  inline void set_corner_gv(uint32_t id, warthog::cost_t g) {
+  inline void set_corner_gv(warthog::grid_id_t id, warthog::cost_t g) {
     warthog::search_node* n = nodepool->get_ptr(id);
     if (n->get_search_number() != pi->instance_id_) {
       n->init(pi->instance_id_, warthog::SN_ID_MAX, warthog::INFTY, warthog::INFTY);
@@ -3,25 +3,38 @@
 #include <unordered_map>
 
 warthog::gm_parser::gm_parser(const char* filename)
+{
+	if(!this->parse(filename)) { exit(1); }
+}
+
+warthog::gm_parser::~gm_parser()
+{
+}
+
+bool
+warthog::gm_parser::is_valid(const char* filename)
+{
+	warthog::gm_parser parser;
+	return parser.parse(filename);
+}
+
+bool
+warthog::gm_parser::parse(const char* filename)
 {
 	std::fstream mapfs(filename, std::fstream::in);
 	if(!mapfs.is_open())
 	{
 		std::cerr << "err; gm_parser::gm_parser "
 			"cannot open map file: "<<filename << std::endl;
-		exit(1);
+		return false;
 	}
 
-	this->parse_header(mapfs);
-	this->parse_map(mapfs);
+	bool ok = this->parse_header(mapfs) && this->parse_map(mapfs);
 	mapfs.close();
+	return ok;
 }
 
-warthog::gm_parser::~gm_parser()
-{
-}
-
-void 
+bool 
 warthog::gm_parser::parse_header(std::fstream& mapfs)
 {
 	// read header fields
@@ -41,13 +54,13 @@ warthog::gm_parser::parse_header(std::fstream& mapfs)
 			{
 				std::cerr << "err; map load failed. could not read header." << 
 					hfield << std::endl;
-				exit(1);
+				return false;
 			}
 		}
 		else
 		{
 			std::cerr << "err;  map load failed. format looks wrong."<<std::endl;
-			exit(1);
+			return false;
 		}
 	}
 
@@ -56,26 +69,26 @@ warthog::gm_parser::parse_header(std::fstream& mapfs)
 	{
 		std::cerr << "err; map type " << this->header_.type_ << 
 			"is unknown. known types: octile "<<std::endl;;
-		exit(1);
+		return false;
 	}
 
 	this->header_.height_ = (uint32_t)atoi(contents[std::string("height")].c_str());
 	if(this->header_.height_ == 0)
 	{
 		std::cerr << "err; map file specifies invalid height. " << std::endl;
-		exit(1);
+		return false;
 	}
 
 	this->header_.width_ = (uint32_t)atoi(contents[std::string("width")].c_str());
 	if(this->header_.width_ == 0)
 	{
 		std::cerr << "err; map file specifies invalid width. " << std::endl;
-		exit(1);
+		return false;
 	}
-
+	return true;
 }
 
-void 
+bool 
 warthog::gm_parser::parse_map(std::fstream& mapfs)
 {
 	std::string hfield;
@@ -84,12 +97,12 @@ warthog::gm_parser::parse_map(std::fstream& mapfs)
 	{
 		std::cerr << "err; map load failed. missing 'map' keyword." 
 			<< std::endl;
-        exit(1);
+        return false;
 	}
 
 	// read map data
-	uint32_t index = 0;
-	uint32_t max_tiles = this->header_.height_*this->header_.width_;
+	uint64_t index = 0;
+	uint64_t max_tiles = (uint64_t)this->header_.height_*this->header_.width_;
 	while(true)
 	{
 		unsigned char c = (unsigned char)mapfs.get();	
@@ -119,7 +132,8 @@ warthog::gm_parser::parse_map(std::fstream& mapfs)
 	{
 		std::cerr << "err; expected " << max_tiles
 			<< " tiles; read " << index <<" tiles." << std::endl;
-		exit(1);
+		return false;
 	}
+	return true;
 }
 
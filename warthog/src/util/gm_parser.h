@@ -53,9 +53,16 @@ namespace warthog
 	class gm_parser
 	{
 		public:
+			// exits if @param filename cannot be parsed
 			gm_parser(const char* filename);
 			~gm_parser();
 
+			// @return true if @param filename is a map file this parser
+			// can read. reports errors like the constructor, but does
+			// not exit
+			static bool
+			is_valid(const char* filename);
+
 			inline warthog::gm_header
 			get_header()
 			{
@@ -69,7 +76,7 @@ namespace warthog
 			}
 
 			inline unsigned char
-			get_tile_at(unsigned int index) 
+			get_tile_at(size_t index) 
 			{ 
 				if(index >= this->map_.size())
 				{
@@ -81,11 +88,13 @@ namespace warthog
 			}
 
 		private:
+			gm_parser() {}
 			gm_parser(const gm_parser&) {}
 			gm_parser& operator=(const gm_parser&) { return *this; }
 
-			void parse_header(std::fstream&);
-			void parse_map(std::fstream&);
+			bool parse(const char* filename);
+			bool parse_header(std::fstream&);
+			bool parse_map(std::fstream&);
 
 			std::vector<unsigned char> map_;
 			gm_header header_;
@@ -0,0 +1,133 @@
+#include "map_registry.h"
+
+#include <iostream>
+#include <iterator>
+
+warthog::map_registry::map_registry(factory_fn factory, size_t budget_bytes)
+    : factory_(factory), cache_(0), next_map_id_(0), budget_(budget_bytes),
+      resident_bytes_(0), hits_(0), misses_(0), evictions_(0)
+{ }
+
+warthog::map_registry::~map_registry()
+{
+    while(lru_.size()) { destroy(lru_.begin()); }
+}
+
+warthog::resident_search*
+warthog::map_registry::acquire(const std::string& name)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    auto it = by_name_.find(name);
+    if(it != by_name_.end())
+    {
+        hits_++;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        it->second->refcount_++;
+        return it->second->rs_.get();
+    }
+
+    misses_++;
+    warthog::resident_search* rs = factory_(name);
+    if(!rs) { return 0; }
+    if(rs->get_map())
+    {
+        rs->store_.reset(new warthog::gridmap_store(rs->get_map()));
+        rs->reader_.reset(
+                new warthog::gridmap_reader(rs->store_.get(), rs->get_map()));
+        rs->reader_->pin();
+    }
+    uint32_t map_id = next_map_id_++;
+    if(cache_)
+    {
+        rs->cached_.reset(new warthog::cached_search(
+                    rs->get_search(), cache_, map_id, rs->get_map()));
+    }
+
+    entry e;
+    e.name_ = name;
+    e.rs_ = std::unique_ptr<warthog::resident_search>(rs);
+    e.refcount_ = 1;
+    e.map_id_ = map_id;
+    e.bytes_ = 0;
+    lru_.push_front(std::move(e));
+    by_name_[name] = lru_.begin();
+    by_ptr_[rs] = lru_.begin();
+    measure(lru_.begin());
+
+    evict();
+    return rs;
+}
+
+void
+warthog::map_registry::release(warthog::resident_search* rs)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+
+    auto it = by_ptr_.find(rs);
+    if(it == by_ptr_.end() || it->second->refcount_ == 0)
+    {
+        std::cerr << "err; map_registry::release: entry not acquired\n";
+        return;
+    }
+    // the entry may have grown while it was in use
+    if(--it->second->refcount_ == 0) { measure(it->second); }
+    evict();
+}
+
+void
+warthog::map_registry::set_budget(size_t budget_bytes)
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    budget_ = budget_bytes;
+    evict();
+}
+
+void
+warthog::map_registry::evict()
+{
+    if(budget_ == 0) { return; }
+
+    entry_iter it = lru_.end();
+    while(resident_bytes_ > budget_ && it != lru_.begin())
+    {
+        --it;
+        if(it->refcount_ > 0) { continue; }
+
+        resident_bytes_ -= it->bytes_;
+        by_name_.erase(it->name_);
+        by_ptr_.erase(it->rs_.get());
+        entry_iter next = std::next(it);
+        destroy(it);
+        it = next;
+        evictions_++;
+    }
+}
+
+void
+warthog::map_registry::measure(entry_iter it)
+{
+    warthog::resident_search* rs = it->rs_.get();
+    resident_bytes_ -= it->bytes_;
+    it->bytes_ = rs->mem() + (rs->store_ ? rs->store_->mem() : 0);
+    resident_bytes_ += it->bytes_;
+}
+
+void
+warthog::map_registry::destroy(entry_iter it)
+{
+    if(it->rs_->cached_)
+    {
+        it->rs_->cached_->get_cache()->invalidate(it->map_id_);
+        it->rs_->cached_.reset();
+    }
+    lru_.erase(it);
+}
+
+size_t
+warthog::map_registry::mem()
+{
+    std::lock_guard<std::mutex> guard(lock_);
+    return sizeof(*this) + resident_bytes_ +
+        lru_.size() * (sizeof(entry) + 4 * sizeof(void*));
+}
@@ -0,0 +1,234 @@
+#ifndef WARTHOG_MAP_REGISTRY_H
+#define WARTHOG_MAP_REGISTRY_H
+
+// util/map_registry.h
+//
+// Keeps a bounded set of maps, and the data derived from them, in memory.
+// Maps are loaded by name the first time they are requested. Each entry
+// counts the searches currently using it (see ::acquire and ::release).
+// When the memory used by all entries exceeds the budget, the least
+// recently used entries that are not in use are evicted, along with
+// their indexes.
+//
+// An entry in use is never evicted, even if that means going over the
+// budget; it becomes a candidate for eviction once it is released.
+// A budget of 0 means no limit. Entries are measured when they are loaded
+// and again when their last user releases them, so indexes built lazily
+// by searches, and changes committed to the map, count against the
+// budget.
+//
+// Edits to a resident map go through the warthog::gridmap_store of its
+// entry (see domains/gridmap_snapshot.h). Any thread may record and
+// commit them; the map itself only changes when the thread using the
+// entry calls ::pin, so a search never sees a map change under it.
+// Edits are lost when the entry is evicted: the map is loaded again
+// from its file.
+//
+// With a warthog::query_cache (see ::set_cache), each entry loaded
+// afterwards also gets a warthog::cached_search in front of its search,
+// under a map id of its own; the entries of an evicted map are dropped
+// from the cache.
+//
+// The registry is thread-safe, statistics included. Loading a map holds
+// the registry lock, so concurrent requests for other maps, and for the
+// statistics, wait until the load completes.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "cached_search.h"
+#include "gridmap.h"
+#include "gridmap_snapshot.h"
+#include "query_cache.h"
+#include "search.h"
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace warthog
+{
+
+class map_registry;
+
+// a resident map, together with a search for it and its indexes
+class resident_search
+{
+    public:
+        virtual ~resident_search() { }
+
+        virtual warthog::gridmap*
+        get_map() = 0;
+
+        virtual warthog::search*
+        get_search() = 0;
+
+        // called before every batch; sets any thread-local state the
+        // search depends on (e.g. the globals used by prune2)
+        virtual void
+        bind() { }
+
+        virtual size_t
+        mem() = 0;
+
+        // where edits to the map are recorded; 0 if the entry has no map
+        inline warthog::gridmap_store*
+        get_store() { return store_.get(); }
+
+        // bring the map up to date with the edits committed to the
+        // store. called before every batch, after ::bind.
+        // @return the version of the map
+        inline uint32_t
+        pin() { return reader_ ? reader_->pin() : 0; }
+
+        // the search that answers queries: ::get_search, behind the
+        // cache of the registry if it has one
+        inline warthog::search*
+        get_cached_search()
+        {
+            if(cached_) { return cached_.get(); }
+            return get_search();
+        }
+
+    private:
+        // set up by the registry when the entry is loaded
+        std::unique_ptr<warthog::gridmap_store> store_;
+        std::unique_ptr<warthog::gridmap_reader> reader_;
+
+        // an index of the map; the registry destroys it before the map
+        std::unique_ptr<warthog::cached_search> cached_;
+
+        friend class warthog::map_registry;
+};
+
+class map_registry
+{
+    public:
+        // creates the entry for a map; returns 0 if the map cannot
+        // be loaded
+        typedef std::function<warthog::resident_search*(const std::string&)>
+            factory_fn;
+
+        map_registry(factory_fn factory, size_t budget_bytes = 0);
+        ~map_registry();
+
+        // @return the entry for map @param name, loading it if necessary,
+        // or 0 if the map cannot be loaded. the entry stays in memory
+        // until every acquire is matched by a ::release
+        warthog::resident_search*
+        acquire(const std::string& name);
+
+        void
+        release(warthog::resident_search* rs);
+
+        // evict unused entries until the budget is met
+        void
+        set_budget(size_t budget_bytes);
+
+        // answer the queries of entries loaded from now on through
+        // @param cache (0 = no cache), which must outlive the registry
+        inline void
+        set_cache(warthog::query_cache* cache)
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            cache_ = cache;
+        }
+
+        inline size_t
+        get_budget()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return budget_;
+        }
+
+        // memory used by all resident entries
+        inline size_t
+        get_resident_bytes()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return resident_bytes_;
+        }
+
+        inline uint32_t
+        get_num_resident()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return (uint32_t)lru_.size();
+        }
+
+        inline uint64_t
+        get_hits()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return hits_;
+        }
+
+        inline uint64_t
+        get_misses()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return misses_;
+        }
+
+        inline uint64_t
+        get_evictions()
+        {
+            std::lock_guard<std::mutex> guard(lock_);
+            return evictions_;
+        }
+
+        size_t
+        mem();
+
+    private:
+        struct entry
+        {
+            std::string name_;
+            std::unique_ptr<warthog::resident_search> rs_;
+            uint32_t refcount_;
+            size_t bytes_;
+            uint32_t map_id_;
+        };
+        typedef std::list<entry>::iterator entry_iter;
+
+        factory_fn factory_;
+        warthog::query_cache* cache_;
+        uint32_t next_map_id_;
+        size_t budget_;
+        size_t resident_bytes_;
+        uint64_t hits_;
+        uint64_t misses_;
+        uint64_t evictions_;
+
+        // most recently used first
+        std::list<entry> lru_;
+        std::unordered_map<std::string, entry_iter> by_name_;
+        std::unordered_map<warthog::resident_search*, entry_iter> by_ptr_;
+        std::mutex lock_;
+
+        // call with lock_ held
+        void
+        evict();
+
+        // (re)compute the memory used by @param it; call with lock_ held
+        // and no user of the entry
+        void
+        measure(entry_iter it);
+
+        // drop @param it, and its entries in the cache
+        void
+        destroy(entry_iter it);
+
+        map_registry(const map_registry& other) { }
+        map_registry&
+        operator=(const map_registry& other) { return *this; }
+};
+
+}
+
+#endif
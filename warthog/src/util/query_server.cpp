@@ -0,0 +1,340 @@
+#include "query_server.h"
+#include "problem_instance.h"
+#include "solution.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+warthog::query_server::query_server(factory_fn factory, size_t budget_bytes,
+        uint32_t cache_entries)
+    : registry_(factory, budget_bytes), default_rs_(0),
+      num_queries_(0), total_nanos_(0)
+{
+    if(cache_entries)
+    {
+        cache_.reset(new warthog::query_cache(cache_entries));
+        registry_.set_cache(cache_.get());
+    }
+}
+
+warthog::query_server::~query_server()
+{
+    if(default_rs_) { registry_.release(default_rs_); }
+}
+
+bool
+warthog::query_server::preload(const std::string& mapfile)
+{
+    warthog::resident_search* rs = registry_.acquire(mapfile);
+    if(!rs) { return false; }
+    if(default_rs_) { registry_.release(default_rs_); }
+    default_rs_ = rs;
+    default_map_ = mapfile;
+    return true;
+}
+
+size_t
+warthog::query_server::mem()
+{
+    return sizeof(*this) + registry_.mem() + (cache_ ? cache_->mem() : 0);
+}
+
+void
+warthog::query_server::solve(warthog::resident_search* rs,
+        const binary_query& q, binary_reply& reply)
+{
+    warthog::gridmap* map = rs->get_map();
+    uint32_t w = map->header_width();
+    uint32_t h = map->header_height();
+
+    reply.cost_ = -1;
+    reply.nanos_ = 0;
+    reply.expanded_ = 0;
+    reply.status_ = warthog::solution::NO_PATH;
+    if(q.sx_ >= w || q.tx_ >= w || q.sy_ >= h || q.ty_ >= h) { return; }
+
+    warthog::problem_instance pi(q.sy_ * w + q.sx_, q.ty_ * w + q.tx_);
+    warthog::solution sol;
+    rs->get_cached_search()->get_pathcost(pi, sol);
+
+    reply.status_ = sol.status_;
+    reply.nanos_ = (uint64_t)sol.time_elapsed_nano_;
+    reply.expanded_ = sol.nodes_expanded_;
+    if(sol.status_ == warthog::solution::FOUND)
+    { reply.cost_ = sol.sum_of_edge_costs_; }
+
+    num_queries_++;
+    total_nanos_ += sol.time_elapsed_nano_;
+}
+
+void
+warthog::query_server::answer_batch(warthog::resident_search* rs,
+        std::vector<binary_query>& batch, FILE* out)
+{
+    if(batch.size() == 0) { return; }
+    rs->bind();
+    rs->pin();
+    for(binary_query& q : batch)
+    {
+        binary_reply reply;
+        solve(rs, q, reply);
+        fprintf(out, "%.8g %u %llu\n", reply.cost_, reply.expanded_,
+                (unsigned long long)reply.nanos_);
+    }
+    batch.clear();
+    fflush(out);
+}
+
+bool
+warthog::query_server::serve(FILE* in, FILE* out)
+{
+    warthog::resident_search* rs = 0;
+    if(default_map_ != "") { rs = registry_.acquire(default_map_); }
+
+    std::vector<binary_query> batch;
+    char* line = 0;
+    size_t line_size = 0;
+    bool keep_running = true;
+    ssize_t len;
+    while((len = getline(&line, &line_size, in)) != -1)
+    {
+        std::string request(line, (size_t)len);
+        while(request.size() &&
+              (request.back() == '\n' || request.back() == '\r'))
+        { request.pop_back(); }
+
+        std::istringstream tokens(request);
+        std::string cmd;
+        tokens >> cmd;
+
+        if(cmd == "")
+        {
+            if(rs) { answer_batch(rs, batch, out); }
+            continue;
+        }
+
+        if(cmd == "quit" || cmd == "shutdown")
+        {
+            keep_running = cmd == "quit";
+            break;
+        }
+
+        // requests other than queries end the current batch
+        if(!isdigit(cmd[0]) && rs) { answer_batch(rs, batch, out); }
+
+        if(cmd == "map")
+        {
+            std::string mapfile;
+            tokens >> mapfile;
+            warthog::resident_search* next = registry_.acquire(mapfile);
+            if(next)
+            {
+                if(rs) { registry_.release(rs); }
+                rs = next;
+                fprintf(out, "ok %u %u\n", rs->get_map()->header_width(),
+                        rs->get_map()->header_height());
+            }
+            else
+            { fprintf(out, "err; cannot load map %s\n", mapfile.c_str()); }
+            fflush(out);
+        }
+        else if(cmd == "binary")
+        {
+            int64_t num = -1;
+            if(!(tokens >> num) || num < 0 || num > MAX_BATCH)
+            {
+                fprintf(out, "err; invalid binary batch: %s\n",
+                        request.c_str());
+                fflush(out);
+                break;
+            }
+
+            // read and answer the records a few at a time
+            const uint32_t CHUNK = 4096;
+            std::vector<binary_query> queries(
+                    (size_t)std::min<int64_t>(num, CHUNK));
+            std::vector<binary_reply> replies(queries.size());
+            if(rs)
+            {
+                rs->bind();
+                rs->pin();
+            }
+            bool complete = true;
+            for(int64_t done = 0; done < num; done += CHUNK)
+            {
+                size_t n = (size_t)std::min<int64_t>(num - done, CHUNK);
+                if(fread(queries.data(), sizeof(binary_query), n, in) != n)
+                {
+                    complete = false;
+                    break;
+                }
+                for(size_t i = 0; i < n; i++)
+                {
+                    if(rs) { solve(rs, queries[i], replies[i]); }
+                    else
+                    {
+                        binary_reply none =
+                            { -1, 0, 0, warthog::solution::NO_PATH };
+                        replies[i] = none;
+                    }
+                }
+                fwrite(replies.data(), sizeof(binary_reply), n, out);
+            }
+            fflush(out);
+            if(!complete) { break; }
+        }
+        else if(cmd == "set")
+        {
+            uint32_t x, y, label;
+            if(!rs)
+            { fprintf(out, "err; no map selected\n"); }
+            else if(!(tokens >> x >> y >> label) || label > 1 ||
+                    x >= rs->get_map()->header_width() ||
+                    y >= rs->get_map()->header_height())
+            { fprintf(out, "err; invalid edit: %s\n", request.c_str()); }
+            else
+            {
+                rs->get_store()->set_label(
+                        rs->get_map()->to_padded_id(x, y), label);
+                continue;
+            }
+            fflush(out);
+        }
+        else if(cmd == "commit")
+        {
+            if(!rs)
+            { fprintf(out, "err; no map selected\n"); }
+            else
+            {
+                rs->get_store()->commit();
+                fprintf(out, "ok %u\n", rs->get_store()->pin()->get_version());
+            }
+            fflush(out);
+        }
+        else if(cmd == "stats")
+        {
+            fprintf(out, "maps %u bytes %llu hits %llu misses %llu "
+                    "evictions %llu queries %llu mean_nanos %.1f "
+                    "cache_hits %llu cache_subpath_hits %llu\n",
+                    get_num_maps(),
+                    (unsigned long long)registry_.get_resident_bytes(),
+                    (unsigned long long)registry_.get_hits(),
+                    (unsigned long long)registry_.get_misses(),
+                    (unsigned long long)registry_.get_evictions(),
+                    (unsigned long long)num_queries_,
+                    num_queries_ ? total_nanos_ / num_queries_ : 0.0,
+                    (unsigned long long)(cache_ ? cache_->get_hits() : 0),
+                    (unsigned long long)
+                        (cache_ ? cache_->get_subpath_hits() : 0));
+            fflush(out);
+        }
+        else if(isdigit(cmd[0]))
+        {
+            binary_query q;
+            std::istringstream query(request);
+            if(!rs)
+            {
+                fprintf(out, "err; no map selected\n");
+                fflush(out);
+            }
+            else if(query >> q.sx_ >> q.sy_ >> q.tx_ >> q.ty_)
+            {
+                batch.push_back(q);
+                if(batch.size() >= MAX_BATCH) { answer_batch(rs, batch, out); }
+            }
+            else
+            {
+                fprintf(out, "err; invalid query: %s\n", request.c_str());
+                fflush(out);
+            }
+        }
+        else
+        {
+            fprintf(out, "err; unknown request: %s\n", cmd.c_str());
+            fflush(out);
+        }
+    }
+
+    if(rs)
+    {
+        answer_batch(rs, batch, out);
+        registry_.release(rs);
+    }
+    free(line);
+    return keep_running;
+}
+
+bool
+warthog::query_server::listen(const char* path)
+{
+    int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(sock == -1)
+    {
+        std::cerr << "err; cannot create socket\n";
+        return false;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path))
+    {
+        std::cerr << "err; socket path too long: " << path << "\n";
+        close(sock);
+        return false;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    unlink(path);
+
+    if(bind(sock, (struct sockaddr*)&addr, sizeof(addr)) == -1 ||
+       ::listen(sock, 8) == -1)
+    {
+        std::cerr << "err; cannot listen on " << path << "\n";
+        close(sock);
+        return false;
+    }
+    std::cerr << "listening on " << path << "\n";
+
+    bool keep_running = true;
+    while(keep_running)
+    {
+        int client = accept(sock, 0, 0);
+        if(client == -1)
+        {
+            // the client went away, or we were interrupted
+            if(errno == EINTR || errno == ECONNABORTED) { continue; }
+
+            // out of descriptors or memory; wait for some to be freed
+            if(errno == EMFILE || errno == ENFILE ||
+               errno == ENOBUFS || errno == ENOMEM)
+            {
+                std::cerr << "err; accept: " << strerror(errno) << "\n";
+                sleep(1);
+                continue;
+            }
+
+            std::cerr << "err; accept: " << strerror(errno) << "\n";
+            close(sock);
+            unlink(path);
+            return false;
+        }
+
+        FILE* in = fdopen(client, "r");
+        FILE* out = fdopen(dup(client), "w");
+        if(in && out) { keep_running = serve(in, out); }
+        if(in) { fclose(in); } else { close(client); }
+        if(out) { fclose(out); }
+    }
+
+    close(sock);
+    unlink(path);
+    return true;
+}
@@ -0,0 +1,164 @@
+#ifndef WARTHOG_QUERY_SERVER_H
+#define WARTHOG_QUERY_SERVER_H
+
+// util/query_server.h
+//
+// A long-running server that answers pathfinding queries on gridmaps.
+// Maps, and everything the search needs to run on them (expansion
+// policy, node pool, open list, preprocessed data), are created the
+// first time a map is requested and then stay resident, so the startup
+// cost is paid once per map rather than once per query. Resident maps
+// are held in a warthog::map_registry, which evicts the least recently
+// used ones when a memory budget is given.
+//
+// Clients talk to the server over stdin/stdout or over a Unix domain
+// socket (one client at a time). The protocol is line-based:
+//
+//  map <file>              select the map for subsequent queries,
+//                          loading it if it is not yet resident.
+//                          reply: "ok <width> <height>" or "err ..."
+//  <sx> <sy> <tx> <ty>     a query (unpadded coordinates). queries are
+//                          collected into a batch.
+//  <empty line>            end of batch. the batch is solved and one
+//                          line is written per query, in input order:
+//                          "<cost> <expanded> <nanos>", where cost is
+//                          -1 if there is no path
+//  binary <n>              a binary batch: n records of four uint32_t
+//                          (sx, sy, tx, ty) follow the line. the reply
+//                          is n warthog::query_server::binary_reply.
+//                          n is at most MAX_BATCH; a larger or missing
+//                          n ends the session, since the records that
+//                          follow cannot be skipped reliably
+//  set <x> <y> <0|1>       record an edit to the selected map: tile
+//                          (x, y) becomes blocked (0) or traversable (1).
+//                          no reply unless the edit is not valid
+//  commit                  publish the recorded edits as a new version
+//                          of the selected map; batches that follow are
+//                          answered on it. reply: "ok <version>"
+//  stats                   reply: "maps <n> bytes <n> hits <n> misses <n>
+//                          evictions <n> queries <n> mean_nanos <x>
+//                          cache_hits <n> cache_subpath_hits <n>"
+//  quit                    end the session
+//  shutdown                end the session and stop the server
+//
+// With a query cache (see the constructor), queries asked before, and
+// queries between two nodes of a path found before, are answered from
+// the cache (see warthog::cached_search) and expand no nodes. Committed
+// edits that only add obstacles keep the paths that avoid them.
+//
+// Replies to a batch are flushed when the whole batch is answered.
+// Pending text queries are also answered at end of input, and once
+// MAX_BATCH of them are pending.
+//
+// Map files are checked before they are loaded (see
+// warthog::gridmap::is_map_file, used by the factory of warthog.cpp);
+// a request for a file that is not a map gets an error reply.
+//
+// The server is single-threaded. Each resident search object is only
+// ever used by the thread running the server. Edits can also come from
+// other threads, through the store of the resident map (see
+// warthog::resident_search::get_store); the server brings the map up to
+// date before each batch, so a batch is answered on one version.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "map_registry.h"
+#include "query_cache.h"
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace warthog
+{
+
+class query_server
+{
+    public:
+        typedef warthog::map_registry::factory_fn factory_fn;
+
+        // the most queries in one batch
+        static const uint32_t MAX_BATCH = 1 << 20;
+
+        struct binary_query
+        {
+            uint32_t sx_, sy_, tx_, ty_;
+        };
+
+        struct binary_reply
+        {
+            double cost_;       // -1 if there is no path
+            uint64_t nanos_;
+            uint32_t expanded_;
+            uint32_t status_;   // see warthog::solution::status
+        };
+
+        // @param factory creates the resident search for a map file
+        // (see warthog::map_registry); @param budget_bytes limits the
+        // memory of all resident maps (0 = no limit); @param
+        // cache_entries is the size of the query cache (0 = no cache)
+        query_server(factory_fn factory, size_t budget_bytes = 0,
+                uint32_t cache_entries = 0);
+        ~query_server();
+
+        // load @param mapfile now and make it the default map of
+        // every session. the default map is never evicted
+        bool
+        preload(const std::string& mapfile);
+
+        // answer the requests read from @param in until the client
+        // quits or the input ends.
+        // @return false if the client asked the server to shut down
+        bool
+        serve(FILE* in, FILE* out);
+
+        // accept clients on the Unix domain socket at @param path and
+        // serve them one at a time, until one of them asks for a shutdown
+        bool
+        listen(const char* path);
+
+        inline uint64_t
+        get_num_queries() { return num_queries_; }
+
+        inline uint32_t
+        get_num_maps() { return registry_.get_num_resident(); }
+
+        inline warthog::map_registry*
+        get_registry() { return &registry_; }
+
+        // 0 if there is no cache
+        inline warthog::query_cache*
+        get_cache() { return cache_.get(); }
+
+        size_t
+        mem();
+
+    private:
+        // outlives the registry, whose entries refer to it
+        std::unique_ptr<warthog::query_cache> cache_;
+        warthog::map_registry registry_;
+        warthog::resident_search* default_rs_;
+        std::string default_map_;
+
+        uint64_t num_queries_;
+        double total_nanos_;
+
+        void
+        solve(warthog::resident_search* rs, const binary_query& q,
+                binary_reply& reply);
+
+        void
+        answer_batch(warthog::resident_search* rs,
+                std::vector<binary_query>& batch, FILE* out);
+
+        query_server(const query_server& other) : registry_(0) { }
+        query_server&
+        operator=(const query_server& other) { return *this; }
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+#ifndef WARTHOG_RLE_H
+#define WARTHOG_RLE_H
+
+// util/rle.h
+//
+// Run-length encoding for rows of bits. A row is stored as the sorted
+// positions at which its value changes, reading from position 0 with an
+// initial value of 0. Entries with an even index start a run of 1s and
+// entries with an odd index end one (they hold the position of the first
+// 0 after the run). An all-zero row has no entries.
+//
+// Queries take the first and one-past-the-last entry of a row and cost
+// a binary search over the entries of that row.
+//
+// @author: dharabor
+// @created: 2020-07-10
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace warthog
+{
+
+namespace rle
+{
+
+// no entry satisfies the query
+static const int32_t NONE_BEFORE = -1;
+static const int32_t NONE_AFTER = INT32_MAX;
+
+// append to @param out the encoding of the @param n bits returned by
+// @param get(0) ... get(n-1)
+template<typename GET>
+inline void
+encode(uint32_t n, GET get, std::vector<uint32_t>& out)
+{
+    bool val = false;
+    for(uint32_t x = 0; x < n; x++)
+    {
+        if(get(x) != val) { out.push_back(x); val = !val; }
+    }
+    if(val) { out.push_back(n); }
+}
+
+// @return the number of entries <= @param x
+inline uint32_t
+rank(const uint32_t* first, const uint32_t* last, int32_t x)
+{
+    if(x < 0) { return 0; }
+    return (uint32_t)(std::upper_bound(first, last, (uint32_t)x) - first);
+}
+
+// @return the value of the bit at position @param x
+inline bool
+get(const uint32_t* first, const uint32_t* last, int32_t x)
+{
+    return rank(first, last, x) & 1;
+}
+
+// @return the smallest entry > @param x that starts (@param ones = true)
+// or ends (@param ones = false) a run of 1s; NONE_AFTER if there is none
+inline int32_t
+next_change(const uint32_t* first, const uint32_t* last, int32_t x,
+        bool ones)
+{
+    uint32_t i = rank(first, last, x);
+    if((i & 1) == (uint32_t)ones) { i++; }
+    return (first + i) < last ? (int32_t)first[i] : NONE_AFTER;
+}
+
+// @return the largest entry <= @param x that starts (@param ones = true)
+// or ends (@param ones = false) a run of 1s; NONE_BEFORE if there is none
+inline int32_t
+prev_change(const uint32_t* first, const uint32_t* last, int32_t x,
+        bool ones)
+{
+    int64_t i = (int64_t)rank(first, last, x) - 1;
+    if(((i & 1) == 0) != ones) { i--; }
+    return i >= 0 ? (int32_t)first[i] : NONE_BEFORE;
+}
+
+// @return bits x ... x+n-1 of the row (n <= 64), bit x in the lowest
+// position. positions >= @param width read as 0
+inline uint64_t
+read(const uint32_t* first, const uint32_t* last, int32_t x, uint32_t n,
+        uint32_t width)
+{
+    uint64_t bits = 0;
+    int64_t end = std::min<int64_t>((int64_t)x + n, width);
+    uint32_t i = rank(first, last, x);
+    int64_t pos = x;
+    while(pos < end)
+    {
+        int64_t next = (first + i) < last ? first[i] : end;
+        next = std::min(next, end);
+        if((i & 1) && next > pos)
+        {
+            uint64_t len = (uint64_t)(next - pos);
+            uint64_t run = len >= 64 ? ~0ull : ((1ull << len) - 1);
+            bits |= run << (pos - x);
+        }
+        pos = next;
+        i++;
+    }
+    return bits;
+}
+
+}
+
+}
+
+#endif
@@ -0,0 +1,212 @@
+// cached_search.cpp
+//
+// Puts a warthog::cached_search (src/search/cached_search.h) in front of
+// prune2 and A* and checks its answers against A*: a query asked again is
+// answered from the cache, also after other queries ran; a query between
+// two nodes of a cached path is answered from that path; a perturbation
+// makes the entries stale; and a batch of new obstacles (see
+// warthog::gridmap_edit) keeps the entries whose paths avoid them.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "cached_search.h"
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_edit.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy_prune2.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "query_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace G = global;
+
+typedef warthog::flexible_astar<warthog::octile_heuristic,
+    warthog::gridmap_expansion_policy, warthog::pqueue_min> astar_search;
+
+// a query and the path the cache gave for it
+struct query
+{
+    uint32_t start_, target_;
+    warthog::solution sol_;
+};
+
+// true if a path segment of @param sol, or a tile next to one, is the
+// padded (@param x, @param y); see warthog::cached_search::repair
+bool
+touches(warthog::gridmap& map, warthog::solution& sol, uint32_t x, uint32_t y)
+{
+    for(uint32_t i = 0; i < sol.path_.size(); i++)
+    {
+        uint32_t ax, ay, bx, by;
+        map.to_padded_xy(sol.path_[i], ax, ay);
+        uint32_t j = i + 1 < sol.path_.size() ? i + 1 : i;
+        map.to_padded_xy(sol.path_[j], bx, by);
+        if(std::max(ax, bx) + 1 >= x && std::min(ax, bx) <= x + 1 &&
+           std::max(ay, by) + 1 >= y && std::min(ay, by) <= y + 1)
+        { return true; }
+    }
+    return false;
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::gridmap map("maps/dao/den520d.map");
+    G::query::map = &map;
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario("../scenarios/movingai/dao/den520d.map.scen");
+
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::gridmap_expansion_policy ref_expander(&map);
+    warthog::pqueue_min ref_open;
+    astar_search reference(&heuristic, &ref_expander, &ref_open);
+    auto optimal = [&](uint32_t start, uint32_t target, warthog::solution& sol)
+    {
+        warthog::problem_instance pi(start, target);
+        G::nodepool = ref_expander.get_nodepool();
+        reference.get_pathcost(pi, sol);
+    };
+
+    warthog::jps2_expansion_policy_prune2 expander(&map);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2_expansion_policy_prune2, warthog::pqueue_min>
+            prune2(&heuristic, &expander, &open);
+    warthog::query_cache cache(4096);
+    warthog::cached_search cached(&prune2, &cache, 0, &map);
+    auto ask = [&](uint32_t start, uint32_t target, warthog::solution& sol)
+    {
+        warthog::problem_instance pi(start, target);
+        G::nodepool = expander.get_nodepool();
+        cached.get_path(pi, sol);
+        warthog::solution ref_sol;
+        optimal(start, target, ref_sol);
+        CHECK(sol.status_ == ref_sol.status_);
+        CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                    ref_sol.sum_of_edge_costs_));
+    };
+
+    std::vector<query> queries;
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 20)
+    {
+        query q;
+        test::get_ids(scenmgr.get_experiment(i), q.start_, q.target_);
+        ask(q.start_, q.target_, q.sol_);
+        queries.push_back(q);
+    }
+
+    // asked again, after every other query ran: exact hits that expand
+    // nothing, although prune2 placed its temporary obstacles meanwhile
+    for(query& q : queries)
+    {
+        if(q.sol_.nodes_expanded_ == 0) { continue; }
+        uint64_t hits = cache.get_hits();
+        warthog::solution sol;
+        ask(q.start_, q.target_, sol);
+        CHECK(cache.get_hits() == hits + 1);
+        CHECK(sol.nodes_expanded_ == 0);
+        CHECK(sol.path_ == q.sol_.path_);
+    }
+
+    // between inner nodes of a cached path, both ways
+    query* longest = &queries[0];
+    for(query& q : queries)
+    {
+        if(q.sol_.path_.size() > longest->sol_.path_.size()) { longest = &q; }
+    }
+    std::vector<warthog::sn_id_t>& path = longest->sol_.path_;
+    CHECK(path.size() >= 4);
+    if(path.size() >= 4)
+    {
+        uint32_t a = (uint32_t)map.to_unpadded_id(path[1]);
+        uint32_t b = (uint32_t)map.to_unpadded_id(path[path.size() - 2]);
+        uint64_t subpath_hits = cache.get_subpath_hits();
+        warthog::solution sol, reversed;
+        ask(a, b, sol);
+        ask(b, a, reversed);
+        CHECK(cache.get_subpath_hits() == subpath_hits + 2);
+        CHECK(sol.nodes_expanded_ == 0 && reversed.nodes_expanded_ == 0);
+        CHECK(sol.path_.front() == path[1] &&
+                sol.path_.back() == path[path.size() - 2]);
+    }
+
+    // a perturbation on the longest path: every entry is stale, and the
+    // query is searched again on the changed map
+    warthog::sn_id_t blocked = path[path.size() / 2];
+    expander.perturbation(blocked, false);
+    {
+        uint64_t hits = cache.get_hits();
+        uint64_t subpath_hits = cache.get_subpath_hits();
+        warthog::solution sol;
+        ask(longest->start_, longest->target_, sol);
+        CHECK(cache.get_hits() == hits);
+        CHECK(cache.get_subpath_hits() == subpath_hits);
+        CHECK(sol.nodes_expanded_ > 0);
+        CHECK(std::find(sol.path_.begin(), sol.path_.end(), blocked) ==
+                sol.path_.end());
+    }
+    expander.perturbation(blocked, true);
+
+    // new obstacles through a warthog::gridmap_edit, with A* behind the
+    // cache: entries whose paths avoid them are carried over, the others
+    // are searched again; new traversable tiles make every entry stale
+    astar_search astar(&heuristic, &ref_expander, &ref_open);
+    warthog::cached_search cached_astar(&astar, &cache, 1, &map);
+    auto ask_astar = [&](query& q)
+    {
+        warthog::problem_instance pi(q.start_, q.target_);
+        G::nodepool = ref_expander.get_nodepool();
+        q.sol_.reset();
+        cached_astar.get_path(pi, q.sol_);
+    };
+    for(query& q : queries) { ask_astar(q); }
+
+    // an obstacle on the longest path, and away from some other path
+    blocked = longest->sol_.path_[longest->sol_.path_.size() / 2];
+    uint32_t x, y;
+    map.to_padded_xy(blocked, x, y);
+    query* away = 0;
+    for(query& q : queries)
+    {
+        if(q.sol_.path_.size() && !touches(map, q.sol_, x, y))
+        { away = &q; }
+    }
+    CHECK(away != 0);
+    if(away)
+    {
+        warthog::gridmap_edit edit(&map);
+        edit.set_label(blocked, false);
+        CHECK(edit.commit());
+
+        uint64_t hits = cache.get_hits();
+        warthog::solution ref_sol;
+        query kept = *away;
+        ask_astar(kept);
+        CHECK(cache.get_hits() == hits + 1);
+        CHECK(kept.sol_.nodes_expanded_ == 0);
+        CHECK(kept.sol_.path_ == away->sol_.path_);
+
+        query changed = *longest;
+        ask_astar(changed);
+        optimal(changed.start_, changed.target_, ref_sol);
+        CHECK(cache.get_hits() == hits + 1);
+        CHECK(changed.sol_.nodes_expanded_ > 0);
+        CHECK(test::same_cost(changed.sol_.sum_of_edge_costs_,
+                    ref_sol.sum_of_edge_costs_));
+
+        edit.set_label(blocked, true);
+        CHECK(edit.commit());
+        ask_astar(kept);
+        CHECK(cache.get_hits() == hits + 1);
+        CHECK(kept.sol_.nodes_expanded_ > 0);
+    }
+    return test::report("cached_search");
+}
@@ -0,0 +1,228 @@
+// component_labelling.cpp
+//
+// Checks the labels of warthog::label::component_labelling
+// (src/label/component_labelling.h) on maps with few components, which
+// take 16 bits per cell, and with more than 2^16, which take 32; that
+// ::set_label widens the labels when it needs to; and that JPS2 and
+// prune2 find the same paths with and without the labels on a map with
+// many components, rejecting pairs that are not connected without
+// expanding a node.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "component_labelling.h"
+#include "flexible_astar.h"
+#include "global.h"
+#include "jps2_expansion_policy.h"
+#include "jps2_expansion_policy_prune2.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace G = global;
+
+const char* MAPFILE = "/tmp/warthog-test-components.map";
+
+// a map of @param width x @param height where only the first
+// @param num_cells cells with even x and y, in row order, are
+// traversable; each is a component of its own
+void
+write_isolated_cells(uint32_t width, uint32_t height, uint32_t num_cells)
+{
+    std::ofstream out(MAPFILE);
+    out << "type octile\nheight " << height << "\nwidth " << width << "\nmap\n";
+    uint32_t n = 0;
+    for(uint32_t y = 0; y < height; y++)
+    {
+        for(uint32_t x = 0; x < width; x++)
+        {
+            bool open = !(x & 1) && !(y & 1) && n < num_cells;
+            if(open) { n++; }
+            out << (open ? '.' : '@');
+        }
+        out << "\n";
+    }
+}
+
+// every traversable cell of @param map has a component of its own
+bool
+all_isolated(warthog::gridmap& map,
+        warthog::label::component_labelling& cl, uint32_t num_cells)
+{
+    std::vector<bool> seen(num_cells + 1, false);
+    for(uint32_t y = 0; y < map.header_height(); y++)
+    {
+        for(uint32_t x = 0; x < map.header_width(); x++)
+        {
+            warthog::grid_id_t id = map.to_padded_id(x, y);
+            uint32_t comp = cl.get_component(id);
+            if(map.get_label(id) != (comp != cl.NO_COMPONENT)) { return false; }
+            if(comp == cl.NO_COMPONENT) { continue; }
+            if(comp > num_cells || seen[comp]) { return false; }
+            seen[comp] = true;
+        }
+    }
+    return true;
+}
+
+void
+check_scenario(const char* mapfile, const char* scenfile)
+{
+    warthog::gridmap map(mapfile);
+    warthog::label::component_labelling cl(&map);
+    cl.precompute();
+    CHECK(cl.is_current());
+
+    // 16 bits per cell
+    CHECK(cl.mem() < 3 * map.padded_mapsize());
+
+    // scenario queries have paths
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(scenfile);
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i++)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        CHECK(cl.connected(map.to_padded_id(start), map.to_padded_id(target)));
+    }
+}
+
+// random start and target pairs on a map with 45% obstacles, searched
+// by JPS2 (or prune2) with and without the labels
+template<typename EXPANDER>
+void
+check_searches()
+{
+    {
+        std::ofstream out(MAPFILE);
+        out << "type octile\nheight 128\nwidth 128\nmap\n";
+        uint32_t seed = 7;
+        for(uint32_t y = 0; y < 128; y++)
+        {
+            for(uint32_t x = 0; x < 128; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                out << ((seed >> 16) % 100 < 45 ? '@' : '.');
+            }
+            out << "\n";
+        }
+    }
+    warthog::gridmap map(MAPFILE);
+    remove(MAPFILE);
+    G::query::map = &map;
+    warthog::label::component_labelling cl(&map);
+    cl.precompute();
+    CHECK(cl.get_num_components() > 1);
+
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    EXPANDER plain_expander(&map);
+    warthog::pqueue_min plain_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        EXPANDER, warthog::pqueue_min>
+            plain(&heuristic, &plain_expander, &plain_open);
+    EXPANDER expander(&map);
+    expander.set_component_labelling(&cl);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        EXPANDER, warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+
+    uint32_t seed = 11, num_paths = 0, num_no_paths = 0;
+    for(uint32_t i = 0; i < 2000; i++)
+    {
+        uint32_t ids[2];
+        for(uint32_t& id : ids)
+        {
+            do
+            {
+                seed = seed * 1103515245 + 12345;
+                id = (seed >> 8) % (128 * 128);
+            } while(!map.get_label(map.to_padded_id(id)));
+        }
+        warthog::problem_instance pi(ids[0], ids[1]);
+        warthog::solution sol, plain_sol;
+        G::nodepool = plain_expander.get_nodepool();
+        plain.get_pathcost(pi, plain_sol);
+        G::nodepool = expander.get_nodepool();
+        astar.get_pathcost(pi, sol);
+        CHECK(sol.status_ == plain_sol.status_);
+        CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                    plain_sol.sum_of_edge_costs_));
+        CHECK(cl.is_current());
+        if(sol.status_ == warthog::solution::FOUND) { num_paths++; }
+        else
+        {
+            CHECK(sol.nodes_expanded_ == 0);
+            num_no_paths++;
+        }
+    }
+    CHECK(num_paths > 0 && num_no_paths > 0);
+}
+
+int
+main(int argc, char** argv)
+{
+    check_searches<warthog::jps2_expansion_policy>();
+    check_searches<warthog::jps2_expansion_policy_prune2>();
+    check_scenario("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen");
+    check_scenario("maps/street/Berlin_0_256.map",
+            "../scenarios/movingai/street/Berlin_0_256.map.scen");
+
+    // one cell short of the largest 16 bit component: the labels start
+    // narrow, and widen when ::set_label adds two more components
+    {
+        uint32_t num_cells = UINT16_MAX - 1;
+        write_isolated_cells(512, 512, num_cells);
+        warthog::gridmap map(MAPFILE);
+        remove(MAPFILE);
+        warthog::label::component_labelling cl(&map);
+        cl.precompute();
+        CHECK(cl.get_num_components() == num_cells);
+        CHECK(all_isolated(map, cl, num_cells));
+        size_t narrow_mem = cl.mem();
+        CHECK(narrow_mem < 3 * map.padded_mapsize());
+
+        for(uint32_t i = num_cells; i < num_cells + 2; i++)
+        {
+            warthog::grid_id_t id =
+                map.to_padded_id((i % 256) * 2, (i / 256) * 2);
+            CHECK(!map.get_label(id));
+            map.set_label(id, true);
+            cl.set_label(id, true);
+        }
+        CHECK(cl.is_current());
+        CHECK(cl.get_num_components() == num_cells + 2);
+        CHECK(all_isolated(map, cl, num_cells + 2));
+        CHECK(cl.mem() > narrow_mem);
+
+        // joining two components through a new cell
+        warthog::grid_id_t a = map.to_padded_id(0, 0);
+        warthog::grid_id_t b = map.to_padded_id(2, 0);
+        CHECK(!cl.connected(a, b));
+        map.set_label(map.to_padded_id(1, 0), true);
+        cl.set_label(map.to_padded_id(1, 0), true);
+        CHECK(cl.connected(a, b));
+        CHECK(!cl.connected(a, map.to_padded_id(0, 2)));
+    }
+
+    // more components than 16 bits can tell apart
+    {
+        uint32_t num_cells = 300 * 300;
+        write_isolated_cells(600, 600, num_cells);
+        warthog::gridmap map(MAPFILE);
+        remove(MAPFILE);
+        warthog::label::component_labelling cl(&map);
+        cl.precompute();
+        CHECK(cl.get_num_components() == num_cells);
+        CHECK(all_isolated(map, cl, num_cells));
+        CHECK(cl.mem() >= 4 * map.padded_mapsize());
+    }
+    return test::report("component_labelling");
+}
@@ -0,0 +1,59 @@
+// gm_parser.cpp
+//
+// Checks which map files warthog::gm_parser (src/util/gm_parser.h)
+// accepts, in particular those whose dimensions do not fit 32 bits.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "gm_parser.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+const char* MAPFILE = "/tmp/warthog-test-parser.map";
+
+// a map file with header @param height x @param width and
+// @param num_tiles traversable tiles
+bool
+accepted(uint32_t height, uint32_t width, uint64_t num_tiles)
+{
+    {
+        std::ofstream out(MAPFILE);
+        out << "type octile\nheight " << height << "\nwidth " << width
+            << "\nmap\n" << std::string(num_tiles, '.') << "\n";
+    }
+    bool ok = warthog::gm_parser::is_valid(MAPFILE);
+    remove(MAPFILE);
+    return ok;
+}
+
+int
+main(int argc, char** argv)
+{
+    CHECK(accepted(3, 4, 12));
+    CHECK(!accepted(3, 4, 11));
+    CHECK(!accepted(3, 4, 13));
+    CHECK(!accepted(0, 4, 0));
+
+    // 65536 * 65537 tiles; the count wraps to 65536 in 32 bits
+    CHECK(!accepted(65536, 65537, 65536));
+
+    // tiles are indexed past 2^16
+    {
+        std::ofstream out(MAPFILE);
+        out << "type octile\nheight 300\nwidth 300\nmap\n";
+        for(uint32_t i = 0; i < 300 * 300; i++) { out << (i % 7 ? '.' : '@'); }
+        out << "\n";
+    }
+    warthog::gm_parser parser(MAPFILE);
+    remove(MAPFILE);
+    CHECK(parser.get_num_tiles() == 300 * 300);
+    CHECK(parser.get_tile_at(300 * 300 - 2) == '.');
+    CHECK(parser.get_tile_at(300 * 299 - 2) == '@');
+    return test::report("gm_parser");
+}
@@ -0,0 +1,167 @@
+// graph_oracle_builder.cpp
+//
+// Builds the CPD of the graph of a gridmap with
+// warthog::cpd::graph_oracle_builder (src/cpd/graph_oracle_builder.h)
+// and checks it against rows computed one after another; then stops
+// builds part way (by cutting the output short) and checks that a build
+// resumes only a file of its own graph.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "graph_expansion_policy.h"
+#include "graph_oracle.h"
+#include "graph_oracle_builder.h"
+#include "gridmap.h"
+#include "oracle_listener.h"
+#include "pqueue.h"
+#include "xy_graph.h"
+#include "zero_heuristic.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* CPDFILE = "/tmp/warthog-test-builder.cpd";
+const char* CKPTFILE = "/tmp/warthog-test-builder.cpd.ckpt";
+
+std::string
+contents(const char* filename)
+{
+    std::ifstream in(filename, std::ios_base::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+bool
+exists(const char* filename)
+{
+    struct stat st;
+    return stat(filename, &st) == 0;
+}
+
+// a build of @param g stopped after writing part of CPDFILE: the first
+// @param size bytes of @param cpd, and a checkpoint for @param g
+void
+stop_build(warthog::graph::xy_graph& g, const std::string& cpd, size_t size)
+{
+    std::ofstream(CPDFILE, std::ios_base::binary).write(cpd.data(), size);
+
+    // the layout of graph_oracle_builder::checkpoint
+    struct
+    {
+        char magic_[4];
+        uint32_t version_;
+        uint64_t graph_hash_;
+        uint32_t num_nodes_;
+        uint32_t reserved_;
+    } ckpt;
+    memset(&ckpt, 0, sizeof(ckpt));
+    memcpy(ckpt.magic_, "WCPK", 4);
+    ckpt.version_ = 1;
+    ckpt.graph_hash_ = g.checksum();
+    ckpt.num_nodes_ = g.get_num_nodes();
+    std::ofstream(CKPTFILE, std::ios_base::binary).write(
+            (char*)&ckpt, sizeof(ckpt));
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::gridmap map("maps/dao/arena.map");
+    warthog::graph::xy_graph g;
+    warthog::graph::gridmap_to_xy_graph(&map, &g);
+    remove(CPDFILE);
+    remove(CKPTFILE);
+
+    // on every core, to a file
+    warthog::cpd::graph_oracle cpd(&g);
+    warthog::cpd::graph_oracle_builder<warthog::cpd::FORWARD> builder(&cpd);
+    CHECK(builder.build(CPDFILE));
+    CHECK(!exists(CKPTFILE));
+    std::string whole = contents(CPDFILE);
+
+    // one row after another
+    {
+        warthog::cpd::graph_oracle serial(&g);
+        serial.compute_dfs_preorder();
+        warthog::simple_graph_expansion_policy expander(&g);
+        warthog::zero_heuristic heuristic;
+        warthog::pqueue_min open;
+        warthog::cpd::graph_oracle_listener<warthog::cpd::FORWARD>
+            listener(&serial);
+        warthog::flexible_astar<warthog::zero_heuristic,
+            warthog::simple_graph_expansion_policy, warthog::pqueue_min,
+            warthog::cpd::graph_oracle_listener<warthog::cpd::FORWARD>>
+                dijkstra(&heuristic, &expander, &open, &listener);
+        std::vector<warthog::cpd::fm_coll> row(g.get_num_nodes());
+        warthog::sn_id_t source_id;
+        listener.set_run(&source_id, &row);
+        for(uint32_t id = 0; id < g.get_num_nodes(); id++)
+        {
+            source_id = id;
+            serial.compute_row(id, &dijkstra, row);
+        }
+        serial.value_index_swap_array();
+        CHECK(serial == cpd);
+
+        std::ostringstream out;
+        out << serial;
+        CHECK(out.str() == whole);
+    }
+
+    // resumed part way through a row
+    stop_build(g, whole, whole.size() * 3 / 5);
+    {
+        warthog::cpd::graph_oracle resumed(&g);
+        warthog::cpd::graph_oracle_builder<warthog::cpd::FORWARD>
+            resumed_builder(&resumed);
+        CHECK(resumed_builder.build(CPDFILE));
+        CHECK(resumed == cpd);
+        CHECK(contents(CPDFILE) == whole);
+        CHECK(!exists(CKPTFILE));
+    }
+
+    // a graph with as many nodes, but one edge that costs more, does
+    // not resume the file; the file is left alone
+    stop_build(g, whole, whole.size() * 3 / 5);
+    {
+        warthog::graph::xy_graph g2;
+        warthog::graph::gridmap_to_xy_graph(&map, &g2);
+        CHECK(g2.checksum() == g.checksum());
+        g2.get_node(0)->outgoing_begin()->wt_ += 1;
+        CHECK(g2.checksum() != g.checksum());
+
+        warthog::cpd::graph_oracle other(&g2);
+        warthog::cpd::graph_oracle_builder<warthog::cpd::FORWARD>
+            other_builder(&other);
+        CHECK(!other_builder.build(CPDFILE));
+        CHECK(contents(CPDFILE) == whole.substr(0, whole.size() * 3 / 5));
+        CHECK(exists(CKPTFILE));
+    }
+
+    // without a checkpoint the file is written again from the start
+    remove(CKPTFILE);
+    {
+        warthog::cpd::graph_oracle again(&g);
+        warthog::cpd::graph_oracle_builder<warthog::cpd::FORWARD>
+            again_builder(&again);
+        CHECK(again_builder.build(CPDFILE));
+        CHECK(again == cpd);
+        CHECK(contents(CPDFILE) == whole);
+    }
+
+    remove(CPDFILE);
+    remove(CKPTFILE);
+    return test::report("graph_oracle_builder");
+}
@@ -0,0 +1,155 @@
+// grid_cpd_search.cpp
+//
+// Walks paths read from a warthog::cpd::grid_oracle
+// (src/cpd/grid_cpd_search.h) and checks their costs against A*; then
+// checks that the walk gives up, instead of reading past its tables or
+// running forever, when the oracle has no rows, is corrupt or was built
+// for a map that has since been edited.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "grid_cpd_search.h"
+#include "grid_oracle.h"
+#include "gridmap_edit.h"
+#include "gridmap_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace G = global;
+
+const char* CPDFILE = "/tmp/warthog-test-grid.cpd";
+const char* BADFILE = "/tmp/warthog-test-grid-bad.cpd";
+
+// the header of a saved oracle; see grid_oracle.cpp
+struct cpd_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint64_t map_hash_;
+    uint64_t num_nodes_;
+    uint64_t num_runs_;
+};
+
+// rewrite the oracle in CPDFILE to BADFILE with one run per row: row i
+// makes move @param moves[i] towards every target
+void
+write_rows(const std::vector<uint32_t>& moves)
+{
+    cpd_header header;
+    std::ifstream in(CPDFILE, std::ios_base::binary);
+    in.read((char*)&header, sizeof(header));
+    header.num_runs_ = moves.size();
+
+    std::ofstream out(BADFILE, std::ios_base::binary);
+    out.write((char*)&header, sizeof(header));
+    for(uint32_t i = 0; i <= moves.size(); i++)
+    { out.write((char*)&i, sizeof(i)); }
+    for(uint32_t move : moves) { out.write((char*)&move, sizeof(move)); }
+}
+
+// every query of @param scenmgr longer than one step has no answer
+void
+check_no_paths(warthog::cpd::grid_cpd_search& cpd,
+        warthog::scenario_manager& scenmgr)
+{
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 5)
+    {
+        if(scenmgr.get_experiment(i)->distance() < 2) { continue; }
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution sol;
+        cpd.get_path(pi, sol);
+        CHECK(sol.status_ == warthog::solution::NO_PATH);
+        CHECK(sol.path_.size() == 0);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::gridmap map("maps/dao/arena.map");
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario("../scenarios/movingai/dao/arena.map.scen");
+
+    // no rows yet
+    warthog::cpd::grid_oracle oracle(&map);
+    warthog::cpd::grid_cpd_search cpd(&oracle);
+    CHECK(!oracle.is_current());
+    check_no_paths(cpd, scenmgr);
+
+    oracle.precompute();
+    CHECK(oracle.is_current());
+    CHECK(oracle.save(CPDFILE));
+
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::gridmap_expansion_policy expander(&map);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy, warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+    G::nodepool = expander.get_nodepool();
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 5)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution sol, astar_sol;
+        cpd.get_path(pi, sol);
+        astar.get_pathcost(pi, astar_sol);
+        CHECK(sol.status_ == astar_sol.status_);
+        CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                    astar_sol.sum_of_edge_costs_));
+        if(sol.path_.size() == 0) { continue; }
+        CHECK(sol.path_.front() == map.to_padded_id(start));
+        CHECK(sol.path_.back() == map.to_padded_id(target));
+    }
+
+    // rows that have no first move
+    std::vector<uint32_t> moves(oracle.get_num_nodes(),
+            warthog::cpd::CPD_FM_NONE);
+    write_rows(moves);
+    {
+        warthog::cpd::grid_oracle bad(&map);
+        warthog::cpd::grid_cpd_search bad_cpd(&bad);
+        CHECK(bad.load(BADFILE));
+        check_no_paths(bad_cpd, scenmgr);
+    }
+
+    // rows that send the walk back and forth: south from even rows,
+    // north from odd ones. nodes are numbered in order of padded id
+    uint32_t node = 0;
+    for(warthog::grid_id_t id = 0; id < map.padded_mapsize(); id++)
+    {
+        if(!map.get_label(id)) { continue; }
+        moves[node++] = ((id / map.width()) & 1) ? 0 : 1;
+    }
+    write_rows(moves);
+    {
+        warthog::cpd::grid_oracle bad(&map);
+        warthog::cpd::grid_cpd_search bad_cpd(&bad);
+        CHECK(bad.load(BADFILE));
+        check_no_paths(bad_cpd, scenmgr);
+    }
+    remove(BADFILE);
+    remove(CPDFILE);
+
+    // the map changes after the oracle is built
+    warthog::gridmap_edit edit(&map);
+    warthog::grid_id_t id = map.to_padded_id(1, 1);
+    edit.set_label(id, !map.get_label(id));
+    CHECK(edit.commit());
+    CHECK(!oracle.is_current());
+    check_no_paths(cpd, scenmgr);
+    return test::report("grid_cpd_search");
+}
@@ -0,0 +1,79 @@
+// gridmap_binary.cpp
+//
+// Writes maps in the binary format (see warthog::gridmap::save_binary)
+// and checks that the maps read back, and their rotated copies, have
+// the same cells as the text maps they came from.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+
+const char* BINFILE = "/tmp/warthog-test.gmb";
+
+// @return true if @param map and @param other have the same cells
+bool
+same_cells(warthog::gridmap& map, warthog::gridmap& other)
+{
+    if(map.header_width() != other.header_width() ||
+       map.header_height() != other.header_height()) { return false; }
+    for(uint32_t y = 0; y < map.header_height(); y++)
+    {
+        for(uint32_t x = 0; x < map.header_width(); x++)
+        {
+            if(map.get_label(map.to_padded_id(x, y)) !=
+               other.get_label(other.to_padded_id(x, y))) { return false; }
+        }
+    }
+    return true;
+}
+
+void
+check_map(const char* mapfile)
+{
+    warthog::gridmap map(mapfile);
+    CHECK(warthog::gridmap::is_map_file(mapfile));
+    CHECK(map.save_binary(BINFILE));
+    CHECK(warthog::gridmap::is_map_file(BINFILE));
+
+    warthog::gridmap binary(BINFILE);
+    CHECK(same_cells(map, binary));
+    CHECK(binary.get_num_traversable_tiles() ==
+            map.get_num_traversable_tiles());
+    CHECK(binary.checksum() == map.checksum());
+
+    // mapped from the file, and computed
+    warthog::gridmap* rmap = map.rotated_copy();
+    warthog::gridmap* rbinary = binary.rotated_copy();
+    CHECK(same_cells(*rmap, *rbinary));
+    delete rmap;
+    delete rbinary;
+
+    // changes stay in memory
+    warthog::grid_id_t id = binary.to_padded_id(0, 0);
+    binary.set_label(id, !binary.get_label(id));
+    warthog::gridmap reread(BINFILE);
+    CHECK(same_cells(map, reread));
+
+    // a truncated file is not a map
+    std::ifstream in(BINFILE, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)),
+            std::istreambuf_iterator<char>());
+    in.close();
+    std::ofstream(BINFILE, std::ios::binary | std::ios::trunc)
+        << bytes.substr(0, bytes.size() - 1);
+    CHECK(!warthog::gridmap::is_map_file(BINFILE));
+    remove(BINFILE);
+}
+
+int
+main(int argc, char** argv)
+{
+    check_map("maps/dao/arena.map");
+    check_map("maps/street/Berlin_0_256.map");
+    return test::report("gridmap_binary");
+}
@@ -0,0 +1,84 @@
+// gridmap_edit.cpp
+//
+// Applies batches of changes to a map through a warthog::gridmap_edit
+// (src/domains/gridmap_edit.h) and checks the map, the reported change
+// and a rotated copy kept in step; changes to padding must be ignored.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "gridmap_edit.h"
+
+// @return true if @param rmap is @param map rotated by 90 degrees
+// clockwise (see warthog::gridmap::rotated_copy)
+bool
+same_rotated(warthog::gridmap& map, warthog::gridmap& rmap)
+{
+    uint32_t maph = map.header_height();
+    for(uint32_t y = 0; y < maph; y++)
+    {
+        for(uint32_t x = 0; x < map.header_width(); x++)
+        {
+            if(map.get_label(map.to_padded_id(x, y)) !=
+               rmap.get_label(rmap.to_padded_id(maph - y - 1, x)))
+            { return false; }
+        }
+    }
+    return true;
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::gridmap map("maps/dao/arena.map");
+    warthog::gridmap* rmap = map.rotated_copy();
+    warthog::rotated_copy_index rindex(&map, rmap);
+    uint64_t num_traversable = map.get_num_traversable_tiles();
+    uint32_t version = map.get_version();
+
+    // every tile outside the header width and height is padding
+    warthog::gridmap_edit edit(&map);
+    uint32_t top = (uint32_t)(map.to_padded_id(0, 0) / map.width());
+    for(uint32_t x = 0; x < map.width(); x++)
+    {
+        edit.set_label(x, top - 1, true);
+        edit.set_label(x, top + map.header_height(), true);
+    }
+    for(uint32_t y = 0; y < map.height(); y++)
+    {
+        for(uint32_t x = map.header_width(); x < map.width(); x++)
+        { edit.set_label((warthog::grid_id_t)y * map.width() + x, true); }
+    }
+    edit.set_label(map.padded_mapsize(), true);
+    CHECK(edit.size() == 0);
+    CHECK(!edit.commit());
+    CHECK(map.get_version() == version);
+    CHECK(map.get_num_traversable_tiles() == num_traversable);
+
+    // a batch inside the map; the last label given for a tile wins
+    warthog::grid_id_t a = map.to_padded_id(3, 4);
+    warthog::grid_id_t b = map.to_padded_id(40, 45);
+    bool label_a = map.get_label(a), label_b = map.get_label(b);
+    edit.set_label(a, label_a);
+    edit.set_label(a, !label_a);
+    edit.set_label(b, !label_b);
+    edit.set_label(map.to_padded_id(10, 10), map.get_label(10, top + 10));
+    CHECK(edit.commit());
+    CHECK(map.get_label(a) == !label_a);
+    CHECK(map.get_label(b) == !label_b);
+    CHECK(map.get_version() == version + 1);
+    CHECK(map.get_num_traversable_tiles() == num_traversable +
+            (label_a ? -1 : 1) + (label_b ? -1 : 1));
+
+    const warthog::gridmap_change& change = edit.get_change();
+    CHECK(change.x1_ == 3 && change.x2_ == 40);
+    CHECK(change.y1_ == top + 4 && change.y2_ == top + 45);
+    CHECK(change.num_opened_ + change.num_closed_ == 2);
+    CHECK(same_rotated(map, *rmap));
+
+    delete rmap;
+    return test::report("gridmap_edit");
+}
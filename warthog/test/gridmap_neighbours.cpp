@@ -0,0 +1,86 @@
+// gridmap_neighbours.cpp
+//
+// Checks the neighbourhood reads of warthog::gridmap (::get_neighbours,
+// ::get_neighbours_32bit and ::get_neighbours_upper_32bit) against
+// ::get_label, tile by tile, on random maps whose widths put the tiles
+// read on either side of word boundaries; see warthog::gridword.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include <cstdio>
+#include <fstream>
+
+const char* MAPFILE = "/tmp/warthog-test-neighbours.map";
+
+// the number of the first @param num bits of each of @param tiles that
+// differ from the labels of the tiles from @param first on, in the row
+// above, the same row and the row below
+uint32_t
+mismatches(warthog::gridmap& map, const uint32_t tiles[3], uint32_t num,
+        warthog::grid_id_t first)
+{
+    uint32_t count = 0;
+    for(uint32_t r = 0; r < 3; r++)
+    {
+        warthog::grid_id_t id = first + r*map.width() - map.width();
+        for(uint32_t b = 0; b < num; b++)
+        {
+            if(((tiles[r] >> b) & 1) != (map.get_label(id + b) ? 1u : 0u))
+            { count++; }
+        }
+    }
+    return count;
+}
+
+void
+check_width(uint32_t width, uint32_t seed)
+{
+    {
+        std::ofstream out(MAPFILE);
+        out << "type octile\nheight 9\nwidth " << width << "\nmap\n";
+        for(uint32_t y = 0; y < 9; y++)
+        {
+            for(uint32_t x = 0; x < width; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                out << ((seed >> 16) % 100 < 50 ? '@' : '.');
+            }
+            out << "\n";
+        }
+    }
+    warthog::gridmap map(MAPFILE);
+    remove(MAPFILE);
+
+    // every tile in the rows of the map, padding included; the rows of
+    // padding above and below are only read as neighbours
+    warthog::grid_id_t begin = map.to_padded_id(0, 0);
+    warthog::grid_id_t end = map.to_padded_id(0, map.header_height());
+    uint32_t wrong = 0;
+    for(warthog::grid_id_t id = begin; id < end; id++)
+    {
+        // three tiles centred on id, 32 tiles from id on and 32 tiles up
+        // to id; the reads straddle two words near word boundaries
+        uint8_t tiles8[3];
+        map.get_neighbours(id, tiles8);
+        uint32_t tiles[3] = { tiles8[0], tiles8[1], tiles8[2] };
+        wrong += mismatches(map, tiles, 3, id - 1);
+        map.get_neighbours_32bit(id, tiles);
+        wrong += mismatches(map, tiles, 32, id);
+        map.get_neighbours_upper_32bit(id, tiles);
+        wrong += mismatches(map, tiles, 32, id - 31);
+    }
+    CHECK(wrong == 0);
+}
+
+int
+main(int argc, char** argv)
+{
+    uint32_t widths[] = { 1, 31, 62, 63, 64, 65, 127, 128, 129, 200 };
+    uint32_t seed = 3;
+    for(uint32_t width : widths) { check_width(width, seed++); }
+    return test::report("gridmap_neighbours");
+}
@@ -0,0 +1,146 @@
+// gridmap_snapshot.cpp
+//
+// Publishes versions of a map through a warthog::gridmap_store
+// (src/domains/gridmap_snapshot.h) from one thread while four others
+// keep maps of their own in step with it and search them. Each reader
+// checks that its map is the snapshot it pinned and that JPS2, whose
+// rotated map is repaired on every pin, finds paths of the same cost as
+// A*. Build with -fsanitize=thread to check for races.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "gridmap_snapshot.h"
+#include "jps2_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace G = global;
+
+const char* MAPFILE = "maps/dao/arena.map";
+const uint32_t NUM_READERS = 4;
+const uint32_t NUM_VERSIONS = 200;
+const uint32_t EDITS_PER_VERSION = 20;
+
+// @return true if the tiles of @param map are those of @param snap
+bool
+same_tiles(warthog::gridmap& map, const warthog::gridmap_snapshot& snap)
+{
+    for(warthog::grid_id_t id = 0; id < map.padded_mapsize(); id++)
+    {
+        if(map.get_label(id) != snap.get_label(id)) { return false; }
+    }
+    return true;
+}
+
+// pins versions of @param store until @param done, searching each one;
+// @return the number of failed checks
+uint32_t
+read(warthog::gridmap_store* store, warthog::scenario_manager* scenmgr,
+        uint32_t seed, std::atomic<bool>* done)
+{
+    warthog::gridmap map(MAPFILE);
+    warthog::gridmap_reader reader(store, &map);
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+
+    warthog::gridmap_expansion_policy grid_expander(&map);
+    warthog::pqueue_min grid_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy, warthog::pqueue_min>
+            astar(&heuristic, &grid_expander, &grid_open);
+
+    warthog::jps2_expansion_policy jps_expander(&map);
+    warthog::pqueue_min jps_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2_expansion_policy, warthog::pqueue_min>
+            jps(&heuristic, &jps_expander, &jps_open);
+
+    uint32_t failures = 0;
+    uint32_t last_version = 0;
+    uint32_t i = seed;
+    bool last_round = false;
+    while(!last_round)
+    {
+        // one more round once the writer is done, on the final version
+        last_round = *done;
+        uint32_t version = reader.pin();
+        if(version < last_version) { failures++; }
+        last_version = version;
+        if(!same_tiles(map, *reader.get_snapshot())) { failures++; }
+
+        for(uint32_t q = 0; q < 4; q++)
+        {
+            i = (i * 7919 + 13) % scenmgr->num_experiments();
+            uint32_t start, target;
+            test::get_ids(scenmgr->get_experiment(i), start, target);
+            warthog::problem_instance pi(start, target);
+            warthog::solution astar_sol, jps_sol;
+            G::nodepool = grid_expander.get_nodepool();
+            astar.get_pathcost(pi, astar_sol);
+            G::nodepool = jps_expander.get_nodepool();
+            jps.get_pathcost(pi, jps_sol);
+            if(astar_sol.status_ != jps_sol.status_) { failures++; }
+            if(astar_sol.status_ == warthog::solution::FOUND &&
+               !test::same_cost(astar_sol.sum_of_edge_costs_,
+                   jps_sol.sum_of_edge_costs_))
+            { failures++; }
+        }
+    }
+    if(last_version != NUM_VERSIONS) { failures++; }
+    return failures;
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::gridmap map(MAPFILE);
+    warthog::gridmap_store store(&map);
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario("../scenarios/movingai/dao/arena.map.scen");
+
+    std::atomic<bool> done(false);
+    std::vector<std::atomic<uint32_t>> failures(NUM_READERS);
+    std::vector<std::thread> readers;
+    for(uint32_t t = 0; t < NUM_READERS; t++)
+    {
+        failures[t] = 0;
+        readers.push_back(std::thread([&store, &scenmgr, &done, &failures, t]()
+        { failures[t] = read(&store, &scenmgr, t * 101, &done); }));
+    }
+
+    // every version flips some tiles, and puts back those of the last one
+    std::vector<warthog::grid_id_t> flipped;
+    uint32_t seed = 1;
+    for(uint32_t v = 0; v < NUM_VERSIONS; v++)
+    {
+        for(warthog::grid_id_t id : flipped)
+        { store.set_label(id, map.get_label(id)); }
+        flipped.clear();
+        for(uint32_t e = 0; e < EDITS_PER_VERSION; e++)
+        {
+            seed = seed * 1103515245 + 12345;
+            warthog::grid_id_t id = map.to_padded_id(
+                    (seed >> 8) % map.header_width(),
+                    (seed >> 20) % map.header_height());
+            store.set_label(id, !map.get_label(id));
+            flipped.push_back(id);
+        }
+        CHECK(store.commit());
+    }
+    done = true;
+    for(std::thread& r : readers) { r.join(); }
+
+    for(uint32_t t = 0; t < NUM_READERS; t++) { CHECK(failures[t] == 0); }
+    CHECK(store.pin()->get_version() == NUM_VERSIONS);
+    return test::report("gridmap_snapshot");
+}
@@ -0,0 +1,118 @@
+// hpa.cpp
+//
+// Runs HPA* queries (src/hpa/hpa_search.h) in exact and near-optimal
+// mode and checks their costs against A* on the grid; that refined
+// paths cost what the abstract search said; and that every refined leg
+// stays inside one cluster.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "hpa_expansion_policy.h"
+#include "hpa_graph.h"
+#include "hpa_search.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <cstdlib>
+
+namespace G = global;
+
+// @return true if the steps of @param path (padded ids) are single
+// moves or stay inside one cluster of @param g
+bool
+legs_in_clusters(warthog::hpa::hpa_graph& g, warthog::gridmap& map,
+        std::vector<warthog::sn_id_t>& path)
+{
+    for(uint32_t i = 1; i < path.size(); i++)
+    {
+        uint32_t x, y, x2, y2;
+        map.to_padded_xy((warthog::grid_id_t)path[i-1], x, y);
+        map.to_padded_xy((warthog::grid_id_t)path[i], x2, y2);
+        if(abs((int32_t)x - (int32_t)x2) <= 1 &&
+           abs((int32_t)y - (int32_t)y2) <= 1) { continue; }
+        if(g.get_cluster((warthog::grid_id_t)path[i-1]) !=
+           g.get_cluster((warthog::grid_id_t)path[i])) { return false; }
+    }
+    return true;
+}
+
+void
+check_map(const char* mapfile, const char* scenfile, uint32_t cluster_size,
+        bool exact)
+{
+    warthog::gridmap map(mapfile);
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(scenfile);
+
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::gridmap_expansion_policy grid_expander(&map);
+    warthog::pqueue_min grid_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy, warthog::pqueue_min>
+            reference(&heuristic, &grid_expander, &grid_open);
+
+    warthog::hpa::hpa_graph g(&map, cluster_size, exact);
+    g.precompute();
+    warthog::hpa::hpa_expansion_policy expander(&g);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::hpa::hpa_expansion_policy, warthog::pqueue_min>
+            abstract(&heuristic, &expander, &open);
+    warthog::hpa::hpa_search hpa(&abstract, &g);
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 7)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+
+        warthog::solution ref_sol;
+        G::nodepool = grid_expander.get_nodepool();
+        reference.get_pathcost(pi, ref_sol);
+
+        warthog::solution sol, cost_sol;
+        G::nodepool = expander.get_nodepool();
+        hpa.get_path(pi, sol);
+        hpa.get_pathcost(pi, cost_sol);
+        CHECK(sol.status_ == warthog::solution::FOUND);
+        CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                    cost_sol.sum_of_edge_costs_));
+        if(exact)
+        {
+            CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                        ref_sol.sum_of_edge_costs_));
+        }
+        else
+        {
+            CHECK(sol.sum_of_edge_costs_ >=
+                    ref_sol.sum_of_edge_costs_ - 1e-4);
+        }
+
+        CHECK(sol.path_.size() > 0);
+        if(sol.path_.size() == 0) { continue; }
+        CHECK(sol.path_.front() == map.to_padded_id(start));
+        CHECK(sol.path_.back() == map.to_padded_id(target));
+        CHECK(legs_in_clusters(g, map, sol.path_));
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    check_map("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen", 8, true);
+    check_map("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen", 16, false);
+    check_map("maps/street/Berlin_0_256.map",
+            "../scenarios/movingai/street/Berlin_0_256.map.scen", 16, true);
+    check_map("maps/street/Berlin_0_256.map",
+            "../scenarios/movingai/street/Berlin_0_256.map.scen", 32, false);
+    return test::report("hpa");
+}
@@ -0,0 +1,444 @@
+// jps2plus.cpp
+//
+// Checks the jump tables of warthog::jps2plus_expansion_policy
+// (src/jps/offline_jump_point_locator2.h): that saving a table for a
+// changed map replaces the file instead of writing over it, so a search
+// that has the old table mapped keeps its paths; that JPS+ with 16 bit
+// and with compact tables finds paths of the same cost as A*, and both
+// jump to the same places from every tile, long jumps included; that
+// tables repaired after batches of edits (see warthog::gridmap_edit)
+// jump as tables computed afresh for the edited map do; that a
+// file whose header does not fit the map is not used but computed again
+// and replaced; and that the tables hold the jumps of
+// warthog::online_jump_point_locator, tile by tile, as they did when
+// they were built one jump at a time. It also checks JPS+ against A* on
+// a small map where paths turn north or south at their last jump point.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_edit.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2plus_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "offline_jump_point_locator2.h"
+#include "online_jump_point_locator.h"
+#include "pqueue.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace G = global;
+
+const char* MAPFILE = "/tmp/warthog-test-jps2plus.map";
+const char* TABLEFILE = "/tmp/warthog-test-jps2plus.map.jps+";
+
+// copy @param from to MAPFILE, blocking its first @param num_blocked
+// traversable tiles
+void
+write_map(const char* from, uint32_t num_blocked)
+{
+    std::ifstream in(from);
+    std::stringstream text;
+    text << in.rdbuf();
+    std::string map = text.str();
+    for(size_t i = map.find("map\n") + 4; num_blocked && i < map.size(); i++)
+    {
+        if(map[i] == '.')
+        {
+            map[i] = '@';
+            num_blocked--;
+        }
+    }
+    std::ofstream(MAPFILE) << map;
+}
+
+// write to MAPFILE a map @param width by @param height with one tile in
+// 97 blocked, so jumps can be longer than a compact entry holds
+void
+write_open_map(uint32_t width, uint32_t height)
+{
+    std::ofstream out(MAPFILE);
+    out << "type octile\nheight " << height << "\nwidth " << width << "\nmap\n";
+    for(uint32_t y = 0; y < height; y++)
+    {
+        for(uint32_t x = 0; x < width; x++)
+        { out << (((x * 7919 + y * 104729) % 97) ? '.' : '@'); }
+        out << "\n";
+    }
+}
+
+// @return the number of traversable tiles and directions of @param map
+// from which @param a and @param b jump to different places or at
+// different costs, with no goal and with @param goal_id as the goal
+uint32_t
+different_jumps(warthog::gridmap& map, warthog::offline_jump_point_locator2& a,
+        warthog::offline_jump_point_locator2& b, uint32_t goal_id)
+{
+    uint32_t num = 0;
+    std::vector<uint32_t> a_ids, b_ids;
+    std::vector<double> a_costs, b_costs;
+    for(uint32_t id = 0; id < map.padded_mapsize(); id++)
+    {
+        if(!map.get_label(id)) { continue; }
+        for(uint32_t i = 0; i < 8; i++)
+        {
+            warthog::jps::direction dir = (warthog::jps::direction)(1 << i);
+            for(uint32_t goal : { (uint32_t)warthog::GRID_ID_MAX, goal_id })
+            {
+                a_ids.clear(); a_costs.clear();
+                b_ids.clear(); b_costs.clear();
+                a.jump(dir, id, goal, a_ids, a_costs);
+                b.jump(dir, id, goal, b_ids, b_costs);
+                if(a_ids != b_ids || a_costs != b_costs) { num++; }
+            }
+        }
+    }
+    return num;
+}
+
+// compact tables give the jumps of 16 bit tables for the map in MAPFILE
+void
+check_compact()
+{
+    warthog::gridmap map(MAPFILE);
+    warthog::offline_jump_point_locator2 wide(&map);
+    warthog::offline_jump_point_locator2 compact(&map, true);
+    CHECK(compact.mem() < wide.mem());
+    uint32_t goal_id = map.to_padded_id(
+            map.header_width() / 2, map.header_height() / 2);
+    CHECK(different_jumps(map, wide, compact, goal_id) == 0);
+}
+
+// apply @param num_batches random batches of edits to the map in MAPFILE,
+// scattered over the whole map and inside small squares in turn. after
+// each, a 16 bit and a compact table that were repaired must jump as a
+// table computed for the edited map does
+void
+check_repairs(uint32_t num_batches)
+{
+    warthog::gridmap map(MAPFILE);
+    warthog::offline_jump_point_locator2 wide(&map);
+    warthog::offline_jump_point_locator2 compact(&map, true);
+    warthog::gridmap_edit edit(&map);
+    uint32_t w = map.header_width(), h = map.header_height();
+    uint32_t seed = 13;
+    for(uint32_t batch = 0; batch < num_batches; batch++)
+    {
+        seed = seed * 1103515245 + 12345;
+        uint32_t x0 = (seed >> 8) % w, y0 = (seed >> 8) / w % h;
+        for(uint32_t i = 0; i < 40; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t x = (seed >> 8) % w, y = (seed >> 8) / w % h;
+            if(batch & 1)
+            {
+                x = std::min(w - 1, x0 + x % 6);
+                y = std::min(h - 1, y0 + y % 6);
+            }
+            edit.set_label(map.to_padded_id(x, y), (seed >> 4) & 1);
+        }
+        if(!edit.commit()) { continue; }
+
+        remove(TABLEFILE);
+        warthog::offline_jump_point_locator2 fresh(&map);
+        uint32_t goal_id = map.to_padded_id(x0, y0);
+        CHECK(different_jumps(map, fresh, wide, goal_id) == 0);
+        CHECK(different_jumps(map, fresh, compact, goal_id) == 0);
+    }
+}
+
+// @return the bytes of @param filename
+std::string
+contents(const char* filename)
+{
+    std::ifstream in(filename, std::ios_base::binary);
+    std::stringstream text;
+    text << in.rdbuf();
+    return text.str();
+}
+
+// @return the table saved for @param from with @param num_blocked tiles
+// blocked; MAPFILE is left holding that map
+std::string
+saved_table(const char* from, uint32_t num_blocked)
+{
+    write_map(from, num_blocked);
+    remove(TABLEFILE);
+    warthog::gridmap map(MAPFILE);
+    warthog::jps2plus_expansion_policy expander(&map);
+    return contents(TABLEFILE);
+}
+
+// with @param table in TABLEFILE, a search on MAPFILE saves @param good
+// in its place
+void
+check_replaced(const std::string& table, const std::string& good)
+{
+    std::ofstream(TABLEFILE, std::ios_base::binary) << table;
+    warthog::gridmap map(MAPFILE);
+    warthog::jps2plus_expansion_policy expander(&map);
+    CHECK(contents(TABLEFILE) == good);
+}
+
+// the first part of the header of a table file; see
+// offline_jump_point_locator2.cpp
+struct table_header
+{
+    char magic_[4];
+    uint32_t version_;
+    uint32_t byte_order_;
+    uint32_t entry_bytes_;
+    uint32_t padded_width_;
+    uint32_t padded_height_;
+    uint64_t map_hash_;
+    uint64_t table_offset_;
+    uint64_t num_entries_;
+};
+
+// the table saved for @param mapfile is the one that one online jump per
+// tile and direction gives: the steps to the jump point, or to the last
+// tile before a dead-end with the leading bit set
+void
+check_table(const char* mapfile)
+{
+    write_map(mapfile, 0);
+    remove(TABLEFILE);
+    warthog::gridmap map(MAPFILE);
+    warthog::jps2plus_expansion_policy expander(&map);
+
+    std::ifstream in(TABLEFILE, std::ios_base::binary);
+    table_header header;
+    in.read((char*)&header, sizeof(header));
+    CHECK(in.good() && header.num_entries_ == 8 * map.padded_mapsize());
+    if(!in.good() || header.num_entries_ != 8 * map.padded_mapsize())
+    { return; }
+    std::vector<uint16_t> table(header.num_entries_);
+    in.seekg(header.table_offset_);
+    in.read((char*)table.data(), 2 * table.size());
+    CHECK(in.good());
+
+    std::vector<uint16_t> expected(table.size(), 0);
+    warthog::online_jump_point_locator jpl(&map);
+    for(uint32_t y = 0; y < map.header_height(); y++)
+    {
+        for(uint32_t x = 0; x < map.header_width(); x++)
+        {
+            warthog::grid_id_t id = map.to_padded_id(x, y);
+            for(uint32_t i = 0; i < 8; i++)
+            {
+                warthog::jps::direction dir = (warthog::jps::direction)(1 << i);
+                warthog::grid_id_t jumpnode_id;
+                double jumpcost;
+                jpl.jump(dir, id, warthog::GRID_ID_MAX, jumpnode_id, jumpcost);
+                if(dir > 8) { jumpcost /= warthog::DBL_ROOT_TWO; }
+                uint16_t entry = (uint16_t)floor(jumpcost + 0.5);
+                if(jumpnode_id == warthog::GRID_ID_MAX) { entry |= 32768; }
+                expected[(size_t)id * 8 + i] = entry;
+            }
+        }
+    }
+    CHECK(table == expected);
+}
+
+// @return the inode of TABLEFILE, or 0 if there is none
+ino_t
+table_inode()
+{
+    struct stat st;
+    if(stat(TABLEFILE, &st) != 0) { return 0; }
+    return st.st_ino;
+}
+
+// @return the number of files left next to the table by ::save
+uint32_t
+num_temporary_files()
+{
+    uint32_t num = 0;
+    DIR* dir = opendir("/tmp");
+    if(!dir) { return 0; }
+    std::string prefix = std::string(TABLEFILE).substr(5) + ".tmp";
+    while(struct dirent* e = readdir(dir))
+    {
+        if(std::string(e->d_name).compare(0, prefix.size(), prefix) == 0)
+        { num++; }
+    }
+    closedir(dir);
+    return num;
+}
+
+// JPS+ on @param map finds paths of the same cost as A*
+void
+check_costs(warthog::gridmap& map, warthog::jps2plus_expansion_policy& expander,
+        warthog::scenario_manager& scenmgr)
+{
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::gridmap_expansion_policy grid_expander(&map);
+    warthog::pqueue_min grid_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy, warthog::pqueue_min>
+            astar(&heuristic, &grid_expander, &grid_open);
+
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2plus_expansion_policy, warthog::pqueue_min>
+            jps(&heuristic, &expander, &open);
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 5)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution astar_sol, jps_sol;
+        G::nodepool = grid_expander.get_nodepool();
+        astar.get_pathcost(pi, astar_sol);
+        G::nodepool = expander.get_nodepool();
+        jps.get_pathcost(pi, jps_sol);
+        CHECK(jps_sol.status_ == astar_sol.status_);
+        CHECK(test::same_cost(jps_sol.sum_of_edge_costs_,
+                    astar_sol.sum_of_edge_costs_));
+    }
+}
+
+// JPS+ finds the paths of A* between every pair of tiles of a small map
+// on which some paths turn north or south at their last jump point: the
+// parent direction of a node reached that way is north or south, not
+// east or west (see jps2plus_expansion_policy::compute_direction)
+void
+check_vertical_turns()
+{
+    const uint32_t width = 6, height = 6;
+    {
+        // from (3, 0), (3, 4) is reached by way of (3, 5)
+        std::ofstream out(MAPFILE);
+        out << "type octile\nheight " << height << "\nwidth " << width
+            << "\nmap\n"
+            << ".@@.@.\n....@@\n...@@@\n...@@.\n..@.@.\n@....@\n";
+    }
+    remove(TABLEFILE);
+    warthog::gridmap map(MAPFILE);
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::gridmap_expansion_policy grid_expander(&map);
+    warthog::pqueue_min grid_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy, warthog::pqueue_min>
+            astar(&heuristic, &grid_expander, &grid_open);
+    warthog::jps2plus_expansion_policy expander(&map);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2plus_expansion_policy, warthog::pqueue_min>
+            jps(&heuristic, &expander, &open);
+
+    uint32_t num_paths = 0, num_wrong = 0;
+    for(uint32_t start = 0; start < width * height; start++)
+    {
+        for(uint32_t target = 0; target < width * height; target++)
+        {
+            warthog::problem_instance pi(start, target);
+            warthog::solution astar_sol, jps_sol;
+            G::nodepool = grid_expander.get_nodepool();
+            astar.get_pathcost(pi, astar_sol);
+            warthog::problem_instance jps_pi(start, target);
+            G::nodepool = expander.get_nodepool();
+            jps.get_pathcost(jps_pi, jps_sol);
+            if(astar_sol.status_ == warthog::solution::FOUND)
+            { num_paths++; }
+            if(jps_sol.status_ != astar_sol.status_ ||
+               !test::same_cost(jps_sol.sum_of_edge_costs_,
+                   astar_sol.sum_of_edge_costs_)) { num_wrong++; }
+        }
+    }
+    CHECK(num_paths > 0);
+    CHECK(num_wrong == 0);
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario("../scenarios/movingai/dao/arena.map.scen");
+    remove(TABLEFILE);
+
+    // the table is computed, saved and mapped
+    write_map("maps/dao/arena.map", 0);
+    warthog::gridmap map(MAPFILE);
+    warthog::jps2plus_expansion_policy expander(&map);
+    ino_t inode = table_inode();
+    CHECK(inode != 0);
+    CHECK(num_temporary_files() == 0);
+
+    // the map changes: the next search saves a new table in a new file
+    write_map("maps/dao/arena.map", 20);
+    {
+        warthog::gridmap changed(MAPFILE);
+        warthog::jps2plus_expansion_policy changed_expander(&changed);
+        CHECK(table_inode() != 0 && table_inode() != inode);
+        CHECK(num_temporary_files() == 0);
+        check_costs(changed, changed_expander, scenmgr);
+    }
+
+    // the first search still reads the table of the first map
+    check_costs(map, expander, scenmgr);
+
+    // compact tables
+    warthog::jps2plus_expansion_policy compact_expander(&map, true);
+    check_costs(map, compact_expander, scenmgr);
+
+    // tables of other maps, of other machines, or that are not tables
+    std::string edited = saved_table("maps/dao/arena.map", 20);
+    std::string berlin = saved_table("maps/street/Berlin_0_256.map", 0);
+    std::string good = saved_table("maps/dao/arena.map", 0);
+    CHECK(good.size() > sizeof(table_header));
+    if(good.size() > sizeof(table_header))
+    {
+        std::string swapped = good;
+        std::reverse(swapped.begin() + offsetof(table_header, byte_order_),
+                swapped.begin() + offsetof(table_header, byte_order_) + 4);
+        check_replaced(swapped, good);
+        check_replaced(edited, good);
+        check_replaced(berlin, good);
+        check_replaced(good.substr(sizeof(table_header)), good);
+        check_replaced(good.substr(0, good.size() - 2), good);
+        check_replaced("localhost\n", good);
+        check_replaced("", good);
+        check_replaced(good, good);
+    }
+
+    // compact tables, jump by jump
+    write_map("maps/dao/arena.map", 0);
+    check_compact();
+    write_map("maps/street/Berlin_0_256.map", 0);
+    check_compact();
+    write_open_map(700, 300);
+    check_compact();
+
+    // repaired tables
+    write_map("maps/dao/arena.map", 0);
+    check_repairs(30);
+    write_map("maps/street/Berlin_0_256.map", 0);
+    check_repairs(6);
+
+    check_vertical_turns();
+
+    check_table("maps/dao/arena.map");
+    check_table("maps/street/Berlin_0_256.map");
+    check_table("maps/random40/random512-40-0.map");
+
+    remove(MAPFILE);
+    remove(TABLEFILE);
+    return test::report("jps2plus");
+}
@@ -0,0 +1,188 @@
+// jps_bb_labelling.cpp
+//
+// Checks that JPS2 and prune2 with bounding-box pruning (see
+// src/label/jps_bb_labelling.h) find optimal paths, also after the map
+// was modified and the boxes went stale; and that the temporary
+// obstacles of prune2 do not make the boxes stale.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy.h"
+#include "jps2_expansion_policy_prune2.h"
+#include "jps_bb_labelling.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <cstdio>
+#include <fstream>
+
+namespace G = global;
+
+// a 32x32 room split by a wall with a gap at the bottom
+const char* MAPFILE = "/tmp/warthog-test-wall.map";
+const uint32_t SIZE = 32;
+
+void
+write_map()
+{
+    std::ofstream out(MAPFILE);
+    out << "type octile\nheight " << SIZE << "\nwidth " << SIZE << "\nmap\n";
+    for(uint32_t y = 0; y < SIZE; y++)
+    {
+        for(uint32_t x = 0; x < SIZE; x++)
+        { out << (x == SIZE / 2 && y + 1 < SIZE ? '@' : '.'); }
+        out << "\n";
+    }
+}
+
+template<typename EXPANDER>
+void
+compare(warthog::gridmap& map, EXPANDER& expander)
+{
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::pqueue_min open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic, EXPANDER, warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+
+    warthog::gridmap_expansion_policy ref_expander(&map);
+    warthog::pqueue_min ref_open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min>
+            reference(&heuristic, &ref_expander, &ref_open);
+
+    // between cells on either side of the wall
+    for(uint32_t y = 0; y < SIZE; y += 3)
+    {
+        for(uint32_t y2 = 0; y2 < SIZE; y2 += 5)
+        {
+            warthog::problem_instance pi(y * SIZE + 2, y2 * SIZE + SIZE - 3);
+            warthog::solution sol, ref_sol;
+            G::nodepool = ref_expander.get_nodepool();
+            reference.get_pathcost(pi, ref_sol);
+            G::nodepool = expander.get_nodepool();
+            astar.get_pathcost(pi, sol);
+            CHECK(sol.status_ == warthog::solution::FOUND);
+            CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                        ref_sol.sum_of_edge_costs_));
+        }
+    }
+}
+
+template<typename EXPANDER>
+void
+check()
+{
+    warthog::gridmap map(MAPFILE);
+    G::query::map = &map;
+
+    warthog::label::jps_bb_labelling bbl(&map);
+    bbl.precompute();
+    EXPANDER expander(&map);
+    expander.set_bb_labelling(&bbl);
+    compare(map, expander);
+
+    // open the top of the wall; the boxes still send every path
+    // through the bottom
+    expander.perturbation(map.to_padded_id(SIZE / 2, 0), true);
+    expander.perturbation(map.to_padded_id(SIZE / 2, 1), true);
+    CHECK(!bbl.is_current());
+    compare(map, expander);
+}
+
+// prune2 places and removes its temporary obstacles without moving the
+// version of the map on, so the boxes stay in use from one query to the
+// next: on a random map, queries run a second time expand as many nodes
+// as the first time, and fewer than without boxes
+void
+check_prune2_keeps_boxes()
+{
+    const char* randomfile = "/tmp/warthog-test-bb-random.map";
+    const uint32_t RSIZE = 48;
+    {
+        std::ofstream out(randomfile);
+        out << "type octile\nheight " << RSIZE << "\nwidth " << RSIZE
+            << "\nmap\n";
+        uint32_t seed = 5;
+        for(uint32_t y = 0; y < RSIZE; y++)
+        {
+            for(uint32_t x = 0; x < RSIZE; x++)
+            {
+                seed = seed * 1103515245 + 12345;
+                out << ((seed >> 16) % 100 < 25 ? '@' : '.');
+            }
+            out << "\n";
+        }
+    }
+    warthog::gridmap map(randomfile);
+    remove(randomfile);
+    G::query::map = &map;
+    warthog::label::jps_bb_labelling bbl(&map);
+    bbl.precompute();
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+
+    warthog::jps2_expansion_policy_prune2 expander(&map);
+    expander.set_bb_labelling(&bbl);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2_expansion_policy_prune2, warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+
+    warthog::jps2_expansion_policy_prune2 plain_expander(&map);
+    warthog::pqueue_min plain_open;
+    warthog::flexible_astar<warthog::octile_heuristic,
+        warthog::jps2_expansion_policy_prune2, warthog::pqueue_min>
+            plain(&heuristic, &plain_expander, &plain_open);
+
+    uint64_t first = 0, again = 0, without = 0;
+    for(uint32_t pass = 0; pass < 2; pass++)
+    {
+        uint32_t seed = 9;
+        for(uint32_t i = 0; i < 200; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            uint32_t start = (seed >> 8) % (RSIZE * RSIZE);
+            seed = seed * 1103515245 + 12345;
+            uint32_t target = (seed >> 8) % (RSIZE * RSIZE);
+            if(!map.get_label(map.to_padded_id(start)) ||
+               !map.get_label(map.to_padded_id(target))) { continue; }
+
+            warthog::problem_instance pi(start, target);
+            warthog::solution sol, plain_sol;
+            G::nodepool = expander.get_nodepool();
+            astar.get_pathcost(pi, sol);
+            CHECK(bbl.is_current());
+            (pass ? again : first) += sol.nodes_expanded_;
+            if(pass) { continue; }
+
+            G::nodepool = plain_expander.get_nodepool();
+            plain.get_pathcost(pi, plain_sol);
+            CHECK(sol.status_ == plain_sol.status_);
+            CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                        plain_sol.sum_of_edge_costs_));
+            without += plain_sol.nodes_expanded_;
+        }
+    }
+    CHECK(again == first);
+    CHECK(first < without);
+}
+
+int
+main(int argc, char** argv)
+{
+    write_map();
+    check<warthog::jps2_expansion_policy>();
+    check<warthog::jps2_expansion_policy_prune2>();
+    check_prune2_keeps_boxes();
+    remove(MAPFILE);
+    return test::report("jps_bb_labelling");
+}
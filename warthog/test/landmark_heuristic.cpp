@@ -0,0 +1,143 @@
+// landmark_heuristic.cpp
+//
+// Checks that the landmark heuristic (src/heuristics/landmark_heuristic.h)
+// is admissible and finds optimal paths, also with prune2, whose
+// temporary obstacles must not make the tables stale; and that it falls
+// back to the octile distance once the map has been modified.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy_prune2.h"
+#include "landmark_heuristic.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <cstdio>
+
+namespace G = global;
+
+void
+check_map(const char* mapfile, const char* scenfile, uint32_t entry_bytes)
+{
+    warthog::gridmap map(mapfile);
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(scenfile);
+
+    const char* lmfile = "/tmp/warthog-test.lm";
+    remove(lmfile);
+    warthog::landmark_heuristic lm(&map, lmfile, 8, entry_bytes);
+    remove(lmfile);
+    CHECK(lm.is_current());
+    double slack = 2 * lm.get_quantum() + 1e-4;
+
+    warthog::gridmap_expansion_policy expander(&map);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<
+        warthog::landmark_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min>
+            astar(&lm, &expander, &open);
+    G::nodepool = expander.get_nodepool();
+
+    warthog::octile_heuristic octile(map.width(), map.height());
+    warthog::pqueue_min ref_open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min>
+            reference(&octile, &expander, &ref_open);
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 7)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution ref_sol;
+        reference.get_pathcost(pi, ref_sol);
+        if(ref_sol.status_ != warthog::solution::FOUND) { continue; }
+
+        CHECK(lm.h(map.to_padded_id(start), map.to_padded_id(target)) <=
+                ref_sol.sum_of_edge_costs_ + slack);
+
+        warthog::solution sol;
+        astar.get_pathcost(pi, sol);
+        CHECK(sol.status_ == warthog::solution::FOUND);
+        CHECK(sol.sum_of_edge_costs_ <= ref_sol.sum_of_edge_costs_ + slack);
+    }
+
+    // prune2 with the landmarks: the tables stay in use from one query
+    // to the next, so some estimate stays above the octile distance
+    G::query::map = &map;
+    warthog::jps2_expansion_policy_prune2 prune2_expander(&map);
+    warthog::pqueue_min prune2_open;
+    warthog::flexible_astar<
+        warthog::landmark_heuristic,
+        warthog::jps2_expansion_policy_prune2,
+        warthog::pqueue_min>
+            prune2(&lm, &prune2_expander, &prune2_open);
+    uint32_t num_above_octile = 0;
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 7)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution sol, ref_sol;
+        G::nodepool = expander.get_nodepool();
+        reference.get_pathcost(pi, ref_sol);
+        G::nodepool = prune2_expander.get_nodepool();
+        prune2.get_pathcost(pi, sol);
+        CHECK(lm.is_current());
+        CHECK(sol.status_ == ref_sol.status_);
+        CHECK(sol.sum_of_edge_costs_ <= ref_sol.sum_of_edge_costs_ + slack);
+
+        warthog::sn_id_t s = map.to_padded_id(start);
+        warthog::sn_id_t t = map.to_padded_id(target);
+        if(lm.h(s, t) > octile.h(s, t)) { num_above_octile++; }
+    }
+    CHECK(num_above_octile > 0);
+    G::nodepool = expander.get_nodepool();
+
+    // open the first obstacle next to a traversable tile; the tables no
+    // longer describe the map
+    for(uint32_t y = 1; y + 1 < map.header_height(); y++)
+    {
+        uint32_t x = 1;
+        for( ; x + 1 < map.header_width(); x++)
+        {
+            if(!map.get_label(map.to_padded_id(x, y)) &&
+                map.get_label(map.to_padded_id(x+1, y))) { break; }
+        }
+        if(x + 1 < map.header_width())
+        {
+            map.set_label(map.to_padded_id(x, y), true);
+            break;
+        }
+    }
+    CHECK(!lm.is_current());
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 7)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::sn_id_t s = map.to_padded_id(start);
+        warthog::sn_id_t t = map.to_padded_id(target);
+        CHECK(lm.h(s, t) == octile.h(s, t));
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    check_map("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen", 4);
+    check_map("maps/dao/den520d.map",
+            "../scenarios/movingai/dao/den520d.map.scen", 2);
+    return test::report("landmark_heuristic");
+}
@@ -0,0 +1,160 @@
+// map_backends.cpp
+//
+// Checks that the maps which stand in for a warthog::gridmap (see
+// src/domains/blockmap.h and src/domains/rle_gridmap.h) have the same
+// cells, neighbourhoods and ids as the gridmap, and that JPS2 (and
+// prune2 on a blockmap) finds paths of the same cost on each. The ids
+// of a blockmap are also checked on maps up to 2^20 tiles wide, over
+// the whole range of 32-bit ids.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "blockmap.h"
+#include "flexible_astar.h"
+#include "global.h"
+#include "jps2_expansion_policy.h"
+#include "jps2_expansion_policy_prune2.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "rle_gridmap.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace G = global;
+
+template<typename M>
+void
+check_cells(warthog::gridmap& map, M& other)
+{
+    CHECK(other.width() == map.width());
+    CHECK(other.height() == map.height());
+    for(warthog::grid_id_t id = 0; id < map.padded_mapsize(); id++)
+    {
+        uint32_t x, y, x2, y2;
+        map.to_padded_xy(id, x, y);
+        other.to_padded_xy(id, x2, y2);
+        CHECK(x == x2 && y == y2);
+        CHECK(map.get_label(id) == other.get_label(id));
+
+        // neighbourhoods are read for traversable cells only; for those
+        // the padding keeps every read in bounds
+        if(!map.get_label(id)) { continue; }
+        uint32_t tiles = 0, tiles2 = 0;
+        map.get_neighbours(id, (uint8_t*)&tiles);
+        other.get_neighbours(id, (uint8_t*)&tiles2);
+        CHECK((tiles & 0xFFFFFF) == (tiles2 & 0xFFFFFF));
+    }
+}
+
+// @param GRID_EXPANDER and @param EXPANDER are the same policy, on a
+// gridmap and on @param other
+template<typename GRID_EXPANDER, typename EXPANDER, typename M>
+void
+check_costs(warthog::gridmap& map, M& other,
+        warthog::scenario_manager& scenmgr)
+{
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    G::query::map = &map;
+
+    GRID_EXPANDER grid_expander(&map);
+    warthog::pqueue_min grid_open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic, GRID_EXPANDER, warthog::pqueue_min>
+            grid_astar(&heuristic, &grid_expander, &grid_open);
+
+    EXPANDER expander(&other);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic, EXPANDER, warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 5)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution sol, grid_sol;
+        G::nodepool = grid_expander.get_nodepool();
+        grid_astar.get_path(pi, grid_sol);
+        G::nodepool = expander.get_nodepool();
+        astar.get_path(pi, sol);
+        CHECK(sol.status_ == grid_sol.status_);
+        CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                    grid_sol.sum_of_edge_costs_));
+    }
+}
+
+void
+check_map(const char* mapfile, const char* scenfile)
+{
+    warthog::gridmap map(mapfile);
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(scenfile);
+
+    warthog::blockmap bmap(&map);
+    check_cells(map, bmap);
+    check_costs<warthog::jps2_expansion_policy,
+        warthog::blocked_jps2_expansion_policy>(map, bmap, scenmgr);
+    check_costs<warthog::jps2_expansion_policy_prune2,
+        warthog::blocked_jps2_expansion_policy_prune2>(map, bmap, scenmgr);
+
+    warthog::rle_gridmap rmap(&map);
+    check_cells(map, rmap);
+    check_costs<warthog::jps2_expansion_policy,
+        warthog::rle_jps2_expansion_policy>(map, rmap, scenmgr);
+}
+
+// blockmaps find the row of an id with a multiply instead of a divide
+// (see warthog::blockmap::row_of); @param width is the header width
+void
+check_rows(uint32_t width)
+{
+    const char* mapfile = "/tmp/warthog-test-backends.map";
+    {
+        std::ofstream out(mapfile);
+        out << "type octile\nheight 2\nwidth " << width << "\nmap\n"
+            << std::string(width, '.') << "\n" << std::string(width, '.')
+            << "\n";
+    }
+    warthog::gridmap map(mapfile);
+    remove(mapfile);
+    warthog::blockmap bmap(&map);
+
+    uint32_t w = bmap.width();
+    uint32_t mismatches = 0;
+    auto check_id = [&bmap, &mismatches, w](uint64_t id)
+    {
+        uint32_t x, y;
+        bmap.to_padded_xy((warthog::grid_id_t)id, x, y);
+        if(y != id / w || x != id % w) { mismatches++; }
+    };
+    for(uint64_t id = 0; id < (1 << 20); id++) { check_id(id); }
+    for(uint64_t id = 0; id <= UINT32_MAX; id += 7919) { check_id(id); }
+    for(uint64_t row = 1; row * w <= UINT32_MAX; row++)
+    {
+        check_id(row * w - 1);
+        check_id(row * w);
+    }
+    check_id(UINT32_MAX);
+    CHECK(mismatches == 0);
+}
+
+int
+main(int argc, char** argv)
+{
+    uint32_t widths[] = { 60, 100, 1000, 4000, 30000, 65000, 200000,
+        1000000, (1 << 20) - 2 };
+    for(uint32_t width : widths) { check_rows(width); }
+
+    check_map("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen");
+    check_map("maps/street/Berlin_0_256.map",
+            "../scenarios/movingai/street/Berlin_0_256.map.scen");
+    return test::report("map_backends");
+}
@@ -0,0 +1,140 @@
+// map_registry.cpp
+//
+// Acquires and releases entries of a warthog::map_registry
+// (src/util/map_registry.h) from several threads while another reads
+// the statistics, then checks that the counters add up and that the
+// budget is met, also by entries that grew while they were in use.
+// Build with -fsanitize=thread to check for races.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "map_registry.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+const size_t ENTRY_BYTES = 1000;
+const uint32_t NUM_NAMES = 8;
+const uint32_t NUM_THREADS = 4;
+const uint32_t NUM_ACQUIRES = 20000;
+
+class dummy_search : public warthog::resident_search
+{
+    public:
+        virtual warthog::gridmap*
+        get_map() { return 0; }
+
+        virtual warthog::search*
+        get_search() { return 0; }
+
+        virtual size_t
+        mem() { return ENTRY_BYTES; }
+};
+
+// an entry whose indexes are built by its searches
+class growing_search : public dummy_search
+{
+    public:
+        growing_search() : bytes_(ENTRY_BYTES) { }
+
+        virtual size_t
+        mem() { return bytes_; }
+
+        size_t bytes_;
+};
+
+int
+main(int argc, char** argv)
+{
+    std::atomic<uint32_t> loads(0);
+    warthog::map_registry registry(
+        [&loads](const std::string& name) -> warthog::resident_search*
+        {
+            if(name == "missing") { return 0; }
+            loads++;
+            return new dummy_search();
+        }, 3 * ENTRY_BYTES);
+
+    // failed checks in other threads; CHECK is not thread-safe
+    std::atomic<uint32_t> failures(0);
+    std::atomic<bool> done(false);
+    std::thread reader([&registry, &done, &failures]()
+    {
+        while(!done)
+        {
+            uint64_t hits = registry.get_hits();
+            uint64_t misses = registry.get_misses();
+            if(hits + misses > NUM_THREADS * NUM_ACQUIRES) { failures++; }
+            if(registry.get_resident_bytes() % ENTRY_BYTES) { failures++; }
+            registry.get_num_resident();
+            registry.get_evictions();
+            registry.mem();
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for(uint32_t t = 0; t < NUM_THREADS; t++)
+    {
+        workers.push_back(std::thread([&registry, &failures, t]()
+        {
+            for(uint32_t i = 0; i < NUM_ACQUIRES; i++)
+            {
+                std::string name =
+                    "map" + std::to_string((i * 7 + t) % NUM_NAMES);
+                warthog::resident_search* rs = registry.acquire(name);
+                if(!rs || rs->mem() != ENTRY_BYTES) { failures++; }
+                if(rs) { registry.release(rs); }
+            }
+        }));
+    }
+    for(std::thread& w : workers) { w.join(); }
+    done = true;
+    reader.join();
+
+    CHECK(failures == 0);
+    CHECK(registry.get_hits() + registry.get_misses() ==
+            NUM_THREADS * NUM_ACQUIRES);
+    CHECK(registry.get_misses() == loads);
+    CHECK(registry.get_evictions() == loads - registry.get_num_resident());
+    CHECK(registry.get_resident_bytes() ==
+            registry.get_num_resident() * ENTRY_BYTES);
+    CHECK(registry.get_resident_bytes() <= registry.get_budget());
+
+    // failed loads count as misses and leave nothing behind
+    uint32_t resident = registry.get_num_resident();
+    CHECK(registry.acquire("missing") == 0);
+    CHECK(registry.get_num_resident() == resident);
+
+    // entries in use are kept over budget
+    std::vector<warthog::resident_search*> held;
+    for(uint32_t i = 0; i < NUM_NAMES; i++)
+    { held.push_back(registry.acquire("map" + std::to_string(i))); }
+    CHECK(registry.get_num_resident() == NUM_NAMES);
+    for(warthog::resident_search* rs : held) { registry.release(rs); }
+    registry.set_budget(registry.get_budget());
+    CHECK(registry.get_resident_bytes() <= registry.get_budget());
+
+    // an entry that grew in use is measured again when released, and
+    // the least recently used entry makes room for it
+    warthog::map_registry growing(
+        [](const std::string& name) -> warthog::resident_search*
+        { return new growing_search(); }, 3 * ENTRY_BYTES);
+    growing.release(growing.acquire("a"));
+    growing.release(growing.acquire("b"));
+    growing_search* rs = (growing_search*)growing.acquire("c");
+    rs->bytes_ = 2 * ENTRY_BYTES;
+    CHECK(growing.get_resident_bytes() == 3 * ENTRY_BYTES);
+    growing.release(rs);
+    CHECK(growing.get_evictions() == 1);
+    CHECK(growing.get_num_resident() == 2);
+    CHECK(growing.get_resident_bytes() == 3 * ENTRY_BYTES);
+    growing.release(growing.acquire("b"));
+    CHECK(growing.get_hits() == 1);
+    return test::report("map_registry");
+}
@@ -0,0 +1,175 @@
+// octile_heuristic.cpp
+//
+// Checks that warthog::octile_heuristic (src/heuristics/octile_heuristic.h),
+// which turns ids into (x, y) without dividing, gives bit for bit the
+// values of the same formula on coordinates found by division, over the
+// whole range of 32-bit ids; and that the batch overload agrees with
+// one call per id. with -DGRID_ID64 it also tries ids on either side of
+// 2^32. Also checks the coordinates warthog::jps2_expansion_policy hands
+// to the (x, y) batch overload against the ids of its successors.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+
+#include <vector>
+
+namespace G = global;
+
+// compares each batch of coordinates with the ids they stand for
+class checked_jps2 : public warthog::jps2_expansion_policy
+{
+    public:
+        checked_jps2(warthog::gridmap* map)
+            : warthog::jps2_expansion_policy(map), map_(map),
+              batches_(0), mismatches_(0) { }
+
+        inline void
+        get_successor_xy(const int32_t*& xs, const int32_t*& ys,
+                int32_t& target_x, int32_t& target_y)
+        {
+            warthog::jps2_expansion_policy::get_successor_xy(
+                    xs, ys, target_x, target_y);
+            batches_++;
+            uint32_t x, y;
+            for(uint32_t i = 0; i < num_successors(); i++)
+            {
+                warthog::search_node* n;
+                double cost;
+                get_successor(i, n, cost);
+                map_->to_padded_xy(n->get_id(), x, y);
+                if((int32_t)x != xs[i] || (int32_t)y != ys[i])
+                { mismatches_++; }
+            }
+            map_->to_padded_xy(G::query::goalid, x, y);
+            if((int32_t)x != target_x || (int32_t)y != target_y)
+            { mismatches_++; }
+        }
+
+        warthog::gridmap* map_;
+        uint32_t batches_;
+        uint32_t mismatches_;
+};
+
+// the ids to try on a map @param width wide: every small id, ids on
+// either side of row boundaries and a sample of the rest of the range
+std::vector<warthog::sn_id_t>
+sample_ids(uint32_t width)
+{
+    std::vector<warthog::sn_id_t> ids;
+    for(uint64_t id = 0; id < (1 << 16); id++) { ids.push_back(id); }
+    for(uint64_t row = 1; row * width <= UINT32_MAX; row = row * 3 + 1)
+    {
+        for(int64_t d = -2; d <= 2; d++)
+        {
+            int64_t id = (int64_t)(row * width) + d;
+            if(id >= 0 && id <= UINT32_MAX) { ids.push_back((uint64_t)id); }
+        }
+    }
+    for(uint64_t id = 0; id <= UINT32_MAX; id += 104729) { ids.push_back(id); }
+    ids.push_back(UINT32_MAX);
+    return ids;
+}
+
+int
+main(int argc, char** argv)
+{
+    uint32_t widths[] = { 1, 3, 7, 64, 1000, 1023, 65536, 99991,
+        1 << 20, (1 << 24) + 1 };
+    for(uint32_t width : widths)
+    {
+        warthog::octile_heuristic heuristic(width, 1);
+        std::vector<warthog::sn_id_t> ids = sample_ids(width);
+        warthog::sn_id_t targets[] = { 0, width - 1,
+            (warthog::sn_id_t)width * 7 + 3, UINT32_MAX };
+
+        std::vector<double> batch(ids.size());
+        for(warthog::sn_id_t target : targets)
+        {
+            int32_t x2 = (int32_t)(target % width);
+            int32_t y2 = (int32_t)(target / width);
+            heuristic.h(ids.data(), (uint32_t)ids.size(), target,
+                    batch.data());
+
+            uint32_t mismatches = 0;
+            for(uint32_t i = 0; i < ids.size(); i++)
+            {
+                double expected = heuristic.h(
+                        (int32_t)(ids[i] % width), (int32_t)(ids[i] / width),
+                        x2, y2);
+                if(heuristic.h(ids[i], target) != expected) { mismatches++; }
+                if(batch[i] != expected) { mismatches++; }
+            }
+            CHECK(mismatches == 0);
+        }
+    }
+
+    // jps2 with the coordinates of its jump points gives A*'s costs
+    {
+        warthog::gridmap map("maps/dao/den520d.map");
+        warthog::scenario_manager scenmgr;
+        scenmgr.load_scenario("../scenarios/movingai/dao/den520d.map.scen");
+        warthog::octile_heuristic heuristic(map.width(), map.height());
+        checked_jps2 expander(&map);
+        warthog::pqueue_min open;
+        warthog::flexible_astar<warthog::octile_heuristic, checked_jps2,
+            warthog::pqueue_min> jps2(&heuristic, &expander, &open);
+        warthog::gridmap_expansion_policy ref_expander(&map);
+        warthog::pqueue_min ref_open;
+        warthog::flexible_astar<warthog::octile_heuristic,
+            warthog::gridmap_expansion_policy, warthog::pqueue_min>
+                astar(&heuristic, &ref_expander, &ref_open);
+
+        for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 10)
+        {
+            uint32_t start, target;
+            test::get_ids(scenmgr.get_experiment(i), start, target);
+            warthog::problem_instance pi(start, target);
+            warthog::solution sol, ref_sol;
+            G::nodepool = expander.get_nodepool();
+            jps2.get_pathcost(pi, sol);
+            warthog::problem_instance ref_pi(start, target);
+            G::nodepool = ref_expander.get_nodepool();
+            astar.get_pathcost(ref_pi, ref_sol);
+            CHECK(test::same_cost(sol.sum_of_edge_costs_,
+                        ref_sol.sum_of_edge_costs_));
+        }
+        CHECK(expander.batches_ > 0);
+        CHECK(expander.mismatches_ == 0);
+    }
+
+#ifdef GRID_ID64
+    // a map 100000 wide; the two tiles are 5000 rows apart, one below
+    // 2^32 and one above
+    {
+        uint32_t width = 100000;
+        warthog::octile_heuristic heuristic(width, 50000);
+        warthog::sn_id_t below = ((1ull << 32) / width - 2500) * width + 17;
+        warthog::sn_id_t above = below + (warthog::sn_id_t)5000 * width;
+        CHECK(below < (1ull << 32) && above > (1ull << 32));
+        CHECK(heuristic.h(below, above) == 5000);
+        CHECK(heuristic.h(above, below) == 5000);
+
+        warthog::sn_id_t ids[] = { below, above, above + 3,
+            above + (warthog::sn_id_t)width * 10000 + 1 };
+        double expected[] = { 5000, 0, 3, 10000 + warthog::DBL_ROOT_TWO - 1 };
+        double out[4];
+        heuristic.h(ids, 4, above, out);
+        for(uint32_t i = 0; i < 4; i++)
+        {
+            CHECK(test::same_cost(out[i], expected[i]));
+            CHECK(heuristic.h(ids[i], above) == out[i]);
+        }
+    }
+#endif
+    return test::report("octile_heuristic");
+}
@@ -0,0 +1,139 @@
+// path_unpacker.cpp
+//
+// Unpacks the jump point paths of JPS2 into cells (see
+// src/jps/path_unpacker.h) and checks that every step is a legal move,
+// that the cells cost what the search reported, and that the buffer
+// and iterator interfaces agree.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "jps2_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "path_unpacker.h"
+#include "pqueue.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace G = global;
+
+bool
+legal_step(warthog::gridmap& map, warthog::grid_id_t from,
+        warthog::grid_id_t to)
+{
+    uint32_t x, y, x2, y2;
+    map.to_padded_xy(from, x, y);
+    map.to_padded_xy(to, x2, y2);
+    int32_t dx = (int32_t)x2 - (int32_t)x;
+    int32_t dy = (int32_t)y2 - (int32_t)y;
+    if(abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0)) { return false; }
+    return map.get_label(to) &&
+        map.get_label(x2, y) && map.get_label(x, y2);
+}
+
+void
+check_map(const char* mapfile, const char* scenfile)
+{
+    warthog::gridmap map(mapfile);
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario(scenfile);
+
+    warthog::octile_heuristic heuristic(map.width(), map.height());
+    warthog::jps2_expansion_policy expander(&map);
+    warthog::pqueue_min open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::jps2_expansion_policy,
+        warthog::pqueue_min>
+            astar(&heuristic, &expander, &open);
+    G::nodepool = expander.get_nodepool();
+
+    // costs are checked against plain A*; the costs in the scenario
+    // files need not match this domain (e.g. corner cutting)
+    warthog::gridmap_expansion_policy ref_expander(&map);
+    warthog::pqueue_min ref_open;
+    warthog::flexible_astar<
+        warthog::octile_heuristic,
+        warthog::gridmap_expansion_policy,
+        warthog::pqueue_min>
+            reference(&heuristic, &ref_expander, &ref_open);
+
+    for(uint32_t i = 0; i < scenmgr.num_experiments(); i += 7)
+    {
+        uint32_t start, target;
+        test::get_ids(scenmgr.get_experiment(i), start, target);
+        warthog::problem_instance pi(start, target);
+        warthog::solution sol;
+        astar.get_path(pi, sol);
+        CHECK(sol.status_ == warthog::solution::FOUND);
+        if(sol.status_ != warthog::solution::FOUND) { continue; }
+
+        uint32_t length = warthog::jps::unpacked_length(&map, sol.path_);
+        CHECK(test::same_cost(
+                warthog::jps::path_cost(&map, sol.path_),
+                sol.sum_of_edge_costs_));
+
+        // too small a buffer is left alone
+        std::vector<warthog::grid_id_t> buf(length);
+        if(length > 1)
+        {
+            CHECK(warthog::jps::unpack_path(
+                        &map, sol.path_, buf.data(), length - 1) == length);
+        }
+        CHECK(warthog::jps::unpack_path(
+                    &map, sol.path_, buf.data(), length) == length);
+
+        std::vector<warthog::sn_id_t> cells;
+        warthog::jps::unpack_path(&map, sol.path_, cells);
+        CHECK(cells.size() == length);
+
+        warthog::cost_t cost = 0;
+        for(uint32_t k = 0; k < cells.size(); k++)
+        {
+            CHECK(cells[k] == buf[k]);
+            if(k == 0) { continue; }
+            CHECK(legal_step(map, cells[k-1], cells[k]));
+            uint32_t x, y, x2, y2;
+            map.to_padded_xy(cells[k-1], x, y);
+            map.to_padded_xy(cells[k], x2, y2);
+            cost += (x != x2 && y != y2) ? warthog::DBL_ROOT_TWO : 1;
+        }
+        CHECK(test::same_cost(cost, sol.sum_of_edge_costs_));
+        warthog::solution ref_sol;
+        reference.get_pathcost(pi, ref_sol);
+        CHECK(test::same_cost(cost, ref_sol.sum_of_edge_costs_));
+        if(cells.size())
+        {
+            CHECK(cells.front() == sol.path_.front());
+            CHECK(cells.back() == sol.path_.back());
+        }
+
+        // the iterator starts over after ::reset
+        warthog::jps::path_unpacker it(&map, &sol.path_);
+        uint32_t n = 0;
+        for(warthog::grid_id_t id; it.next(id); ) { n++; }
+        it.reset();
+        warthog::grid_id_t first = 0;
+        CHECK(it.next(first) && first == sol.path_.front());
+        CHECK(n == length);
+    }
+}
+
+int
+main(int argc, char** argv)
+{
+    check_map("maps/dao/arena.map",
+            "../scenarios/movingai/dao/arena.map.scen");
+    check_map("maps/dao/den520d.map",
+            "../scenarios/movingai/dao/den520d.map.scen");
+    check_map("maps/street/Berlin_0_256.map",
+            "../scenarios/movingai/street/Berlin_0_256.map.scen");
+    return test::report("path_unpacker");
+}
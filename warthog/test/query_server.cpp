@@ -0,0 +1,258 @@
+// query_server.cpp
+//
+// Feeds requests to a warthog::query_server (src/util/query_server.h)
+// and checks the replies, including those to requests that are not
+// valid: files that are not maps and binary batches of a bad size; and
+// that with a query cache, queries asked again are answered from it.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "flexible_astar.h"
+#include "global.h"
+#include "gridmap_expansion_policy.h"
+#include "octile_heuristic.h"
+#include "pqueue.h"
+#include "query_server.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace G = global;
+
+class astar_search : public warthog::resident_search
+{
+    public:
+        astar_search(const std::string& mapname)
+            : map_(mapname.c_str()), heuristic_(map_.width(), map_.height()),
+              expander_(&map_), astar_(&heuristic_, &expander_, &open_)
+        { }
+
+        virtual warthog::gridmap*
+        get_map() { return &map_; }
+
+        virtual warthog::search*
+        get_search() { return &astar_; }
+
+        virtual void
+        bind() { G::nodepool = expander_.get_nodepool(); }
+
+        virtual size_t
+        mem() { return astar_.mem(); }
+
+    private:
+        warthog::gridmap map_;
+        warthog::octile_heuristic heuristic_;
+        warthog::gridmap_expansion_policy expander_;
+        warthog::pqueue_min open_;
+        warthog::flexible_astar<
+            warthog::octile_heuristic,
+            warthog::gridmap_expansion_policy,
+            warthog::pqueue_min> astar_;
+};
+
+// run @param server on @param request; @return what it wrote
+std::string
+serve(warthog::query_server& server, const std::string& request,
+        bool& keep_running)
+{
+    FILE* in = fmemopen((void*)request.data(), request.size(), "r");
+    char* reply = 0;
+    size_t reply_size = 0;
+    FILE* out = open_memstream(&reply, &reply_size);
+    keep_running = server.serve(in, out);
+    fclose(in);
+    fclose(out);
+    std::string result(reply, reply_size);
+    free(reply);
+    return result;
+}
+
+std::string
+binary_request(const std::string& head,
+        const warthog::query_server::binary_query* queries, uint32_t num)
+{
+    std::string request = head + "\n";
+    request.append((const char*)queries,
+            num * sizeof(warthog::query_server::binary_query));
+    return request;
+}
+
+int
+main(int argc, char** argv)
+{
+    warthog::query_server::factory_fn factory =
+        [](const std::string& name) -> warthog::resident_search*
+        {
+            if(!warthog::gridmap::is_map_file(name.c_str())) { return 0; }
+            return new astar_search(name);
+        };
+    warthog::query_server server(factory);
+
+    // a query from the scenario file, and its cost
+    warthog::scenario_manager scenmgr;
+    scenmgr.load_scenario("../scenarios/movingai/dao/arena.map.scen");
+    warthog::experiment* exp =
+        scenmgr.get_experiment(scenmgr.num_experiments() / 2);
+    warthog::query_server::binary_query q =
+        { exp->startx(), exp->starty(), exp->goalx(), exp->goaly() };
+    astar_search reference("maps/dao/arena.map");
+    reference.bind();
+    uint32_t start, target;
+    test::get_ids(exp, start, target);
+    warthog::problem_instance pi(start, target);
+    warthog::solution sol;
+    reference.get_search()->get_pathcost(pi, sol);
+    CHECK(sol.status_ == warthog::solution::FOUND);
+    std::ostringstream text_query;
+    text_query << q.sx_ << " " << q.sy_ << " " << q.tx_ << " " << q.ty_;
+
+    // files that are not maps, or not there, are refused and the
+    // session goes on
+    const char* notamap = "/tmp/warthog-test-notamap";
+    std::ofstream(notamap) << "localhost\n";
+    const char* truncated = "/tmp/warthog-test-truncated.map";
+    std::ofstream(truncated) << "type octile\nheight 4\nwidth 4\nmap\n....\n";
+    bool keep_running = false;
+    std::string reply = serve(server,
+            std::string("map ") + notamap + "\n" +
+            "map " + truncated + "\n" +
+            "map /nonexistent.map\n" +
+            "map maps/dao/arena.map\n" +
+            text_query.str() + "\n\n" +
+            "quit\n", keep_running);
+    remove(notamap);
+    remove(truncated);
+    CHECK(keep_running);
+    std::string head = std::string("err; cannot load map ") + notamap + "\n" +
+            "err; cannot load map " + truncated + "\n" +
+            "err; cannot load map /nonexistent.map\n" +
+            "ok 49 49\n";
+    CHECK(reply.compare(0, head.size(), head) == 0);
+    double cost = -1;
+    std::istringstream(reply.substr(std::min(head.size(), reply.size())))
+        >> cost;
+    CHECK(test::same_cost(cost, sol.sum_of_edge_costs_));
+    CHECK(server.get_num_maps() == 1);
+
+    // binary batches get the same answers
+    warthog::query_server::binary_query queries[2] = { q, q };
+    std::string request = binary_request(
+            "map maps/dao/arena.map\nbinary 2", queries, 2) + "quit\n";
+    reply = serve(server, request, keep_running);
+    CHECK(keep_running);
+    head = "ok 49 49\n";
+    CHECK(reply.size() == head.size() +
+            2 * sizeof(warthog::query_server::binary_reply));
+    if(reply.size() == head.size() +
+            2 * sizeof(warthog::query_server::binary_reply))
+    {
+        warthog::query_server::binary_reply replies[2];
+        memcpy(replies, reply.data() + head.size(), sizeof(replies));
+        for(warthog::query_server::binary_reply& r : replies)
+        {
+            CHECK(r.status_ == warthog::solution::FOUND);
+            CHECK(test::same_cost(r.cost_, sol.sum_of_edge_costs_));
+        }
+    }
+
+    // edits are seen by batches once they are committed: blocking the
+    // target leaves no path, opening it again restores the cost
+    std::ostringstream target_tile;
+    target_tile << q.tx_ << " " << q.ty_;
+    reply = serve(server, "map maps/dao/arena.map\n"
+            "set " + target_tile.str() + " 0\n" +
+            text_query.str() + "\n\n" +
+            "commit\n" +
+            text_query.str() + "\n\n" +
+            "set " + target_tile.str() + " 1\n" +
+            "commit\n" +
+            text_query.str() + "\n\n" +
+            "set 49 0 1\nset 0 0 2\nset 0 0\nquit\n", keep_running);
+    CHECK(keep_running);
+    {
+        std::istringstream lines(reply);
+        std::string line;
+        std::vector<std::string> got;
+        while(std::getline(lines, line)) { got.push_back(line); }
+        CHECK(got.size() == 9);
+        if(got.size() == 9)
+        {
+            CHECK(got[0] == "ok 49 49");
+            CHECK(test::same_cost(atof(got[1].c_str()),
+                        sol.sum_of_edge_costs_));
+            CHECK(got[2] == "ok 1");
+            CHECK(atof(got[3].c_str()) == -1);
+            CHECK(got[4] == "ok 2");
+            CHECK(test::same_cost(atof(got[5].c_str()),
+                        sol.sum_of_edge_costs_));
+            CHECK(got[6] == "err; invalid edit: set 49 0 1");
+            CHECK(got[7] == "err; invalid edit: set 0 0 2");
+            CHECK(got[8] == "err; invalid edit: set 0 0");
+        }
+    }
+
+    // a bad count ends the session before anything is allocated
+    const char* bad[] = { "binary 99999999999", "binary -1", "binary",
+        "binary 1048577" };
+    for(const char* line : bad)
+    {
+        reply = serve(server, "map maps/dao/arena.map\n" +
+                std::string(line) + "\nquit\n", keep_running);
+        CHECK(keep_running);
+        CHECK(reply == std::string("ok 49 49\nerr; invalid binary batch: ") +
+                line + "\n");
+    }
+
+    // too few records: the session ends without a reply to the batch
+    reply = serve(server, binary_request(
+                "map maps/dao/arena.map\nbinary 3", queries, 2),
+            keep_running);
+    CHECK(reply == "ok 49 49\n");
+
+    // with a cache, the second time a query is asked it expands nothing;
+    // after an edit that opens a tile it is searched again
+    {
+        warthog::query_server cached_server(factory, 0, 1024);
+        CHECK(cached_server.get_cache() != 0);
+        reply = serve(cached_server, "map maps/dao/arena.map\n" +
+                text_query.str() + "\n\n" +
+                text_query.str() + "\n\n" +
+                "set 0 0 1\ncommit\n" +
+                text_query.str() + "\n\n" +
+                "stats\nquit\n", keep_running);
+        CHECK(keep_running);
+        std::istringstream lines(reply);
+        std::string line;
+        std::vector<std::string> got;
+        while(std::getline(lines, line)) { got.push_back(line); }
+        CHECK(got.size() == 6);
+        if(got.size() == 6)
+        {
+            double cost[3];
+            uint32_t expanded[3];
+            for(uint32_t i = 0; i < 3; i++)
+            {
+                std::istringstream(got[i == 2 ? 4 : i + 1])
+                    >> cost[i] >> expanded[i];
+                CHECK(test::same_cost(cost[i], sol.sum_of_edge_costs_));
+            }
+            CHECK(expanded[0] > 0);
+            CHECK(expanded[1] == 0);
+            CHECK(expanded[2] > 0);
+            CHECK(got[5].find(" cache_hits 1 ") != std::string::npos);
+        }
+        CHECK(cached_server.get_cache()->get_hits() == 1);
+    }
+
+    reply = serve(server, "shutdown\n", keep_running);
+    CHECK(!keep_running);
+    return test::report("query_server");
+}
@@ -0,0 +1,64 @@
+#ifndef WARTHOG_TEST_TEST_H
+#define WARTHOG_TEST_TEST_H
+
+// test/test.h
+//
+// The few helpers shared by the test programs in this directory. Each
+// test is a program that exits with a nonzero status if any check
+// failed. Tests are built with `make [flavour] test` and run, from the
+// warthog directory, with `make [flavour] check`; paths to maps and
+// scenarios are relative to the warthog directory.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "experiment.h"
+#include "gridmap.h"
+#include "scenario_manager.h"
+
+#include <cmath>
+#include <iostream>
+
+namespace test
+{
+
+static uint32_t failures = 0;
+
+#define CHECK(cond) \
+    do \
+    { \
+        if(!(cond)) \
+        { \
+            std::cerr << __FILE__ << ":" << __LINE__ \
+                << ": check failed: " #cond "\n"; \
+            test::failures++; \
+        } \
+    } while(0)
+
+inline bool
+same_cost(double a, double b) { return std::fabs(a - b) < 1e-4; }
+
+// the unpadded ids of the start and target of @param exp
+inline void
+get_ids(warthog::experiment* exp, uint32_t& start, uint32_t& target)
+{
+    start = exp->starty() * exp->mapwidth() + exp->startx();
+    target = exp->goaly() * exp->mapwidth() + exp->goalx();
+}
+
+inline int
+report(const char* name)
+{
+    if(test::failures)
+    {
+        std::cerr << name << ": " << test::failures << " checks failed\n";
+        return 1;
+    }
+    std::cerr << name << ": ok\n";
+    return 0;
+}
+
+}
+
+#endif
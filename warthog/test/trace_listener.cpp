@@ -0,0 +1,87 @@
+// trace_listener.cpp
+//
+// Records events with a warthog::trace_listener
+// (src/search/trace_listener.h) and reads the trace back: the ids and
+// parent ids come out as they went in, also past 2^32 with
+// -DGRID_ID64, and a start node has no parent.
+//
+// @author: agent
+// @created: 2026-10-19
+//
+
+#include "test.h"
+
+#include "jps.h"
+#include "search_node.h"
+#include "trace_listener.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+const char* TRACEFILE = "/tmp/warthog-test-trace.bin";
+
+int
+main(int argc, char** argv)
+{
+    std::vector<warthog::sn_id_t> ids = { 7, UINT32_MAX - 1 };
+#ifdef GRID_ID64
+    ids.push_back((1ull << 32) + 5);
+    ids.push_back((1ull << 40) + 3);
+#endif
+
+    {
+        // small chunks, so the writer thread gets several
+        warthog::trace_listener tracer(TRACEFILE, 0, 2, 2);
+        CHECK(tracer.good());
+        warthog::search_node start(ids.back());
+        start.init(0, warthog::SN_ID_MAX, 0, 0);
+        tracer.generate_node(0, &start, 0, 0);
+        tracer.expand_node(&start);
+        for(warthog::sn_id_t id : ids)
+        {
+            warthog::search_node child(id);
+            child.init(0, start.get_id(), 1, 1);
+            tracer.generate_node(&start, &child, 1, 0);
+            tracer.relax_node(&child);
+            tracer.jump_segment((warthog::grid_id_t)start.get_id(),
+                    (warthog::grid_id_t)id, warthog::jps::EAST, 1);
+        }
+        tracer.flush();
+        CHECK(tracer.num_events() == 2 + 3 * ids.size());
+    }
+
+    FILE* fd = fopen(TRACEFILE, "rb");
+    CHECK(fd != 0);
+    if(fd == 0) { return test::report("trace_listener"); }
+    warthog::trace::header hdr;
+    CHECK(fread(&hdr, sizeof(hdr), 1, fd) == 1);
+    CHECK(memcmp(hdr.magic_, warthog::trace::TRACE_MAGIC, 4) == 0);
+    CHECK(hdr.version_ == warthog::trace::TRACE_VERSION);
+    std::vector<warthog::trace::event> events(2 + 3 * ids.size() + 1);
+    CHECK(fread(&events[0], sizeof(warthog::trace::event), events.size(), fd)
+            == events.size() - 1);
+    fclose(fd);
+    remove(TRACEFILE);
+
+    warthog::grid_id_t start_id = (warthog::grid_id_t)ids.back();
+    CHECK(events[0].type_ == warthog::trace::QUERY);
+    CHECK(events[0].id_ == start_id);
+    CHECK(events[0].from_ == warthog::GRID_ID_MAX);
+    CHECK(events[1].type_ == warthog::trace::EXPAND);
+    CHECK(events[1].from_ == warthog::GRID_ID_MAX);
+    for(uint32_t i = 0; i < ids.size(); i++)
+    {
+        warthog::trace::event* e = &events[2 + 3 * i];
+        CHECK(e[0].type_ == warthog::trace::GENERATE);
+        CHECK(e[1].type_ == warthog::trace::RELAX);
+        CHECK(e[2].type_ == warthog::trace::JUMP);
+        CHECK(e[2].dir_ == warthog::jps::EAST);
+        for(uint32_t j = 0; j < 3; j++)
+        {
+            CHECK(e[j].id_ == (warthog::grid_id_t)ids[i]);
+            CHECK(e[j].from_ == start_id);
+        }
+    }
+    return test::report("trace_listener");
+}